@@ -0,0 +1,53 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+
+//
+// Benchmarks print one line per case: the best of several runs,
+// so a preempted run does not count
+//
+namespace bench
+{
+    constexpr int Runs = 5;
+
+    //
+    // Nanoseconds per call of body(), called iterations times per run
+    //
+    template <typename Body>
+    double NsPerCall(uint64_t iterations, Body&& body)
+    {
+        double best = 0;
+
+        for (int run = 0; run < Runs; ++run)
+        {
+            const auto start = std::chrono::steady_clock::now();
+
+            for (uint64_t i = 0; i < iterations; ++i)
+            {
+                body(i);
+            }
+
+            const double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+            best = run ? std::min(best, ns) : ns;
+        }
+
+        return best / iterations;
+    }
+
+    //
+    // Keeps a computed value alive so the optimizer cannot drop the work
+    //
+    template <typename T>
+    void DoNotOptimize(const T& value)
+    {
+#if defined(__GNUC__) || defined(__clang__)
+        asm volatile("" : : "r,m"(value) : "memory");
+#else
+        static const T* volatile sink;
+        sink = &value;
+#endif
+    }
+}
@@ -0,0 +1,52 @@
+#include "BenchHarness.h"
+#include "FrameDiff.h"
+
+#include <vector>
+
+using namespace video;
+
+//
+// Per-frame cost of the frame difference on 1080p and 4K NV12 frames
+// with the scalar and the SIMD kernel. Two frames alternate so every
+// call compares new content
+//
+int main()
+{
+    const struct { uint32_t width; uint32_t height; } sizes[] = { { 1920, 1080 }, { 3840, 2160 } };
+
+    for (const auto& size : sizes)
+    {
+        std::vector<uint8_t> buffers[2];
+        FrameView frames[2];
+
+        for (size_t i = 0; i < 2; ++i)
+        {
+            buffers[i].resize(static_cast<size_t>(size.width) * size.height * 3 / 2);
+
+            for (size_t j = 0; j < buffers[i].size(); ++j)
+            {
+                buffers[i][j] = static_cast<uint8_t>(j * (7 + i * 6) + (j >> 11));
+            }
+
+            frames[i] = MakeFrameView(PixelFormat::NV12, size.width, size.height, buffers[i].data(), size.width);
+        }
+
+        std::printf("%ux%u NV12, us per frame:", size.width, size.height);
+
+        for (ConvertKernel kernel : { ConvertKernel::Scalar, ConvertKernel::Auto })
+        {
+            FrameDiffDetector detector(kernel);
+
+            const double us = bench::NsPerCall(20000, [&](uint64_t i)
+            {
+                bench::DoNotOptimize(detector.OnFrame(frames[i % 2]));
+            }) / 1e3;
+
+            std::printf(" %s %.2f", kernel == ConvertKernel::Scalar ? "scalar" : "simd", us);
+        }
+
+        std::printf("\n");
+    }
+
+    return 0;
+}
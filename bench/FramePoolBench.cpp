@@ -0,0 +1,101 @@
+#include "BenchHarness.h"
+#include "FramePool.h"
+
+#include <new>
+
+using namespace video;
+
+namespace
+{
+    //
+    // Frames in flight: one being filled, the rest queued to the sink
+    //
+    constexpr size_t Depth = 4;
+    constexpr size_t PageBytes = 4096;
+
+    //
+    // A capture writes the whole frame, a fresh allocation of this size
+    // is mapped on first touch. One byte per page pays the faults without
+    // the copy
+    //
+    void TouchPages(uint8_t* data, size_t size) noexcept
+    {
+        for (size_t offset = 0; offset < size; offset += PageBytes)
+        {
+            data[offset] = static_cast<uint8_t>(offset);
+        }
+    }
+
+    double PoolNs(const FrameFormat& format, bool touch)
+    {
+        FramePool pool(Depth * format.BufferSize() * 2);
+        FrameRef frames[Depth];
+
+        return bench::NsPerCall(2000, [&](uint64_t i)
+        {
+            FrameRef& frame = frames[i % Depth];
+            frame = pool.Acquire(format);
+
+            if (touch)
+            {
+                TouchPages(frame->Data(), frame->Size());
+            }
+
+            bench::DoNotOptimize(frame->Data());
+        });
+    }
+
+    //
+    // The same 64-byte aligned buffer from the heap for every frame
+    //
+    double HeapNs(const FrameFormat& format, bool touch)
+    {
+        const size_t size = format.BufferSize();
+        uint8_t* frames[Depth] = {};
+
+        const double ns = bench::NsPerCall(2000, [&](uint64_t i)
+        {
+            uint8_t*& frame = frames[i % Depth];
+            ::operator delete[](frame, std::align_val_t(FrameAlignment));
+            frame = static_cast<uint8_t*>(::operator new[](size, std::align_val_t(FrameAlignment)));
+
+            if (touch)
+            {
+                TouchPages(frame, size);
+            }
+
+            bench::DoNotOptimize(frame);
+        });
+
+        for (uint8_t* frame : frames)
+        {
+            ::operator delete[](frame, std::align_val_t(FrameAlignment));
+        }
+
+        return ns;
+    }
+}
+
+//
+// Steady state acquire and release of 1080p and 4K NV12 frames with
+// four in flight, from the pool and from the heap per frame. The pool
+// only allocates for the first four frames of the first run
+//
+int main()
+{
+    const struct { uint32_t width; uint32_t height; } sizes[] = { { 1920, 1080 }, { 3840, 2160 } };
+
+    for (const auto& size : sizes)
+    {
+        const FrameFormat format = FramePool::AlignedFormat(PixelFormat::NV12, size.width, size.height);
+
+        std::printf("%ux%u NV12, us per frame: pool %.3f, new[] %.3f, touching every page: pool %.1f, new[] %.1f\n",
+            size.width, size.height,
+            PoolNs(format, false) / 1e3,
+            HeapNs(format, false) / 1e3,
+            PoolNs(format, true) / 1e3,
+            HeapNs(format, true) / 1e3);
+    }
+
+    return 0;
+}
@@ -0,0 +1,84 @@
+#include "BenchHarness.h"
+#include "FrameVerifier.h"
+#include "SyntheticSource.h"
+
+#include <vector>
+
+using namespace video;
+
+namespace
+{
+    constexpr uint32_t Width = 3840;
+    constexpr uint32_t Height = 2160;
+    constexpr uint64_t Frames = 20;
+
+    //
+    // Milliseconds per frame of rendering the gradient, with the frame
+    // passed to the sink when there is one
+    //
+    double RenderMs(PixelFormat format, VerifySink* sink)
+    {
+        SyntheticSource source(format, Width, Height, 60, 1, TestPattern::Gradient);
+
+        return bench::NsPerCall(Frames, [&](uint64_t)
+        {
+            int64_t timestamp = 0;
+            const FrameView frame = source.Next(timestamp);
+
+            if (sink)
+            {
+                sink->OnFrame(frame, timestamp);
+            }
+
+            bench::DoNotOptimize(frame);
+        }) / 1e6;
+    }
+}
+
+//
+// The hash alone over 64 MB, then the hash plus gradient check of 4K frames.
+// The frames are rendered in the loop since the gradient must advance,
+// the render time is measured alone and taken off
+//
+int main()
+{
+    std::vector<uint8_t> data(64 << 20);
+
+    for (size_t i = 0; i < data.size(); ++i)
+    {
+        data[i] = static_cast<uint8_t>(i * 31 + (i >> 12));
+    }
+
+    std::printf("hash GB/s:");
+
+    for (ConvertKernel kernel : { ConvertKernel::Scalar, ConvertKernel::Auto })
+    {
+        const double ns = bench::NsPerCall(4, [&](uint64_t)
+        {
+            FrameHasher hasher(kernel);
+            hasher.Update(data.data(), data.size());
+            bench::DoNotOptimize(hasher.Final());
+        });
+
+        std::printf(" %s %.2f", kernel == ConvertKernel::Scalar ? "scalar" : "simd", data.size() / ns);
+    }
+
+    std::printf("\n");
+
+    for (PixelFormat format : { PixelFormat::YUY2, PixelFormat::NV12, PixelFormat::RGB32 })
+    {
+        VerifySink simd(TestPattern::Gradient);
+        VerifySink scalar(TestPattern::Gradient, ColorSpace(), ConvertKernel::Scalar);
+
+        const double render = RenderMs(format, nullptr);
+        const double verifySimd = RenderMs(format, &simd) - render;
+        const double verifyScalar = RenderMs(format, &scalar) - render;
+        const VerifySink::Report report = simd.GetReport();
+
+        std::printf("%ux%u %ls, ms per frame: verify %.2f, scalar hash %.2f (%llu of %llu frames mismatched)\n",
+            Width, Height, PixelFormatName(format), verifySimd, verifyScalar,
+            static_cast<unsigned long long>(report.mismatched), static_cast<unsigned long long>(report.frames));
+    }
+
+    return 0;
+}
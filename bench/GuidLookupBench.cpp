@@ -0,0 +1,86 @@
+#include "BenchHarness.h"
+#include "GuidRegistry.h"
+
+#include <random>
+#include <string>
+#include <vector>
+
+//
+// GuidToName before and after the registry: the old code compared the
+// guid with every listed guid in turn and returned a new std::wstring,
+// the registry binary-searches a sorted table and returns a view.
+// The keys are a media type's worth of attributes, one in ten unregistered
+//
+namespace
+{
+    constexpr size_t GuidCount = 180;
+    constexpr size_t KeyCount = 4096;
+
+    GUID MakeGuid(uint32_t i)
+    {
+        GUID guid = { 0x32595559u + i * 0x01000193u, 0x0000, 0x0010,
+            { 0x80, 0x00, 0x00, 0xaa, 0x00, 0x38, 0x9b, 0x71 } };
+        return guid;
+    }
+
+    std::wstring IfChainToName(const std::vector<utils::GuidName>& names, const GUID& guid)
+    {
+        for (const auto& name : names)
+        {
+            if (name.guid == guid)
+            {
+                return std::wstring(name.name);
+            }
+        }
+
+        return L"<unknown>";
+    }
+}
+
+int main()
+{
+    std::vector<std::wstring> strings;
+    std::vector<utils::GuidName> names;
+
+    for (uint32_t i = 0; i < GuidCount; ++i)
+    {
+        strings.push_back(L"MF_MT_ATTRIBUTE_NAME_" + std::to_wstring(i));
+    }
+
+    for (uint32_t i = 0; i < GuidCount; ++i)
+    {
+        names.push_back({ MakeGuid(i), strings[i] });
+    }
+
+    const utils::GuidRegistry registry(names);
+
+    std::mt19937 random(1);
+    std::vector<GUID> keys;
+
+    for (size_t i = 0; i < KeyCount; ++i)
+    {
+        keys.push_back(MakeGuid(0 == i % 10 ? static_cast<uint32_t>(GuidCount + i) : random() % GuidCount));
+    }
+
+    const double chain = bench::NsPerCall(1000000, [&](uint64_t i)
+    {
+        const std::wstring name = IfChainToName(names, keys[i % KeyCount]);
+        bench::DoNotOptimize(name);
+    });
+
+    const double view = bench::NsPerCall(1000000, [&](uint64_t i)
+    {
+        const std::wstring_view name = registry.Find(keys[i % KeyCount]);
+        bench::DoNotOptimize(name);
+    });
+
+    const double copy = bench::NsPerCall(1000000, [&](uint64_t i)
+    {
+        const std::wstring name(registry.Find(keys[i % KeyCount]));
+        bench::DoNotOptimize(name);
+    });
+
+    std::printf("%zu guids, lookup ns: if-chain + wstring %.1f, registry view %.1f, registry + wstring %.1f\n",
+        GuidCount, chain, view, copy);
+    return 0;
+}
@@ -0,0 +1,105 @@
+#include "BenchHarness.h"
+#include "MediaTypeCatalog.h"
+#include "FakeBackend.h"
+
+#include <filesystem>
+
+using namespace capture;
+
+//
+// A catalog of 20 devices with 2 streams of 250 media types each, 10k types:
+// building and saving it cold, loading it, and looking up and decoding
+// every type of every device from the loaded catalog
+//
+int main()
+{
+    std::vector<FakeBackend::DeviceConfig> configs;
+
+    for (int device = 0; device < 20; ++device)
+    {
+        FakeBackend::DeviceConfig config;
+        config.friendlyName = L"Bench Camera " + std::to_wstring(device);
+        config.symbolicLink = L"\\\\?\\usb#vid_046d&pid_0825&mi_00#" + std::to_wstring(device) + L"#{e5323777-f976-4f5b-9b55-b94699c46e44}\\global";
+        config.fingerprint = 100 + device;
+
+        for (uint32_t stream = 0; stream < 2; ++stream)
+        {
+            StreamInfo info;
+            info.index = stream;
+
+            for (uint32_t i = 0; i < 250; ++i)
+            {
+                info.mediaTypes.push_back(FakeBackend::MakeMediaType(
+                    i, (i % 2) ? video::PixelFormat::YUY2 : video::PixelFormat::NV12, 160 + i * 8, 120 + i * 4, 30));
+            }
+
+            config.streams.push_back(info);
+        }
+
+        configs.push_back(config);
+    }
+
+    FakeBackend backend(configs);
+    DeviceList devices;
+    backend.EnumDevices(devices);
+
+    const std::filesystem::path directory = std::filesystem::temp_directory_path() / "msmf_catalog_bench";
+    const std::wstring path = (directory / "media-types.catalog").wstring();
+
+    const double build = bench::NsPerCall(1, [&](uint64_t)
+    {
+        std::filesystem::remove_all(directory);
+        StreamCache cache(path);
+
+        for (const auto& device : devices)
+        {
+            std::vector<StreamInfo> streams;
+            cache.GetStreams(*device, streams);
+        }
+
+        cache.Save();
+    }) / 1e6;
+
+    const double load = bench::NsPerCall(100, [&](uint64_t)
+    {
+        MediaTypeCatalog catalog;
+        catalog.Load(path);
+        bench::DoNotOptimize(catalog);
+    }) / 1e6;
+
+    MediaTypeCatalog catalog;
+
+    if (FAILED(catalog.Load(path)))
+    {
+        std::printf("cannot load %ls\n", path.c_str());
+        return 1;
+    }
+
+    size_t mediaTypes = 0;
+
+    const double lookup = bench::NsPerCall(10, [&](uint64_t)
+    {
+        mediaTypes = 0;
+
+        for (const auto& device : devices)
+        {
+            size_t index = 0;
+            MediaTypeCatalog::DeviceEntry entry;
+
+            if (S_OK == catalog.Find(device->GetSymbolicLink(), device->GetFingerprint(), index)
+                && SUCCEEDED(catalog.GetDevice(index, entry)))
+            {
+                for (const auto& stream : entry.streams)
+                {
+                    mediaTypes += stream.mediaTypes.size();
+                }
+            }
+        }
+    }) / 1e6;
+
+    std::printf("%zu media types: cold build and save %.2f ms, load %.3f ms, lookup and decode %.2f ms\n",
+        mediaTypes, build, load, lookup);
+
+    std::filesystem::remove_all(directory);
+    return 0;
+}
@@ -0,0 +1,108 @@
+#include "BenchHarness.h"
+#include "MediaTypeFormatter.h"
+
+#include <sstream>
+#include <vector>
+
+using namespace capture;
+
+namespace
+{
+    //
+    // The field-by-field wostream output the formatter replaced
+    //
+    void PrintPerField(const MediaTypeInfo& mediaType, std::wostream& st)
+    {
+        st << "\n\n Stream ID : " << 0 << "\n Media type ID : " << mediaType.index;
+        st << "\n\r SUBTYPE : " << mediaType.subtype;
+        st << "\n\r FRAME_SIZE : " << mediaType.width << " x " << mediaType.height;
+        st << "\n\r FRAME_RATE : " << mediaType.Fps();
+        st << "\n\r DEFAULT_STRIDE : " << mediaType.defaultStride;
+        st << "\n\r COLOR_MATRIX : " << (mediaType.colorSpace.matrix == video::YuvMatrix::BT709 ? L"BT709" : L"BT601");
+        st << "\n\r COLOR_RANGE : " << (mediaType.colorSpace.range == video::YuvRange::Full ? L"full" : L"studio");
+    }
+
+    size_t FormatAll(MediaTypeFormatter& formatter, const std::vector<MediaTypeInfo>& mediaTypes)
+    {
+        std::wostringstream st;
+
+        for (const auto& mediaType : mediaTypes)
+        {
+            formatter.BeginRecord(L"USB Camera", 0, mediaType.index);
+            FormatMediaTypeInfo(mediaType, formatter);
+            formatter.EndRecord();
+        }
+
+        const size_t size = formatter.GetBuffer().size();
+        formatter.Flush(st);
+        return size;
+    }
+}
+
+//
+// 10k media types as text the old way and through the formatter
+// in every output format
+//
+int main()
+{
+    const wchar_t* subtypes[] = { L"MFVideoFormat_NV12", L"MFVideoFormat_YUY2", L"MFVideoFormat_MJPG" };
+    std::vector<MediaTypeInfo> mediaTypes(10000);
+
+    for (size_t i = 0; i < mediaTypes.size(); ++i)
+    {
+        MediaTypeInfo& mediaType = mediaTypes[i];
+        mediaType.index = static_cast<uint32_t>(i);
+        mediaType.subtype = subtypes[i % 3];
+        mediaType.width = static_cast<uint32_t>(160 + (i % 40) * 32);
+        mediaType.height = static_cast<uint32_t>(120 + (i % 30) * 24);
+        mediaType.fpsNumerator = (i % 4 == 3) ? 30000 : static_cast<uint32_t>(30 - i % 3 * 5);
+        mediaType.fpsDenominator = (i % 4 == 3) ? 1001 : 1;
+        mediaType.defaultStride = (i % 5 == 0) ? -static_cast<int32_t>(mediaType.width * 3) : static_cast<int32_t>(mediaType.width * 2);
+    }
+
+    {
+        std::wostringstream perField;
+        std::wostringstream formatted;
+        MediaTypeFormatter formatter(OutputFormat::Text);
+
+        for (const auto& mediaType : mediaTypes)
+        {
+            PrintPerField(mediaType, perField);
+            formatter.BeginRecord(L"USB Camera", 0, mediaType.index);
+            FormatMediaTypeInfo(mediaType, formatter);
+            formatter.EndRecord();
+        }
+
+        formatter.Flush(formatted);
+        std::printf("text output %s\n", perField.str() == formatted.str() ? "identical" : "differs");
+    }
+
+    const double perField = bench::NsPerCall(1, [&](uint64_t)
+    {
+        std::wostringstream st;
+
+        for (const auto& mediaType : mediaTypes)
+        {
+            PrintPerField(mediaType, st);
+        }
+
+        bench::DoNotOptimize(st);
+    }) / 1e6;
+
+    std::printf("%zu media types, ms: per-field wostream %.2f", mediaTypes.size(), perField);
+
+    for (OutputFormat format : { OutputFormat::Text, OutputFormat::Json, OutputFormat::Csv })
+    {
+        MediaTypeFormatter formatter(format);
+
+        const double ms = bench::NsPerCall(1, [&](uint64_t)
+        {
+            bench::DoNotOptimize(FormatAll(formatter, mediaTypes));
+        }) / 1e6;
+
+        std::printf(", formatter %ls %.2f", OutputFormatName(format), ms);
+    }
+
+    std::printf("\n");
+    return 0;
+}
@@ -0,0 +1,89 @@
+#include "BenchHarness.h"
+#include "MosaicCompositor.h"
+
+#include <vector>
+
+using namespace video;
+
+namespace
+{
+    constexpr uint32_t Width = 1920;
+    constexpr uint32_t Height = 1080;
+    constexpr size_t Tiles = 8;
+
+    std::vector<uint8_t> MakePixels(size_t size, uint32_t step)
+    {
+        std::vector<uint8_t> pixels(size);
+
+        for (size_t i = 0; i < pixels.size(); ++i)
+        {
+            pixels[i] = static_cast<uint8_t>(i * step);
+        }
+
+        return pixels;
+    }
+}
+
+//
+// 8 tiles of 1080p NV12 and YUY2 into a 1920x1080 canvas: the cost of
+// a Submit on the capture thread, of composing a display frame where
+// every tile has a new frame, and of the full-frame convert and scale
+// per tile the compositor replaced
+//
+int main()
+{
+    const std::vector<uint8_t> nv12 = MakePixels(Width * Height * 3 / 2, 7);
+    const std::vector<uint8_t> yuy2 = MakePixels(Width * Height * 2, 13);
+    const FrameView frames[] = {
+        MakeFrameView(PixelFormat::YUY2, Width, Height, yuy2.data(), Width * 2),
+        MakeFrameView(PixelFormat::NV12, Width, Height, nv12.data(), Width),
+    };
+
+    MosaicCompositor mosaic(Tiles, Width, Height);
+
+    const double submit = bench::NsPerCall(400, [&](uint64_t i)
+    {
+        mosaic.Submit(i % Tiles, frames[i % 2], static_cast<int64_t>(i));
+    }) / 1e6;
+
+    //
+    // Compose draws only the tiles with a new frame, so every tile gets one
+    // before each call and the submits are taken off the result
+    //
+    size_t drawn = 0;
+
+    const double composeAndSubmit = bench::NsPerCall(60, [&](uint64_t i)
+    {
+        for (size_t tile = 0; tile < Tiles; ++tile)
+        {
+            mosaic.Submit(tile, frames[tile % 2], static_cast<int64_t>(i));
+        }
+
+        drawn = mosaic.Compose();
+    }) / 1e6;
+
+    const std::vector<TileRect> cells = GridLayout(Tiles, Width, Height, 2);
+    std::vector<uint8_t> full(Width * Height * 4);
+    std::vector<uint8_t> canvas(Width * Height * 4);
+    const PixelConverter converters[] = {
+        PixelConverter(PixelFormat::YUY2, PixelFormat::RGB32, Width, Height, ColorSpace()),
+        PixelConverter(PixelFormat::NV12, PixelFormat::RGB32, Width, Height, ColorSpace()),
+    };
+
+    const double baseline = bench::NsPerCall(10, [&](uint64_t)
+    {
+        for (size_t tile = 0; tile < Tiles; ++tile)
+        {
+            const TileRect rect = FitRect(cells[tile], Width, Height);
+            converters[tile % 2].Convert(frames[tile % 2].planes, full.data(), Width * 4);
+            ScaleRgb32(full.data(), Width * 4, Width, Height,
+                canvas.data() + (static_cast<size_t>(rect.y) * Width + rect.x) * 4, Width * 4, rect.width, rect.height);
+        }
+
+        bench::DoNotOptimize(canvas);
+    }) / 1e6;
+
+    std::printf("%zu tiles of %ux%u, ms: submit %.3f per frame, compose %.2f per display frame (%zu drawn), full-frame baseline %.2f\n",
+        Tiles, Width, Height, submit, composeAndSubmit - submit * Tiles, drawn, baseline);
+    return 0;
+}
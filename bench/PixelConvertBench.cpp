@@ -0,0 +1,68 @@
+#include "BenchHarness.h"
+#include "PixelConvert.h"
+
+#include <vector>
+
+using namespace video;
+
+//
+// One 1080p frame of every YUV format and RGB24 converted to RGB32 and
+// YUY2, scalar against SSE2. At 60 fps a frame has 16.7 ms
+//
+int main()
+{
+    constexpr uint32_t Width = 1920;
+    constexpr uint32_t Height = 1080;
+    constexpr uint64_t Frames = 50;
+
+    const PixelFormat formats[] = { PixelFormat::NV12, PixelFormat::YUY2, PixelFormat::UYVY, PixelFormat::I420, PixelFormat::YV12, PixelFormat::RGB24 };
+    const PixelFormat targets[] = { PixelFormat::RGB32, PixelFormat::YUY2 };
+
+    std::vector<uint8_t> src(Width * Height * 3);
+    std::vector<uint8_t> dst(Width * Height * 4);
+
+    for (size_t i = 0; i < src.size(); ++i)
+    {
+        src[i] = static_cast<uint8_t>(i * 7919 >> 3);
+    }
+
+    for (PixelFormat target : targets)
+    {
+        for (PixelFormat format : formats)
+        {
+            if (!PixelConverter::IsSupported(format, target) || format == target)
+            {
+                continue;
+            }
+
+            const bool planar = PlaneCount(format) > 1;
+            const Plane planes[MaxPlanes] =
+            {
+                { src.data(), static_cast<ptrdiff_t>(Width * BytesPerPixel(format)) },
+                { src.data() + Width * Height, static_cast<ptrdiff_t>(format == PixelFormat::NV12 ? Width : Width / 2) },
+                { src.data() + Width * Height * 5 / 4, static_cast<ptrdiff_t>(Width / 2) },
+            };
+
+            const ptrdiff_t dstStride = Width * BytesPerPixel(target);
+            double ms[2] = {};
+            int index = 0;
+
+            for (ConvertKernel kernel : { ConvertKernel::Scalar, ConvertKernel::Sse2 })
+            {
+                const PixelConverter converter(format, target, Width, Height, ColorSpace(), kernel);
+
+                ms[index++] = bench::NsPerCall(Frames, [&](uint64_t)
+                {
+                    converter.Convert(planes, dst.data(), dstStride);
+                    bench::DoNotOptimize(dst[0]);
+                }) / 1e6;
+            }
+
+            std::printf("%-5ls -> %-5ls %s: scalar %6.3f ms, sse2 %6.3f ms, %4.1fx\n",
+                PixelFormatName(format), PixelFormatName(target), planar ? "planar" : "packed",
+                ms[0], ms[1], ms[0] / ms[1]);
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,259 @@
+#include "AttributeSnapshot.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+namespace
+{
+    bool KeyLess(const GUID& left, const GUID& right) noexcept
+    {
+        return memcmp(&left, &right, sizeof(GUID)) < 0;
+    }
+}
+
+namespace utils
+{
+    void AttributeSnapshot::Clear() noexcept
+    {
+        m_items.clear();
+        m_strings.clear();
+        m_blobs.clear();
+        m_sealed = true;
+    }
+
+    void AttributeSnapshot::Reserve(size_t items, size_t stringChars)
+    {
+        m_items.reserve(items);
+        m_strings.reserve(stringChars);
+    }
+
+    void AttributeSnapshot::AddUint32(const GUID& key, uint32_t value)
+    {
+        AddItem(key, AttributeType::Uint32).value.u32 = value;
+    }
+
+    void AttributeSnapshot::AddUint64(const GUID& key, uint64_t value)
+    {
+        AddItem(key, AttributeType::Uint64).value.u64 = value;
+    }
+
+    void AttributeSnapshot::AddDouble(const GUID& key, double value)
+    {
+        AddItem(key, AttributeType::Double).value.dbl = value;
+    }
+
+    void AttributeSnapshot::AddGuid(const GUID& key, const GUID& value)
+    {
+        AddItem(key, AttributeType::Guid).value.guid = value;
+    }
+
+    void AttributeSnapshot::AddString(const GUID& key, std::wstring_view value)
+    {
+        //
+        // Device attributes repeat the same strings (the symbolic link, the name),
+        // an attribute store has a few dozen items so the search is linear
+        //
+        size_t offset = m_strings.size();
+
+        for (const auto& item : m_items)
+        {
+            if (item.type == AttributeType::String
+                && item.size == value.size()
+                && 0 == m_strings.compare(static_cast<size_t>(item.value.offset), item.size, value.data(), value.size()))
+            {
+                offset = static_cast<size_t>(item.value.offset);
+                break;
+            }
+        }
+
+        if (offset == m_strings.size())
+        {
+            m_strings.append(value.data(), value.size());
+        }
+
+        Item& item = AddItem(key, AttributeType::String);
+        item.value.offset = offset;
+        item.size = static_cast<uint32_t>(value.size());
+    }
+
+    void AttributeSnapshot::AddBlob(const GUID& key, const uint8_t* data, size_t size)
+    {
+        //
+        // Blobs hold structures such as MFT_REGISTER_TYPE_INFO, keep them aligned
+        //
+        const size_t offset = (m_blobs.size() + alignof(std::max_align_t) - 1) & ~(alignof(std::max_align_t) - 1);
+        m_blobs.resize(offset);
+        m_blobs.insert(m_blobs.end(), data, data + size);
+
+        Item& item = AddItem(key, AttributeType::Blob);
+        item.value.offset = offset;
+        item.size = static_cast<uint32_t>(size);
+    }
+
+    void AttributeSnapshot::Seal()
+    {
+        std::stable_sort(m_items.begin(), m_items.end(), [](const Item& left, const Item& right)
+        {
+            return KeyLess(left.key, right.key);
+        });
+
+        m_items.erase(std::unique(m_items.begin(), m_items.end(), [](const Item& left, const Item& right)
+        {
+            return left.key == right.key;
+        }), m_items.end());
+
+        m_sealed = true;
+    }
+
+    size_t AttributeSnapshot::GetCount() const noexcept
+    {
+        return m_items.size();
+    }
+
+    bool AttributeSnapshot::Contains(const GUID& key) const noexcept
+    {
+        return nullptr != Find(key);
+    }
+
+    bool AttributeSnapshot::GetType(const GUID& key, AttributeType& type) const noexcept
+    {
+        const Item* item = Find(key);
+
+        if (!item)
+        {
+            return false;
+        }
+
+        type = item->type;
+        return true;
+    }
+
+    bool AttributeSnapshot::GetUint32(const GUID& key, uint32_t& value) const noexcept
+    {
+        const Item* item = Find(key, AttributeType::Uint32);
+
+        if (!item)
+        {
+            return false;
+        }
+
+        value = item->value.u32;
+        return true;
+    }
+
+    bool AttributeSnapshot::GetUint64(const GUID& key, uint64_t& value) const noexcept
+    {
+        const Item* item = Find(key, AttributeType::Uint64);
+
+        if (!item)
+        {
+            return false;
+        }
+
+        value = item->value.u64;
+        return true;
+    }
+
+    bool AttributeSnapshot::GetDouble(const GUID& key, double& value) const noexcept
+    {
+        const Item* item = Find(key, AttributeType::Double);
+
+        if (!item)
+        {
+            return false;
+        }
+
+        value = item->value.dbl;
+        return true;
+    }
+
+    bool AttributeSnapshot::GetGuid(const GUID& key, GUID& value) const noexcept
+    {
+        const Item* item = Find(key, AttributeType::Guid);
+
+        if (!item)
+        {
+            return false;
+        }
+
+        value = item->value.guid;
+        return true;
+    }
+
+    bool AttributeSnapshot::GetString(const GUID& key, std::wstring_view& value) const noexcept
+    {
+        const Item* item = Find(key, AttributeType::String);
+
+        if (!item)
+        {
+            return false;
+        }
+
+        value = std::wstring_view(m_strings.data() + item->value.offset, item->size);
+        return true;
+    }
+
+    bool AttributeSnapshot::GetBlob(const GUID& key, const uint8_t*& data, size_t& size) const noexcept
+    {
+        const Item* item = Find(key, AttributeType::Blob);
+
+        if (!item)
+        {
+            return false;
+        }
+
+        data = m_blobs.data() + item->value.offset;
+        size = item->size;
+        return true;
+    }
+
+    uint32_t AttributeSnapshot::GetUint32Or(const GUID& key, uint32_t def) const noexcept
+    {
+        uint32_t value = def;
+        GetUint32(key, value);
+        return value;
+    }
+
+    std::wstring_view AttributeSnapshot::GetString(const GUID& key) const noexcept
+    {
+        std::wstring_view value;
+        GetString(key, value);
+        return value;
+    }
+
+    AttributeSnapshot::Item& AttributeSnapshot::AddItem(const GUID& key, AttributeType type)
+    {
+        m_sealed = false;
+        m_items.emplace_back();
+
+        Item& item = m_items.back();
+        item.key = key;
+        item.type = type;
+        item.size = 0;
+        return item;
+    }
+
+    const AttributeSnapshot::Item* AttributeSnapshot::Find(const GUID& key, AttributeType type) const noexcept
+    {
+        const Item* item = Find(key);
+        return item && item->type == type ? item : nullptr;
+    }
+
+    const AttributeSnapshot::Item* AttributeSnapshot::Find(const GUID& key) const noexcept
+    {
+        assert(m_sealed && "Seal the snapshot before the lookups");
+
+        auto it = std::lower_bound(m_items.begin(), m_items.end(), key, [](const Item& item, const GUID& value)
+        {
+            return KeyLess(item.key, value);
+        });
+
+        if (it != m_items.end() && it->key == key)
+        {
+            return &*it;
+        }
+
+        return nullptr;
+    }
+}
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "Platform.h"
+
+namespace utils
+{
+    enum class AttributeType : uint32_t
+    {
+        Uint32 = 0,
+        Uint64,
+        Double,
+        Guid,
+        String,
+        Blob,
+    };
+
+    //
+    // All items of an attribute store copied at once, sorted by key.
+    // Strings and blobs live in two arenas, equal strings are stored once,
+    // so lookups neither call COM nor allocate
+    //
+    class AttributeSnapshot
+    {
+    public:
+        AttributeSnapshot() = default;
+
+        //
+        // Filling: Clear, Add* in any order, then Seal before the lookups.
+        // A key added twice keeps the first value
+        //
+        void Clear() noexcept;
+        void Reserve(size_t items, size_t stringChars);
+
+        void AddUint32(const GUID& key, uint32_t value);
+        void AddUint64(const GUID& key, uint64_t value);
+        void AddDouble(const GUID& key, double value);
+        void AddGuid(const GUID& key, const GUID& value);
+        void AddString(const GUID& key, std::wstring_view value);
+        void AddBlob(const GUID& key, const uint8_t* data, size_t size);
+        void Seal();
+
+        size_t GetCount() const noexcept;
+        bool Contains(const GUID& key) const noexcept;
+
+        //
+        // Return false if the key is missing or holds another type
+        //
+        bool GetType(const GUID& key, AttributeType& type) const noexcept;
+        bool GetUint32(const GUID& key, uint32_t& value) const noexcept;
+        bool GetUint64(const GUID& key, uint64_t& value) const noexcept;
+        bool GetDouble(const GUID& key, double& value) const noexcept;
+        bool GetGuid(const GUID& key, GUID& value) const noexcept;
+        bool GetString(const GUID& key, std::wstring_view& value) const noexcept;
+        bool GetBlob(const GUID& key, const uint8_t*& data, size_t& size) const noexcept;
+
+        uint32_t GetUint32Or(const GUID& key, uint32_t def) const noexcept;
+
+        //
+        // An empty view if the key is missing, the view lives as long as the snapshot
+        //
+        std::wstring_view GetString(const GUID& key) const noexcept;
+
+    private:
+        struct Item
+        {
+            GUID key;
+            AttributeType type;
+            uint32_t size;      // characters or bytes in the arena
+            union
+            {
+                uint32_t u32;
+                uint64_t u64;
+                double dbl;
+                GUID guid;
+                uint64_t offset; // into the arena
+            } value;
+        };
+
+        Item& AddItem(const GUID& key, AttributeType type);
+        const Item* Find(const GUID& key, AttributeType type) const noexcept;
+        const Item* Find(const GUID& key) const noexcept;
+
+    private:
+        std::vector<Item> m_items;
+        std::wstring m_strings;
+        std::vector<uint8_t> m_blobs;
+        bool m_sealed = true;
+    };
+}
@@ -0,0 +1,229 @@
+#include "BenchRunner.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+
+namespace
+{
+    //
+    // An adaptive bench checks the convergence this often
+    //
+    constexpr uint32_t DwellPollMs = 50;
+
+    //
+    // Times the frames on the way to the sink. FrameSource calls it
+    // from one thread and not after Stop, so no lock is needed
+    //
+    class TimedSink : public video::FrameSink
+    {
+    public:
+        TimedSink(video::FrameSink& sink, const capture::FrameSource& source, size_t expectedFrames)
+            : m_sink(sink)
+            , m_source(source)
+            , m_statistics(expectedFrames)
+            , m_bytes(0)
+            , m_converged(false)
+        {
+        }
+
+        void Start(const capture::MediaTypeInfo& mediaType) noexcept
+        {
+            m_timing.SetFrameRate(mediaType.fpsNumerator, mediaType.fpsDenominator);
+            m_timing.Reset();
+            m_latency.Reset();
+            m_frameDiff.Reset();
+            m_dwell.Start(video::TimingAnalyzer::Now());
+            m_converged = false;
+            m_statistics.Start();
+            m_bytes = 0;
+        }
+
+        void Stop() noexcept
+        {
+            m_statistics.Stop();
+        }
+
+        bool IsConverged() const noexcept
+        {
+            return m_converged;
+        }
+
+        void OnFrame(const video::FrameView& frame, int64_t timestamp) override
+        {
+            video::FrameTimes times;
+            times.arrival = video::TimingAnalyzer::Now();
+            times.device = m_source.TimestampToHost(timestamp);
+
+            m_statistics.OnFrame();
+            m_timing.OnSample(timestamp, times.arrival);
+
+            if (m_dwell.OnFrame(timestamp, times.arrival))
+            {
+                m_converged = true;
+            }
+
+            m_bytes += frame.Bytes();
+            m_frameDiff.OnFrame(frame);
+
+            times.copyStart = video::TimingAnalyzer::Now();
+            m_sink.OnFrame(frame, timestamp);
+            times.copyEnd = video::TimingAnalyzer::Now();
+
+            m_latency.Record(times);
+        }
+
+        capture::BenchResult GetResult() const
+        {
+            capture::BenchResult result;
+            result.bench = m_statistics.GetReport();
+            result.timing = m_timing.GetReport();
+            result.latency = m_latency.GetReport();
+            result.frameDiff = m_frameDiff.GetReport();
+            result.dwell = m_dwell.GetReport();
+            result.bytes = m_bytes;
+            return result;
+        }
+
+    private:
+        video::FrameSink& m_sink;
+        const capture::FrameSource& m_source;
+        video::BenchStatistics m_statistics;
+        video::TimingAnalyzer m_timing;
+        video::LatencyTracker m_latency;
+        video::FrameDiffDetector m_frameDiff;
+        video::DwellMonitor m_dwell;
+        uint64_t m_bytes;
+        std::atomic<bool> m_converged;  // read by the waiting thread
+    };
+}
+
+namespace capture
+{
+    HRESULT RunBench(
+        FrameSource& source,
+        video::FrameSink& sink,
+        uint32_t readDepth,
+        uint32_t seconds,
+        BenchResult& result,
+        bool adaptive)
+    {
+        const MediaTypeInfo& mediaType = source.GetMediaType();
+
+        //
+        // Enough interval storage for the nominal rate with some headroom,
+        // so the capture does not allocate
+        //
+        const size_t expectedFrames = static_cast<size_t>(mediaType.Fps() * 2 * seconds) + 1024;
+
+        TimedSink timedSink(sink, source, expectedFrames);
+        timedSink.Start(mediaType);
+
+        HRCHK(source.Start(timedSink, readDepth));
+
+        HRESULT hr = S_OK;
+
+        if (adaptive)
+        {
+            const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(seconds);
+
+            do
+            {
+                hr = source.Wait(DwellPollMs);
+            }
+            while (hr == S_FALSE
+                && !timedSink.IsConverged()
+                && (0 == seconds || std::chrono::steady_clock::now() < deadline));
+        }
+        else
+        {
+            hr = source.Wait(seconds ? seconds * 1000 : WaitInfinite);
+        }
+
+        source.Stop();
+        timedSink.Stop();
+
+        result = timedSink.GetResult();
+        return FAILED(hr) ? hr : S_OK;
+    }
+
+    HRESULT RunMultiStreamBench(
+        MultiStreamSource& source,
+        const std::vector<video::FrameSink*>& sinks,
+        uint32_t readDepth,
+        uint32_t seconds,
+        StreamDispatcher::Report& report)
+    {
+        if (sinks.size() != source.GetStreamCount())
+        {
+            return E_INVALIDARG;
+        }
+
+        double fps = 0;
+
+        for (size_t i = 0; i < source.GetStreamCount(); ++i)
+        {
+            fps = std::max(fps, source.GetMediaType(i).Fps());
+        }
+
+        StreamDispatcher dispatcher(static_cast<size_t>(fps * 2 * seconds) + 1024);
+
+        for (size_t i = 0; i < sinks.size(); ++i)
+        {
+            HRCHK(dispatcher.AddStream(source.GetStreamIndex(i), *sinks[i]));
+        }
+
+        dispatcher.Start();
+        HRCHK(source.Start(dispatcher, readDepth));
+
+        const HRESULT hr = source.Wait(seconds ? seconds * 1000 : WaitInfinite);
+
+        source.Stop();
+        dispatcher.Stop();
+
+        report = dispatcher.GetReport();
+        return FAILED(hr) ? hr : S_OK;
+    }
+
+    HRESULT Sweep(
+        Backend& backend,
+        video::FrameSink& sink,
+        uint32_t readDepth,
+        uint32_t seconds,
+        bool adaptive,
+        const SweepCallback& callback)
+    {
+        DeviceList devices;
+        HRCHK(backend.EnumDevices(devices));
+
+        for (auto& device : devices)
+        {
+            std::vector<StreamInfo> streams;
+            HRESULT hr = device->GetStreams(streams);
+
+            if (FAILED(hr))
+            {
+                continue;
+            }
+
+            for (const auto& stream : streams)
+            {
+                for (const auto& mediaType : stream.mediaTypes)
+                {
+                    BenchResult result = {};
+                    std::unique_ptr<FrameSource> source;
+                    hr = device->OpenFrameSource(stream.index, mediaType.index, source);
+
+                    if (SUCCEEDED(hr))
+                    {
+                        hr = RunBench(*source, sink, readDepth, seconds, result, adaptive);
+                    }
+
+                    callback(*device, stream, mediaType, hr, result);
+                }
+            }
+        }
+
+        return S_OK;
+    }
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <functional>
+#include "CaptureBackend.h"
+#include "BenchStatistics.h"
+#include "TimingAnalyzer.h"
+#include "LatencyTracker.h"
+#include "FrameDiff.h"
+#include "DwellMonitor.h"
+#include "StreamDispatcher.h"
+
+namespace capture
+{
+    struct BenchResult
+    {
+        video::BenchStatistics::Report bench;
+        video::TimingAnalyzer::Report timing;
+        video::LatencyTracker::Report latency;  // the copy span is the sink
+        video::FrameDiffDetector::Report frameDiff;
+        video::DwellMonitor::Report dwell;
+        uint64_t bytes = 0;         // delivered frame data
+    };
+
+    //
+    // Captures from the source into the sink for the given time
+    // or until the end of the stream, timing every frame.
+    // With 0 seconds it runs until the end of the stream.
+    // An adaptive bench also ends once the fps and the jitter converge,
+    // seconds is the longest it runs then
+    //
+    HRESULT RunBench(
+        FrameSource& source,
+        video::FrameSink& sink,
+        uint32_t readDepth,
+        uint32_t seconds,
+        BenchResult& result,
+        bool adaptive = false);
+
+    //
+    // RunBench for the streams of a multi-stream source, sinks[i] consumes
+    // the i-th stream of the source. Reports every stream and the sum
+    //
+    HRESULT RunMultiStreamBench(
+        MultiStreamSource& source,
+        const std::vector<video::FrameSink*>& sinks,
+        uint32_t readDepth,
+        uint32_t seconds,
+        StreamDispatcher::Report& report);
+
+    using SweepCallback = std::function<void(
+        Device& device,
+        const StreamInfo& stream,
+        const MediaTypeInfo& mediaType,
+        HRESULT hr,
+        const BenchResult& result)>;
+
+    //
+    // Benchmarks every media type of every stream of every device in turn
+    //
+    HRESULT Sweep(
+        Backend& backend,
+        video::FrameSink& sink,
+        uint32_t readDepth,
+        uint32_t seconds,
+        bool adaptive,
+        const SweepCallback& callback);
+}
@@ -0,0 +1,142 @@
+#include "BenchStatistics.h"
+
+#include <algorithm>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+namespace
+{
+    double Percentile(std::vector<int64_t>& values, double fraction)
+    {
+        //
+        // Nearest rank, values are reordered
+        //
+        const size_t rank = static_cast<size_t>(fraction * (values.size() - 1) + 0.5);
+        std::nth_element(values.begin(), values.begin() + rank, values.end());
+        return values[rank] / 1e6;
+    }
+}
+
+namespace video
+{
+    BenchStatistics::BenchStatistics(size_t expectedFrames)
+        : m_frames(0)
+        , m_cpuStart(0)
+        , m_cpuStop(0)
+    {
+        m_intervals.reserve(expectedFrames);
+    }
+
+    void BenchStatistics::Start() noexcept
+    {
+        Start(Clock::now(), ProcessCpuSeconds());
+    }
+
+    void BenchStatistics::Start(Clock::time_point now, double cpuSeconds) noexcept
+    {
+        m_intervals.clear();
+        m_frames = 0;
+        m_start = now;
+        m_stop = now;
+        m_lastArrival = now;
+        m_cpuStart = cpuSeconds;
+        m_cpuStop = cpuSeconds;
+    }
+
+    void BenchStatistics::OnFrame()
+    {
+        OnFrame(Clock::now());
+    }
+
+    void BenchStatistics::OnFrame(Clock::time_point arrival)
+    {
+        //
+        // The first interval is measured from the first frame, not from Start,
+        // so the device warm-up does not show up as a huge interval
+        //
+        if (m_frames > 0)
+        {
+            m_intervals.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(arrival - m_lastArrival).count());
+        }
+
+        m_frames += 1;
+        m_lastArrival = arrival;
+    }
+
+    void BenchStatistics::Stop() noexcept
+    {
+        Stop(Clock::now(), ProcessCpuSeconds());
+    }
+
+    void BenchStatistics::Stop(Clock::time_point now, double cpuSeconds) noexcept
+    {
+        m_stop = now;
+        m_cpuStop = cpuSeconds;
+    }
+
+    BenchStatistics::Report BenchStatistics::GetReport() const
+    {
+        Report report = {};
+        report.frames = m_frames;
+        report.seconds = std::chrono::duration<double>(m_stop - m_start).count();
+        report.cpuSeconds = m_cpuStop - m_cpuStart;
+
+        if (report.seconds > 0)
+        {
+            report.fps = m_frames / report.seconds;
+        }
+
+        if (m_frames > 0)
+        {
+            report.cpuPerFrameMs = report.cpuSeconds * 1e3 / m_frames;
+        }
+
+        if (!m_intervals.empty())
+        {
+            std::vector<int64_t> intervals = m_intervals;
+            report.intervalMin = *std::min_element(intervals.begin(), intervals.end()) / 1e6;
+            report.intervalMax = *std::max_element(intervals.begin(), intervals.end()) / 1e6;
+            report.intervalP50 = Percentile(intervals, 0.50);
+            report.intervalP90 = Percentile(intervals, 0.90);
+            report.intervalP99 = Percentile(intervals, 0.99);
+        }
+
+        return report;
+    }
+
+    double BenchStatistics::ProcessCpuSeconds() noexcept
+    {
+#ifdef _WIN32
+        FILETIME creation, exit, kernel, user;
+
+        if (!GetProcessTimes(GetCurrentProcess(), &creation, &exit, &kernel, &user))
+        {
+            return 0;
+        }
+
+        ULARGE_INTEGER k, u;
+        k.LowPart = kernel.dwLowDateTime;
+        k.HighPart = kernel.dwHighDateTime;
+        u.LowPart = user.dwLowDateTime;
+        u.HighPart = user.dwHighDateTime;
+
+        //
+        // FILETIME ticks are 100 ns
+        //
+        return (k.QuadPart + u.QuadPart) / 1e7;
+#else
+        timespec ts;
+
+        if (0 != clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts))
+        {
+            return 0;
+        }
+
+        return ts.tv_sec + ts.tv_nsec / 1e9;
+#endif
+    }
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+namespace video
+{
+    //
+    // Throughput of a headless capture: sustained fps, inter-frame interval
+    // percentiles and process CPU time per frame
+    //
+    class BenchStatistics
+    {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        struct Report
+        {
+            uint64_t frames;
+            double seconds;
+            double fps;
+
+            //
+            // Inter-frame intervals of the arrival time, milliseconds
+            //
+            double intervalMin;
+            double intervalP50;
+            double intervalP90;
+            double intervalP99;
+            double intervalMax;
+
+            double cpuSeconds;
+            double cpuPerFrameMs;
+        };
+
+        //
+        // expectedFrames reserves the interval storage up front,
+        // so the capture does not allocate until it is exceeded
+        //
+        explicit BenchStatistics(size_t expectedFrames = 0);
+
+        void Start() noexcept;
+        void Start(Clock::time_point now, double cpuSeconds) noexcept;
+
+        void OnFrame();
+        void OnFrame(Clock::time_point arrival);
+
+        void Stop() noexcept;
+        void Stop(Clock::time_point now, double cpuSeconds) noexcept;
+
+        Report GetReport() const;
+
+        //
+        // CPU time of all the threads of the process, seconds
+        //
+        static double ProcessCpuSeconds() noexcept;
+
+    private:
+        std::vector<int64_t> m_intervals; // nanoseconds
+        uint64_t m_frames;
+        Clock::time_point m_start;
+        Clock::time_point m_stop;
+        Clock::time_point m_lastArrival;
+        double m_cpuStart;
+        double m_cpuStop;
+    };
+}
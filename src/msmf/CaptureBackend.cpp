@@ -0,0 +1,111 @@
+#include "CaptureBackend.h"
+#include "MediaTypeFormatter.h"
+
+#include <cwctype>
+#include <stdexcept>
+
+namespace
+{
+    bool EqualNoCase(const std::wstring& a, const std::wstring& b) noexcept
+    {
+        if (a.size() != b.size())
+        {
+            return false;
+        }
+
+        for (size_t i = 0; i < a.size(); ++i)
+        {
+            if (std::towlower(a[i]) != std::towlower(b[i]))
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+}
+
+namespace capture
+{
+    HRESULT Backend::OpenDevice(const std::wstring& device, DeviceList& devices)
+    {
+        DeviceList all;
+        HRCHK(EnumDevices(all));
+
+        bool foundDevice = false;
+
+        //
+        // Try to open device by symbolic link
+        //
+        for (auto& dev : all)
+        {
+            if (EqualNoCase(dev->GetSymbolicLink(), device))
+            {
+                devices.push_back(dev);
+                foundDevice = true;
+                break;
+            }
+        }
+
+        //
+        // Try to open device by number in device's list
+        //
+        try
+        {
+            size_t pos = 0;
+            const unsigned long deviceNumber = std::stoul(device, &pos);
+
+            if (pos == device.size() && deviceNumber < all.size())
+            {
+                devices.push_back(all[deviceNumber]);
+                foundDevice = true;
+            }
+        }
+        catch (const std::logic_error&)
+        {
+            // Cannot convert 'device' to a device number
+        }
+
+        //
+        // Try to open device by Friendly Name
+        //
+        for (auto& dev : all)
+        {
+            if (EqualNoCase(dev->GetFriendlyName(), device))
+            {
+                devices.push_back(dev);
+                foundDevice = true;
+            }
+        }
+
+        return foundDevice ? S_OK : E_FAIL;
+    }
+
+    HRESULT CheckStreamSelections(const std::vector<StreamSelection>& selections)
+    {
+        if (selections.empty())
+        {
+            return E_INVALIDARG;
+        }
+
+        for (size_t i = 0; i < selections.size(); ++i)
+        {
+            for (size_t j = i + 1; j < selections.size(); ++j)
+            {
+                if (selections[i].streamIndex == selections[j].streamIndex)
+                {
+                    return E_INVALIDARG;
+                }
+            }
+        }
+
+        return S_OK;
+    }
+
+    void PrintMediaTypeInfo(const MediaTypeInfo& mediaType, std::wostream& st)
+    {
+        MediaTypeFormatter formatter(OutputFormat::Text, true);
+        FormatMediaTypeInfo(mediaType, formatter);
+        formatter.Flush(st);
+    }
+}
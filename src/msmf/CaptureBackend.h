@@ -0,0 +1,209 @@
+#pragma once
+
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "Platform.h"
+#include "FrameSink.h"
+
+namespace capture
+{
+    //
+    // FrameSource::Wait timeout that waits for the end of the stream
+    //
+    constexpr uint32_t WaitInfinite = UINT32_MAX;
+
+    //
+    // Description of one media type of a stream
+    //
+    struct MediaTypeInfo
+    {
+        uint32_t index = 0;         // media type ID within the stream
+        std::wstring subtype;       // backend name of the subtype
+        video::PixelFormat format = video::PixelFormat::Unknown; // Unknown for compressed formats
+        uint32_t width = 0;
+        uint32_t height = 0;
+        uint32_t fpsNumerator = 0;
+        uint32_t fpsDenominator = 0;
+        int32_t defaultStride = 0;  // 0 if unknown, negative for bottom-up images
+        video::ColorSpace colorSpace;
+
+        double Fps() const noexcept
+        {
+            return fpsDenominator ? static_cast<double>(fpsNumerator) / fpsDenominator : 0;
+        }
+    };
+
+    struct StreamInfo
+    {
+        uint32_t index = 0;
+        std::vector<MediaTypeInfo> mediaTypes;
+    };
+
+    //
+    // Delivers the frames of one stream in one media type
+    //
+    class FrameSource
+    {
+    public:
+        virtual ~FrameSource() = default;
+
+        //
+        // The format of the delivered frames, it differs from the selected
+        // media type if the backend has to decode it
+        //
+        virtual const MediaTypeInfo& GetMediaType() const noexcept = 0;
+
+        //
+        // Frames are delivered to the sink on a backend thread,
+        // readDepth requests are kept in flight
+        //
+        virtual HRESULT Start(video::FrameSink& sink, uint32_t readDepth) = 0;
+
+        //
+        // Waits for the end of the stream or an error, S_FALSE on timeout.
+        // Live sources never end, WaitInfinite returns on an error only
+        //
+        virtual HRESULT Wait(uint32_t timeoutMs) = 0;
+
+        //
+        // The sink is not called after Stop returns
+        //
+        virtual HRESULT Stop() = 0;
+
+        //
+        // The host steady clock (TimingAnalyzer::Now) at a sample timestamp,
+        // 0 if the source clock is not related to the host clock
+        //
+        virtual int64_t TimestampToHost(int64_t) const noexcept
+        {
+            return 0;
+        }
+    };
+
+    class StreamDispatcher;
+
+    struct StreamSelection
+    {
+        uint32_t streamIndex = 0;
+        uint32_t mediaTypeIndex = 0;
+    };
+
+    //
+    // Delivers the frames of several streams of one device, each in its own
+    // media type, the way an application reads preview and record pins together
+    //
+    class MultiStreamSource
+    {
+    public:
+        virtual ~MultiStreamSource() = default;
+
+        //
+        // The streams in the order of the selections, with the delivered formats
+        //
+        virtual size_t GetStreamCount() const noexcept = 0;
+        virtual uint32_t GetStreamIndex(size_t stream) const noexcept = 0;
+        virtual const MediaTypeInfo& GetMediaType(size_t stream) const noexcept = 0;
+
+        //
+        // Frames are passed to the dispatcher with their stream index,
+        // readDepth requests are kept in flight for every stream
+        //
+        virtual HRESULT Start(StreamDispatcher& dispatcher, uint32_t readDepth) = 0;
+
+        //
+        // Waits for the end of every stream or an error, S_FALSE on timeout
+        //
+        virtual HRESULT Wait(uint32_t timeoutMs) = 0;
+
+        //
+        // The dispatcher is not called after Stop returns
+        //
+        virtual HRESULT Stop() = 0;
+    };
+
+    //
+    // At least one selection and one media type per stream
+    //
+    HRESULT CheckStreamSelections(const std::vector<StreamSelection>& selections);
+
+    class Device
+    {
+    public:
+        virtual ~Device() = default;
+
+        virtual std::wstring GetFriendlyName() const = 0;
+        virtual std::wstring GetSymbolicLink() const = 0;
+
+        //
+        // Changes when the driver changes, so cached media types can be trusted.
+        // 0 if the backend cannot tell
+        //
+        virtual uint64_t GetFingerprint() const
+        {
+            return 0;
+        }
+
+        virtual HRESULT GetStreams(std::vector<StreamInfo>& streams) = 0;
+        virtual HRESULT OpenFrameSource(
+            uint32_t streamIndex,
+            uint32_t mediaTypeIndex,
+            std::unique_ptr<FrameSource>& source) = 0;
+
+        //
+        // E_NOTIMPL if the backend reads one stream at a time
+        //
+        virtual HRESULT OpenMultiStreamSource(
+            const std::vector<StreamSelection>& selections,
+            std::unique_ptr<MultiStreamSource>& source)
+        {
+            (void)selections;
+            (void)source;
+            return E_NOTIMPL;
+        }
+    };
+
+    using DevicePtr = std::shared_ptr<Device>;
+    using DeviceList = std::vector<DevicePtr>;
+
+    class Backend
+    {
+    public:
+        virtual ~Backend() = default;
+
+        virtual const wchar_t* GetName() const noexcept = 0;
+        virtual HRESULT EnumDevices(DeviceList& devices) = 0;
+
+        //
+        // Backends that cache the device list enumerate again on the next EnumDevices
+        //
+        virtual void InvalidateDevices() noexcept
+        {
+        }
+
+        //
+        // Prepares a thread the caller starts to open and run devices from,
+        // DetachThread follows a successful AttachThread on the same thread
+        //
+        virtual HRESULT AttachThread() noexcept
+        {
+            return S_OK;
+        }
+
+        virtual void DetachThread() noexcept
+        {
+        }
+
+        //
+        // Finds devices by symbolic link, number in the device list or friendly name,
+        // the same rules as mf::MediaSource::OpenDevice
+        //
+        HRESULT OpenDevice(const std::wstring& device, DeviceList& devices);
+    };
+
+    //
+    // " <subtype> <width> x <height> <fps>@FPS", the short form of PrintBaseVideoMediaType
+    //
+    void PrintMediaTypeInfo(const MediaTypeInfo& mediaType, std::wostream& st);
+}
@@ -0,0 +1,428 @@
+#include "CapturePlan.h"
+#include "RecordFile.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cwctype>
+#include <filesystem>
+#include <sstream>
+
+namespace
+{
+    using namespace capture;
+
+    std::string Trim(const std::string& str)
+    {
+        const size_t first = str.find_first_not_of(" \t\r");
+
+        if (first == std::string::npos)
+        {
+            return std::string();
+        }
+
+        const size_t last = str.find_last_not_of(" \t\r");
+        return str.substr(first, last - first + 1);
+    }
+
+    std::vector<std::string> SplitList(const std::string& str)
+    {
+        std::vector<std::string> items;
+        std::istringstream st(str);
+        std::string item;
+
+        while (std::getline(st, item, ','))
+        {
+            item = Trim(item);
+
+            if (!item.empty())
+            {
+                items.push_back(item);
+            }
+        }
+
+        return items;
+    }
+
+    bool ParseNumber(const std::string& str, uint32_t& value)
+    {
+        if (str.empty() || str.find_first_not_of("0123456789") != std::string::npos)
+        {
+            return false;
+        }
+
+        const unsigned long long number = std::strtoull(str.c_str(), nullptr, 10);
+
+        if (number > UINT32_MAX)
+        {
+            return false;
+        }
+
+        value = static_cast<uint32_t>(number);
+        return true;
+    }
+
+    bool ParseNumber(const std::string& str, double& value)
+    {
+        if (str.empty() || str.find_first_not_of("0123456789.") != std::string::npos)
+        {
+            return false;
+        }
+
+        char* end = nullptr;
+        value = std::strtod(str.c_str(), &end);
+        return end == str.c_str() + str.size();
+    }
+
+    //
+    // "<min>-<max>" or "<value>"
+    //
+    template <typename T>
+    bool ParseRange(const std::string& str, PlanRange<T>& range)
+    {
+        const size_t dash = str.find('-');
+
+        if (dash == std::string::npos)
+        {
+            if (!ParseNumber(str, range.min))
+            {
+                return false;
+            }
+
+            range.max = range.min;
+            return true;
+        }
+
+        return ParseNumber(Trim(str.substr(0, dash)), range.min)
+            && ParseNumber(Trim(str.substr(dash + 1)), range.max)
+            && range.min <= range.max;
+    }
+
+    bool Utf8ToWide(const std::string& str, std::wstring& wide)
+    {
+        try
+        {
+            wide = std::filesystem::u8path(str).wstring();
+            return true;
+        }
+        catch (const std::exception&)
+        {
+            return false;
+        }
+    }
+
+    bool EqualNoCase(const std::wstring& a, const std::wstring& b) noexcept
+    {
+        if (a.size() != b.size())
+        {
+            return false;
+        }
+
+        for (size_t i = 0; i < a.size(); ++i)
+        {
+            if (std::towlower(a[i]) != std::towlower(b[i]))
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    bool ParseSink(const std::string& str, PlanSink& sink)
+    {
+        for (auto value : { PlanSink::Null, PlanSink::Checksum, PlanSink::Verify })
+        {
+            if (str == PlanSinkName(value))
+            {
+                sink = value;
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    bool ParsePattern(const std::string& str, video::TestPattern& pattern)
+    {
+        for (auto value : {
+            video::TestPattern::None,
+            video::TestPattern::Gradient,
+            video::TestPattern::ColorBars,
+            video::TestPattern::Counter })
+        {
+            if (str == video::TestPatternName(value))
+            {
+                pattern = value;
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    //
+    // Sets one key of a section, false for an unknown key or a bad value
+    //
+    bool SetEntryKey(const std::string& key, const std::string& value, PlanEntry& entry, std::string& error)
+    {
+        if (key == "streams")
+        {
+            entry.streams.clear();
+
+            for (const auto& item : SplitList(value))
+            {
+                uint32_t stream = 0;
+
+                if (!ParseNumber(item, stream))
+                {
+                    error = "bad stream '" + item + "'";
+                    return false;
+                }
+
+                entry.streams.push_back(stream);
+            }
+
+            return true;
+        }
+
+        if (key == "formats")
+        {
+            entry.formats.clear();
+
+            for (const auto& item : SplitList(value))
+            {
+                std::wstring format;
+
+                if (!Utf8ToWide(item, format))
+                {
+                    error = "bad format '" + item + "'";
+                    return false;
+                }
+
+                entry.formats.push_back(format);
+            }
+
+            return true;
+        }
+
+        bool valid = true;
+
+        if (key == "width")
+        {
+            valid = ParseRange(value, entry.width);
+        }
+        else if (key == "height")
+        {
+            valid = ParseRange(value, entry.height);
+        }
+        else if (key == "fps")
+        {
+            valid = ParseRange(value, entry.fps);
+        }
+        else if (key == "seconds")
+        {
+            valid = ParseNumber(value, entry.seconds) && entry.seconds > 0;
+        }
+        else if (key == "dwell")
+        {
+            valid = value == "adaptive" || value == "fixed";
+            entry.adaptive = value != "fixed";
+        }
+        else if (key == "read-depth")
+        {
+            valid = ParseNumber(value, entry.readDepth) && entry.readDepth > 0;
+        }
+        else if (key == "sink")
+        {
+            valid = ParseSink(value, entry.sink);
+        }
+        else if (key == "pattern")
+        {
+            valid = ParsePattern(value, entry.pattern);
+        }
+        else
+        {
+            error = "unknown key '" + key + "'";
+            return false;
+        }
+
+        if (!valid)
+        {
+            error = "bad " + key + " '" + value + "'";
+        }
+
+        return valid;
+    }
+}
+
+namespace capture
+{
+    const char* PlanSinkName(PlanSink sink) noexcept
+    {
+        switch (sink)
+        {
+        case PlanSink::Null: return "null";
+        case PlanSink::Checksum: return "checksum";
+        case PlanSink::Verify: return "verify";
+        default: return "unknown";
+        }
+    }
+
+    bool PlanEntry::Matches(const StreamInfo& stream, const MediaTypeInfo& mediaType) const
+    {
+        if (!streams.empty() && std::find(streams.begin(), streams.end(), stream.index) == streams.end())
+        {
+            return false;
+        }
+
+        if (!formats.empty())
+        {
+            bool found = false;
+
+            for (const auto& format : formats)
+            {
+                if (EqualNoCase(format, video::PixelFormatName(mediaType.format))
+                    || EqualNoCase(format, mediaType.subtype))
+                {
+                    found = true;
+                    break;
+                }
+            }
+
+            if (!found)
+            {
+                return false;
+            }
+        }
+
+        return width.Contains(mediaType.width)
+            && height.Contains(mediaType.height)
+            && fps.Contains(mediaType.Fps());
+    }
+
+    HRESULT ParsePlan(const std::string& text, CapturePlan& plan, std::string& error)
+    {
+        plan = CapturePlan();
+
+        //
+        // The keys before the first section are the defaults of every section
+        //
+        PlanEntry defaults;
+        PlanEntry* entry = &defaults;
+
+        std::istringstream st(text);
+        std::string line;
+        uint32_t lineNumber = 0;
+
+        auto fail = [&](const std::string& message)
+        {
+            error = "line " + std::to_string(lineNumber) + ": " + message;
+            plan = CapturePlan();
+            return E_INVALIDARG;
+        };
+
+        while (std::getline(st, line))
+        {
+            lineNumber += 1;
+
+            //
+            // A UTF-8 byte order mark is not a part of the first line
+            //
+            if (1 == lineNumber && 0 == line.compare(0, 3, "\xEF\xBB\xBF"))
+            {
+                line.erase(0, 3);
+            }
+
+            //
+            // Only whole lines are comments, symbolic links contain '#'
+            //
+            line = Trim(line);
+
+            if (line.empty() || line.front() == '#')
+            {
+                continue;
+            }
+
+            if (line.front() == '[')
+            {
+                if (line.back() != ']' || 0 != line.compare(1, 7, "device "))
+                {
+                    return fail("expected [device <name>]");
+                }
+
+                PlanEntry section = defaults;
+                section.line = lineNumber;
+
+                if (!Utf8ToWide(Trim(line.substr(8, line.size() - 9)), section.device) || section.device.empty())
+                {
+                    return fail("bad device name");
+                }
+
+                plan.entries.push_back(std::move(section));
+                entry = &plan.entries.back();
+                continue;
+            }
+
+            const size_t equal = line.find('=');
+
+            if (equal == std::string::npos)
+            {
+                return fail("expected <key> = <value>");
+            }
+
+            const std::string key = Trim(line.substr(0, equal));
+            const std::string value = Trim(line.substr(equal + 1));
+
+            if (key == "concurrency")
+            {
+                if (entry != &defaults)
+                {
+                    return fail("concurrency belongs before the first section");
+                }
+
+                if (!ParseNumber(value, plan.concurrency))
+                {
+                    return fail("bad concurrency '" + value + "'");
+                }
+
+                continue;
+            }
+
+            std::string message;
+
+            if (!SetEntryKey(key, value, *entry, message))
+            {
+                return fail(message);
+            }
+        }
+
+        if (plan.entries.empty())
+        {
+            error = "no [device <name>] section";
+            plan = CapturePlan();
+            return E_INVALIDARG;
+        }
+
+        return S_OK;
+    }
+
+    HRESULT LoadPlan(const std::wstring& path, CapturePlan& plan, std::string& error)
+    {
+        video::MappedFile file;
+
+        if (FAILED(file.Open(path)))
+        {
+            error = "cannot open the plan file";
+            return E_FAIL;
+        }
+
+        std::string text;
+
+        if (file.Size())
+        {
+            text.assign(reinterpret_cast<const char*>(file.Data()), static_cast<size_t>(file.Size()));
+        }
+
+        return ParsePlan(text, plan, error);
+    }
+}
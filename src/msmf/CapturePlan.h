@@ -0,0 +1,84 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include "CaptureBackend.h"
+#include "TestPattern.h"
+
+namespace capture
+{
+    //
+    // Inclusive range of a plan filter, a single value is a range of one
+    //
+    template <typename T>
+    struct PlanRange
+    {
+        T min;
+        T max;
+
+        bool Contains(T value) const noexcept
+        {
+            return min <= value && value <= max;
+        }
+    };
+
+    enum class PlanSink : uint32_t
+    {
+        Null = 0,
+        Checksum,
+        Verify,     // hashes every frame and checks the pattern
+    };
+
+    const char* PlanSinkName(PlanSink sink) noexcept;
+
+    //
+    // The media types of one device a plan runs, every one for seconds
+    //
+    struct PlanEntry
+    {
+        std::wstring device;                // name, ID or friendly name as --bench takes it
+        std::vector<uint32_t> streams;      // empty for every stream
+        std::vector<std::wstring> formats;  // pixel format or subtype names, empty for every format
+        PlanRange<uint32_t> width = { 0, UINT32_MAX };
+        PlanRange<uint32_t> height = { 0, UINT32_MAX };
+        PlanRange<double> fps = { 0, 1e9 };
+        uint32_t seconds = 5;               // the longest a media type runs with the adaptive dwell
+        bool adaptive = true;               // stops once the fps and the jitter converge
+        uint32_t readDepth = 1;
+        PlanSink sink = PlanSink::Null;
+        video::TestPattern pattern = video::TestPattern::None;
+        uint32_t line = 0;                  // of the section in the plan file
+
+        bool Matches(const StreamInfo& stream, const MediaTypeInfo& mediaType) const;
+    };
+
+    //
+    // A plan file is UTF-8 text of "key = value" lines and [device <name>]
+    // sections, lines starting with '#' are comments:
+    //
+    //  concurrency = 2         devices captured at once, 0 for all of them
+    //  seconds = 5             keys before the first section are defaults
+    //
+    //  [device Fake Camera]
+    //  streams = 0
+    //  formats = NV12, YUY2
+    //  width = 640-1920
+    //  height = 480-1080
+    //  fps = 30-60
+    //  dwell = adaptive|fixed
+    //  read-depth = 2
+    //  sink = null|checksum|verify
+    //  pattern = none|gradient|bars|counter
+    //
+    struct CapturePlan
+    {
+        uint32_t concurrency = 0;
+        std::vector<PlanEntry> entries;
+    };
+
+    //
+    // E_INVALIDARG with "line N: ..." in error for a malformed plan
+    //
+    HRESULT ParsePlan(const std::string& text, CapturePlan& plan, std::string& error);
+    HRESULT LoadPlan(const std::wstring& path, CapturePlan& plan, std::string& error);
+}
@@ -1,513 +1,1068 @@
-#include "stdafx.h"
-#include "CaptureWindow.h"
-
-using namespace Microsoft::WRL::Wrappers;
-
-namespace mf
-{
-    CaptureWindow::CaptureWindow() noexcept
-        : m_hwnd(nullptr)
-        , m_width(0)
-        , m_height(0)
-        , m_framesPrev(0)
-        , m_frames(0)
-        , m_format(D3DFMT_UNKNOWN)
-        , m_streamIndex(0)
-    {
-    }
-
-    CaptureWindow::~CaptureWindow()
-    {
-        Close();
-    }
-
-    HRESULT CaptureWindow::Show(ComPtr<IMFSourceReader> pVideoSource, ComPtr<IMFMediaType> pType, ULONG streamIndex, bool showInThread)
-    {
-        std::unique_lock<std::shared_mutex> lock(m_mutex);
-
-        if (m_thread.joinable())
-        {
-            if (HWND hwnd = m_hwnd)
-            {
-                SetForegroundWindow(hwnd);
-                return S_FALSE;
-            }
-            m_thread.join();
-        }
-
-        //
-        // https://docs.microsoft.com/en-us/windows/desktop/medfound/video-subtype-guids
-        // Video formats are often represented by FOURCCs or D3DFORMAT values. 
-        // A range of GUIDs is reserved for representing these values as subtypes.
-        //
-        GUID subtype;
-        HR_CHECK2(pType->GetGUID(MF_MT_SUBTYPE, &subtype));
-        m_format = static_cast<D3DFORMAT>(subtype.Data1);
-
-        UINT64 resolution = 0;
-        HR_CHECK2(pType->GetUINT64(MF_MT_FRAME_SIZE, &resolution));
-
-        m_width = HI32(resolution);
-        m_height = LO32(resolution);
-        m_framesPrev = 0;
-        m_frames = 0;
-        m_streamIndex = streamIndex;
-        m_pVideoSource = pVideoSource;
-
-        if (0 == m_width || 0 == m_height)
-        {
-            HR_CHECK(E_INVALIDARG, "invalid width or height");
-        }
-
-        if (!showInThread)
-        {
-            lock.unlock();
-            HRESULT hr = ShowModalImpl(nullptr);
-
-            lock.lock();
-            DestroyWnd();
-            return hr;
-        }
-
-        Event event(CreateEvent(NULL, FALSE, FALSE, NULL));
-        if (!event.IsValid())
-        {
-            const DWORD err = GetLastError();
-            return HRESULT_FROM_WIN32(err);
-        }
-
-        m_thread = std::thread(&CaptureWindow::ShowModalImpl, this, event.Get());
-
-        HANDLE handles[] = { event.Get(), m_thread.native_handle() };
-        lock.unlock();
-
-        const DWORD res = WaitForMultipleObjects(ARRAYSIZE(handles), &handles[0], FALSE, INFINITE);
-        
-        lock.lock();
-        if (res != WAIT_OBJECT_0)
-        {
-            DestroyWnd();
-            m_thread.join();
-            return E_FAIL;
-        }
-
-        return S_OK;
-    }
-
-    HRESULT CaptureWindow::Close() noexcept
-    {
-        std::unique_lock<std::shared_mutex> lock(m_mutex);
-
-        if (m_hwnd)
-        {
-            if (!PostMessageW(m_hwnd, WM_CLOSE, 0, 0))
-            {
-                return E_FAIL;
-            }
-        }
-
-        auto thread = std::move(m_thread);
-        lock.unlock();
-
-        if (thread.joinable())
-        {
-            thread.join();
-        }
-        
-        return S_OK;
-    }
-
-    HRESULT CaptureWindow::SetTitle(std::wstring title)
-    {
-        std::unique_lock<std::shared_mutex> lock(m_mutex);
-        m_title = std::move(title);
-        return S_OK;
-    }
-
-    BOOL CaptureWindow::WaitForExit(ULONG timeout)
-    {
-        std::unique_lock<std::shared_mutex> lock(m_mutex);
-        HANDLE hThread = m_thread.native_handle();
-        lock.unlock();
-
-        if (!hThread)
-        {
-            //
-            // Running not in thread or closed
-            //
-            return TRUE;
-        }
-
-        DWORD res = WaitForSingleObject(hThread, timeout);
-        return res == WAIT_OBJECT_0;
-    }
-
-    HWND CaptureWindow::GetHwnd()
-    {
-        std::shared_lock<std::shared_mutex> lock(m_mutex);
-        return m_hwnd;
-    }
-
-    HRESULT CaptureWindow::AttachWindow()
-    {
-        assert(m_width && m_height && m_format && m_hwnd);
-
-        m_pDirect3DSurface.Reset();
-        m_pDirect3DDevice.Reset();
-        m_pDirect3D9.Reset();
-
-        ComPtr<IDirect3D9> direct3D9 = Direct3DCreate9(D3D_SDK_VERSION);
-        if (!direct3D9)
-        {
-            return E_FAIL;
-        }
-
-        D3DPRESENT_PARAMETERS d3dpp = { 0 };
-        d3dpp.Windowed = TRUE;
-        d3dpp.SwapEffect = D3DSWAPEFFECT_DISCARD;
-        d3dpp.BackBufferFormat = D3DFMT_UNKNOWN;
-
-        ComPtr<IDirect3DDevice9> direct3DDevice;
-        HRCHK(IDirect3D9_CreateDevice(direct3D9
-            , D3DADAPTER_DEFAULT
-            , D3DDEVTYPE_HAL
-            , m_hwnd
-            , D3DCREATE_SOFTWARE_VERTEXPROCESSING
-            , &d3dpp
-            , &direct3DDevice));
-
-        ComPtr<IDirect3DSurface9> direct3DSurfaceRender;
-        HRESULT hr = IDirect3DDevice9_CreateOffscreenPlainSurface(direct3DDevice
-            , m_width
-            , m_height
-            , m_format
-            , D3DPOOL_DEFAULT
-            , &direct3DSurfaceRender
-            , NULL);
-        
-        if (FAILED(hr))
-        {
-            return hr;
-        }
-
-        m_pDirect3D9.Swap(direct3D9);
-        m_pDirect3DDevice.Swap(direct3DDevice);
-        m_pDirect3DSurface.Swap(direct3DSurfaceRender);
-        return S_OK;
-    }
-
-    HRESULT CaptureWindow::Render(const void* buffer, LONG pitch)
-    {
-        m_frames += 1;
-
-        if (!m_pDirect3DSurface || !m_pDirect3DDevice)
-        {
-            return E_FAIL;
-        }
-
-        D3DLOCKED_RECT d3dRect = {};
-        HRCHK(IDirect3DSurface9_LockRect(m_pDirect3DSurface
-            , &d3dRect
-            , NULL
-            , D3DLOCK_DONOTWAIT));
-
-        auto dest = static_cast<char*>(d3dRect.pBits);
-        auto src = static_cast<const char*>(buffer);
-
-        if (!dest || !src)
-        {
-            // check dest and scr just for VS static analyzer 
-            return E_FAIL;
-        }
-
-        for (ULONG row = 0; row < m_height; ++row)
-        {
-            assert(pitch <= d3dRect.Pitch);
-            memcpy(dest, src, pitch);
-            dest += d3dRect.Pitch;
-            src += pitch;
-        }
-
-        HRCHK(IDirect3DSurface9_UnlockRect(m_pDirect3DSurface));
-        HRCHK(IDirect3DDevice9_Clear(m_pDirect3DDevice
-            , 0
-            , NULL
-            , D3DCLEAR_TARGET
-            , D3DCOLOR_XRGB(0, 0, 0)
-            , 1.0f
-            , 0));
-        HRCHK(IDirect3DDevice9_BeginScene(m_pDirect3DDevice));
-
-        IDirect3DSurface9 * pBackBuffer = NULL;
-        HRCHK(IDirect3DDevice9_GetBackBuffer(m_pDirect3DDevice
-            , 0
-            , 0
-            , D3DBACKBUFFER_TYPE_MONO
-            , &pBackBuffer));
-
-        HRCHK(IDirect3DDevice9_StretchRect(m_pDirect3DDevice
-            , m_pDirect3DSurface.Get()
-            , NULL
-            , pBackBuffer
-            , NULL
-            , D3DTEXF_LINEAR));
-
-        HRCHK(IDirect3DDevice9_EndScene(m_pDirect3DDevice));
-        HRCHK(IDirect3DDevice9_Present(m_pDirect3DDevice
-            , NULL
-            , NULL
-            , NULL
-            , NULL));
-
-        return S_OK;
-    }
-
-    HRESULT CaptureWindow::CreateWnd()
-    {
-        if (m_hwnd)
-        {
-            return E_FAIL;
-        }
-
-        WNDCLASSEX wc = { 0 };
-        wc.cbSize = sizeof(wc);
-        wc.hbrBackground = reinterpret_cast<HBRUSH>(COLOR_WINDOW + 1);
-        wc.lpfnWndProc = WndProc;
-        wc.lpszClassName = L"msmf capture window";
-        wc.style = CS_HREDRAW | CS_VREDRAW;
-        RegisterClassEx(&wc);
-
-        const DWORD wndStyle = WS_CAPTION | WS_SYSMENU | WS_MINIMIZEBOX;
-
-        RECT rect = { 0 };
-        rect.right = m_width;
-        rect.bottom = m_height;
-
-        if (!AdjustWindowRect(&rect, wndStyle, FALSE))
-        {
-            const DWORD err = GetLastError();
-            return HRESULT_FROM_WIN32(err);
-        };
-
-        m_hwnd = CreateWindowW(wc.lpszClassName
-            , m_title.c_str()
-            , wndStyle
-            , 0, 0
-            , rect.right - rect.left
-            , rect.bottom - rect.top
-            , NULL, NULL, NULL, NULL);
-
-        if (!m_hwnd)
-        {
-            const DWORD err = GetLastError();
-            return HRESULT_FROM_WIN32(err);
-        }
-
-        return S_OK;
-    }
-
-    HRESULT CaptureWindow::DestroyWnd()
-    {
-        HWND hwnd = m_hwnd;
-        m_hwnd = nullptr;
-
-        if (m_pVideoSource)
-        {
-            m_pVideoSource->Flush(m_streamIndex);
-            m_pVideoSource->SetStreamSelection(m_streamIndex, FALSE);
-        }
-
-        m_pVideoSource.Reset();
-        m_pDirect3DSurface.Reset();
-        m_pDirect3DDevice.Reset();
-        m_pDirect3D9.Reset();
-
-        if (hwnd && !DestroyWindow(hwnd))
-        {
-            const DWORD err = GetLastError();
-            return HRESULT_FROM_WIN32(err);
-        }
-
-        return S_OK;
-    }
-
-    HRESULT CaptureWindow::ShowModalImpl(HANDLE readyEvent)
-    {
-        std::unique_lock<std::shared_mutex> lock(m_mutex);
-
-        HRCHK(CreateWnd());
-        assert(m_hwnd);
-
-        if (0 != SetWindowLongPtr(m_hwnd, GWLP_USERDATA, reinterpret_cast<ULONG_PTR>(this)))
-        {
-            const DWORD err = GetLastError();
-            return HRESULT_FROM_WIN32(err);
-        }
-
-        if (0 == SetTimer(m_hwnd, 0, 1000, FpsTimer))
-        {
-            const DWORD err = GetLastError();
-            return HRESULT_FROM_WIN32(err);
-        }
-
-        HRCHK(AttachWindow());
-        HRCHK(m_pVideoSource->ReadSample(m_streamIndex, 0, NULL, NULL, NULL, NULL));
-
-        HWND hwnd = m_hwnd;
-        lock.unlock();
-
-        if (readyEvent)
-        {
-            SetEvent(readyEvent);
-            readyEvent = NULL;
-        }
-
-        ShowWindow(hwnd, SW_SHOW);
-        UpdateWindow(hwnd);
-
-        MSG msg = { 0 };
-        BOOL ret = FALSE;
-
-        while ((ret = GetMessage(&msg, hwnd, 0, 0)) != 0)
-        {
-            if (ret == -1)
-            {
-                break;
-            }
-            TranslateMessage(&msg);
-            DispatchMessage(&msg);
-        }
-
-        return S_OK;
-    }
-
-    CaptureWindow* CaptureWindow::GetThis(HWND hwnd)
-    {
-        return reinterpret_cast<CaptureWindow*>(GetWindowLongPtr(hwnd, GWLP_USERDATA));
-    }
-
-    LRESULT WINAPI CaptureWindow::WndProc(HWND hwnd, UINT msg, WPARAM wparma, LPARAM lparam)
-    {
-        auto pThis = GetThis(hwnd);
-
-        switch (msg)
-        {
-        case WM_CLOSE:
-        {
-            std::unique_lock<std::shared_mutex> lock(pThis->m_mutex);
-            pThis->DestroyWnd();
-            return 0;
-        }
-        case WM_DESTROY:
-            PostQuitMessage(0);
-            return 0;
-        }
-
-        return DefWindowProc(hwnd, msg, wparma, lparam);
-    }
-
-    VOID CALLBACK CaptureWindow::FpsTimer(HWND hwnd, UINT msg, UINT_PTR idEvent, DWORD dwTime)
-    {
-        UNREFERENCED_PARAMETER(msg);
-        UNREFERENCED_PARAMETER(idEvent);
-        UNREFERENCED_PARAMETER(dwTime);
-
-        auto pThis = GetThis(hwnd);
-
-        const uint64_t curr = pThis->m_frames;
-        const uint64_t fps = curr - pThis->m_framesPrev;
-        pThis->m_framesPrev = curr;
-
-        std::wstringstream st;
-        std::shared_lock<std::shared_mutex> lock(pThis->m_mutex);
-        st << pThis->m_title << " real FPS " << fps;
-        lock.unlock();
-
-        SetWindowTextW(hwnd, st.str().c_str());
-    }
-
-    STDMETHODIMP CaptureWindow::QueryInterface(REFIID iid, void** ppv)
-    {
-        static const QITAB qit[] =
-        {
-            QITABENT(CaptureWindow, IMFSourceReaderCallback),
-            { 0 },
-        };
-        return QISearch(this, qit, iid, ppv);
-    }
-
-    STDMETHODIMP_(ULONG) CaptureWindow::AddRef()
-    {
-        return 1;
-    }
-
-    STDMETHODIMP_(ULONG) CaptureWindow::Release()
-    {
-        return 1;
-    }
-
-    STDMETHODIMP CaptureWindow::OnReadSample(
-        HRESULT hrStatus, 
-        DWORD dwStreamIndex, 
-        DWORD dwStreamFlags, 
-        LONGLONG llTimestamp, 
-        IMFSample *pSample)
-    {
-        UNREFERENCED_PARAMETER(llTimestamp);
-
-        if (FAILED(hrStatus))
-        {
-            std::wstringstream st;
-            st << "OnReadSample error 0x" << std::hex << hrStatus;
-            MessageBoxW(GetHwnd(), st.str().c_str(), NULL, MB_OK | MB_ICONERROR);
-            Close();
-            return hrStatus;
-        }
-
-        if (MF_SOURCE_READERF_ENDOFSTREAM & dwStreamFlags)
-        {
-            MessageBoxW(GetHwnd(), L"OnReadSample end of stream", NULL, MB_OK | MB_ICONINFORMATION);
-            Close();
-            return S_OK;
-        }
-
-        std::shared_lock<std::shared_mutex> lock(m_mutex);
-
-        if (pSample)
-        {
-            ComPtr<IMFMediaBuffer> buffer;
-
-            if (SUCCEEDED(pSample->ConvertToContiguousBuffer(&buffer)))
-            {
-                ComPtr<IMF2DBuffer> buffer2d;
-                PBYTE pBuffer = nullptr;
-                LONG pinch = 0;
-
-                HRESULT hr = buffer->QueryInterface(__uuidof(IMF2DBuffer), reinterpret_cast<void**>(buffer2d.ReleaseAndGetAddressOf()));
-                
-                if (SUCCEEDED(hr) && SUCCEEDED(buffer2d->Lock2D(&pBuffer, &pinch)))
-                {
-                    Render(pBuffer, pinch);
-                    buffer2d->Unlock2D();
-                }
-            }
-        }
-
-        if (m_hwnd)
-        {
-            HRCHK(m_pVideoSource->ReadSample(dwStreamIndex, 0, NULL, NULL, NULL, NULL));
-        }
-        return S_OK;
-    }
-
-    STDMETHODIMP CaptureWindow::OnEvent(DWORD, IMFMediaEvent *)
-    {
-        return S_OK;
-    }
-
-    STDMETHODIMP CaptureWindow::OnFlush(DWORD streamIndex)
-    {
-        UNREFERENCED_PARAMETER(streamIndex);
-        return S_OK;
-    }
-}
+#include "stdafx.h"
+#include "CaptureWindow.h"
+#include "MFVideoFormat.h"
+#include "MFBackend.h"
+#include "TextOverlay.h"
+
+using namespace Microsoft::WRL::Wrappers;
+
+namespace
+{
+    //
+    // Memory cap of the frames queued for rendering
+    //
+    constexpr size_t FramePoolLimit = 256 * 1024 * 1024;
+
+    //
+    // The timecode is about a tenth of the frame height
+    //
+    constexpr uint32_t TimecodeLines = 90;
+    constexpr uint32_t TimecodeMargin = 8;
+
+    //
+    // Presentation pace when the adapter does not report its refresh rate
+    //
+    constexpr UINT DefaultRefreshRate = 60;
+}
+
+namespace mf
+{
+    CaptureWindow::CaptureWindow() noexcept
+        : m_pixelFormat(video::PixelFormat::Unknown)
+        , m_hwnd(nullptr)
+        , m_width(0)
+        , m_height(0)
+        , m_streamIndex(0)
+        , m_frameSource(nullptr)
+        , m_framesPrev(0)
+        , m_frames(0)
+        , m_renderedPrev(0)
+        , m_rendered(0)
+        , m_framePool(FramePoolLimit)
+        , m_displaySkips(0)
+        , m_frameReady(CreateEvent(NULL, FALSE, FALSE, NULL))
+        , m_recording(false)
+        , m_recordError(S_OK)
+        , m_queuePolicy(video::QueuePolicy::DropOldest)
+        , m_queueDepth(4)
+        , m_poolDrops(0)
+        , m_deviceDrops(0)
+        , m_readDepth(1)
+        , m_lastTimestamp(-1)
+        , m_outOfOrder(0)
+        , m_uniquePrev(0)
+        , m_timecode(false)
+    {
+    }
+
+    CaptureWindow::~CaptureWindow()
+    {
+        Close();
+    }
+
+    HRESULT CaptureWindow::Show(ComPtr<IMFSourceReader> pVideoSource, ComPtr<IMFMediaType> pType, ULONG streamIndex, bool showInThread)
+    {
+        std::unique_lock<std::shared_mutex> lock(m_mutex);
+
+        if (IsShown())
+        {
+            return S_FALSE;
+        }
+
+        //
+        // The native subtype is kept and converted to X8R8G8B8 in Render,
+        // so Media Foundation does not insert its own converter
+        //
+        capture::MediaTypeInfo mediaType;
+        HR_CHECK2(GetMediaTypeInfo(pType.Get(), 0, mediaType));
+
+        m_streamIndex = streamIndex;
+        m_pVideoSource = pVideoSource;
+        m_frameSource = nullptr;
+        return ShowImpl(lock, mediaType, showInThread);
+    }
+
+    HRESULT CaptureWindow::Show(capture::FrameSource& source, bool showInThread)
+    {
+        std::unique_lock<std::shared_mutex> lock(m_mutex);
+
+        if (IsShown())
+        {
+            return S_FALSE;
+        }
+
+        m_streamIndex = 0;
+        m_pVideoSource.Reset();
+        m_frameSource = &source;
+        return ShowImpl(lock, source.GetMediaType(), showInThread);
+    }
+
+    bool CaptureWindow::IsShown()
+    {
+        //
+        // Called under the lock
+        //
+        if (m_thread.joinable())
+        {
+            if (HWND hwnd = m_hwnd)
+            {
+                SetForegroundWindow(hwnd);
+                return true;
+            }
+            m_thread.join();
+        }
+
+        return false;
+    }
+
+    HRESULT CaptureWindow::ShowImpl(
+        std::unique_lock<std::shared_mutex>& lock,
+        const capture::MediaTypeInfo& mediaType,
+        bool showInThread)
+    {
+        m_pixelFormat = mediaType.format;
+        m_colorSpace = mediaType.colorSpace;
+
+        if (!video::PixelConverter::IsSupported(m_pixelFormat, video::PixelFormat::RGB32))
+        {
+            HR_CHECK(MF_E_INVALIDMEDIATYPE, "unsupported subtype " << static_cast<uint32_t>(m_pixelFormat));
+        }
+
+        m_width = mediaType.width;
+        m_height = mediaType.height;
+
+        //
+        // MF_MT_DEFAULT_STRIDE is negative for bottom-up images
+        //
+        m_sampleAccess.SetFormat(m_pixelFormat, m_width, m_height, mediaType.defaultStride);
+
+        const UINT32 fpsNumerator = mediaType.fpsNumerator;
+        const UINT32 fpsDenominator = mediaType.fpsDenominator;
+
+        {
+            std::lock_guard<std::mutex> timingLock(m_timingMutex);
+            m_timing.SetFrameRate(fpsNumerator, fpsDenominator);
+            m_timing.Reset();
+            m_frameDiff.Reset();
+            m_dwell.Start(video::TimingAnalyzer::Now());
+            m_uniquePrev = 0;
+        }
+
+        m_latency.Reset();
+        m_recordError = S_OK;
+
+        if (!m_recordPath.empty())
+        {
+            HR_CHECK(m_recorder.Open(m_recordPath, m_pixelFormat, m_width, m_height, fpsNumerator, fpsDenominator),
+                "cannot create the recording");
+            m_recording = true;
+        }
+
+        m_sampleAccess.ResetStatistics();
+        m_framesPrev = 0;
+        m_frames = 0;
+        m_renderedPrev = 0;
+        m_rendered = 0;
+        m_displaySkips = 0;
+        m_poolDrops = 0;
+        m_deviceDrops = 0;
+        m_outOfOrder = 0;
+        m_lastTimestamp = -1;
+        m_frameQueue.reset(new video::SpscQueue<video::FrameRef>(m_queueDepth, m_queuePolicy));
+
+        if (0 == m_width || 0 == m_height)
+        {
+            HR_CHECK(E_INVALIDARG, "invalid width or height");
+        }
+
+        if (!m_frameReady.IsValid())
+        {
+            HR_CHECK(E_HANDLE, "invalid frame event");
+        }
+
+        if (!showInThread)
+        {
+            lock.unlock();
+            HRESULT hr = ShowModalImpl(nullptr);
+
+            lock.lock();
+            DestroyWnd();
+            return hr;
+        }
+
+        Event event(CreateEvent(NULL, FALSE, FALSE, NULL));
+        if (!event.IsValid())
+        {
+            const DWORD err = GetLastError();
+            return HRESULT_FROM_WIN32(err);
+        }
+
+        m_thread = std::thread(&CaptureWindow::ShowModalImpl, this, event.Get());
+
+        HANDLE handles[] = { event.Get(), m_thread.native_handle() };
+        lock.unlock();
+
+        const DWORD res = WaitForMultipleObjects(ARRAYSIZE(handles), &handles[0], FALSE, INFINITE);
+        
+        lock.lock();
+        if (res != WAIT_OBJECT_0)
+        {
+            DestroyWnd();
+            m_thread.join();
+            return E_FAIL;
+        }
+
+        return S_OK;
+    }
+
+    HRESULT CaptureWindow::Close() noexcept
+    {
+        std::unique_lock<std::shared_mutex> lock(m_mutex);
+
+        if (m_frameQueue)
+        {
+            //
+            // Releases the capture callback blocked by the Block policy
+            //
+            m_frameQueue->Close();
+        }
+
+        if (m_hwnd)
+        {
+            if (!PostMessageW(m_hwnd, WM_CLOSE, 0, 0))
+            {
+                return E_FAIL;
+            }
+        }
+
+        auto thread = std::move(m_thread);
+        lock.unlock();
+
+        if (thread.joinable())
+        {
+            thread.join();
+        }
+        
+        return S_OK;
+    }
+
+    HRESULT CaptureWindow::SetTitle(std::wstring title)
+    {
+        std::unique_lock<std::shared_mutex> lock(m_mutex);
+        m_title = std::move(title);
+        return S_OK;
+    }
+
+    HRESULT CaptureWindow::SetQueuePolicy(video::QueuePolicy policy, size_t depth)
+    {
+        if (0 == depth)
+        {
+            return E_INVALIDARG;
+        }
+
+        std::unique_lock<std::shared_mutex> lock(m_mutex);
+        m_queuePolicy = policy;
+        m_queueDepth = depth;
+        return S_OK;
+    }
+
+    HRESULT CaptureWindow::SetReadDepth(ULONG depth)
+    {
+        if (0 == depth)
+        {
+            return E_INVALIDARG;
+        }
+
+        std::unique_lock<std::shared_mutex> lock(m_mutex);
+        m_readDepth = depth;
+        return S_OK;
+    }
+
+    HRESULT CaptureWindow::SetRecordPath(std::wstring path)
+    {
+        std::unique_lock<std::shared_mutex> lock(m_mutex);
+        m_recordPath = std::move(path);
+        return S_OK;
+    }
+
+    HRESULT CaptureWindow::SetTimecode(bool enable)
+    {
+        m_timecode = enable;
+        return S_OK;
+    }
+
+    CaptureWindow::Statistics CaptureWindow::GetStatistics()
+    {
+        std::shared_lock<std::shared_mutex> lock(m_mutex);
+
+        Statistics stat = {};
+        stat.readDepth = m_readDepth;
+        stat.captured = m_frames;
+        stat.rendered = m_rendered;
+        stat.displaySkips = m_displaySkips;
+        stat.deviceDrops = m_deviceDrops;
+        stat.outOfOrder = m_outOfOrder;
+        stat.queueDrops = m_poolDrops;
+
+        if (m_frameQueue)
+        {
+            const auto queueStat = m_frameQueue->GetStatistics();
+            stat.queueDrops += queueStat.droppedOldest + queueStat.droppedNewest;
+        }
+
+        //
+        // The capture is still running if the stop time was not set yet
+        //
+        const auto stop = m_hwnd ? std::chrono::steady_clock::now() : m_stopTime;
+
+        if (stop > m_startTime)
+        {
+            stat.seconds = std::chrono::duration<double>(stop - m_startTime).count();
+        }
+
+        stat.record = m_recorder.GetStatistics();
+        stat.recordError = m_recording ? m_recorder.GetError() : m_recordError;
+        stat.latency = m_latency.GetReport();
+
+        std::lock_guard<std::mutex> timingLock(m_timingMutex);
+        stat.timing = m_timing.GetReport();
+        stat.frameDiff = m_frameDiff.GetReport();
+        stat.dwell = m_dwell.GetReport();
+
+        return stat;
+    }
+
+    BOOL CaptureWindow::WaitForExit(ULONG timeout)
+    {
+        std::unique_lock<std::shared_mutex> lock(m_mutex);
+        HANDLE hThread = m_thread.native_handle();
+        lock.unlock();
+
+        if (!hThread)
+        {
+            //
+            // Running not in thread or closed
+            //
+            return TRUE;
+        }
+
+        DWORD res = WaitForSingleObject(hThread, timeout);
+        return res == WAIT_OBJECT_0;
+    }
+
+    BOOL CaptureWindow::WaitForDwell(ULONG timeout)
+    {
+        constexpr ULONG PollMs = 50;
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout);
+
+        for (;;)
+        {
+            const auto left = std::chrono::duration_cast<std::chrono::milliseconds>(
+                deadline - std::chrono::steady_clock::now()).count();
+
+            if (left <= 0)
+            {
+                return FALSE;
+            }
+
+            if (WaitForExit(std::min<ULONG>(PollMs, static_cast<ULONG>(left))))
+            {
+                return TRUE;
+            }
+
+            std::lock_guard<std::mutex> timingLock(m_timingMutex);
+
+            if (m_dwell.IsConverged())
+            {
+                return FALSE;
+            }
+        }
+    }
+
+    HWND CaptureWindow::GetHwnd()
+    {
+        std::shared_lock<std::shared_mutex> lock(m_mutex);
+        return m_hwnd;
+    }
+
+    bool CaptureWindow::IsSubtypeSupported(const GUID& subtype) noexcept
+    {
+        return video::PixelConverter::IsSupported(ToPixelFormat(subtype), video::PixelFormat::RGB32);
+    }
+
+    HRESULT CaptureWindow::AttachWindow()
+    {
+        assert(m_width && m_height && m_hwnd);
+
+        m_pDirect3DSurface.Reset();
+        m_pDirect3DDevice.Reset();
+        m_pDirect3D9.Reset();
+
+        ComPtr<IDirect3D9> direct3D9 = Direct3DCreate9(D3D_SDK_VERSION);
+        if (!direct3D9)
+        {
+            return E_FAIL;
+        }
+
+        D3DPRESENT_PARAMETERS d3dpp = { 0 };
+        d3dpp.Windowed = TRUE;
+        d3dpp.SwapEffect = D3DSWAPEFFECT_DISCARD;
+        d3dpp.BackBufferFormat = D3DFMT_UNKNOWN;
+
+        ComPtr<IDirect3DDevice9> direct3DDevice;
+        HRCHK(IDirect3D9_CreateDevice(direct3D9
+            , D3DADAPTER_DEFAULT
+            , D3DDEVTYPE_HAL
+            , m_hwnd
+            , D3DCREATE_SOFTWARE_VERTEXPROCESSING
+            , &d3dpp
+            , &direct3DDevice));
+
+        video::PixelConverter converter(
+            m_pixelFormat,
+            video::PixelFormat::RGB32,
+            m_width,
+            m_height,
+            m_colorSpace);
+
+        if (!converter.IsValid())
+        {
+            return MF_E_INVALIDMEDIATYPE;
+        }
+
+        ComPtr<IDirect3DSurface9> direct3DSurfaceRender;
+        HRESULT hr = IDirect3DDevice9_CreateOffscreenPlainSurface(direct3DDevice
+            , m_width
+            , m_height
+            , D3DFMT_X8R8G8B8
+            , D3DPOOL_DEFAULT
+            , &direct3DSurfaceRender
+            , NULL);
+        
+        if (FAILED(hr))
+        {
+            return hr;
+        }
+
+        m_pDirect3D9.Swap(direct3D9);
+        m_pDirect3DDevice.Swap(direct3DDevice);
+        m_pDirect3DSurface.Swap(direct3DSurfaceRender);
+        m_converter = converter;
+        return S_OK;
+    }
+
+    HRESULT CaptureWindow::Render(const video::FrameView& frame, video::FrameTimes& times)
+    {
+        m_rendered += 1;
+
+        if (!m_pDirect3DSurface || !m_pDirect3DDevice)
+        {
+            return E_FAIL;
+        }
+
+        D3DLOCKED_RECT d3dRect = {};
+        HRCHK(IDirect3DSurface9_LockRect(m_pDirect3DSurface
+            , &d3dRect
+            , NULL
+            , D3DLOCK_DONOTWAIT));
+
+        auto dest = static_cast<uint8_t*>(d3dRect.pBits);
+
+        if (!dest)
+        {
+            // check dest just for VS static analyzer 
+            return E_FAIL;
+        }
+
+        times.copyStart = video::TimingAnalyzer::Now();
+        const bool converted = m_converter.Convert(frame.planes, dest, d3dRect.Pitch);
+
+        if (converted && m_timecode)
+        {
+            //
+            // Seconds modulo a day keep the label short
+            //
+            const int64_t ms = times.copyStart / 1000000;
+            char text[32];
+            snprintf(text, sizeof(text), "%05lld.%03lld",
+                static_cast<long long>(ms / 1000 % 86400),
+                static_cast<long long>(ms % 1000));
+
+            const uint32_t scale = std::max<uint32_t>(1, m_height / TimecodeLines);
+            video::TileRect clip;
+            clip.width = m_width;
+            clip.height = m_height;
+
+            video::DrawLabel(
+                dest,
+                d3dRect.Pitch,
+                clip,
+                TimecodeMargin,
+                m_height > 7 * scale + TimecodeMargin ? m_height - 7 * scale - TimecodeMargin : 0,
+                text,
+                scale);
+        }
+
+        HRCHK(IDirect3DSurface9_UnlockRect(m_pDirect3DSurface));
+        times.copyEnd = video::TimingAnalyzer::Now();
+
+        if (!converted)
+        {
+            return MF_E_INVALIDMEDIATYPE;
+        }
+
+        HRCHK(IDirect3DDevice9_Clear(m_pDirect3DDevice
+            , 0
+            , NULL
+            , D3DCLEAR_TARGET
+            , D3DCOLOR_XRGB(0, 0, 0)
+            , 1.0f
+            , 0));
+        HRCHK(IDirect3DDevice9_BeginScene(m_pDirect3DDevice));
+
+        IDirect3DSurface9 * pBackBuffer = NULL;
+        HRCHK(IDirect3DDevice9_GetBackBuffer(m_pDirect3DDevice
+            , 0
+            , 0
+            , D3DBACKBUFFER_TYPE_MONO
+            , &pBackBuffer));
+
+        HRCHK(IDirect3DDevice9_StretchRect(m_pDirect3DDevice
+            , m_pDirect3DSurface.Get()
+            , NULL
+            , pBackBuffer
+            , NULL
+            , D3DTEXF_LINEAR));
+
+        HRCHK(IDirect3DDevice9_EndScene(m_pDirect3DDevice));
+        HRCHK(IDirect3DDevice9_Present(m_pDirect3DDevice
+            , NULL
+            , NULL
+            , NULL
+            , NULL));
+
+        times.present = video::TimingAnalyzer::Now();
+        return S_OK;
+    }
+
+    HRESULT CaptureWindow::RenderQueuedFrames()
+    {
+        //
+        // Runs on the window thread, the capture callback only queues frames.
+        // The queue is drained at the capture rate, only the newest frame
+        // is presented once per display refresh
+        //
+        video::FrameRef frame;
+
+        while (m_frameQueue->Pop(frame))
+        {
+            m_presentScheduler.OnFrame();
+            m_pendingFrame = std::move(frame);
+        }
+
+        m_displaySkips = m_presentScheduler.GetStatistics().skipped;
+
+        if (!m_presentScheduler.OnTick(video::TimingAnalyzer::Now()))
+        {
+            return S_OK;
+        }
+
+        video::FrameTimes times;
+        times.device = m_pendingFrame->deviceTime;
+        times.arrival = m_pendingFrame->arrival;
+
+        //
+        // A failed frame does not stall the next ones
+        //
+        const HRESULT hr = Render(m_pendingFrame->View(), times);
+        m_pendingFrame.Reset();
+
+        if (SUCCEEDED(hr))
+        {
+            m_latency.Record(times);
+        }
+
+        return hr;
+    }
+
+    HRESULT CaptureWindow::CreateWnd()
+    {
+        if (m_hwnd)
+        {
+            return E_FAIL;
+        }
+
+        WNDCLASSEX wc = { 0 };
+        wc.cbSize = sizeof(wc);
+        wc.hbrBackground = reinterpret_cast<HBRUSH>(COLOR_WINDOW + 1);
+        wc.lpfnWndProc = WndProc;
+        wc.lpszClassName = L"msmf capture window";
+        wc.style = CS_HREDRAW | CS_VREDRAW;
+        RegisterClassEx(&wc);
+
+        const DWORD wndStyle = WS_CAPTION | WS_SYSMENU | WS_MINIMIZEBOX;
+
+        RECT rect = { 0 };
+        rect.right = m_width;
+        rect.bottom = m_height;
+
+        if (!AdjustWindowRect(&rect, wndStyle, FALSE))
+        {
+            const DWORD err = GetLastError();
+            return HRESULT_FROM_WIN32(err);
+        };
+
+        m_hwnd = CreateWindowW(wc.lpszClassName
+            , m_title.c_str()
+            , wndStyle
+            , 0, 0
+            , rect.right - rect.left
+            , rect.bottom - rect.top
+            , NULL, NULL, NULL, NULL);
+
+        if (!m_hwnd)
+        {
+            const DWORD err = GetLastError();
+            return HRESULT_FROM_WIN32(err);
+        }
+
+        return S_OK;
+    }
+
+    HRESULT CaptureWindow::DestroyWnd()
+    {
+        HWND hwnd = m_hwnd;
+        m_hwnd = nullptr;
+
+        if (m_pVideoSource)
+        {
+            m_pVideoSource->Flush(m_streamIndex);
+            m_pVideoSource->SetStreamSelection(m_streamIndex, FALSE);
+        }
+
+        if (m_frameQueue)
+        {
+            m_frameQueue->Close();
+        }
+
+        if (m_frameSource)
+        {
+            //
+            // OnFrame takes no lock, so the source thread can finish its frame
+            //
+            m_frameSource->Stop();
+            m_frameSource = nullptr;
+        }
+
+        if (m_frameQueue)
+        {
+            m_frameQueue->Clear();
+        }
+
+        if (m_recording.exchange(false))
+        {
+            //
+            // Writes the backlog, so the recording is complete when the window is gone
+            //
+            m_recordError = m_recorder.Close();
+        }
+
+        if (hwnd)
+        {
+            m_stopTime = std::chrono::steady_clock::now();
+        }
+
+        m_pVideoSource.Reset();
+        m_pDirect3DSurface.Reset();
+        m_pDirect3DDevice.Reset();
+        m_pDirect3D9.Reset();
+
+        if (hwnd && !DestroyWindow(hwnd))
+        {
+            const DWORD err = GetLastError();
+            return HRESULT_FROM_WIN32(err);
+        }
+
+        return S_OK;
+    }
+
+    HRESULT CaptureWindow::ShowModalImpl(HANDLE readyEvent)
+    {
+        std::unique_lock<std::shared_mutex> lock(m_mutex);
+
+        HRCHK(CreateWnd());
+        assert(m_hwnd);
+
+        if (0 != SetWindowLongPtr(m_hwnd, GWLP_USERDATA, reinterpret_cast<ULONG_PTR>(this)))
+        {
+            const DWORD err = GetLastError();
+            return HRESULT_FROM_WIN32(err);
+        }
+
+        if (0 == SetTimer(m_hwnd, 0, 1000, FpsTimer))
+        {
+            const DWORD err = GetLastError();
+            return HRESULT_FROM_WIN32(err);
+        }
+
+        HRCHK(AttachWindow());
+
+        D3DDISPLAYMODE mode = {};
+        m_pDirect3D9->GetAdapterDisplayMode(D3DADAPTER_DEFAULT, &mode);
+        m_presentScheduler.Reset();
+        m_presentScheduler.SetRefreshRate(mode.RefreshRate ? mode.RefreshRate : DefaultRefreshRate);
+
+        //
+        // Several requests in flight keep the driver queue full:
+        // each OnReadSample issues one request to replace the completed one
+        //
+        m_startTime = std::chrono::steady_clock::now();
+        m_stopTime = m_startTime;
+
+        if (m_frameSource)
+        {
+            HRCHK(m_frameSource->Start(*this, m_readDepth));
+        }
+        else
+        {
+            for (ULONG i = 0; i < m_readDepth; ++i)
+            {
+                HRCHK(m_pVideoSource->ReadSample(m_streamIndex, 0, NULL, NULL, NULL, NULL));
+            }
+        }
+
+        HWND hwnd = m_hwnd;
+        lock.unlock();
+
+        if (readyEvent)
+        {
+            SetEvent(readyEvent);
+            readyEvent = NULL;
+        }
+
+        ShowWindow(hwnd, SW_SHOW);
+        UpdateWindow(hwnd);
+
+        MSG msg = { 0 };
+        HANDLE frameReady = m_frameReady.Get();
+        bool quit = false;
+
+        while (!quit)
+        {
+            //
+            // Wakes for a new frame or for the refresh the pending frame waits for,
+            // the timeout is rounded up so the wait does not spin
+            //
+            const int64_t wait = m_presentScheduler.GetWaitTime(video::TimingAnalyzer::Now());
+            const DWORD timeout = wait == video::PresentScheduler::WaitInfinite
+                ? INFINITE
+                : static_cast<DWORD>((wait + 999999) / 1000000);
+
+            const DWORD res = MsgWaitForMultipleObjects(1, &frameReady, FALSE, timeout, QS_ALLINPUT);
+
+            if (res == WAIT_OBJECT_0 || res == WAIT_TIMEOUT)
+            {
+                RenderQueuedFrames();
+                continue;
+            }
+
+            if (res != WAIT_OBJECT_0 + 1)
+            {
+                break;
+            }
+
+            while (PeekMessage(&msg, NULL, 0, 0, PM_REMOVE))
+            {
+                if (msg.message == WM_QUIT)
+                {
+                    quit = true;
+                    break;
+                }
+                TranslateMessage(&msg);
+                DispatchMessage(&msg);
+            }
+        }
+
+        //
+        // The frame not presented goes back to the pool
+        //
+        m_pendingFrame.Reset();
+        return S_OK;
+    }
+
+    CaptureWindow* CaptureWindow::GetThis(HWND hwnd)
+    {
+        return reinterpret_cast<CaptureWindow*>(GetWindowLongPtr(hwnd, GWLP_USERDATA));
+    }
+
+    LRESULT WINAPI CaptureWindow::WndProc(HWND hwnd, UINT msg, WPARAM wparma, LPARAM lparam)
+    {
+        auto pThis = GetThis(hwnd);
+
+        switch (msg)
+        {
+        case WM_CLOSE:
+        {
+            if (pThis->m_frameQueue)
+            {
+                //
+                // The blocked capture callback holds no lock, release it first
+                //
+                pThis->m_frameQueue->Close();
+            }
+
+            std::unique_lock<std::shared_mutex> lock(pThis->m_mutex);
+            pThis->DestroyWnd();
+            return 0;
+        }
+        case WM_DESTROY:
+            PostQuitMessage(0);
+            return 0;
+        }
+
+        return DefWindowProc(hwnd, msg, wparma, lparam);
+    }
+
+    VOID CALLBACK CaptureWindow::FpsTimer(HWND hwnd, UINT msg, UINT_PTR idEvent, DWORD dwTime)
+    {
+        UNREFERENCED_PARAMETER(msg);
+        UNREFERENCED_PARAMETER(idEvent);
+        UNREFERENCED_PARAMETER(dwTime);
+
+        auto pThis = GetThis(hwnd);
+
+        const uint64_t curr = pThis->m_frames;
+        const uint64_t fps = curr - pThis->m_framesPrev;
+        pThis->m_framesPrev = curr;
+
+        const uint64_t rendered = pThis->m_rendered;
+        const uint64_t renderFps = rendered - pThis->m_renderedPrev;
+        pThis->m_renderedPrev = rendered;
+        const uint64_t displaySkips = pThis->m_displaySkips;
+
+        std::unique_lock<std::mutex> timingLock(pThis->m_timingMutex);
+        const auto timing = pThis->m_timing.GetReport();
+        const auto frameDiff = pThis->m_frameDiff.GetReport();
+        const uint64_t uniqueFps = frameDiff.unique - pThis->m_uniquePrev;
+        pThis->m_uniquePrev = frameDiff.unique;
+        timingLock.unlock();
+
+        const auto latency = pThis->m_latency.GetReport();
+        const auto& total = latency[video::LatencyTracker::Span::Total];
+
+        const auto queueStat = pThis->m_frameQueue->GetStatistics();
+        const uint64_t queueDrops = queueStat.droppedOldest + queueStat.droppedNewest + pThis->m_poolDrops;
+
+        //
+        // Shows how the frames were accessed: in place or copied to a contiguous buffer
+        //
+        const auto stat = pThis->m_sampleAccess.GetStatistics();
+        const auto inPlace = stat.paths[static_cast<size_t>(SampleAccess::Path::Lock2DSize)]
+            + stat.paths[static_cast<size_t>(SampleAccess::Path::Lock2D)]
+            + stat.paths[static_cast<size_t>(SampleAccess::Path::Lock)];
+        const auto copied = stat.paths[static_cast<size_t>(SampleAccess::Path::Contiguous)];
+
+        std::wstringstream st;
+        std::shared_lock<std::shared_mutex> lock(pThis->m_mutex);
+        st << pThis->m_title << " real FPS " << fps;
+        st << " unique FPS " << uniqueFps;
+        st << " render FPS " << renderFps << " (display skips " << displaySkips << ")";
+        st << " depth " << pThis->m_readDepth;
+        st << " dropped: queue " << queueDrops << ", device " << pThis->m_deviceDrops;
+        st << ", out of order " << pThis->m_outOfOrder;
+        st << ", missing " << timing.droppedFrames;
+        st << " frozen " << frameDiff.frozen << ", partial " << frameDiff.partial;
+        st << " jitter p99 " << timing.jitterP99 << " us";
+        st << " latency p50 " << total.p50 / 1000.0 << " p99 " << total.p99 / 1000.0 << " ms";
+        st << " [in place " << inPlace << ", copied " << copied << "]";
+
+        if (pThis->m_recording)
+        {
+            const auto record = pThis->m_recorder.GetStatistics();
+            st << " rec backlog " << record.backlog << ", dropped " << record.dropped;
+        }
+        lock.unlock();
+
+        SetWindowTextW(hwnd, st.str().c_str());
+    }
+
+    STDMETHODIMP CaptureWindow::QueryInterface(REFIID iid, void** ppv)
+    {
+        static const QITAB qit[] =
+        {
+            QITABENT(CaptureWindow, IMFSourceReaderCallback),
+            { 0 },
+        };
+        return QISearch(this, qit, iid, ppv);
+    }
+
+    STDMETHODIMP_(ULONG) CaptureWindow::AddRef()
+    {
+        return 1;
+    }
+
+    STDMETHODIMP_(ULONG) CaptureWindow::Release()
+    {
+        return 1;
+    }
+
+    STDMETHODIMP CaptureWindow::OnReadSample(
+        HRESULT hrStatus, 
+        DWORD dwStreamIndex, 
+        DWORD dwStreamFlags, 
+        LONGLONG llTimestamp, 
+        IMFSample *pSample)
+    {
+        const int64_t arrival = video::TimingAnalyzer::Now();
+
+        if (FAILED(hrStatus))
+        {
+            std::wstringstream st;
+            st << "OnReadSample error 0x" << std::hex << hrStatus;
+            MessageBoxW(GetHwnd(), st.str().c_str(), NULL, MB_OK | MB_ICONERROR);
+            Close();
+            return hrStatus;
+        }
+
+        if (MF_SOURCE_READERF_ENDOFSTREAM & dwStreamFlags)
+        {
+            MessageBoxW(GetHwnd(), L"OnReadSample end of stream", NULL, MB_OK | MB_ICONINFORMATION);
+            Close();
+            return S_OK;
+        }
+
+        //
+        // Gaps reported by the device: stream ticks and discontinuities after the first frame
+        //
+        if (MF_SOURCE_READERF_STREAMTICK & dwStreamFlags)
+        {
+            m_deviceDrops += 1;
+        }
+
+        if (pSample)
+        {
+            UINT32 discontinuity = FALSE;
+
+            if (m_frames > 0
+                && SUCCEEDED(pSample->GetUINT32(MFSampleExtension_Discontinuity, &discontinuity))
+                && discontinuity)
+            {
+                m_deviceDrops += 1;
+            }
+
+            //
+            // The source reader serializes the callbacks of all requests in flight
+            //
+            video::FrameView view;
+
+            if (AcceptFrame(llTimestamp, arrival) && SUCCEEDED(m_sampleAccess.Lock(pSample, view)))
+            {
+                QueueFrame(view, llTimestamp, dwStreamFlags, dwStreamIndex, arrival, TimestampToHost(llTimestamp));
+                m_sampleAccess.Unlock();
+            }
+        }
+
+        std::shared_lock<std::shared_mutex> lock(m_mutex);
+
+        if (m_hwnd)
+        {
+            HRCHK(m_pVideoSource->ReadSample(dwStreamIndex, 0, NULL, NULL, NULL, NULL));
+        }
+        return S_OK;
+    }
+
+    void CaptureWindow::OnFrame(const video::FrameView& frame, int64_t timestamp)
+    {
+        //
+        // Frames of a capture::FrameSource, one backend thread calls it
+        //
+        const int64_t arrival = video::TimingAnalyzer::Now();
+
+        if (AcceptFrame(timestamp, arrival))
+        {
+            QueueFrame(frame, timestamp, 0, m_streamIndex, arrival, m_frameSource->TimestampToHost(timestamp));
+        }
+    }
+
+    bool CaptureWindow::AcceptFrame(int64_t timestamp, int64_t arrival)
+    {
+        m_frames += 1;
+
+        {
+            std::lock_guard<std::mutex> timingLock(m_timingMutex);
+            m_timing.OnSample(timestamp, arrival);
+            m_dwell.OnFrame(timestamp, arrival);
+        }
+
+        //
+        // A frame older than the previous one is counted and not rendered
+        //
+        if (timestamp <= m_lastTimestamp)
+        {
+            m_outOfOrder += 1;
+            return false;
+        }
+
+        m_lastTimestamp = timestamp;
+        return true;
+    }
+
+    void CaptureWindow::QueueFrame(
+        const video::FrameView& view,
+        int64_t timestamp,
+        uint32_t flags,
+        uint32_t streamIndex,
+        int64_t arrival,
+        int64_t deviceTime)
+    {
+        {
+            //
+            // Compared before the copy, so frames dropped by the queue
+            // still count: a driver repeating its buffers shows here
+            // while the callback rate stays steady
+            //
+            std::lock_guard<std::mutex> timingLock(m_timingMutex);
+            m_frameDiff.OnFrame(view);
+        }
+
+        //
+        // The frame is copied to the pool and queued for the window thread,
+        // so a slow Present does not delay the next frame.
+        // The queue may block here with the Block policy, so no lock is held
+        //
+        video::FrameRef frame = m_framePool.Copy(view);
+
+        if (!frame)
+        {
+            m_poolDrops += 1;
+            return;
+        }
+
+        frame->timestamp = timestamp;
+        frame->flags = flags;
+        frame->streamIndex = streamIndex;
+        frame->arrival = arrival;
+        frame->deviceTime = deviceTime;
+
+        if (m_recording)
+        {
+            m_recorder.Write(frame);
+        }
+
+        if (m_frameQueue->Push(std::move(frame)))
+        {
+            SetEvent(m_frameReady.Get());
+        }
+    }
+
+    STDMETHODIMP CaptureWindow::OnEvent(DWORD, IMFMediaEvent *)
+    {
+        return S_OK;
+    }
+
+    STDMETHODIMP CaptureWindow::OnFlush(DWORD streamIndex)
+    {
+        UNREFERENCED_PARAMETER(streamIndex);
+        return S_OK;
+    }
+}
@@ -1,81 +1,226 @@
-#pragma once
-#include <windows.h>
-#include <shlwapi.h>
-#include <wrl.h>
-#include <wrl/client.h>
-#include <mfreadwrite.h>
-#include <d3d9.h>
-#include <thread>
-#include <shared_mutex>
-#include <atomic>
-#include "ComUtils.h"
-
-#pragma comment(lib, "d3d9.lib")
-
-namespace mf
-{
-    class CaptureWindow : public IMFSourceReaderCallback
-    {
-    public:
-        CaptureWindow() noexcept;
-        ~CaptureWindow();
-
-        CaptureWindow(CaptureWindow&&) = delete;
-        CaptureWindow& operator=(CaptureWindow&&) = delete;
-
-        HRESULT Show(
-            ComPtr<IMFSourceReader> pVideoSource,
-            ComPtr<IMFMediaType> pType,
-            ULONG streamIndex,
-            bool showInThread);
-
-        HRESULT Close() noexcept;
-        HRESULT SetTitle(std::wstring title);
-
-        BOOL WaitForExit(ULONG timeout);
-        HWND GetHwnd();
-
-    private:
-        HRESULT AttachWindow();
-        HRESULT Render(const void* buffer, LONG pitch);
-
-        HRESULT CreateWnd();
-        HRESULT DestroyWnd();
-        HRESULT ShowModalImpl(HANDLE readyEvent);
-
-        static CaptureWindow* GetThis(HWND hwnd);
-        static LRESULT WINAPI WndProc(HWND hwnd, UINT msg, WPARAM wparma, LPARAM lparam);
-        static VOID CALLBACK FpsTimer(HWND hwnd, UINT msg, UINT_PTR idEvent, DWORD dwTime);
-
-    private:
-        STDMETHODIMP QueryInterface(REFIID iid, void** ppv) override;
-        STDMETHODIMP_(ULONG) AddRef() override;
-        STDMETHODIMP_(ULONG) Release() override;
-        STDMETHODIMP OnReadSample(
-            HRESULT hrStatus, 
-            DWORD dwStreamIndex, 
-            DWORD dwStreamFlags, 
-            LONGLONG llTimestamp, 
-            IMFSample *pSample) override;
-        STDMETHODIMP OnEvent(DWORD, IMFMediaEvent*) override;
-        STDMETHODIMP OnFlush(DWORD streamIndex) override;
-
-    private:
-        std::thread m_thread;
-        std::shared_mutex m_mutex;
-        std::wstring m_title;
-
-        ComPtr<IDirect3D9> m_pDirect3D9;
-        ComPtr<IDirect3DDevice9> m_pDirect3DDevice;
-        ComPtr<IDirect3DSurface9> m_pDirect3DSurface;
-        ComPtr<IMFSourceReader> m_pVideoSource;
-
-        D3DFORMAT m_format;
-        HWND m_hwnd;
-        ULONG m_width;
-        ULONG m_height;
-        ULONG m_streamIndex;
-        std::atomic<uint64_t> m_framesPrev;
-        std::atomic<uint64_t> m_frames;
-    };
-}
+#pragma once
+#include <windows.h>
+#include <shlwapi.h>
+#include <wrl.h>
+#include <wrl/client.h>
+#include <mfreadwrite.h>
+#include <d3d9.h>
+#include <thread>
+#include <shared_mutex>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include "ComUtils.h"
+#include "PixelConvert.h"
+#include "MFSampleAccess.h"
+#include "FramePool.h"
+#include "SpscQueue.h"
+#include "TimingAnalyzer.h"
+#include "LatencyTracker.h"
+#include "FrameDiff.h"
+#include "DwellMonitor.h"
+#include "PresentScheduler.h"
+#include "RecordWriter.h"
+#include "CaptureBackend.h"
+
+#pragma comment(lib, "d3d9.lib")
+
+namespace mf
+{
+    class CaptureWindow : public IMFSourceReaderCallback, public video::FrameSink
+    {
+    public:
+        struct Statistics
+        {
+            ULONG readDepth;
+            uint64_t captured;
+            uint64_t rendered;
+            uint64_t displaySkips;  // replaced by a newer frame within one display refresh
+            uint64_t queueDrops;
+            uint64_t deviceDrops;
+            uint64_t outOfOrder;
+            double seconds;
+            video::TimingAnalyzer::Report timing;
+            video::LatencyTracker::Report latency;
+            video::FrameDiffDetector::Report frameDiff;
+            video::DwellMonitor::Report dwell;
+            video::RecordWriter::Statistics record;
+            HRESULT recordError;
+        };
+
+        CaptureWindow() noexcept;
+        ~CaptureWindow();
+
+        CaptureWindow(CaptureWindow&&) = delete;
+        CaptureWindow& operator=(CaptureWindow&&) = delete;
+
+        HRESULT Show(
+            ComPtr<IMFSourceReader> pVideoSource,
+            ComPtr<IMFMediaType> pType,
+            ULONG streamIndex,
+            bool showInThread);
+
+        //
+        // Shows the frames of a backend source, e.g. a replayed recording.
+        // The source is started by the window and stopped when it closes,
+        // it must outlive the window
+        //
+        HRESULT Show(capture::FrameSource& source, bool showInThread);
+
+        HRESULT Close() noexcept;
+        HRESULT SetTitle(std::wstring title);
+
+        //
+        // Frames are handed from the capture callback to the window thread
+        // through a bounded queue, applied by the next Show
+        //
+        HRESULT SetQueuePolicy(video::QueuePolicy policy, size_t depth);
+
+        //
+        // Number of ReadSample requests kept in flight, applied by the next Show
+        //
+        HRESULT SetReadDepth(ULONG depth);
+
+        //
+        // Records the raw frames of the next Show, an empty path disables recording
+        //
+        HRESULT SetRecordPath(std::wstring path);
+
+        //
+        // Burns the host clock, seconds and milliseconds, into every frame
+        // at its upload, a camera filming the screen next to the console
+        // then shows the glass-to-glass latency
+        //
+        HRESULT SetTimecode(bool enable);
+
+        Statistics GetStatistics();
+
+        BOOL WaitForExit(ULONG timeout);
+
+        //
+        // Waits until the fps and the jitter of the stream converge,
+        // the window closes or the timeout elapses.
+        // TRUE when the window closed
+        //
+        BOOL WaitForDwell(ULONG timeout);
+        HWND GetHwnd();
+
+        //
+        // The subtype can be rendered without a Media Foundation converter
+        //
+        static bool IsSubtypeSupported(const GUID& subtype) noexcept;
+
+    private:
+        bool IsShown();
+        HRESULT ShowImpl(
+            std::unique_lock<std::shared_mutex>& lock,
+            const capture::MediaTypeInfo& mediaType,
+            bool showInThread);
+
+        //
+        // The consumer path shared by OnReadSample and OnFrame
+        //
+        bool AcceptFrame(int64_t timestamp, int64_t arrival);
+        void QueueFrame(
+            const video::FrameView& view,
+            int64_t timestamp,
+            uint32_t flags,
+            uint32_t streamIndex,
+            int64_t arrival,
+            int64_t deviceTime);
+
+        HRESULT AttachWindow();
+        HRESULT Render(const video::FrameView& frame, video::FrameTimes& times);
+        HRESULT RenderQueuedFrames();
+
+        HRESULT CreateWnd();
+        HRESULT DestroyWnd();
+        HRESULT ShowModalImpl(HANDLE readyEvent);
+
+        static CaptureWindow* GetThis(HWND hwnd);
+        static LRESULT WINAPI WndProc(HWND hwnd, UINT msg, WPARAM wparma, LPARAM lparam);
+        static VOID CALLBACK FpsTimer(HWND hwnd, UINT msg, UINT_PTR idEvent, DWORD dwTime);
+
+    private:
+        STDMETHODIMP QueryInterface(REFIID iid, void** ppv) override;
+        STDMETHODIMP_(ULONG) AddRef() override;
+        STDMETHODIMP_(ULONG) Release() override;
+        STDMETHODIMP OnReadSample(
+            HRESULT hrStatus, 
+            DWORD dwStreamIndex, 
+            DWORD dwStreamFlags, 
+            LONGLONG llTimestamp, 
+            IMFSample *pSample) override;
+        STDMETHODIMP OnEvent(DWORD, IMFMediaEvent*) override;
+        STDMETHODIMP OnFlush(DWORD streamIndex) override;
+
+        void OnFrame(const video::FrameView& frame, int64_t timestamp) override;
+
+    private:
+        std::thread m_thread;
+        std::shared_mutex m_mutex;
+        std::wstring m_title;
+
+        ComPtr<IDirect3D9> m_pDirect3D9;
+        ComPtr<IDirect3DDevice9> m_pDirect3DDevice;
+        ComPtr<IDirect3DSurface9> m_pDirect3DSurface;
+        ComPtr<IMFSourceReader> m_pVideoSource;
+
+        video::PixelFormat m_pixelFormat;
+        video::ColorSpace m_colorSpace;
+        video::PixelConverter m_converter;
+        SampleAccess m_sampleAccess;
+        HWND m_hwnd;
+        ULONG m_width;
+        ULONG m_height;
+        ULONG m_streamIndex;
+        capture::FrameSource* m_frameSource;
+        std::atomic<uint64_t> m_framesPrev;
+        std::atomic<uint64_t> m_frames;
+        std::atomic<uint64_t> m_renderedPrev;
+        std::atomic<uint64_t> m_rendered;
+
+        //
+        // The pool must outlive the queue holding its frames
+        //
+        video::FramePool m_framePool;
+        std::unique_ptr<video::SpscQueue<video::FrameRef>> m_frameQueue;
+
+        //
+        // The newest frame waiting for the next display refresh, window thread only
+        //
+        video::FrameRef m_pendingFrame;
+        video::PresentScheduler m_presentScheduler;
+        std::atomic<uint64_t> m_displaySkips;
+        video::RecordWriter m_recorder;
+        std::wstring m_recordPath;
+        std::atomic<bool> m_recording;
+        HRESULT m_recordError;
+        Microsoft::WRL::Wrappers::Event m_frameReady;
+        video::QueuePolicy m_queuePolicy;
+        size_t m_queueDepth;
+        std::atomic<uint64_t> m_poolDrops;
+        std::atomic<uint64_t> m_deviceDrops;
+
+        ULONG m_readDepth;
+        LONGLONG m_lastTimestamp;
+        std::atomic<uint64_t> m_outOfOrder;
+        std::chrono::steady_clock::time_point m_startTime;
+        std::chrono::steady_clock::time_point m_stopTime;
+
+        //
+        // Fed by the capture callback, read by the timer
+        //
+        std::mutex m_timingMutex;
+        video::TimingAnalyzer m_timing;
+        video::FrameDiffDetector m_frameDiff;
+        video::DwellMonitor m_dwell;
+        uint64_t m_uniquePrev;
+
+        //
+        // Recorded by the window thread, read by the timer without a lock
+        //
+        video::LatencyTracker m_latency;
+        std::atomic<bool> m_timecode;
+    };
+}
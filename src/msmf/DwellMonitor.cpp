@@ -0,0 +1,187 @@
+#include "DwellMonitor.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace
+{
+    //
+    // Two-sided 95% quantiles of Student's t for 1 to 30 degrees of freedom
+    //
+    constexpr double StudentT95[] =
+    {
+        12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+        2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+        2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042,
+    };
+
+    double StudentT(uint32_t degrees) noexcept
+    {
+        constexpr uint32_t count = sizeof(StudentT95) / sizeof(StudentT95[0]);
+        return degrees <= count ? StudentT95[degrees - 1] : 1.96;
+    }
+
+    //
+    // Sample timestamps are in 100 ns units
+    //
+    constexpr int64_t TimestampUnit = 100;
+}
+
+namespace video
+{
+    void DwellMonitor::Samples::Add(double value) noexcept
+    {
+        count += 1;
+        const double delta = value - mean;
+        mean += delta / count;
+        m2 += delta * (value - mean);
+    }
+
+    double DwellMonitor::Samples::HalfWidth() const noexcept
+    {
+        if (count < 2)
+        {
+            return std::numeric_limits<double>::infinity();
+        }
+
+        return StudentT(count - 1) * std::sqrt(m2 / (count - 1) / count);
+    }
+
+    DwellMonitor::DwellMonitor() noexcept
+        : DwellMonitor(Settings())
+    {
+    }
+
+    DwellMonitor::DwellMonitor(const Settings& settings) noexcept
+        : m_settings(settings)
+        , m_start(0)
+        , m_firstArrival(0)
+        , m_lastArrival(0)
+        , m_lastTimestamp(0)
+        , m_batchStart(0)
+        , m_batchIntervals(0)
+        , m_batchJitterUs(0)
+        , m_frames(0)
+        , m_fps{}
+        , m_jitter{}
+        , m_started(false)
+        , m_converged(false)
+        , m_convergedAt(0)
+    {
+        m_settings.batchFrames = std::max<uint32_t>(m_settings.batchFrames, 1);
+        m_settings.minBatches = std::max<uint32_t>(m_settings.minBatches, 2);
+    }
+
+    void DwellMonitor::Start(int64_t now) noexcept
+    {
+        m_start = now;
+        m_firstArrival = 0;
+        m_lastArrival = 0;
+        m_lastTimestamp = 0;
+        m_batchStart = 0;
+        m_batchIntervals = 0;
+        m_batchJitterUs = 0;
+        m_frames = 0;
+        m_fps = Samples{};
+        m_jitter = Samples{};
+        m_started = true;
+        m_converged = false;
+        m_convergedAt = 0;
+    }
+
+    bool DwellMonitor::OnFrame(int64_t timestamp, int64_t arrival) noexcept
+    {
+        m_frames += 1;
+
+        if (1 == m_frames)
+        {
+            m_firstArrival = arrival;
+        }
+
+        //
+        // The first sampled interval ends at the first frame after the warm-up
+        //
+        if (m_frames <= std::max<uint64_t>(m_settings.warmupFrames, 1))
+        {
+            m_lastArrival = arrival;
+            m_lastTimestamp = timestamp;
+            m_batchStart = arrival;
+            return m_converged;
+        }
+
+        const int64_t arrivalInterval = arrival - m_lastArrival;
+        const int64_t timestampInterval = (timestamp - m_lastTimestamp) * TimestampUnit;
+
+        m_batchJitterUs += std::abs(static_cast<double>(arrivalInterval - timestampInterval)) / 1000;
+        m_batchIntervals += 1;
+        m_lastArrival = arrival;
+        m_lastTimestamp = timestamp;
+
+        if (m_batchIntervals >= m_settings.batchFrames)
+        {
+            CloseBatch(arrival);
+        }
+
+        return m_converged;
+    }
+
+    DwellMonitor::Report DwellMonitor::GetReport() const noexcept
+    {
+        Report report = {};
+        report.converged = m_converged;
+        report.frames = m_frames;
+        report.batches = m_fps.count;
+        report.firstFrameMs = m_started && m_frames ? (m_firstArrival - m_start) / 1e6 : -1;
+        report.fps = m_fps.mean;
+        report.jitterUs = m_jitter.mean;
+
+        if (m_fps.count >= 2)
+        {
+            report.fpsHalfWidth = m_fps.HalfWidth();
+            report.jitterHalfWidthUs = m_jitter.HalfWidth();
+        }
+
+        const int64_t end = m_converged ? m_convergedAt : m_lastArrival;
+
+        if (m_started && end > m_start)
+        {
+            report.seconds = (end - m_start) / 1e9;
+        }
+
+        return report;
+    }
+
+    void DwellMonitor::CloseBatch(int64_t arrival) noexcept
+    {
+        const int64_t duration = arrival - m_batchStart;
+
+        //
+        // A batch of frames delivered at once has no rate, it is not sampled
+        //
+        if (duration > 0)
+        {
+            m_fps.Add(m_batchIntervals * 1e9 / duration);
+            m_jitter.Add(m_batchJitterUs / m_batchIntervals);
+        }
+
+        m_batchStart = arrival;
+        m_batchIntervals = 0;
+        m_batchJitterUs = 0;
+
+        if (m_converged || m_fps.count < m_settings.minBatches)
+        {
+            return;
+        }
+
+        const bool fpsConverged = m_fps.HalfWidth() <= m_settings.fpsTolerance * m_fps.mean;
+        const bool jitterConverged = m_jitter.HalfWidth()
+            <= std::max(m_settings.jitterTolerance * m_jitter.mean, m_settings.jitterFloorUs);
+
+        if (fpsConverged && jitterConverged)
+        {
+            m_converged = true;
+            m_convergedAt = arrival;
+        }
+    }
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cstdint>
+
+namespace video
+{
+    //
+    // Decides when a stream has run long enough to be measured: frames are
+    // grouped in batches, the fps and the mean jitter of each batch are the
+    // samples, the stream converged when their 95% confidence intervals
+    // are within the tolerances. Means of batches are nearly independent
+    // where consecutive frame intervals are not.
+    // OnFrame never allocates
+    //
+    class DwellMonitor
+    {
+    public:
+        struct Settings
+        {
+            double fpsTolerance = 0.01;     // half-width of the fps interval relative to the fps
+            double jitterTolerance = 0.1;   // relative to the mean jitter
+            double jitterFloorUs = 100;     // a jitter half-width accepted whatever the mean
+            uint32_t warmupFrames = 5;      // not sampled while the stream settles
+            uint32_t batchFrames = 10;
+            uint32_t minBatches = 5;
+        };
+
+        struct Report
+        {
+            bool converged;
+            uint64_t frames;
+            uint32_t batches;
+            double seconds;             // from Start to the convergence, or to the last frame
+            double firstFrameMs;        // from Start to the first frame, negative without one
+            double fps;                 // the mean of the batches
+            double fpsHalfWidth;
+            double jitterUs;            // mean of |arrival interval - timestamp interval|
+            double jitterHalfWidthUs;
+        };
+
+        DwellMonitor() noexcept;
+        explicit DwellMonitor(const Settings& settings) noexcept;
+
+        //
+        // now is the host steady clock in nanoseconds when the stream is started
+        //
+        void Start(int64_t now) noexcept;
+
+        //
+        // timestamp is the sample time in 100 ns units,
+        // arrival is the host steady clock in nanoseconds.
+        // True once the stream converged
+        //
+        bool OnFrame(int64_t timestamp, int64_t arrival) noexcept;
+
+        bool IsConverged() const noexcept { return m_converged; }
+        Report GetReport() const noexcept;
+
+    private:
+        //
+        // Running mean and variance of the batch samples
+        //
+        struct Samples
+        {
+            uint32_t count;
+            double mean;
+            double m2;
+
+            void Add(double value) noexcept;
+            double HalfWidth() const noexcept;
+        };
+
+        void CloseBatch(int64_t arrival) noexcept;
+
+    private:
+        Settings m_settings;
+        int64_t m_start;
+        int64_t m_firstArrival;
+        int64_t m_lastArrival;
+        int64_t m_lastTimestamp;
+        int64_t m_batchStart;
+        uint32_t m_batchIntervals;
+        double m_batchJitterUs;
+        uint64_t m_frames;
+        Samples m_fps;
+        Samples m_jitter;
+        bool m_started;
+        bool m_converged;
+        int64_t m_convergedAt;
+    };
+}
@@ -0,0 +1,506 @@
+#include "FakeBackend.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include "SyntheticSource.h"
+#include "StreamDispatcher.h"
+
+namespace
+{
+    using namespace capture;
+
+    class FakeFrameSource : public FrameSource
+    {
+    public:
+        FakeFrameSource(const MediaTypeInfo& mediaType, bool realtime, uint64_t frameLimit, video::TestPattern pattern)
+            : m_mediaType(mediaType)
+            , m_realtime(realtime)
+            , m_frameLimit(frameLimit)
+            , m_pattern(pattern)
+            , m_stopping(false)
+            , m_startTime(0)
+            , m_done(false)
+        {
+        }
+
+        ~FakeFrameSource()
+        {
+            Stop();
+        }
+
+        const MediaTypeInfo& GetMediaType() const noexcept override
+        {
+            return m_mediaType;
+        }
+
+        HRESULT Start(video::FrameSink& sink, uint32_t readDepth) override
+        {
+            if (0 == readDepth)
+            {
+                return E_INVALIDARG;
+            }
+
+            if (m_thread.joinable())
+            {
+                return E_UNEXPECTED;
+            }
+
+            m_stopping = false;
+            m_done = false;
+            m_thread = std::thread(&FakeFrameSource::Run, this, std::ref(sink));
+            return S_OK;
+        }
+
+        HRESULT Wait(uint32_t timeoutMs) override
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+
+            if (WaitInfinite == timeoutMs)
+            {
+                m_doneEvent.wait(lock, [this] { return m_done; });
+                return S_OK;
+            }
+
+            const bool done = m_doneEvent.wait_for(lock, std::chrono::milliseconds(timeoutMs), [this] { return m_done; });
+            return done ? S_OK : S_FALSE;
+        }
+
+        HRESULT Stop() override
+        {
+            m_stopping = true;
+
+            if (m_thread.joinable())
+            {
+                m_thread.join();
+            }
+
+            return S_OK;
+        }
+
+        int64_t TimestampToHost(int64_t timestamp) const noexcept override
+        {
+            //
+            // Realtime frames are due at the start time plus the timestamp
+            //
+            const int64_t start = m_startTime.load(std::memory_order_acquire);
+            return m_realtime && start ? start + timestamp * 100 : 0;
+        }
+
+    private:
+        void Run(video::FrameSink& sink)
+        {
+            video::SyntheticSource source(
+                m_mediaType.format,
+                m_mediaType.width,
+                m_mediaType.height,
+                m_mediaType.fpsNumerator,
+                m_mediaType.fpsDenominator,
+                m_pattern,
+                m_mediaType.colorSpace);
+
+            const auto start = std::chrono::steady_clock::now();
+            m_startTime.store(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                start.time_since_epoch()).count(), std::memory_order_release);
+
+            while (source.IsValid() && !m_stopping)
+            {
+                if (m_frameLimit && source.GetFrameIndex() >= m_frameLimit)
+                {
+                    break;
+                }
+
+                int64_t timestamp = 0;
+                const video::FrameView frame = source.Next(timestamp);
+
+                if (m_realtime)
+                {
+                    //
+                    // Timestamps are 100 ns units
+                    //
+                    std::this_thread::sleep_until(start + std::chrono::nanoseconds(timestamp * 100));
+                }
+
+                sink.OnFrame(frame, timestamp);
+            }
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_done = true;
+            m_doneEvent.notify_all();
+        }
+
+    private:
+        const MediaTypeInfo m_mediaType;
+        const bool m_realtime;
+        const uint64_t m_frameLimit;
+        const video::TestPattern m_pattern;
+        std::atomic<bool> m_stopping;
+        std::atomic<int64_t> m_startTime;
+        std::thread m_thread;
+        std::mutex m_mutex;
+        std::condition_variable m_doneEvent;
+        bool m_done;
+    };
+
+    //
+    // Interleaves the streams on one thread in timestamp order,
+    // as one source reader delivers the streams it has selected
+    //
+    class FakeMultiStreamSource : public MultiStreamSource
+    {
+    public:
+        FakeMultiStreamSource(
+            std::vector<uint32_t> streamIndexes,
+            std::vector<MediaTypeInfo> mediaTypes,
+            bool realtime,
+            uint64_t frameLimit,
+            video::TestPattern pattern)
+            : m_streamIndexes(std::move(streamIndexes))
+            , m_mediaTypes(std::move(mediaTypes))
+            , m_realtime(realtime)
+            , m_frameLimit(frameLimit)
+            , m_pattern(pattern)
+            , m_stopping(false)
+            , m_done(false)
+        {
+        }
+
+        ~FakeMultiStreamSource()
+        {
+            Stop();
+        }
+
+        size_t GetStreamCount() const noexcept override
+        {
+            return m_mediaTypes.size();
+        }
+
+        uint32_t GetStreamIndex(size_t stream) const noexcept override
+        {
+            return m_streamIndexes[stream];
+        }
+
+        const MediaTypeInfo& GetMediaType(size_t stream) const noexcept override
+        {
+            return m_mediaTypes[stream];
+        }
+
+        HRESULT Start(StreamDispatcher& dispatcher, uint32_t readDepth) override
+        {
+            if (0 == readDepth)
+            {
+                return E_INVALIDARG;
+            }
+
+            if (m_thread.joinable())
+            {
+                return E_UNEXPECTED;
+            }
+
+            m_stopping = false;
+            m_done = false;
+            m_thread = std::thread(&FakeMultiStreamSource::Run, this, std::ref(dispatcher));
+            return S_OK;
+        }
+
+        HRESULT Wait(uint32_t timeoutMs) override
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+
+            if (WaitInfinite == timeoutMs)
+            {
+                m_doneEvent.wait(lock, [this] { return m_done; });
+                return S_OK;
+            }
+
+            const bool done = m_doneEvent.wait_for(lock, std::chrono::milliseconds(timeoutMs), [this] { return m_done; });
+            return done ? S_OK : S_FALSE;
+        }
+
+        HRESULT Stop() override
+        {
+            m_stopping = true;
+
+            if (m_thread.joinable())
+            {
+                m_thread.join();
+            }
+
+            return S_OK;
+        }
+
+    private:
+        void Run(StreamDispatcher& dispatcher)
+        {
+            std::vector<std::unique_ptr<video::SyntheticSource>> sources;
+
+            for (const auto& mediaType : m_mediaTypes)
+            {
+                sources.emplace_back(new video::SyntheticSource(
+                    mediaType.format,
+                    mediaType.width,
+                    mediaType.height,
+                    mediaType.fpsNumerator,
+                    mediaType.fpsDenominator,
+                    m_pattern,
+                    mediaType.colorSpace));
+            }
+
+            const auto start = std::chrono::steady_clock::now();
+
+            while (!m_stopping)
+            {
+                //
+                // The stream whose next frame is due first
+                //
+                size_t next = sources.size();
+                int64_t nextTimestamp = 0;
+
+                for (size_t i = 0; i < sources.size(); ++i)
+                {
+                    const auto& source = *sources[i];
+
+                    if (!source.IsValid() || (m_frameLimit && source.GetFrameIndex() >= m_frameLimit))
+                    {
+                        continue;
+                    }
+
+                    const int64_t timestamp = static_cast<int64_t>(source.GetFrameIndex()) * source.GetFrameDuration();
+
+                    if (next == sources.size() || timestamp < nextTimestamp)
+                    {
+                        next = i;
+                        nextTimestamp = timestamp;
+                    }
+                }
+
+                if (next == sources.size())
+                {
+                    break;
+                }
+
+                int64_t timestamp = 0;
+                const video::FrameView frame = sources[next]->Next(timestamp);
+
+                if (m_realtime)
+                {
+                    std::this_thread::sleep_until(start + std::chrono::nanoseconds(timestamp * 100));
+                }
+
+                dispatcher.OnFrame(m_streamIndexes[next], frame, timestamp);
+            }
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_done = true;
+            m_doneEvent.notify_all();
+        }
+
+    private:
+        const std::vector<uint32_t> m_streamIndexes;
+        const std::vector<MediaTypeInfo> m_mediaTypes;
+        const bool m_realtime;
+        const uint64_t m_frameLimit;
+        const video::TestPattern m_pattern;
+        std::atomic<bool> m_stopping;
+        std::thread m_thread;
+        std::mutex m_mutex;
+        std::condition_variable m_doneEvent;
+        bool m_done;
+    };
+
+    class FakeDevice : public Device
+    {
+    public:
+        FakeDevice(const FakeBackend::DeviceConfig& config, bool realtime, uint64_t frameLimit, video::TestPattern pattern)
+            : m_config(config)
+            , m_realtime(realtime)
+            , m_frameLimit(frameLimit)
+            , m_pattern(pattern)
+        {
+        }
+
+        std::wstring GetFriendlyName() const override
+        {
+            return m_config.friendlyName;
+        }
+
+        std::wstring GetSymbolicLink() const override
+        {
+            return m_config.symbolicLink;
+        }
+
+        uint64_t GetFingerprint() const override
+        {
+            return m_config.fingerprint;
+        }
+
+        HRESULT GetStreams(std::vector<StreamInfo>& streams) override
+        {
+            streams = m_config.streams;
+            return S_OK;
+        }
+
+        HRESULT OpenFrameSource(
+            uint32_t streamIndex,
+            uint32_t mediaTypeIndex,
+            std::unique_ptr<FrameSource>& source) override
+        {
+            if (streamIndex >= m_config.streams.size())
+            {
+                return E_INVALIDARG;
+            }
+
+            const auto& mediaTypes = m_config.streams[streamIndex].mediaTypes;
+
+            if (mediaTypeIndex >= mediaTypes.size())
+            {
+                return E_INVALIDARG;
+            }
+
+            source.reset(new FakeFrameSource(mediaTypes[mediaTypeIndex], m_realtime, m_frameLimit, m_pattern));
+            return S_OK;
+        }
+
+        HRESULT OpenMultiStreamSource(
+            const std::vector<StreamSelection>& selections,
+            std::unique_ptr<MultiStreamSource>& source) override
+        {
+            HRCHK(CheckStreamSelections(selections));
+
+            std::vector<uint32_t> streamIndexes;
+            std::vector<MediaTypeInfo> mediaTypes;
+
+            for (const auto& selection : selections)
+            {
+                if (selection.streamIndex >= m_config.streams.size())
+                {
+                    return E_INVALIDARG;
+                }
+
+                const auto& streamTypes = m_config.streams[selection.streamIndex].mediaTypes;
+
+                if (selection.mediaTypeIndex >= streamTypes.size())
+                {
+                    return E_INVALIDARG;
+                }
+
+                streamIndexes.push_back(selection.streamIndex);
+                mediaTypes.push_back(streamTypes[selection.mediaTypeIndex]);
+            }
+
+            source.reset(new FakeMultiStreamSource(std::move(streamIndexes), std::move(mediaTypes), m_realtime, m_frameLimit, m_pattern));
+            return S_OK;
+        }
+
+    private:
+        const FakeBackend::DeviceConfig m_config;
+        const bool m_realtime;
+        const uint64_t m_frameLimit;
+        const video::TestPattern m_pattern;
+    };
+}
+
+namespace capture
+{
+    FakeBackend::FakeBackend()
+        : FakeBackend(DefaultDevices())
+    {
+    }
+
+    FakeBackend::FakeBackend(std::vector<DeviceConfig> devices)
+        : m_devices(std::move(devices))
+        , m_realtime(true)
+        , m_frameLimit(0)
+        , m_pattern(video::TestPattern::Gradient)
+    {
+    }
+
+    void FakeBackend::SetRealtime(bool realtime) noexcept
+    {
+        m_realtime = realtime;
+    }
+
+    void FakeBackend::SetFrameLimit(uint64_t frameLimit) noexcept
+    {
+        m_frameLimit = frameLimit;
+    }
+
+    void FakeBackend::SetPattern(video::TestPattern pattern) noexcept
+    {
+        m_pattern = pattern;
+    }
+
+    const wchar_t* FakeBackend::GetName() const noexcept
+    {
+        return L"fake";
+    }
+
+    HRESULT FakeBackend::EnumDevices(DeviceList& devices)
+    {
+        devices.clear();
+
+        for (const auto& config : m_devices)
+        {
+            devices.push_back(std::make_shared<FakeDevice>(config, m_realtime, m_frameLimit, m_pattern));
+        }
+
+        return S_OK;
+    }
+
+    std::vector<FakeBackend::DeviceConfig> FakeBackend::DefaultDevices()
+    {
+        using video::PixelFormat;
+
+        DeviceConfig webcam;
+        webcam.friendlyName = L"Fake Camera";
+        webcam.symbolicLink = L"fake#camera#0";
+        webcam.streams.resize(1);
+        webcam.streams[0].index = 0;
+        webcam.streams[0].mediaTypes = {
+            MakeMediaType(0, PixelFormat::YUY2, 640, 480, 30),
+            MakeMediaType(1, PixelFormat::NV12, 1280, 720, 30),
+            MakeMediaType(2, PixelFormat::NV12, 1920, 1080, 30),
+            MakeMediaType(3, PixelFormat::RGB24, 640, 480, 15),
+            MakeMediaType(4, PixelFormat::YUY2, 1280, 720, 30000, 1001),
+        };
+
+        DeviceConfig highSpeed;
+        highSpeed.friendlyName = L"Fake High Speed Camera";
+        highSpeed.symbolicLink = L"fake#camera#1";
+        highSpeed.streams.resize(2);
+        highSpeed.streams[0].index = 0;
+        highSpeed.streams[0].mediaTypes = {
+            MakeMediaType(0, PixelFormat::NV12, 1280, 720, 240),
+            MakeMediaType(1, PixelFormat::I420, 1920, 1080, 120),
+            MakeMediaType(2, PixelFormat::UYVY, 3840, 2160, 60),
+        };
+        highSpeed.streams[1].index = 1;
+        highSpeed.streams[1].mediaTypes = {
+            MakeMediaType(0, PixelFormat::YV12, 640, 480, 60),
+            MakeMediaType(1, PixelFormat::RGB32, 320, 240, 30),
+        };
+
+        return { webcam, highSpeed };
+    }
+
+    MediaTypeInfo FakeBackend::MakeMediaType(
+        uint32_t index,
+        video::PixelFormat format,
+        uint32_t width,
+        uint32_t height,
+        uint32_t fpsNumerator,
+        uint32_t fpsDenominator)
+    {
+        MediaTypeInfo mediaType;
+        mediaType.index = index;
+        mediaType.subtype = video::PixelFormatName(format);
+        mediaType.format = format;
+        mediaType.width = width;
+        mediaType.height = height;
+        mediaType.fpsNumerator = fpsNumerator;
+        mediaType.fpsDenominator = fpsDenominator;
+        return mediaType;
+    }
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include "CaptureBackend.h"
+#include "TestPattern.h"
+
+namespace capture
+{
+    //
+    // In-process backend generating synthetic frames, the capture pipeline
+    // runs on it without a device or Media Foundation
+    //
+    class FakeBackend : public Backend
+    {
+    public:
+        struct DeviceConfig
+        {
+            std::wstring friendlyName;
+            std::wstring symbolicLink;
+            uint64_t fingerprint = 1;   // stands for the driver version
+            std::vector<StreamInfo> streams;
+        };
+
+        //
+        // Default set of devices covering every pixel format
+        //
+        FakeBackend();
+        explicit FakeBackend(std::vector<DeviceConfig> devices);
+
+        //
+        // Realtime sources pace frames at the nominal frame rate,
+        // otherwise frames are generated as fast as possible
+        //
+        void SetRealtime(bool realtime) noexcept;
+
+        //
+        // Sources report the end of the stream after frameLimit frames, 0 means unlimited
+        //
+        void SetFrameLimit(uint64_t frameLimit) noexcept;
+
+        //
+        // Content of the frames, the moving gradient by default
+        //
+        void SetPattern(video::TestPattern pattern) noexcept;
+
+        const wchar_t* GetName() const noexcept override;
+        HRESULT EnumDevices(DeviceList& devices) override;
+
+        static std::vector<DeviceConfig> DefaultDevices();
+        static MediaTypeInfo MakeMediaType(
+            uint32_t index,
+            video::PixelFormat format,
+            uint32_t width,
+            uint32_t height,
+            uint32_t fpsNumerator,
+            uint32_t fpsDenominator = 1);
+
+    private:
+        std::vector<DeviceConfig> m_devices;
+        bool m_realtime;
+        uint64_t m_frameLimit;
+        video::TestPattern m_pattern;
+    };
+}
@@ -0,0 +1,254 @@
+#include "FrameDiff.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#define FRAME_DIFF_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace
+{
+    using namespace video;
+
+    constexpr size_t TileRowBytes = FrameDiffDetector::TileBytes;
+
+    //
+    // SAD of one tile row against the history, the history takes the new bytes.
+    // The scalar kernel is the reference for the SIMD one
+    //
+    uint32_t DiffRowScalar(const uint8_t* src, uint8_t* history) noexcept
+    {
+        uint32_t sad = 0;
+
+        for (size_t i = 0; i < TileRowBytes; ++i)
+        {
+            sad += static_cast<uint32_t>(std::abs(src[i] - history[i]));
+        }
+
+        memcpy(history, src, TileRowBytes);
+        return sad;
+    }
+
+#ifdef FRAME_DIFF_SSE2
+    uint32_t DiffRowSse2(const uint8_t* src, uint8_t* history) noexcept
+    {
+        __m128i sum = _mm_setzero_si128();
+
+        for (size_t i = 0; i < TileRowBytes; i += 16)
+        {
+            const __m128i value = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+            const __m128i previous = _mm_loadu_si128(reinterpret_cast<const __m128i*>(history + i));
+            sum = _mm_add_epi64(sum, _mm_sad_epu8(value, previous));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(history + i), value);
+        }
+
+        //
+        // Two 16-bit sums in the low words of the 64-bit lanes
+        //
+        return static_cast<uint32_t>(_mm_cvtsi128_si32(sum) + _mm_cvtsi128_si32(_mm_srli_si128(sum, 8)));
+    }
+#endif
+}
+
+namespace video
+{
+    FrameDiffDetector::FrameDiffDetector(ConvertKernel kernel) noexcept
+        : m_kernel(ConvertKernel::Scalar)
+        , m_history{}
+        , m_tileSad{}
+        , m_format(PixelFormat::Unknown)
+        , m_width(0)
+        , m_height(0)
+        , m_staleRows(AllRows)
+        , m_lastSad(0)
+        , m_report{}
+    {
+#ifdef FRAME_DIFF_SSE2
+        if (kernel != ConvertKernel::Scalar)
+        {
+            m_kernel = ConvertKernel::Sse2;
+        }
+#else
+        (void)kernel;
+#endif
+    }
+
+    FrameDiffDetector::Result FrameDiffDetector::OnFrame(const FrameView& frame) noexcept
+    {
+        m_report.frames += 1;
+
+        const size_t rowBytes = frame.IsValid() ? frame.RowBytes(0) : 0;
+
+        if (rowBytes < TileBytes || frame.height < TileRows)
+        {
+            //
+            // Too small to sample, counted as new content
+            //
+            m_format = PixelFormat::Unknown;
+            m_staleRows = AllRows;
+            m_report.unique += 1;
+            m_report.currentRun = 0;
+            return Result::First;
+        }
+
+        const bool comparable = m_format == frame.format && m_width == frame.width && m_height == frame.height;
+
+        m_format = frame.format;
+        m_width = frame.width;
+        m_height = frame.height;
+
+        //
+        // Tiles are spread evenly, the outer ones touch the frame edges
+        //
+        uint8_t* history = m_history.data();
+        uint64_t total = 0;
+
+        for (uint32_t row = 0; row < GridRows; ++row)
+        {
+            const size_t y = (frame.height - TileRows) * row / (GridRows - 1);
+            const uint8_t* line = frame.planes[0].data + frame.planes[0].stride * static_cast<ptrdiff_t>(y);
+
+            for (uint32_t column = 0; column < GridColumns; ++column)
+            {
+                const size_t x = (rowBytes - TileBytes) * column / (GridColumns - 1);
+                const uint8_t* src = line + x;
+                uint32_t sad = 0;
+
+                for (uint32_t i = 0; i < TileRows; ++i)
+                {
+#ifdef FRAME_DIFF_SSE2
+                    sad += m_kernel == ConvertKernel::Sse2
+                        ? DiffRowSse2(src, history)
+                        : DiffRowScalar(src, history);
+#else
+                    sad += DiffRowScalar(src, history);
+#endif
+                    src += frame.planes[0].stride;
+                    history += TileBytes;
+                }
+
+                m_tileSad[row][column] = sad;
+                total += sad;
+            }
+        }
+
+        if (!comparable)
+        {
+            //
+            // Nothing is known to have changed yet
+            //
+            m_staleRows = AllRows;
+            m_report.unique += 1;
+            m_report.currentRun = 0;
+            return Result::First;
+        }
+
+        m_lastSad = total;
+
+        uint32_t staleRows = 0;
+        const Result result = Classify(staleRows);
+        m_staleRows = staleRows;
+
+        if (result == Result::Frozen)
+        {
+            m_report.frozen += 1;
+
+            if (0 == m_report.currentRun)
+            {
+                m_report.frozenRuns += 1;
+            }
+
+            m_report.currentRun += 1;
+            m_report.longestRun = std::max(m_report.longestRun, m_report.currentRun);
+            return result;
+        }
+
+        if (result == Result::Partial)
+        {
+            m_report.partial += 1;
+        }
+
+        //
+        // A partial update still brings new content
+        //
+        m_report.unique += 1;
+        m_report.currentRun = 0;
+        return result;
+    }
+
+    void FrameDiffDetector::Reset() noexcept
+    {
+        m_format = PixelFormat::Unknown;
+        m_width = 0;
+        m_height = 0;
+        m_staleRows = AllRows;
+        m_lastSad = 0;
+        m_report = Report{};
+    }
+
+    const char* FrameDiffDetector::ResultName(Result result) noexcept
+    {
+        switch (result)
+        {
+        case Result::First: return "first";
+        case Result::Unique: return "unique";
+        case Result::Frozen: return "frozen";
+        case Result::Partial: return "partial";
+        default: return "unknown";
+        }
+    }
+
+    FrameDiffDetector::Result FrameDiffDetector::Classify(uint32_t& staleRows) const noexcept
+    {
+        //
+        // A tile row is stale when all its tiles are unchanged, fresh when none is.
+        // A frame mixing both is partial only when its stale rows form one band
+        // and some of them were fresh in the previous frame. Rows that stay
+        // stale are a static part of the scene, e.g. a banner or padding rows
+        //
+        uint32_t bands = 0;
+        bool previousStale = false;
+        bool mixed = false;
+
+        staleRows = 0;
+
+        for (uint32_t row = 0; row < GridRows; ++row)
+        {
+            uint32_t unchanged = 0;
+
+            for (uint32_t column = 0; column < GridColumns; ++column)
+            {
+                unchanged += 0 == m_tileSad[row][column] ? 1 : 0;
+            }
+
+            if (unchanged == GridColumns)
+            {
+                staleRows |= 1u << row;
+                bands += previousStale ? 0 : 1;
+                previousStale = true;
+                continue;
+            }
+
+            //
+            // Static parts of the scene, e.g. a letterbox, not a torn frame
+            //
+            mixed = mixed || unchanged != 0;
+            previousStale = false;
+        }
+
+        if (staleRows == AllRows)
+        {
+            return Result::Frozen;
+        }
+
+        if (mixed || 0 == staleRows || 1 != bands)
+        {
+            return Result::Unique;
+        }
+
+        return 0 != (staleRows & ~m_staleRows) ? Result::Partial : Result::Unique;
+    }
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <array>
+#include "FrameView.h"
+#include "PixelConvert.h"
+
+namespace video
+{
+    //
+    // Tells new frames from stale ones by the sum of absolute differences
+    // of sampled tiles of plane 0 against the previous frame. A live sensor
+    // never repeats a tile exactly, a re-delivered buffer repeats all of them,
+    // a partially written one repeats whole bands of tile rows.
+    // OnFrame reads 48 KB of the frame and keeps a copy of them in the object
+    //
+    class FrameDiffDetector
+    {
+    public:
+        enum class Result : uint32_t
+        {
+            First = 0,  // nothing to compare with: the first frame or a new format
+            Unique,
+            Frozen,     // every tile equals the previous frame
+            Partial,    // a band of tile rows newly equals the previous frame, the rest changed
+        };
+
+        struct Report
+        {
+            uint64_t frames;
+            uint64_t unique;        // frames with new content, the first one included
+            uint64_t frozen;
+            uint64_t partial;
+            uint64_t frozenRuns;    // runs of consecutive frozen frames
+            uint64_t longestRun;
+            uint64_t currentRun;
+        };
+
+        static constexpr uint32_t GridColumns = 16;
+        static constexpr uint32_t GridRows = 12;
+        static constexpr uint32_t TileBytes = 64;
+        static constexpr uint32_t TileRows = 4;
+
+        explicit FrameDiffDetector(ConvertKernel kernel = ConvertKernel::Auto) noexcept;
+
+        FrameDiffDetector(const FrameDiffDetector&) = delete;
+        FrameDiffDetector& operator=(const FrameDiffDetector&) = delete;
+
+        Result OnFrame(const FrameView& frame) noexcept;
+
+        //
+        // The next frame starts over as the first one
+        //
+        void Reset() noexcept;
+
+        Report GetReport() const noexcept { return m_report; }
+        ConvertKernel GetKernel() const noexcept { return m_kernel; }
+
+        //
+        // Sum of the tile differences of the last compared frame
+        //
+        uint64_t GetLastSad() const noexcept { return m_lastSad; }
+
+        static const char* ResultName(Result result) noexcept;
+
+    private:
+        static constexpr uint32_t AllRows = (1u << GridRows) - 1;
+
+        Result Classify(uint32_t& staleRows) const noexcept;
+
+    private:
+        ConvertKernel m_kernel;
+        std::array<uint8_t, GridRows * GridColumns * TileRows * TileBytes> m_history;  // the sampled tiles of the previous frame
+        uint32_t m_tileSad[GridRows][GridColumns];
+        PixelFormat m_format;
+        uint32_t m_width;
+        uint32_t m_height;
+        uint32_t m_staleRows;   // a bit per tile row unchanged in the last compared frame
+        uint64_t m_lastSad;
+        Report m_report;
+    };
+}
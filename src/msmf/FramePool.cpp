@@ -0,0 +1,306 @@
+#include "FramePool.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <new>
+
+namespace
+{
+    size_t AlignUp(size_t value, size_t alignment) noexcept
+    {
+        return (value + alignment - 1) & ~(alignment - 1);
+    }
+}
+
+namespace video
+{
+    size_t FrameFormat::BufferSize() const noexcept
+    {
+        const size_t luma = static_cast<size_t>(stride) * height;
+        const size_t chromaRows = (height + 1) / 2;
+
+        switch (format)
+        {
+        case PixelFormat::NV12:
+            return AlignUp(luma + static_cast<size_t>(stride) * chromaRows, FrameAlignment);
+        case PixelFormat::I420:
+        case PixelFormat::YV12:
+            return AlignUp(luma + static_cast<size_t>(stride / 2) * chromaRows * 2, FrameAlignment);
+        default:
+            return AlignUp(luma, FrameAlignment);
+        }
+    }
+
+    //
+    // FrameBuffer
+    //
+
+    FrameBuffer::FrameBuffer(FramePool* pool, const FrameFormat& format, uint8_t* data, size_t size) noexcept
+        : m_pool(pool)
+        , m_format(format)
+        , m_data(data)
+        , m_size(size)
+        , m_refs(0)
+        , m_next(nullptr)
+    {
+    }
+
+    FrameView FrameBuffer::View() const noexcept
+    {
+        return MakeFrameView(m_format.format, m_format.width, m_format.height, m_data, m_format.stride);
+    }
+
+    //
+    // FrameRef
+    //
+
+    FrameRef::FrameRef() noexcept
+        : m_buffer(nullptr)
+    {
+    }
+
+    FrameRef::FrameRef(FrameBuffer* buffer) noexcept
+        : m_buffer(buffer)
+    {
+        if (m_buffer)
+        {
+            m_buffer->m_refs.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    FrameRef::FrameRef(const FrameRef& other) noexcept
+        : FrameRef(other.m_buffer)
+    {
+    }
+
+    FrameRef::FrameRef(FrameRef&& other) noexcept
+        : m_buffer(other.m_buffer)
+    {
+        other.m_buffer = nullptr;
+    }
+
+    FrameRef::~FrameRef()
+    {
+        Reset();
+    }
+
+    FrameRef& FrameRef::operator=(const FrameRef& other) noexcept
+    {
+        if (this != &other)
+        {
+            FrameRef copy(other);
+            std::swap(m_buffer, copy.m_buffer);
+        }
+
+        return *this;
+    }
+
+    FrameRef& FrameRef::operator=(FrameRef&& other) noexcept
+    {
+        if (this != &other)
+        {
+            Reset();
+            std::swap(m_buffer, other.m_buffer);
+        }
+
+        return *this;
+    }
+
+    void FrameRef::Reset() noexcept
+    {
+        FrameBuffer* buffer = m_buffer;
+        m_buffer = nullptr;
+
+        if (buffer && 1 == buffer->m_refs.fetch_sub(1, std::memory_order_acq_rel))
+        {
+            buffer->m_pool->Recycle(buffer);
+        }
+    }
+
+    //
+    // FramePool
+    //
+
+    FramePool::FramePool(size_t memoryLimit) noexcept
+        : m_memoryLimit(memoryLimit)
+        , m_free(nullptr)
+        , m_stat()
+    {
+    }
+
+    FramePool::~FramePool()
+    {
+        Trim();
+        assert(0 == m_stat.outstanding && "frames outlive their pool");
+    }
+
+    FrameRef FramePool::Acquire(const FrameFormat& format) noexcept
+    {
+        const size_t size = format.BufferSize();
+
+        if (0 == size)
+        {
+            return FrameRef();
+        }
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+
+        //
+        // Steady state: a free buffer of the same format
+        //
+        for (FrameBuffer** link = &m_free; *link; link = &(*link)->m_next)
+        {
+            FrameBuffer* buffer = *link;
+
+            if (buffer->m_format == format)
+            {
+                *link = buffer->m_next;
+                buffer->m_next = nullptr;
+                buffer->timestamp = 0;
+                buffer->flags = 0;
+                buffer->streamIndex = 0;
+                buffer->arrival = 0;
+                buffer->deviceTime = 0;
+
+                m_stat.hits += 1;
+                m_stat.outstanding += 1;
+                return FrameRef(buffer);
+            }
+        }
+
+        //
+        // The format changed: free buffers of other formats are released to fit the limit
+        //
+        while (m_stat.bytes + size > m_memoryLimit && m_free)
+        {
+            FrameBuffer* buffer = m_free;
+            m_free = buffer->m_next;
+            Free(buffer);
+            m_stat.evicted += 1;
+        }
+
+        if (m_stat.bytes + size > m_memoryLimit)
+        {
+            m_stat.rejected += 1;
+            return FrameRef();
+        }
+
+        m_stat.misses += 1;
+        m_stat.buffers += 1;
+        m_stat.outstanding += 1;
+        m_stat.bytes += size;
+        m_stat.highWaterBuffers = std::max(m_stat.highWaterBuffers, m_stat.buffers);
+        m_stat.highWaterBytes = std::max(m_stat.highWaterBytes, m_stat.bytes);
+        lock.unlock();
+
+        auto data = static_cast<uint8_t*>(::operator new(size, std::align_val_t(FrameAlignment), std::nothrow));
+        FrameBuffer* buffer = data ? new (std::nothrow) FrameBuffer(this, format, data, size) : nullptr;
+
+        if (!buffer)
+        {
+            if (data)
+            {
+                ::operator delete(data, std::align_val_t(FrameAlignment));
+            }
+
+            lock.lock();
+            m_stat.buffers -= 1;
+            m_stat.outstanding -= 1;
+            m_stat.bytes -= size;
+            m_stat.rejected += 1;
+            return FrameRef();
+        }
+
+        return FrameRef(buffer);
+    }
+
+    FrameRef FramePool::Copy(const FrameView& frame) noexcept
+    {
+        if (!frame.IsValid())
+        {
+            return FrameRef();
+        }
+
+        FrameRef ref = Acquire(AlignedFormat(frame.format, frame.width, frame.height));
+
+        if (!ref)
+        {
+            return ref;
+        }
+
+        const FrameView dst = ref->View();
+
+        for (size_t plane = 0; plane < frame.planeCount; ++plane)
+        {
+            const size_t rowBytes = frame.RowBytes(plane);
+            const size_t rows = frame.Rows(plane);
+
+            const uint8_t* src = frame.planes[plane].data;
+            auto out = const_cast<uint8_t*>(dst.planes[plane].data);
+
+            for (size_t row = 0; row < rows; ++row)
+            {
+                memcpy(out, src, rowBytes);
+                src += frame.planes[plane].stride;
+                out += dst.planes[plane].stride;
+            }
+        }
+
+        return ref;
+    }
+
+    void FramePool::Trim() noexcept
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        while (m_free)
+        {
+            FrameBuffer* buffer = m_free;
+            m_free = buffer->m_next;
+            Free(buffer);
+        }
+    }
+
+    FramePool::Statistics FramePool::GetStatistics() const noexcept
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_stat;
+    }
+
+    size_t FramePool::GetMemoryLimit() const noexcept
+    {
+        return m_memoryLimit;
+    }
+
+    FrameFormat FramePool::AlignedFormat(PixelFormat format, uint32_t width, uint32_t height) noexcept
+    {
+        FrameFormat result;
+        result.format = format;
+        result.width = width;
+        result.height = height;
+        result.stride = static_cast<uint32_t>(AlignUp(width * BytesPerPixel(format), FrameAlignment));
+        return result;
+    }
+
+    void FramePool::Recycle(FrameBuffer* buffer) noexcept
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        buffer->m_next = m_free;
+        m_free = buffer;
+        m_stat.outstanding -= 1;
+    }
+
+    void FramePool::Free(FrameBuffer* buffer) noexcept
+    {
+        //
+        // Called under the lock
+        //
+        m_stat.buffers -= 1;
+        m_stat.bytes -= buffer->m_size;
+
+        ::operator delete(buffer->m_data, std::align_val_t(FrameAlignment));
+        delete buffer;
+    }
+}
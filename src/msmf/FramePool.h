@@ -0,0 +1,169 @@
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include "FrameView.h"
+
+namespace video
+{
+    constexpr size_t FrameAlignment = 64;
+
+    struct FrameFormat
+    {
+        PixelFormat format = PixelFormat::Unknown;
+        uint32_t width = 0;
+        uint32_t height = 0;
+        uint32_t stride = 0;
+
+        //
+        // Bytes of all the planes laid out as MakeFrameView expects
+        //
+        size_t BufferSize() const noexcept;
+
+        bool operator==(const FrameFormat& other) const noexcept
+        {
+            return format == other.format
+                && width == other.width
+                && height == other.height
+                && stride == other.stride;
+        }
+
+        bool operator!=(const FrameFormat& other) const noexcept
+        {
+            return !(*this == other);
+        }
+    };
+
+    class FramePool;
+
+    //
+    // 64-byte aligned frame memory owned by a FramePool,
+    // returned to the pool when the last FrameRef is released
+    //
+    class FrameBuffer
+    {
+    public:
+        FrameBuffer(const FrameBuffer&) = delete;
+        FrameBuffer& operator=(const FrameBuffer&) = delete;
+
+        const FrameFormat& Format() const noexcept { return m_format; }
+        uint8_t* Data() noexcept { return m_data; }
+        const uint8_t* Data() const noexcept { return m_data; }
+        size_t Size() const noexcept { return m_size; }
+
+        FrameView View() const noexcept;
+
+    public:
+        //
+        // Sample metadata carried with the frame
+        //
+        int64_t timestamp = 0;
+        uint32_t flags = 0;
+        uint32_t streamIndex = 0;
+
+        //
+        // Host steady clock nanoseconds, 0 if unknown
+        //
+        int64_t arrival = 0;
+        int64_t deviceTime = 0;
+
+    private:
+        friend class FramePool;
+        friend class FrameRef;
+
+        FrameBuffer(FramePool* pool, const FrameFormat& format, uint8_t* data, size_t size) noexcept;
+
+        FramePool* m_pool;
+        FrameFormat m_format;
+        uint8_t* m_data;
+        size_t m_size;
+        std::atomic<uint32_t> m_refs;
+        FrameBuffer* m_next;
+    };
+
+    //
+    // Refcounting handle of a pooled frame
+    //
+    class FrameRef
+    {
+    public:
+        FrameRef() noexcept;
+        explicit FrameRef(FrameBuffer* buffer) noexcept;
+        FrameRef(const FrameRef& other) noexcept;
+        FrameRef(FrameRef&& other) noexcept;
+        ~FrameRef();
+
+        FrameRef& operator=(const FrameRef& other) noexcept;
+        FrameRef& operator=(FrameRef&& other) noexcept;
+
+        void Reset() noexcept;
+
+        FrameBuffer* Get() const noexcept { return m_buffer; }
+        FrameBuffer* operator->() const noexcept { return m_buffer; }
+        explicit operator bool() const noexcept { return m_buffer != nullptr; }
+
+    private:
+        FrameBuffer* m_buffer;
+    };
+
+    //
+    // Recycles frame buffers keyed by format, width, height and stride.
+    // Buffers are allocated only until the pool reaches its working set,
+    // after that Acquire takes them from the free list without touching the heap.
+    // The pool must outlive every FrameRef it handed out
+    //
+    class FramePool
+    {
+    public:
+        struct Statistics
+        {
+            uint64_t hits;              // served from the free list
+            uint64_t misses;            // allocated a new buffer
+            uint64_t rejected;          // memory limit reached
+            uint64_t evicted;           // free buffers of other formats released to fit the limit
+            size_t buffers;             // allocated buffers
+            size_t outstanding;         // buffers in use
+            size_t highWaterBuffers;
+            size_t bytes;               // allocated bytes
+            size_t highWaterBytes;
+        };
+
+        explicit FramePool(size_t memoryLimit) noexcept;
+        ~FramePool();
+
+        FramePool(const FramePool&) = delete;
+        FramePool& operator=(const FramePool&) = delete;
+
+        //
+        // Returns an empty FrameRef if the memory limit does not allow one more buffer
+        //
+        FrameRef Acquire(const FrameFormat& format) noexcept;
+
+        //
+        // Copies the frame into a pooled buffer with 64-byte aligned rows
+        //
+        FrameRef Copy(const FrameView& frame) noexcept;
+
+        //
+        // Releases the free buffers
+        //
+        void Trim() noexcept;
+
+        Statistics GetStatistics() const noexcept;
+        size_t GetMemoryLimit() const noexcept;
+
+        static FrameFormat AlignedFormat(PixelFormat format, uint32_t width, uint32_t height) noexcept;
+
+    private:
+        friend class FrameRef;
+
+        void Recycle(FrameBuffer* buffer) noexcept;
+        void Free(FrameBuffer* buffer) noexcept;
+
+    private:
+        mutable std::mutex m_mutex;
+        const size_t m_memoryLimit;
+        FrameBuffer* m_free;
+        Statistics m_stat;
+    };
+}
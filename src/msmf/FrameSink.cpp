@@ -0,0 +1,66 @@
+#include "FrameSink.h"
+
+#include <cstring>
+
+namespace
+{
+    constexpr uint64_t HashPrime = 0x100000001b3ull;
+    constexpr uint64_t HashBasis = 0xcbf29ce484222325ull;
+
+    //
+    // FNV-1a over 64-bit words, the row tail is hashed byte by byte
+    //
+    uint64_t HashRow(uint64_t hash, const uint8_t* data, size_t size) noexcept
+    {
+        size_t i = 0;
+
+        for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t))
+        {
+            uint64_t word;
+            memcpy(&word, data + i, sizeof(word));
+            hash = (hash ^ word) * HashPrime;
+        }
+
+        for (; i < size; ++i)
+        {
+            hash = (hash ^ data[i]) * HashPrime;
+        }
+
+        return hash;
+    }
+}
+
+namespace video
+{
+    void ChecksumSink::OnFrame(const FrameView& frame, int64_t timestamp)
+    {
+        (void)timestamp;
+        m_frames += 1;
+        m_bytes += frame.Bytes();
+        m_checksum = (m_checksum ^ FrameChecksum(frame)) * HashPrime;
+    }
+
+    uint64_t ChecksumSink::FrameChecksum(const FrameView& frame) noexcept
+    {
+        //
+        // Padding between rows is not hashed, so the checksum
+        // does not depend on the stride of the capture buffer
+        //
+        uint64_t hash = HashBasis;
+
+        for (size_t plane = 0; plane < frame.planeCount; ++plane)
+        {
+            const size_t rowBytes = frame.RowBytes(plane);
+            const size_t rows = frame.Rows(plane);
+            const uint8_t* row = frame.planes[plane].data;
+
+            for (size_t i = 0; i < rows; ++i)
+            {
+                hash = HashRow(hash, row, rowBytes);
+                row += frame.planes[plane].stride;
+            }
+        }
+
+        return hash;
+    }
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "FrameView.h"
+
+namespace video
+{
+    //
+    // Consumer of captured frames, the view is valid only during the call
+    //
+    class FrameSink
+    {
+    public:
+        virtual ~FrameSink() = default;
+        virtual void OnFrame(const FrameView& frame, int64_t timestamp) = 0;
+    };
+
+    //
+    // Counts frames and bytes without touching the pixels
+    //
+    class NullSink : public FrameSink
+    {
+    public:
+        void OnFrame(const FrameView& frame, int64_t timestamp) override
+        {
+            (void)timestamp;
+            m_frames += 1;
+            m_bytes += frame.Bytes();
+        }
+
+        uint64_t GetFrames() const noexcept { return m_frames; }
+        uint64_t GetBytes() const noexcept { return m_bytes; }
+
+    private:
+        uint64_t m_frames = 0;
+        uint64_t m_bytes = 0;
+    };
+
+    //
+    // Reads every visible byte of the frame, so the memory traffic
+    // of a real consumer is measured, and folds it into one checksum
+    //
+    class ChecksumSink : public FrameSink
+    {
+    public:
+        void OnFrame(const FrameView& frame, int64_t timestamp) override;
+
+        uint64_t GetFrames() const noexcept { return m_frames; }
+        uint64_t GetBytes() const noexcept { return m_bytes; }
+        uint64_t GetChecksum() const noexcept { return m_checksum; }
+
+        static uint64_t FrameChecksum(const FrameView& frame) noexcept;
+
+    private:
+        uint64_t m_frames = 0;
+        uint64_t m_bytes = 0;
+        uint64_t m_checksum = 0;
+    };
+}
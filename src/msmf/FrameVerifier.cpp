@@ -0,0 +1,402 @@
+#include "FrameVerifier.h"
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#define FRAME_HASH_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace
+{
+    constexpr size_t Lanes = 8;
+    constexpr size_t StripesPerBlock = 16;
+
+    constexpr uint64_t Prime32 = 0x9E3779B1ull;
+    constexpr uint64_t Prime64 = 0x9E3779B185EBCA87ull;
+
+    //
+    // Key words: stripe s of a block uses [s, s + 8), the scramble [16, 24),
+    // the final merge [24, 32)
+    //
+    constexpr size_t SecretWords = 32;
+    constexpr size_t ScrambleKey = 16;
+    constexpr size_t MergeKey = 24;
+
+    constexpr uint64_t SplitMix(uint64_t x) noexcept
+    {
+        x += 0x9E3779B97F4A7C15ull;
+        x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+        x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+        return x ^ (x >> 31);
+    }
+
+    struct Secret
+    {
+        uint64_t words[SecretWords];
+
+        Secret() noexcept
+        {
+            for (size_t i = 0; i < SecretWords; ++i)
+            {
+                words[i] = SplitMix(i);
+            }
+        }
+    };
+
+    const uint64_t* GetSecret() noexcept
+    {
+        static const Secret secret;
+        return secret.words;
+    }
+
+    inline uint64_t Load64(const uint8_t* p) noexcept
+    {
+        uint64_t value;
+        memcpy(&value, p, sizeof(value));
+        return value;
+    }
+
+    //
+    // The scalar kernel is the reference for the SIMD one
+    //
+    void AccumulateScalar(uint64_t* acc, const uint8_t* data, size_t stripes, uint64_t stripeIndex) noexcept
+    {
+        const uint64_t* secret = GetSecret();
+
+        for (size_t s = 0; s < stripes; ++s, data += 64)
+        {
+            const uint64_t* key = secret + (stripeIndex % StripesPerBlock);
+
+            for (size_t i = 0; i < Lanes; ++i)
+            {
+                const uint64_t value = Load64(data + 8 * i);
+                const uint64_t keyed = value ^ key[i];
+                acc[i] += Load64(data + 8 * (i ^ 1)) + (keyed & 0xFFFFFFFFull) * (keyed >> 32);
+            }
+
+            stripeIndex += 1;
+
+            if (0 == stripeIndex % StripesPerBlock)
+            {
+                for (size_t i = 0; i < Lanes; ++i)
+                {
+                    acc[i] = (acc[i] ^ (acc[i] >> 47) ^ secret[ScrambleKey + i]) * Prime32;
+                }
+            }
+        }
+    }
+
+#ifdef FRAME_HASH_SSE2
+    void AccumulateSse2(uint64_t* acc, const uint8_t* data, size_t stripes, uint64_t stripeIndex) noexcept
+    {
+        const uint64_t* secret = GetSecret();
+        const __m128i prime = _mm_set1_epi32(static_cast<int>(Prime32));
+
+        __m128i a[4];
+
+        for (size_t j = 0; j < 4; ++j)
+        {
+            a[j] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(acc) + j);
+        }
+
+        for (size_t s = 0; s < stripes; ++s, data += 64)
+        {
+            const auto key = reinterpret_cast<const __m128i*>(secret + (stripeIndex % StripesPerBlock));
+
+            for (size_t j = 0; j < 4; ++j)
+            {
+                const __m128i value = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data) + j);
+                const __m128i keyed = _mm_xor_si128(value, _mm_loadu_si128(key + j));
+
+                //
+                // low 32 bits times high 32 bits of every lane,
+                // plus the value of the other lane of the pair
+                //
+                const __m128i product = _mm_mul_epu32(keyed, _mm_shuffle_epi32(keyed, _MM_SHUFFLE(0, 3, 0, 1)));
+                const __m128i swapped = _mm_shuffle_epi32(value, _MM_SHUFFLE(1, 0, 3, 2));
+                a[j] = _mm_add_epi64(a[j], _mm_add_epi64(product, swapped));
+            }
+
+            stripeIndex += 1;
+
+            if (0 == stripeIndex % StripesPerBlock)
+            {
+                const auto scrambleKey = reinterpret_cast<const __m128i*>(secret + ScrambleKey);
+
+                for (size_t j = 0; j < 4; ++j)
+                {
+                    __m128i x = _mm_xor_si128(a[j], _mm_srli_epi64(a[j], 47));
+                    x = _mm_xor_si128(x, _mm_loadu_si128(scrambleKey + j));
+
+                    //
+                    // 64 x 32 bit multiply from two 32 x 32 bit halves
+                    //
+                    const __m128i low = _mm_mul_epu32(x, prime);
+                    const __m128i high = _mm_mul_epu32(_mm_srli_epi64(x, 32), prime);
+                    a[j] = _mm_add_epi64(low, _mm_slli_epi64(high, 32));
+                }
+            }
+        }
+
+        for (size_t j = 0; j < 4; ++j)
+        {
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(acc) + j, a[j]);
+        }
+    }
+#endif
+
+    //
+    // The 128-bit product of a and b folded to 64 bits
+    //
+    uint64_t Mul128Fold64(uint64_t a, uint64_t b) noexcept
+    {
+        const uint64_t mask = 0xFFFFFFFFull;
+        const uint64_t lowLow = (a & mask) * (b & mask);
+        const uint64_t highLow = (a >> 32) * (b & mask);
+        const uint64_t lowHigh = (a & mask) * (b >> 32);
+        const uint64_t highHigh = (a >> 32) * (b >> 32);
+
+        const uint64_t cross = (lowLow >> 32) + (highLow & mask) + lowHigh;
+        const uint64_t upper = (highLow >> 32) + (cross >> 32) + highHigh;
+        const uint64_t lower = (cross << 32) | (lowLow & mask);
+        return lower ^ upper;
+    }
+
+    uint64_t Avalanche(uint64_t h) noexcept
+    {
+        h ^= h >> 37;
+        h *= 0x165667919E3779F9ull;
+        return h ^ (h >> 32);
+    }
+}
+
+namespace video
+{
+    FrameHasher::FrameHasher(ConvertKernel kernel) noexcept
+        : m_acc{}
+        , m_carry{}
+        , m_carrySize(0)
+        , m_stripes(0)
+        , m_length(0)
+        , m_kernel(ConvertKernel::Scalar)
+    {
+#ifdef FRAME_HASH_SSE2
+        if (kernel != ConvertKernel::Scalar)
+        {
+            m_kernel = ConvertKernel::Sse2;
+        }
+#else
+        (void)kernel;
+#endif
+        Reset();
+    }
+
+    void FrameHasher::Reset() noexcept
+    {
+        //
+        // Non-zero lanes, so leading zero bytes change the hash
+        //
+        const uint64_t* secret = GetSecret();
+
+        for (size_t i = 0; i < Lanes; ++i)
+        {
+            m_acc[i] = secret[MergeKey + i] ^ Prime64;
+        }
+
+        m_carrySize = 0;
+        m_stripes = 0;
+        m_length = 0;
+    }
+
+    void FrameHasher::Update(const uint8_t* data, size_t size) noexcept
+    {
+        m_length += size;
+
+        //
+        // Bytes short of a stripe wait for the next call, rows of any width
+        // hash the same as the frame packed into one buffer
+        //
+        if (m_carrySize)
+        {
+            const size_t bytes = std::min(StripeBytes - m_carrySize, size);
+            memcpy(m_carry + m_carrySize, data, bytes);
+            m_carrySize += bytes;
+            data += bytes;
+            size -= bytes;
+
+            if (m_carrySize < StripeBytes)
+            {
+                return;
+            }
+
+            Accumulate(m_carry, 1);
+            m_carrySize = 0;
+        }
+
+        const size_t stripes = size / StripeBytes;
+
+        if (stripes)
+        {
+            Accumulate(data, stripes);
+            data += stripes * StripeBytes;
+            size -= stripes * StripeBytes;
+        }
+
+        if (size)
+        {
+            memcpy(m_carry, data, size);
+            m_carrySize = size;
+        }
+    }
+
+    uint64_t FrameHasher::Final() const noexcept
+    {
+        uint64_t acc[Lanes];
+        memcpy(acc, m_acc, sizeof(acc));
+
+        //
+        // The last partial stripe is padded with zeros, the length tells it apart
+        //
+        if (m_carrySize)
+        {
+            uint8_t last[StripeBytes] = {};
+            memcpy(last, m_carry, m_carrySize);
+            AccumulateScalar(acc, last, 1, m_stripes);
+        }
+
+        const uint64_t* secret = GetSecret();
+        uint64_t h = m_length * Prime64;
+
+        for (size_t i = 0; i < Lanes; i += 2)
+        {
+            h += Mul128Fold64(acc[i] ^ secret[MergeKey + i], acc[i + 1] ^ secret[MergeKey + i + 1]);
+        }
+
+        return Avalanche(h);
+    }
+
+    uint64_t FrameHasher::HashFrame(const FrameView& frame, ConvertKernel kernel) noexcept
+    {
+        FrameHasher hasher(kernel);
+
+        for (size_t plane = 0; plane < frame.planeCount; ++plane)
+        {
+            const size_t rowBytes = frame.RowBytes(plane);
+            const size_t rows = frame.Rows(plane);
+            const uint8_t* row = frame.planes[plane].data;
+
+            //
+            // A packed plane is one run of stripes
+            //
+            if (static_cast<ptrdiff_t>(rowBytes) == frame.planes[plane].stride)
+            {
+                hasher.Update(row, rowBytes * rows);
+                continue;
+            }
+
+            for (size_t i = 0; i < rows; ++i)
+            {
+                hasher.Update(row, rowBytes);
+                row += frame.planes[plane].stride;
+            }
+        }
+
+        return hasher.Final();
+    }
+
+    void FrameHasher::Accumulate(const uint8_t* data, size_t stripes) noexcept
+    {
+#ifdef FRAME_HASH_SSE2
+        if (m_kernel == ConvertKernel::Sse2)
+        {
+            AccumulateSse2(m_acc, data, stripes, m_stripes);
+            m_stripes += stripes;
+            return;
+        }
+#endif
+        AccumulateScalar(m_acc, data, stripes, m_stripes);
+        m_stripes += stripes;
+    }
+
+    VerifySink::VerifySink(TestPattern pattern, ColorSpace colorSpace, ConvertKernel kernel)
+        : m_checker(pattern, colorSpace)
+        , m_kernel(kernel)
+        , m_report{}
+        , m_lastHash(0)
+    {
+        m_events.reserve(MaxEvents);
+    }
+
+    void VerifySink::OnFrame(const FrameView& frame, int64_t timestamp)
+    {
+        const uint64_t hash = FrameHasher::HashFrame(frame, m_kernel);
+
+        //
+        // An identical frame matches the pattern as its predecessor did,
+        // only the repeat is reported
+        //
+        if (m_report.frames && hash == m_lastHash)
+        {
+            m_report.identical += 1;
+            AddEvent(timestamp, Issue::Identical, 0, 0);
+        }
+        else
+        {
+            uint32_t row = 0;
+            uint64_t skipped = 0;
+
+            switch (m_checker.Check(frame, row, skipped))
+            {
+            case PatternChecker::Result::Mismatch:
+                m_report.mismatched += 1;
+                AddEvent(timestamp, Issue::Mismatch, row, 0);
+                break;
+            case PatternChecker::Result::Repeated:
+                m_report.repeated += 1;
+                AddEvent(timestamp, Issue::Repeated, 0, 0);
+                break;
+            case PatternChecker::Result::Skipped:
+                m_report.skipped += skipped;
+                AddEvent(timestamp, Issue::Skipped, 0, skipped);
+                break;
+            default:
+                break;
+            }
+        }
+
+        m_lastHash = hash;
+        m_report.frames += 1;
+        m_report.bytes += frame.Bytes();
+        m_report.hash = Avalanche(m_report.hash ^ hash);
+    }
+
+    VerifySink::Report VerifySink::GetReport() const noexcept
+    {
+        return m_report;
+    }
+
+    const char* VerifySink::IssueName(Issue issue) noexcept
+    {
+        switch (issue)
+        {
+        case Issue::Identical: return "identical";
+        case Issue::Mismatch: return "mismatch";
+        case Issue::Repeated: return "repeated";
+        case Issue::Skipped: return "skipped";
+        default: return "unknown";
+        }
+    }
+
+    void VerifySink::AddEvent(int64_t timestamp, Issue issue, uint32_t row, uint64_t skipped) noexcept
+    {
+        if (m_events.size() >= MaxEvents)
+        {
+            m_report.lostEvents += 1;
+            return;
+        }
+
+        m_events.push_back({ m_report.frames, timestamp, issue, row, skipped });
+    }
+}
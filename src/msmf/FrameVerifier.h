@@ -0,0 +1,111 @@
+#pragma once
+
+#include <vector>
+#include "FrameSink.h"
+#include "PixelConvert.h"
+#include "TestPattern.h"
+
+namespace video
+{
+    //
+    // 64-bit hash of a byte stream in the manner of XXH3: 64-byte stripes
+    // are accumulated into eight 64-bit lanes with 32x32 multiplies and
+    // scrambled every 1 KB. The SSE2 and the scalar kernels give the same hash,
+    // it is not compatible with xxHash itself
+    //
+    class FrameHasher
+    {
+    public:
+        explicit FrameHasher(ConvertKernel kernel = ConvertKernel::Auto) noexcept;
+
+        void Reset() noexcept;
+        void Update(const uint8_t* data, size_t size) noexcept;
+        uint64_t Final() const noexcept;
+
+        ConvertKernel GetKernel() const noexcept { return m_kernel; }
+
+        //
+        // The visible bytes of every plane as one stream,
+        // the padding between rows is not hashed
+        //
+        static uint64_t HashFrame(const FrameView& frame, ConvertKernel kernel = ConvertKernel::Auto) noexcept;
+
+    private:
+        void Accumulate(const uint8_t* data, size_t stripes) noexcept;
+
+    private:
+        static constexpr size_t StripeBytes = 64;
+
+        uint64_t m_acc[8];
+        uint8_t m_carry[StripeBytes];
+        size_t m_carrySize;
+        uint64_t m_stripes;
+        uint64_t m_length;
+        ConvertKernel m_kernel;
+    };
+
+    //
+    // Hashes every frame to find identical consecutive frames and checks it
+    // against a test pattern. Keeps up with 4K60 on one core
+    //
+    class VerifySink : public FrameSink
+    {
+    public:
+        enum class Issue : uint32_t
+        {
+            Identical = 0,  // the same bytes as the previous frame
+            Mismatch,       // the pixels do not form the pattern
+            Repeated,       // the pattern did not advance
+            Skipped,        // frames of the pattern are missing
+        };
+
+        struct Event
+        {
+            uint64_t frame;
+            int64_t timestamp;
+            Issue issue;
+            uint32_t row;       // the first row not matching the pattern
+            uint64_t skipped;   // frames missing before this one
+        };
+
+        struct Report
+        {
+            uint64_t frames;
+            uint64_t bytes;
+            uint64_t identical;
+            uint64_t mismatched;
+            uint64_t repeated;
+            uint64_t skipped;       // frames, not events
+            uint64_t lostEvents;    // events beyond MaxEvents
+            uint64_t hash;          // of all the frames in order
+        };
+
+        //
+        // Events kept for the report, the rest are only counted
+        //
+        static constexpr size_t MaxEvents = 64;
+
+        explicit VerifySink(
+            TestPattern pattern = TestPattern::None,
+            ColorSpace colorSpace = ColorSpace(),
+            ConvertKernel kernel = ConvertKernel::Auto);
+
+        void OnFrame(const FrameView& frame, int64_t timestamp) override;
+
+        Report GetReport() const noexcept;
+        const std::vector<Event>& GetEvents() const noexcept { return m_events; }
+        TestPattern GetPattern() const noexcept { return m_checker.GetPattern(); }
+
+        static const char* IssueName(Issue issue) noexcept;
+
+    private:
+        void AddEvent(int64_t timestamp, Issue issue, uint32_t row, uint64_t skipped) noexcept;
+
+    private:
+        PatternChecker m_checker;
+        ConvertKernel m_kernel;
+        std::vector<Event> m_events;
+        Report m_report;
+        uint64_t m_lastHash;
+    };
+}
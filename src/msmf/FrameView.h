@@ -0,0 +1,147 @@
+#pragma once
+
+#include "PixelFormat.h"
+
+namespace video
+{
+    //
+    // Non-owning view of one video frame, planes point into the capture buffer
+    // and are valid while the buffer is locked
+    //
+    struct FrameView
+    {
+        PixelFormat format = PixelFormat::Unknown;
+        uint32_t width = 0;
+        uint32_t height = 0;
+        size_t planeCount = 0;
+        Plane planes[MaxPlanes] = {};
+
+        bool IsValid() const noexcept
+        {
+            return planeCount != 0 && planes[0].data && width && height;
+        }
+
+        //
+        // Bytes of the visible pixels in one row of the plane
+        //
+        size_t RowBytes(size_t plane) const noexcept
+        {
+            if (plane == 0)
+            {
+                return width * BytesPerPixel(format);
+            }
+
+            return (format == PixelFormat::NV12) ? ((width + 1) & ~1u) : (width + 1) / 2;
+        }
+
+        size_t Rows(size_t plane) const noexcept
+        {
+            return (plane == 0) ? height : (height + 1) / 2;
+        }
+
+        //
+        // Total visible bytes of all the planes, strides are not counted
+        //
+        size_t Bytes() const noexcept
+        {
+            size_t bytes = 0;
+
+            for (size_t i = 0; i < planeCount; ++i)
+            {
+                bytes += RowBytes(i) * Rows(i);
+            }
+
+            return bytes;
+        }
+
+        //
+        // Bytes of the buffer the planes span, |stride| x rows summed over the planes
+        //
+        size_t SpanBytes() const noexcept
+        {
+            size_t bytes = 0;
+
+            for (size_t i = 0; i < planeCount; ++i)
+            {
+                bytes += static_cast<size_t>(planes[i].stride < 0 ? -planes[i].stride : planes[i].stride) * Rows(i);
+            }
+
+            return bytes;
+        }
+    };
+
+    //
+    // True if every row of every plane, |stride| bytes each, lies in [start, start + length).
+    // Planes with a negative stride run from their first row down to lower addresses
+    //
+    inline bool FitsBuffer(const FrameView& view, const uint8_t* start, size_t length) noexcept
+    {
+        if (!view.IsValid() || view.SpanBytes() > length)
+        {
+            return false;
+        }
+
+        const uintptr_t base = reinterpret_cast<uintptr_t>(start);
+
+        for (size_t i = 0; i < view.planeCount; ++i)
+        {
+            const uintptr_t first = reinterpret_cast<uintptr_t>(view.planes[i].data);
+            const ptrdiff_t stride = view.planes[i].stride;
+            const uintptr_t step = static_cast<uintptr_t>(stride < 0 ? -stride : stride);
+            const uintptr_t rows = view.Rows(i);
+
+            //
+            // Bytes from the lowest row up to the first row of the plane
+            //
+            const uintptr_t below = (stride < 0) ? step * (rows - 1) : 0;
+
+            if (first < base || first - base < below || first - base - below + step * rows > length)
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    //
+    // Splits a frame stored as one 2D buffer to planes,
+    // the chroma planes of 4:2:0 formats follow the luma plane
+    //
+    inline FrameView MakeFrameView(
+        PixelFormat format,
+        uint32_t width,
+        uint32_t height,
+        const uint8_t* scanline0,
+        ptrdiff_t pitch) noexcept
+    {
+        FrameView view;
+        view.format = format;
+        view.width = width;
+        view.height = height;
+        view.planeCount = PlaneCount(format);
+        view.planes[0].data = scanline0;
+        view.planes[0].stride = pitch;
+
+        switch (format)
+        {
+        case PixelFormat::NV12:
+            view.planes[1].data = scanline0 + pitch * height;
+            view.planes[1].stride = pitch;
+            break;
+
+        case PixelFormat::I420:
+        case PixelFormat::YV12:
+            view.planes[1].data = scanline0 + pitch * height;
+            view.planes[1].stride = pitch / 2;
+            view.planes[2].data = view.planes[1].data + (pitch / 2) * ((height + 1) / 2);
+            view.planes[2].stride = pitch / 2;
+            break;
+
+        default:
+            break;
+        }
+
+        return view;
+    }
+}
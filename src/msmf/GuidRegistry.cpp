@@ -0,0 +1,57 @@
+#include "GuidRegistry.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+namespace
+{
+    //
+    // Any strict order will do, so compare the guid as two 64-bit words
+    // rather than byte by byte
+    //
+    bool GuidLess(const GUID& left, const GUID& right) noexcept
+    {
+        uint64_t l[2];
+        uint64_t r[2];
+        static_assert(sizeof(l) == sizeof(GUID), "GUID is 16 bytes");
+        memcpy(l, &left, sizeof(l));
+        memcpy(r, &right, sizeof(r));
+        return l[0] != r[0] ? l[0] < r[0] : l[1] < r[1];
+    }
+}
+
+namespace utils
+{
+    GuidRegistry::GuidRegistry(std::vector<GuidName> names)
+        : m_names(std::move(names))
+    {
+        //
+        // stable_sort keeps the first listed name of a duplicated guid first
+        //
+        std::stable_sort(m_names.begin(), m_names.end(), [](const GuidName& left, const GuidName& right)
+        {
+            return GuidLess(left.guid, right.guid);
+        });
+
+        m_names.erase(std::unique(m_names.begin(), m_names.end(), [](const GuidName& left, const GuidName& right)
+        {
+            return left.guid == right.guid;
+        }), m_names.end());
+    }
+
+    std::wstring_view GuidRegistry::Find(const GUID& guid) const noexcept
+    {
+        const auto it = std::lower_bound(m_names.begin(), m_names.end(), guid, [](const GuidName& item, const GUID& value)
+        {
+            return GuidLess(item.guid, value);
+        });
+
+        if (it != m_names.end() && it->guid == guid)
+        {
+            return it->name;
+        }
+
+        return std::wstring_view();
+    }
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <string_view>
+#include <vector>
+#include "Platform.h"
+
+namespace utils
+{
+    struct GuidName
+    {
+        GUID guid;
+        std::wstring_view name;     // must outlive the registry, e.g. a literal
+    };
+
+    //
+    // Names of guids, sorted once and searched with lower_bound.
+    // A guid listed twice keeps the first listed name
+    //
+    class GuidRegistry
+    {
+    public:
+        explicit GuidRegistry(std::vector<GuidName> names);
+
+        //
+        // An empty view for an unregistered guid
+        //
+        std::wstring_view Find(const GUID& guid) const noexcept;
+
+        size_t GetCount() const noexcept { return m_names.size(); }
+
+    private:
+        std::vector<GuidName> m_names;
+    };
+}
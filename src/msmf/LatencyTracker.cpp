@@ -0,0 +1,94 @@
+#include "LatencyTracker.h"
+
+#include <algorithm>
+
+namespace video
+{
+    LatencyTracker::LatencyTracker() noexcept
+        : m_frames(0)
+        , m_unmapped(0)
+    {
+    }
+
+    void LatencyTracker::Record(const FrameTimes& times) noexcept
+    {
+        m_frames.fetch_add(1, std::memory_order_relaxed);
+
+        int64_t device = times.device;
+
+        if (device && (device > times.arrival || times.arrival - device > MaxDeviceLatency))
+        {
+            m_unmapped.fetch_add(1, std::memory_order_relaxed);
+            device = 0;
+        }
+
+        Add(Span::Device, device, times.arrival);
+        Add(Span::Queue, times.arrival, times.copyStart);
+        Add(Span::Copy, times.copyStart, times.copyEnd);
+        Add(Span::Present, times.copyEnd, times.present);
+
+        const int64_t first = device ? device : times.arrival;
+        const int64_t last = std::max({ times.arrival, times.copyEnd, times.present });
+        Add(Span::Total, first, last);
+    }
+
+    void LatencyTracker::Reset() noexcept
+    {
+        for (auto& span : m_spans)
+        {
+            span.Reset();
+        }
+
+        m_frames.store(0, std::memory_order_relaxed);
+        m_unmapped.store(0, std::memory_order_relaxed);
+    }
+
+    LatencyTracker::Report LatencyTracker::GetReport() const noexcept
+    {
+        Report report = {};
+        report.frames = m_frames.load(std::memory_order_relaxed);
+        report.unmapped = m_unmapped.load(std::memory_order_relaxed);
+
+        LogHistogram histogram;
+
+        for (size_t i = 0; i < static_cast<size_t>(Span::Count); ++i)
+        {
+            m_spans[i].Snapshot(histogram);
+
+            SpanReport& span = report.spans[i];
+            span.count = histogram.Count();
+            span.mean = histogram.Mean();
+            span.p50 = histogram.Percentile(0.50);
+            span.p99 = histogram.Percentile(0.99);
+            span.max = histogram.Max();
+        }
+
+        return report;
+    }
+
+    const char* LatencyTracker::SpanName(Span span) noexcept
+    {
+        switch (span)
+        {
+        case Span::Device: return "device";
+        case Span::Queue: return "queue";
+        case Span::Copy: return "copy";
+        case Span::Present: return "present";
+        case Span::Total: return "total";
+        default: return "unknown";
+        }
+    }
+
+    void LatencyTracker::Add(Span span, int64_t begin, int64_t end) noexcept
+    {
+        //
+        // A stage the frame did not pass leaves its spans out
+        //
+        if (0 == begin || 0 == end || end < begin)
+        {
+            return;
+        }
+
+        m_spans[static_cast<size_t>(span)].Add(static_cast<uint64_t>(end - begin) / 1000);
+    }
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <atomic>
+#include "LogHistogram.h"
+
+namespace video
+{
+    //
+    // When one frame passed each stage, nanoseconds of the host steady clock
+    // (TimingAnalyzer::Now), 0 for the stages the frame did not pass
+    //
+    struct FrameTimes
+    {
+        int64_t device = 0;     // the sample timestamp on the host clock
+        int64_t arrival = 0;    // the sample reached the application
+        int64_t copyStart = 0;  // the consumer started copying or converting it
+        int64_t copyEnd = 0;
+        int64_t present = 0;    // Present returned
+    };
+
+    //
+    // Latency between the stages of every frame, any thread can Record
+    //
+    class LatencyTracker
+    {
+    public:
+        enum class Span : uint32_t
+        {
+            Device = 0,     // device to arrival
+            Queue,          // arrival to copy start
+            Copy,           // copy start to copy end
+            Present,        // copy end to present
+            Total,          // device, or arrival if the device time is unknown, to the last stage
+            Count,
+        };
+
+        //
+        // Microseconds
+        //
+        struct SpanReport
+        {
+            uint64_t count;
+            double mean;
+            uint64_t p50;
+            uint64_t p99;
+            uint64_t max;
+        };
+
+        struct Report
+        {
+            uint64_t frames;
+            uint64_t unmapped;  // device times not on the host clock, ignored
+            SpanReport spans[static_cast<size_t>(Span::Count)];
+
+            const SpanReport& operator[](Span span) const noexcept
+            {
+                return spans[static_cast<size_t>(span)];
+            }
+        };
+
+        //
+        // A device time older than this is taken for another clock
+        //
+        static constexpr int64_t MaxDeviceLatency = 10000000000ll;
+
+        LatencyTracker() noexcept;
+
+        LatencyTracker(const LatencyTracker&) = delete;
+        LatencyTracker& operator=(const LatencyTracker&) = delete;
+
+        void Record(const FrameTimes& times) noexcept;
+
+        //
+        // Not concurrent with Record
+        //
+        void Reset() noexcept;
+
+        Report GetReport() const noexcept;
+
+        static const char* SpanName(Span span) noexcept;
+
+    private:
+        void Add(Span span, int64_t begin, int64_t end) noexcept;
+
+    private:
+        AtomicLogHistogram m_spans[static_cast<size_t>(Span::Count)];
+        std::atomic<uint64_t> m_frames;
+        std::atomic<uint64_t> m_unmapped;
+    };
+}
@@ -0,0 +1,184 @@
+#include "LogHistogram.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+    size_t HighestBit(uint64_t value) noexcept
+    {
+        size_t bit = 0;
+
+        while (value >>= 1)
+        {
+            ++bit;
+        }
+
+        return bit;
+    }
+}
+
+namespace video
+{
+    LogHistogram::LogHistogram() noexcept
+    {
+        Reset();
+    }
+
+    void LogHistogram::Add(uint64_t value) noexcept
+    {
+        m_buckets[BucketIndex(value)] += 1;
+        m_count += 1;
+        m_min = std::min(m_min, value);
+        m_max = std::max(m_max, value);
+        m_sum += static_cast<double>(value);
+    }
+
+    void LogHistogram::Merge(const LogHistogram& other) noexcept
+    {
+        for (size_t i = 0; i < BucketCount; ++i)
+        {
+            m_buckets[i] += other.m_buckets[i];
+        }
+
+        m_count += other.m_count;
+        m_min = std::min(m_min, other.m_min);
+        m_max = std::max(m_max, other.m_max);
+        m_sum += other.m_sum;
+    }
+
+    void LogHistogram::Reset() noexcept
+    {
+        memset(m_buckets, 0, sizeof(m_buckets));
+        m_count = 0;
+        m_min = UINT64_MAX;
+        m_max = 0;
+        m_sum = 0;
+    }
+
+    double LogHistogram::Mean() const noexcept
+    {
+        return m_count ? m_sum / m_count : 0;
+    }
+
+    uint64_t LogHistogram::Percentile(double fraction) const noexcept
+    {
+        if (0 == m_count)
+        {
+            return 0;
+        }
+
+        fraction = std::min(std::max(fraction, 0.0), 1.0);
+
+        //
+        // Nearest rank, 1-based
+        //
+        const uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(fraction * m_count + 0.5));
+        uint64_t seen = 0;
+
+        for (size_t i = 0; i < BucketCount; ++i)
+        {
+            seen += m_buckets[i];
+
+            if (seen >= rank)
+            {
+                const uint64_t lower = BucketLowerBound(i);
+                const uint64_t middle = lower + (BucketUpperBound(i) - lower) / 2;
+                return std::min(std::max(middle, Min()), m_max);
+            }
+        }
+
+        return m_max;
+    }
+
+    size_t LogHistogram::BucketIndex(uint64_t value) noexcept
+    {
+        if (value < SubBucketCount)
+        {
+            return static_cast<size_t>(value);
+        }
+
+        const size_t bit = HighestBit(value);
+        const size_t subBucket = static_cast<size_t>(value >> (bit - SubBucketBits)) & (SubBucketCount - 1);
+        return (bit - SubBucketBits + 1) * SubBucketCount + subBucket;
+    }
+
+    uint64_t LogHistogram::BucketLowerBound(size_t index) noexcept
+    {
+        if (index < SubBucketCount)
+        {
+            return index;
+        }
+
+        const size_t shift = index / SubBucketCount - 1;
+        const uint64_t subBucket = index % SubBucketCount;
+        return (SubBucketCount + subBucket) << shift;
+    }
+
+    uint64_t LogHistogram::BucketUpperBound(size_t index) noexcept
+    {
+        if (index < SubBucketCount)
+        {
+            return index;
+        }
+
+        const size_t shift = index / SubBucketCount - 1;
+        return BucketLowerBound(index) + ((uint64_t(1) << shift) - 1);
+    }
+
+    AtomicLogHistogram::AtomicLogHistogram() noexcept
+    {
+        Reset();
+    }
+
+    void AtomicLogHistogram::Add(uint64_t value) noexcept
+    {
+        m_sum.fetch_add(value, std::memory_order_relaxed);
+
+        uint64_t min = m_min.load(std::memory_order_relaxed);
+        while (value < min && !m_min.compare_exchange_weak(min, value, std::memory_order_relaxed))
+        {
+        }
+
+        uint64_t max = m_max.load(std::memory_order_relaxed);
+        while (value > max && !m_max.compare_exchange_weak(max, value, std::memory_order_relaxed))
+        {
+        }
+
+        //
+        // Released after the min and the max, a snapshot that sees the bucket sees them too
+        //
+        m_buckets[LogHistogram::BucketIndex(value)].fetch_add(1, std::memory_order_release);
+    }
+
+    void AtomicLogHistogram::Reset() noexcept
+    {
+        for (auto& bucket : m_buckets)
+        {
+            bucket.store(0, std::memory_order_relaxed);
+        }
+
+        m_min.store(UINT64_MAX, std::memory_order_relaxed);
+        m_max.store(0, std::memory_order_relaxed);
+        m_sum.store(0, std::memory_order_relaxed);
+    }
+
+    void AtomicLogHistogram::Snapshot(LogHistogram& histogram) const noexcept
+    {
+        //
+        // The count is taken from the copied buckets, so percentiles stay consistent
+        //
+        uint64_t count = 0;
+
+        for (size_t i = 0; i < LogHistogram::BucketCount; ++i)
+        {
+            histogram.m_buckets[i] = m_buckets[i].load(std::memory_order_acquire);
+            count += histogram.m_buckets[i];
+        }
+
+        histogram.m_count = count;
+        histogram.m_min = m_min.load(std::memory_order_relaxed);
+        histogram.m_max = m_max.load(std::memory_order_relaxed);
+        histogram.m_sum = static_cast<double>(m_sum.load(std::memory_order_relaxed));
+    }
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace video
+{
+    //
+    // Fixed-size histogram with logarithmic buckets: each power of two is split
+    // into 16 linear sub-buckets, so any value is recorded with an error below 6.25%.
+    // Add never allocates
+    //
+    class LogHistogram
+    {
+    public:
+        static constexpr size_t SubBucketBits = 4;
+        static constexpr size_t SubBucketCount = size_t(1) << SubBucketBits;
+        static constexpr size_t BucketCount = (64 - SubBucketBits + 1) * SubBucketCount;
+
+        LogHistogram() noexcept;
+
+        void Add(uint64_t value) noexcept;
+        void Merge(const LogHistogram& other) noexcept;
+        void Reset() noexcept;
+
+        uint64_t Count() const noexcept { return m_count; }
+        uint64_t Min() const noexcept { return m_count ? m_min : 0; }
+        uint64_t Max() const noexcept { return m_max; }
+        double Mean() const noexcept;
+
+        //
+        // fraction is in [0, 1], the result is the middle of the bucket
+        // holding the value of that rank, clamped to the recorded range
+        //
+        uint64_t Percentile(double fraction) const noexcept;
+
+        static size_t BucketIndex(uint64_t value) noexcept;
+        static uint64_t BucketLowerBound(size_t index) noexcept;
+        static uint64_t BucketUpperBound(size_t index) noexcept;
+
+    private:
+        friend class AtomicLogHistogram;
+
+        uint64_t m_buckets[BucketCount];
+        uint64_t m_count;
+        uint64_t m_min;
+        uint64_t m_max;
+        double m_sum;
+    };
+
+    //
+    // LogHistogram for many writers, Add is lock-free. Snapshot may run
+    // along with Add and misses only the values added during the copy
+    //
+    class AtomicLogHistogram
+    {
+    public:
+        AtomicLogHistogram() noexcept;
+
+        AtomicLogHistogram(const AtomicLogHistogram&) = delete;
+        AtomicLogHistogram& operator=(const AtomicLogHistogram&) = delete;
+
+        void Add(uint64_t value) noexcept;
+
+        //
+        // Not concurrent with Add
+        //
+        void Reset() noexcept;
+
+        void Snapshot(LogHistogram& histogram) const noexcept;
+
+    private:
+        std::atomic<uint64_t> m_buckets[LogHistogram::BucketCount];
+        std::atomic<uint64_t> m_min;
+        std::atomic<uint64_t> m_max;
+        std::atomic<uint64_t> m_sum;
+    };
+}
@@ -1,23 +1,42 @@
-#pragma once
-
-#include "ComUtils.h"
-
-namespace mf
-{
-    class MFAttributes
-    {
-    public:
-        explicit MFAttributes(ComPtr<IMFAttributes> ptr);
-
-        std::wstring GetString(const GUID& key) const;
-        std::wstring GetGuidName(const GUID& key) const;
-
-        uint32_t GetUint32(const GUID& key, uint32_t def = 0) const;
-        HRESULT GetBlob(const GUID& key, std::vector<UINT8>& data) const;
-
-        static std::wstring GuidToName(const GUID& guid);
-
-    private:
-        ComPtr<IMFAttributes> m_ptr;
-    };
-}
+#pragma once
+
+#include <array>
+#include <string_view>
+#include "ComUtils.h"
+#include "AttributeSnapshot.h"
+
+namespace mf
+{
+    //
+    // Fits "{xxxxxxxx-xxxx-xxxx-xxxx-xxxxxxxxxxxx}" with the terminating zero
+    //
+    using GuidString = std::array<wchar_t, 39>;
+
+    class MFAttributes
+    {
+    public:
+        explicit MFAttributes(ComPtr<IMFAttributes> ptr);
+
+        std::wstring GetString(const GUID& key) const;
+        std::wstring GetGuidName(const GUID& key) const;
+
+        uint32_t GetUint32(const GUID& key, uint32_t def = 0) const;
+        HRESULT GetBlob(const GUID& key, std::vector<UINT8>& data) const;
+
+        //
+        // Copies every item in one pass under LockStore,
+        // use it when more than a couple of attributes are read
+        //
+        HRESULT GetSnapshot(utils::AttributeSnapshot& snapshot) const;
+
+        //
+        // Returns the registered name of the guid,
+        // unknown guids are formatted into the 'unknown' buffer
+        //
+        static std::wstring_view GuidToName(const GUID& guid, GuidString& unknown);
+        static std::wstring GuidToName(const GUID& guid);
+
+    private:
+        ComPtr<IMFAttributes> m_ptr;
+    };
+}
@@ -0,0 +1,895 @@
+#include "stdafx.h"
+#include "MFBackend.h"
+#include "MFAttributes.h"
+#include "MFVideoFormat.h"
+#include "PixelConvert.h"
+#include "StreamDispatcher.h"
+#include "TimingAnalyzer.h"
+#include <cfgmgr32.h>
+#include <devpkey.h>
+
+using namespace Microsoft::WRL::Wrappers;
+
+namespace
+{
+    //
+    // How long to wait for the requests in flight after the capture is stopped
+    //
+    constexpr DWORD FlushTimeoutMs = 5000;
+
+    uint64_t HashBytes(uint64_t hash, const void* data, size_t size) noexcept
+    {
+        //
+        // FNV-1a
+        //
+        auto bytes = static_cast<const uint8_t*>(data);
+
+        for (size_t i = 0; i < size; ++i)
+        {
+            hash = (hash ^ bytes[i]) * 0x100000001b3ull;
+        }
+
+        return hash;
+    }
+}
+
+namespace mf
+{
+    HRESULT CreateSourceReader(
+        MFActivate& pActivate,
+        IMFSourceReaderCallback* pCallback,
+        ComPtr<IMFSourceReader>& pReader)
+    {
+        ComPtr<IMFMediaSource> pSource;
+        HRCHK(pActivate->ActivateObject(
+            __uuidof(IMFMediaSource),
+            reinterpret_cast<void**>(pSource.GetAddressOf())));
+
+        ComPtr<IMFAttributes> pAttributes;
+        HRCHK(MFCreateAttributes(&pAttributes, 10));
+        HRCHK(pAttributes->SetUINT32(MF_READWRITE_ENABLE_HARDWARE_TRANSFORMS, TRUE));
+        HRCHK(pAttributes->SetUINT32(MF_SOURCE_READER_DISABLE_DXVA, FALSE));
+        HRCHK(pAttributes->SetUINT32(MF_SOURCE_READER_ENABLE_VIDEO_PROCESSING, FALSE));
+        HRCHK(pAttributes->SetUINT32(MF_SOURCE_READER_ENABLE_ADVANCED_VIDEO_PROCESSING, TRUE));
+        HRCHK(pAttributes->SetUnknown(MF_SOURCE_READER_ASYNC_CALLBACK, pCallback));
+
+        ComPtr<IMFSourceReader> pVideoFileSource;
+        HRCHK(MFCreateSourceReaderFromMediaSource(
+            pSource.Get(),
+            pAttributes.Get(),
+            pVideoFileSource.GetAddressOf()));
+
+        pReader = std::move(pVideoFileSource);
+        return S_OK;
+    }
+
+    HRESULT SelectMediaType(
+        IMFSourceReader* pReader,
+        ULONG streamId,
+        ULONG mediaId,
+        ComPtr<IMFMediaType>& pNativeType,
+        ComPtr<IMFMediaType>& pType)
+    {
+        ComPtr<IMFMediaType> pNative;
+        HRCHK(pReader->GetNativeMediaType(
+            streamId,
+            mediaId,
+            pNative.GetAddressOf()));
+
+        ComPtr<IMFMediaType> pCurrent;
+        HRCHK(MFCreateMediaType(&pCurrent));
+        HRCHK(pNative->CopyAllItems(pCurrent.Get()));
+
+        GUID subtype = GUID_NULL;
+        HRCHK(pCurrent->GetGUID(MF_MT_SUBTYPE, &subtype));
+
+        if (!video::PixelConverter::IsSupported(ToPixelFormat(subtype), video::PixelFormat::RGB32))
+        {
+            //
+            // Compressed or exotic formats are decoded by Media Foundation
+            //
+            HRCHK(pCurrent->SetGUID(MF_MT_SUBTYPE, MFVideoFormat_YUY2));
+        }
+
+        HRCHK(pReader->SetCurrentMediaType(streamId, NULL, pCurrent.Get()));
+
+        pNativeType = std::move(pNative);
+        pType = std::move(pCurrent);
+        return S_OK;
+    }
+
+    HRESULT OpenSourceReader(
+        MFActivate& pActivate,
+        IMFSourceReaderCallback* pCallback,
+        ULONG streamId,
+        ULONG mediaId,
+        ComPtr<IMFSourceReader>& pReader,
+        ComPtr<IMFMediaType>& pNativeType,
+        ComPtr<IMFMediaType>& pType)
+    {
+        ComPtr<IMFSourceReader> pVideoFileSource;
+        HRCHK(CreateSourceReader(pActivate, pCallback, pVideoFileSource));
+
+        HRCHK(pVideoFileSource->SetStreamSelection(static_cast<DWORD>(MF_SOURCE_READER_ALL_STREAMS), FALSE));
+        HRCHK(pVideoFileSource->SetStreamSelection(streamId, TRUE));
+        HRCHK(SelectMediaType(pVideoFileSource.Get(), streamId, mediaId, pNativeType, pType));
+
+        pReader = std::move(pVideoFileSource);
+        return S_OK;
+    }
+
+    HRESULT GetMediaTypeInfo(IMFMediaType* pType, uint32_t index, capture::MediaTypeInfo& info)
+    {
+        GUID subtype = GUID_NULL;
+        HRCHK(pType->GetGUID(MF_MT_SUBTYPE, &subtype));
+
+        UINT32 width = 0;
+        UINT32 height = 0;
+        MFGetAttributeSize(pType, MF_MT_FRAME_SIZE, &width, &height);
+
+        UINT32 fpsNumerator = 0;
+        UINT32 fpsDenominator = 0;
+        MFGetAttributeRatio(pType, MF_MT_FRAME_RATE, &fpsNumerator, &fpsDenominator);
+
+        info.index = index;
+        info.subtype = MFAttributes::GuidToName(subtype);
+        info.format = ToPixelFormat(subtype);
+        info.width = width;
+        info.height = height;
+        info.fpsNumerator = fpsNumerator;
+        info.fpsDenominator = fpsDenominator;
+        info.defaultStride = static_cast<INT32>(MFGetAttributeUINT32(pType, MF_MT_DEFAULT_STRIDE, 0));
+        info.colorSpace = GetColorSpace(pType);
+        return S_OK;
+    }
+
+    int64_t TimestampToHost(LONGLONG timestamp) noexcept
+    {
+        //
+        // Both clocks are read back to back, the offset between them
+        // is exact to the time between the two calls
+        //
+        const int64_t host = video::TimingAnalyzer::Now();
+        const int64_t system = MFGetSystemTime();
+        return host + (timestamp - system) * 100;
+    }
+
+    //
+    // MFFrameSource
+    //
+
+    MFFrameSource::MFFrameSource() noexcept
+        : m_sink(nullptr)
+        , m_streamIndex(0)
+        , m_done(CreateEvent(NULL, TRUE, FALSE, NULL))
+        , m_flushed(CreateEvent(NULL, TRUE, FALSE, NULL))
+        , m_hr(S_OK)
+        , m_stopping(false)
+    {
+    }
+
+    MFFrameSource::~MFFrameSource()
+    {
+        Stop();
+
+        //
+        // The reader holds a pointer to this callback
+        //
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_pVideoSource.Reset();
+    }
+
+    HRESULT MFFrameSource::Open(MFActivate& pActivate, ULONG streamIndex, ULONG mediaTypeIndex)
+    {
+        if (!m_done.IsValid() || !m_flushed.IsValid())
+        {
+            return E_HANDLE;
+        }
+
+        ComPtr<IMFSourceReader> pVideoSource;
+        ComPtr<IMFMediaType> pNativeType;
+        ComPtr<IMFMediaType> pType;
+        HRCHK(OpenSourceReader(pActivate, this, streamIndex, mediaTypeIndex, pVideoSource, pNativeType, pType));
+
+        capture::MediaTypeInfo info;
+        HRCHK(GetMediaTypeInfo(pType.Get(), mediaTypeIndex, info));
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_mediaType = info;
+        m_sampleAccess.SetFormat(info.format, info.width, info.height, info.defaultStride);
+        m_pVideoSource = pVideoSource;
+        m_streamIndex = streamIndex;
+        return S_OK;
+    }
+
+    const capture::MediaTypeInfo& MFFrameSource::GetMediaType() const noexcept
+    {
+        return m_mediaType;
+    }
+
+    HRESULT MFFrameSource::Start(video::FrameSink& sink, uint32_t readDepth)
+    {
+        if (0 == readDepth)
+        {
+            return E_INVALIDARG;
+        }
+
+        ComPtr<IMFSourceReader> pVideoSource;
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+
+            if (!m_pVideoSource)
+            {
+                return E_UNEXPECTED;
+            }
+
+            m_sink = &sink;
+            m_hr = S_OK;
+            m_stopping = false;
+            m_sampleAccess.ResetStatistics();
+            ResetEvent(m_done.Get());
+            ResetEvent(m_flushed.Get());
+            pVideoSource = m_pVideoSource;
+        }
+
+        for (uint32_t i = 0; i < readDepth; ++i)
+        {
+            HRCHK(pVideoSource->ReadSample(m_streamIndex, 0, NULL, NULL, NULL, NULL));
+        }
+
+        return S_OK;
+    }
+
+    HRESULT MFFrameSource::Wait(uint32_t timeoutMs)
+    {
+        const DWORD res = WaitForSingleObject(m_done.Get(), timeoutMs);
+
+        if (res != WAIT_OBJECT_0)
+        {
+            return S_FALSE;
+        }
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_hr;
+    }
+
+    int64_t MFFrameSource::TimestampToHost(int64_t timestamp) const noexcept
+    {
+        return mf::TimestampToHost(timestamp);
+    }
+
+    HRESULT MFFrameSource::Stop()
+    {
+        ComPtr<IMFSourceReader> pVideoSource;
+
+        {
+            //
+            // Samples delivered after this point are not passed to the sink
+            //
+            std::lock_guard<std::mutex> lock(m_mutex);
+
+            if (m_stopping || !m_sink)
+            {
+                return S_OK;
+            }
+
+            m_stopping = true;
+            m_sink = nullptr;
+            pVideoSource = m_pVideoSource;
+        }
+
+        //
+        // Flush completes the requests in flight before the reader is released
+        //
+        if (pVideoSource && SUCCEEDED(pVideoSource->Flush(m_streamIndex)))
+        {
+            WaitForSingleObject(m_flushed.Get(), FlushTimeoutMs);
+        }
+
+        return S_OK;
+    }
+
+    STDMETHODIMP MFFrameSource::QueryInterface(REFIID iid, void** ppv)
+    {
+        static const QITAB qit[] =
+        {
+            QITABENT(MFFrameSource, IMFSourceReaderCallback),
+            { 0 },
+        };
+        return QISearch(this, qit, iid, ppv);
+    }
+
+    STDMETHODIMP_(ULONG) MFFrameSource::AddRef()
+    {
+        return 1;
+    }
+
+    STDMETHODIMP_(ULONG) MFFrameSource::Release()
+    {
+        return 1;
+    }
+
+    STDMETHODIMP MFFrameSource::OnReadSample(
+        HRESULT hrStatus,
+        DWORD dwStreamIndex,
+        DWORD dwStreamFlags,
+        LONGLONG llTimestamp,
+        IMFSample *pSample)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        if (m_stopping || !m_sink || !m_pVideoSource)
+        {
+            return S_OK;
+        }
+
+        if (FAILED(hrStatus))
+        {
+            m_hr = hrStatus;
+            SetEvent(m_done.Get());
+            return hrStatus;
+        }
+
+        if (MF_SOURCE_READERF_ENDOFSTREAM & dwStreamFlags)
+        {
+            SetEvent(m_done.Get());
+            return S_OK;
+        }
+
+        if (pSample)
+        {
+            video::FrameView view;
+
+            if (SUCCEEDED(m_sampleAccess.Lock(pSample, view)))
+            {
+                m_sink->OnFrame(view, llTimestamp);
+                m_sampleAccess.Unlock();
+            }
+        }
+
+        HRESULT hr = m_pVideoSource->ReadSample(dwStreamIndex, 0, NULL, NULL, NULL, NULL);
+
+        if (FAILED(hr))
+        {
+            m_hr = hr;
+            SetEvent(m_done.Get());
+        }
+
+        return hr;
+    }
+
+    STDMETHODIMP MFFrameSource::OnEvent(DWORD, IMFMediaEvent *)
+    {
+        return S_OK;
+    }
+
+    STDMETHODIMP MFFrameSource::OnFlush(DWORD streamIndex)
+    {
+        UNREFERENCED_PARAMETER(streamIndex);
+        SetEvent(m_flushed.Get());
+        return S_OK;
+    }
+
+    //
+    // MFMultiStreamSource
+    //
+
+    MFMultiStreamSource::MFMultiStreamSource() noexcept
+        : m_dispatcher(nullptr)
+        , m_done(CreateEvent(NULL, TRUE, FALSE, NULL))
+        , m_flushed(CreateEvent(NULL, TRUE, FALSE, NULL))
+        , m_ended(0)
+        , m_hr(S_OK)
+        , m_stopping(false)
+    {
+    }
+
+    MFMultiStreamSource::~MFMultiStreamSource()
+    {
+        Stop();
+
+        //
+        // The reader holds a pointer to this callback
+        //
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_pVideoSource.Reset();
+    }
+
+    HRESULT MFMultiStreamSource::Open(MFActivate& pActivate, const std::vector<capture::StreamSelection>& selections)
+    {
+        if (!m_done.IsValid() || !m_flushed.IsValid())
+        {
+            return E_HANDLE;
+        }
+
+        HRCHK(capture::CheckStreamSelections(selections));
+
+        ComPtr<IMFSourceReader> pVideoSource;
+        HRCHK(CreateSourceReader(pActivate, this, pVideoSource));
+        HRCHK(pVideoSource->SetStreamSelection(static_cast<DWORD>(MF_SOURCE_READER_ALL_STREAMS), FALSE));
+
+        std::vector<std::unique_ptr<Stream>> streams;
+
+        for (const auto& selection : selections)
+        {
+            HRCHK(pVideoSource->SetStreamSelection(selection.streamIndex, TRUE));
+
+            ComPtr<IMFMediaType> pNativeType;
+            ComPtr<IMFMediaType> pType;
+            HRCHK(SelectMediaType(pVideoSource.Get(), selection.streamIndex, selection.mediaTypeIndex, pNativeType, pType));
+
+            std::unique_ptr<Stream> stream(new Stream());
+            HRCHK(GetMediaTypeInfo(pType.Get(), selection.mediaTypeIndex, stream->mediaType));
+
+            const auto& info = stream->mediaType;
+            stream->sampleAccess.SetFormat(info.format, info.width, info.height, info.defaultStride);
+            stream->streamIndex = selection.streamIndex;
+            stream->ended = false;
+            streams.push_back(std::move(stream));
+        }
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_streams = std::move(streams);
+        m_pVideoSource = pVideoSource;
+        return S_OK;
+    }
+
+    size_t MFMultiStreamSource::GetStreamCount() const noexcept
+    {
+        return m_streams.size();
+    }
+
+    uint32_t MFMultiStreamSource::GetStreamIndex(size_t stream) const noexcept
+    {
+        return m_streams[stream]->streamIndex;
+    }
+
+    const capture::MediaTypeInfo& MFMultiStreamSource::GetMediaType(size_t stream) const noexcept
+    {
+        return m_streams[stream]->mediaType;
+    }
+
+    HRESULT MFMultiStreamSource::Start(capture::StreamDispatcher& dispatcher, uint32_t readDepth)
+    {
+        if (0 == readDepth)
+        {
+            return E_INVALIDARG;
+        }
+
+        ComPtr<IMFSourceReader> pVideoSource;
+        std::vector<ULONG> streamIndexes;
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+
+            if (!m_pVideoSource)
+            {
+                return E_UNEXPECTED;
+            }
+
+            m_dispatcher = &dispatcher;
+            m_hr = S_OK;
+            m_ended = 0;
+            m_stopping = false;
+            ResetEvent(m_done.Get());
+            ResetEvent(m_flushed.Get());
+            pVideoSource = m_pVideoSource;
+
+            for (auto& stream : m_streams)
+            {
+                stream->ended = false;
+                stream->sampleAccess.ResetStatistics();
+                streamIndexes.push_back(stream->streamIndex);
+            }
+        }
+
+        //
+        // Requests of the streams are interleaved, so none of them starts late
+        //
+        for (uint32_t i = 0; i < readDepth; ++i)
+        {
+            for (ULONG streamIndex : streamIndexes)
+            {
+                HRCHK(pVideoSource->ReadSample(streamIndex, 0, NULL, NULL, NULL, NULL));
+            }
+        }
+
+        return S_OK;
+    }
+
+    HRESULT MFMultiStreamSource::Wait(uint32_t timeoutMs)
+    {
+        const DWORD res = WaitForSingleObject(m_done.Get(), timeoutMs);
+
+        if (res != WAIT_OBJECT_0)
+        {
+            return S_FALSE;
+        }
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_hr;
+    }
+
+    HRESULT MFMultiStreamSource::Stop()
+    {
+        ComPtr<IMFSourceReader> pVideoSource;
+
+        {
+            //
+            // Samples delivered after this point are not dispatched
+            //
+            std::lock_guard<std::mutex> lock(m_mutex);
+
+            if (m_stopping || !m_dispatcher)
+            {
+                return S_OK;
+            }
+
+            m_stopping = true;
+            m_dispatcher = nullptr;
+            pVideoSource = m_pVideoSource;
+        }
+
+        //
+        // One OnFlush for all the streams
+        //
+        if (pVideoSource && SUCCEEDED(pVideoSource->Flush(static_cast<DWORD>(MF_SOURCE_READER_ALL_STREAMS))))
+        {
+            WaitForSingleObject(m_flushed.Get(), FlushTimeoutMs);
+        }
+
+        return S_OK;
+    }
+
+    STDMETHODIMP MFMultiStreamSource::QueryInterface(REFIID iid, void** ppv)
+    {
+        static const QITAB qit[] =
+        {
+            QITABENT(MFMultiStreamSource, IMFSourceReaderCallback),
+            { 0 },
+        };
+        return QISearch(this, qit, iid, ppv);
+    }
+
+    STDMETHODIMP_(ULONG) MFMultiStreamSource::AddRef()
+    {
+        return 1;
+    }
+
+    STDMETHODIMP_(ULONG) MFMultiStreamSource::Release()
+    {
+        return 1;
+    }
+
+    STDMETHODIMP MFMultiStreamSource::OnReadSample(
+        HRESULT hrStatus,
+        DWORD dwStreamIndex,
+        DWORD dwStreamFlags,
+        LONGLONG llTimestamp,
+        IMFSample *pSample)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        if (m_stopping || !m_dispatcher || !m_pVideoSource)
+        {
+            return S_OK;
+        }
+
+        if (FAILED(hrStatus))
+        {
+            Fail(hrStatus);
+            return hrStatus;
+        }
+
+        Stream* stream = nullptr;
+
+        for (auto& item : m_streams)
+        {
+            if (item->streamIndex == dwStreamIndex)
+            {
+                stream = item.get();
+                break;
+            }
+        }
+
+        if (!stream)
+        {
+            //
+            // Not a selected stream, nothing to request again
+            //
+            return S_OK;
+        }
+
+        if (MF_SOURCE_READERF_ENDOFSTREAM & dwStreamFlags)
+        {
+            if (!stream->ended)
+            {
+                stream->ended = true;
+                m_ended += 1;
+            }
+
+            if (m_ended == m_streams.size())
+            {
+                SetEvent(m_done.Get());
+            }
+
+            return S_OK;
+        }
+
+        if (pSample)
+        {
+            video::FrameView view;
+
+            if (SUCCEEDED(stream->sampleAccess.Lock(pSample, view)))
+            {
+                m_dispatcher->OnFrame(dwStreamIndex, view, llTimestamp);
+                stream->sampleAccess.Unlock();
+            }
+        }
+
+        HRESULT hr = m_pVideoSource->ReadSample(dwStreamIndex, 0, NULL, NULL, NULL, NULL);
+
+        if (FAILED(hr))
+        {
+            Fail(hr);
+        }
+
+        return hr;
+    }
+
+    STDMETHODIMP MFMultiStreamSource::OnEvent(DWORD, IMFMediaEvent *)
+    {
+        return S_OK;
+    }
+
+    STDMETHODIMP MFMultiStreamSource::OnFlush(DWORD streamIndex)
+    {
+        UNREFERENCED_PARAMETER(streamIndex);
+        SetEvent(m_flushed.Get());
+        return S_OK;
+    }
+
+    void MFMultiStreamSource::Fail(HRESULT hr) noexcept
+    {
+        //
+        // Called under the lock, the first error is reported
+        //
+        if (SUCCEEDED(m_hr))
+        {
+            m_hr = hr;
+        }
+
+        SetEvent(m_done.Get());
+    }
+
+    //
+    // MFDevice
+    //
+
+    MFDevice::MFDevice(MFActivate pActivate) noexcept
+        : m_pActivate(std::move(pActivate))
+    {
+    }
+
+    std::wstring MFDevice::GetFriendlyName() const
+    {
+        MFAttributes attr(m_pActivate);
+        return attr.GetString(MF_DEVSOURCE_ATTRIBUTE_FRIENDLY_NAME);
+    }
+
+    std::wstring MFDevice::GetSymbolicLink() const
+    {
+        MFAttributes attr(m_pActivate);
+        return attr.GetString(MF_DEVSOURCE_ATTRIBUTE_SOURCE_TYPE_VIDCAP_SYMBOLIC_LINK);
+    }
+
+    uint64_t MFDevice::GetFingerprint() const
+    {
+        //
+        // The device node behind the interface carries the driver version and date
+        //
+        const std::wstring symbolicLink = GetSymbolicLink();
+
+        DEVPROPTYPE type = 0;
+        WCHAR instanceId[MAX_DEVICE_ID_LEN] = {};
+        ULONG size = sizeof(instanceId);
+
+        if (CR_SUCCESS != CM_Get_Device_Interface_PropertyW(
+            symbolicLink.c_str(),
+            &DEVPKEY_Device_InstanceId,
+            &type,
+            reinterpret_cast<PBYTE>(instanceId),
+            &size,
+            0))
+        {
+            return 0;
+        }
+
+        DEVINST devInst = 0;
+
+        if (CR_SUCCESS != CM_Locate_DevNodeW(&devInst, instanceId, CM_LOCATE_DEVNODE_NORMAL))
+        {
+            return 0;
+        }
+
+        WCHAR driverVersion[256] = {};
+        size = sizeof(driverVersion);
+
+        if (CR_SUCCESS != CM_Get_DevNode_PropertyW(
+            devInst,
+            &DEVPKEY_Device_DriverVersion,
+            &type,
+            reinterpret_cast<PBYTE>(driverVersion),
+            &size,
+            0))
+        {
+            return 0;
+        }
+
+        FILETIME driverDate = {};
+        size = sizeof(driverDate);
+        CM_Get_DevNode_PropertyW(
+            devInst,
+            &DEVPKEY_Device_DriverDate,
+            &type,
+            reinterpret_cast<PBYTE>(&driverDate),
+            &size,
+            0);
+
+        uint64_t hash = 0xcbf29ce484222325ull;
+        hash = HashBytes(hash, instanceId, wcslen(instanceId) * sizeof(WCHAR));
+        hash = HashBytes(hash, driverVersion, wcslen(driverVersion) * sizeof(WCHAR));
+        hash = HashBytes(hash, &driverDate, sizeof(driverDate));
+
+        //
+        // 0 means unknown
+        //
+        return hash ? hash : 1;
+    }
+
+    HRESULT MFDevice::GetStreams(std::vector<capture::StreamInfo>& streams)
+    {
+        ComPtr<IMFMediaSource> pSource;
+        HRCHK(m_pActivate->ActivateObject(
+            __uuidof(IMFMediaSource),
+            reinterpret_cast<void**>(pSource.GetAddressOf())));
+
+        ComPtr<IMFSourceReader> pVideoFileSource;
+        HRCHK(MFCreateSourceReaderFromMediaSource(
+            pSource.Get(),
+            NULL,
+            pVideoFileSource.GetAddressOf()));
+
+        HRCHK(pVideoFileSource->SetStreamSelection(
+            static_cast<DWORD>(MF_SOURCE_READER_ALL_STREAMS),
+            TRUE));
+
+        streams.clear();
+
+        DWORD dwMediaTypeTest = 0;
+        DWORD dwStreamTest = 0;
+        HRESULT hr = S_OK;
+
+        while (SUCCEEDED(hr))
+        {
+            ComPtr<IMFMediaType> pType;
+            hr = pVideoFileSource->GetNativeMediaType(
+                dwStreamTest,
+                dwMediaTypeTest,
+                pType.GetAddressOf());
+
+            if (hr == MF_E_NO_MORE_TYPES)
+            {
+                hr = S_OK;
+                dwMediaTypeTest = 0;
+                ++dwStreamTest;
+                continue;
+            }
+
+            if (hr == MF_E_INVALIDSTREAMNUMBER)
+            {
+                break;
+            }
+
+            if (SUCCEEDED(hr))
+            {
+                if (streams.empty() || streams.back().index != dwStreamTest)
+                {
+                    streams.emplace_back();
+                    streams.back().index = dwStreamTest;
+                }
+
+                capture::MediaTypeInfo info;
+
+                if (SUCCEEDED(GetMediaTypeInfo(pType.Get(), dwMediaTypeTest, info)))
+                {
+                    streams.back().mediaTypes.push_back(std::move(info));
+                }
+            }
+
+            ++dwMediaTypeTest;
+        }
+
+        return S_OK;
+    }
+
+    HRESULT MFDevice::OpenFrameSource(
+        uint32_t streamIndex,
+        uint32_t mediaTypeIndex,
+        std::unique_ptr<capture::FrameSource>& source)
+    {
+        std::unique_ptr<MFFrameSource> mfSource(new MFFrameSource());
+        HRCHK(mfSource->Open(m_pActivate, streamIndex, mediaTypeIndex));
+
+        source = std::move(mfSource);
+        return S_OK;
+    }
+
+    HRESULT MFDevice::OpenMultiStreamSource(
+        const std::vector<capture::StreamSelection>& selections,
+        std::unique_ptr<capture::MultiStreamSource>& source)
+    {
+        std::unique_ptr<MFMultiStreamSource> mfSource(new MFMultiStreamSource());
+        HRCHK(mfSource->Open(m_pActivate, selections));
+
+        source = std::move(mfSource);
+        return S_OK;
+    }
+
+    MFActivate& MFDevice::GetActivate() noexcept
+    {
+        return m_pActivate;
+    }
+
+    //
+    // MFBackend
+    //
+
+    MFBackend::MFBackend()
+    {
+        //
+        // Without notifications the device list is cached until InvalidateDevices
+        //
+        m_sources.GetRegistry().WatchDevices();
+    }
+
+    const wchar_t* MFBackend::GetName() const noexcept
+    {
+        return L"mf";
+    }
+
+    HRESULT MFBackend::EnumDevices(capture::DeviceList& devices)
+    {
+        MFActivateList devs;
+        HRCHK(m_sources.EnumDevice(devs));
+
+        devices.clear();
+
+        for (auto& dev : devs)
+        {
+            devices.push_back(std::make_shared<MFDevice>(dev));
+        }
+
+        return S_OK;
+    }
+
+    void MFBackend::InvalidateDevices() noexcept
+    {
+        m_sources.GetRegistry().Invalidate();
+    }
+
+    HRESULT MFBackend::AttachThread() noexcept
+    {
+        //
+        // Source readers and activation objects are free threaded,
+        // S_FALSE for a thread in the apartment already is balanced too
+        //
+        return CoInitializeEx(NULL, COINIT_MULTITHREADED);
+    }
+
+    void MFBackend::DetachThread() noexcept
+    {
+        CoUninitialize();
+    }
+}
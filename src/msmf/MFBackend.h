@@ -0,0 +1,200 @@
+#pragma once
+#include <windows.h>
+#include <shlwapi.h>
+#include <wrl.h>
+#include <mfreadwrite.h>
+#include <mutex>
+#include "ComUtils.h"
+#include "MediaSource.h"
+#include "MFSampleAccess.h"
+#include "CaptureBackend.h"
+
+namespace mf
+{
+    //
+    // An asynchronous source reader of the device, the caller selects the streams
+    //
+    HRESULT CreateSourceReader(
+        MFActivate& pActivate,
+        IMFSourceReaderCallback* pCallback,
+        ComPtr<IMFSourceReader>& pReader);
+
+    //
+    // Sets the current media type of a stream from its native media type mediaId,
+    // formats the converters cannot consume are decoded to YUY2
+    //
+    HRESULT SelectMediaType(
+        IMFSourceReader* pReader,
+        ULONG streamId,
+        ULONG mediaId,
+        ComPtr<IMFMediaType>& pNativeType,
+        ComPtr<IMFMediaType>& pType);
+
+    //
+    // Creates an asynchronous source reader for one stream of the device.
+    // pNativeType is the selected native media type, pType is the current one:
+    // formats the converters cannot consume are decoded to YUY2
+    //
+    HRESULT OpenSourceReader(
+        MFActivate& pActivate,
+        IMFSourceReaderCallback* pCallback,
+        ULONG streamId,
+        ULONG mediaId,
+        ComPtr<IMFSourceReader>& pReader,
+        ComPtr<IMFMediaType>& pNativeType,
+        ComPtr<IMFMediaType>& pType);
+
+    HRESULT GetMediaTypeInfo(IMFMediaType* pType, uint32_t index, capture::MediaTypeInfo& info);
+
+    //
+    // Capture devices stamp the samples with the Media Foundation system clock,
+    // returns the sample time on the host steady clock (TimingAnalyzer::Now)
+    //
+    int64_t TimestampToHost(LONGLONG timestamp) noexcept;
+
+    //
+    // Source reader frame delivery behind capture::FrameSource
+    //
+    class MFFrameSource : public capture::FrameSource, public IMFSourceReaderCallback
+    {
+    public:
+        MFFrameSource() noexcept;
+        ~MFFrameSource();
+
+        MFFrameSource(MFFrameSource&&) = delete;
+        MFFrameSource& operator=(MFFrameSource&&) = delete;
+
+        HRESULT Open(MFActivate& pActivate, ULONG streamIndex, ULONG mediaTypeIndex);
+
+        const capture::MediaTypeInfo& GetMediaType() const noexcept override;
+        HRESULT Start(video::FrameSink& sink, uint32_t readDepth) override;
+        HRESULT Wait(uint32_t timeoutMs) override;
+        HRESULT Stop() override;
+        int64_t TimestampToHost(int64_t timestamp) const noexcept override;
+
+    private:
+        STDMETHODIMP QueryInterface(REFIID iid, void** ppv) override;
+        STDMETHODIMP_(ULONG) AddRef() override;
+        STDMETHODIMP_(ULONG) Release() override;
+        STDMETHODIMP OnReadSample(
+            HRESULT hrStatus,
+            DWORD dwStreamIndex,
+            DWORD dwStreamFlags,
+            LONGLONG llTimestamp,
+            IMFSample *pSample) override;
+        STDMETHODIMP OnEvent(DWORD, IMFMediaEvent*) override;
+        STDMETHODIMP OnFlush(DWORD streamIndex) override;
+
+    private:
+        std::mutex m_mutex;
+        video::FrameSink* m_sink;
+        SampleAccess m_sampleAccess;
+        capture::MediaTypeInfo m_mediaType;
+        ComPtr<IMFSourceReader> m_pVideoSource;
+        ULONG m_streamIndex;
+        Microsoft::WRL::Wrappers::Event m_done;
+        Microsoft::WRL::Wrappers::Event m_flushed;
+        HRESULT m_hr;
+        bool m_stopping;
+    };
+
+    //
+    // Several streams of the device on one source reader, every stream
+    // keeps its own requests in flight and its own sample access
+    //
+    class MFMultiStreamSource : public capture::MultiStreamSource, public IMFSourceReaderCallback
+    {
+    public:
+        MFMultiStreamSource() noexcept;
+        ~MFMultiStreamSource();
+
+        MFMultiStreamSource(MFMultiStreamSource&&) = delete;
+        MFMultiStreamSource& operator=(MFMultiStreamSource&&) = delete;
+
+        HRESULT Open(MFActivate& pActivate, const std::vector<capture::StreamSelection>& selections);
+
+        size_t GetStreamCount() const noexcept override;
+        uint32_t GetStreamIndex(size_t stream) const noexcept override;
+        const capture::MediaTypeInfo& GetMediaType(size_t stream) const noexcept override;
+        HRESULT Start(capture::StreamDispatcher& dispatcher, uint32_t readDepth) override;
+        HRESULT Wait(uint32_t timeoutMs) override;
+        HRESULT Stop() override;
+
+    private:
+        STDMETHODIMP QueryInterface(REFIID iid, void** ppv) override;
+        STDMETHODIMP_(ULONG) AddRef() override;
+        STDMETHODIMP_(ULONG) Release() override;
+        STDMETHODIMP OnReadSample(
+            HRESULT hrStatus,
+            DWORD dwStreamIndex,
+            DWORD dwStreamFlags,
+            LONGLONG llTimestamp,
+            IMFSample *pSample) override;
+        STDMETHODIMP OnEvent(DWORD, IMFMediaEvent*) override;
+        STDMETHODIMP OnFlush(DWORD streamIndex) override;
+
+        void Fail(HRESULT hr) noexcept;
+
+    private:
+        struct Stream
+        {
+            ULONG streamIndex;
+            capture::MediaTypeInfo mediaType;
+            SampleAccess sampleAccess;
+            bool ended;
+        };
+
+        std::mutex m_mutex;
+        capture::StreamDispatcher* m_dispatcher;
+        std::vector<std::unique_ptr<Stream>> m_streams;
+        ComPtr<IMFSourceReader> m_pVideoSource;
+        Microsoft::WRL::Wrappers::Event m_done;
+        Microsoft::WRL::Wrappers::Event m_flushed;
+        size_t m_ended;
+        HRESULT m_hr;
+        bool m_stopping;
+    };
+
+    class MFDevice : public capture::Device
+    {
+    public:
+        explicit MFDevice(MFActivate pActivate) noexcept;
+
+        std::wstring GetFriendlyName() const override;
+        std::wstring GetSymbolicLink() const override;
+        uint64_t GetFingerprint() const override;
+
+        HRESULT GetStreams(std::vector<capture::StreamInfo>& streams) override;
+        HRESULT OpenFrameSource(
+            uint32_t streamIndex,
+            uint32_t mediaTypeIndex,
+            std::unique_ptr<capture::FrameSource>& source) override;
+        HRESULT OpenMultiStreamSource(
+            const std::vector<capture::StreamSelection>& selections,
+            std::unique_ptr<capture::MultiStreamSource>& source) override;
+
+        MFActivate& GetActivate() noexcept;
+
+    private:
+        MFActivate m_pActivate;
+    };
+
+    class MFBackend : public capture::Backend
+    {
+    public:
+        MFBackend();
+
+        const wchar_t* GetName() const noexcept override;
+        HRESULT EnumDevices(capture::DeviceList& devices) override;
+        void InvalidateDevices() noexcept override;
+
+        //
+        // Joins the thread to the multithreaded apartment
+        //
+        HRESULT AttachThread() noexcept override;
+        void DetachThread() noexcept override;
+
+    private:
+        MediaVideoSource m_sources;
+    };
+}
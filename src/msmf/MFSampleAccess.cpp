@@ -0,0 +1,202 @@
+#include "stdafx.h"
+#include "MFSampleAccess.h"
+
+namespace mf
+{
+    SampleAccess::SampleAccess() noexcept
+        : m_format(video::PixelFormat::Unknown)
+        , m_width(0)
+        , m_height(0)
+        , m_defaultStride(0)
+        , m_failed(0)
+    {
+        for (auto& counter : m_paths)
+        {
+            counter = 0;
+        }
+    }
+
+    SampleAccess::~SampleAccess()
+    {
+        Unlock();
+    }
+
+    void SampleAccess::SetFormat(video::PixelFormat format, UINT32 width, UINT32 height, LONG defaultStride) noexcept
+    {
+        m_format = format;
+        m_width = width;
+        m_height = height;
+        m_defaultStride = defaultStride;
+
+        if (0 == m_defaultStride)
+        {
+            m_defaultStride = static_cast<LONG>(width * video::BytesPerPixel(format));
+        }
+    }
+
+    HRESULT SampleAccess::Lock(IMFSample* pSample, video::FrameView& view)
+    {
+        Unlock();
+
+        DWORD count = 0;
+        HRESULT hr = pSample->GetBufferCount(&count);
+
+        if (SUCCEEDED(hr))
+        {
+            ComPtr<IMFMediaBuffer> buffer;
+
+            if (1 == count)
+            {
+                hr = pSample->GetBufferByIndex(0, &buffer);
+            }
+            else
+            {
+                //
+                // The frame is split over several buffers, a copy cannot be avoided
+                //
+                hr = pSample->ConvertToContiguousBuffer(&buffer);
+            }
+
+            if (SUCCEEDED(hr))
+            {
+                hr = LockBuffer(std::move(buffer), 1 != count, view);
+            }
+        }
+
+        if (FAILED(hr))
+        {
+            m_failed += 1;
+        }
+
+        return hr;
+    }
+
+    HRESULT SampleAccess::LockBuffer(ComPtr<IMFMediaBuffer> buffer, bool contiguous, video::FrameView& view)
+    {
+        BYTE* scanline0 = nullptr;
+        LONG pitch = 0;
+        Path path = Path::Lock;
+
+        //
+        // The locked bytes, start is null if only their count is known
+        //
+        BYTE* start = nullptr;
+        DWORD length = 0;
+
+        ComPtr<IMF2DBuffer2> buffer2d2;
+        ComPtr<IMF2DBuffer> buffer2d;
+
+        if (SUCCEEDED(buffer.As(&buffer2d2)))
+        {
+            HRCHK(buffer2d2->Lock2DSize(MF2DBuffer_LockFlags_Read, &scanline0, &pitch, &start, &length));
+            m_buffer2d = buffer2d2;
+            path = Path::Lock2DSize;
+        }
+        else if (SUCCEEDED(buffer.As(&buffer2d)))
+        {
+            HRCHK(buffer->GetMaxLength(&length));
+            HRCHK(buffer2d->Lock2D(&scanline0, &pitch));
+            m_buffer2d = buffer2d;
+            path = Path::Lock2D;
+        }
+        else
+        {
+            DWORD maxLength = 0;
+
+            HRCHK(buffer->Lock(&scanline0, &maxLength, &length));
+            start = scanline0;
+            pitch = m_defaultStride;
+        }
+
+        m_buffer = std::move(buffer);
+
+        if (path == Path::Lock && pitch < 0)
+        {
+            //
+            // Bottom-up image, the first row is at the end of the buffer.
+            // Moving scanline0 there needs every row in the buffer
+            //
+            const size_t rowBytes = static_cast<size_t>(-static_cast<ptrdiff_t>(pitch));
+
+            if (0 == m_height || rowBytes * m_height > length)
+            {
+                Unlock();
+                return MF_E_BUFFERTOOSMALL;
+            }
+
+            scanline0 += rowBytes * (m_height - 1);
+        }
+
+        //
+        // A buffer shorter than the media type says would be read past its end
+        //
+        const video::FrameView frame = video::MakeFrameView(m_format, m_width, m_height, scanline0, pitch);
+        const bool fits = start ? video::FitsBuffer(frame, start, length) : frame.IsValid() && frame.SpanBytes() <= length;
+
+        if (!fits)
+        {
+            Unlock();
+            return MF_E_BUFFERTOOSMALL;
+        }
+
+        Count(contiguous ? Path::Contiguous : path);
+
+        view = frame;
+        return S_OK;
+    }
+
+    void SampleAccess::Unlock() noexcept
+    {
+        if (m_buffer2d)
+        {
+            m_buffer2d->Unlock2D();
+        }
+        else if (m_buffer)
+        {
+            m_buffer->Unlock();
+        }
+
+        m_buffer2d.Reset();
+        m_buffer.Reset();
+    }
+
+    SampleAccess::Statistics SampleAccess::GetStatistics() const noexcept
+    {
+        Statistics stat = {};
+
+        for (size_t i = 0; i < static_cast<size_t>(Path::Count); ++i)
+        {
+            stat.paths[i] = m_paths[i];
+        }
+
+        stat.failed = m_failed;
+        return stat;
+    }
+
+    void SampleAccess::ResetStatistics() noexcept
+    {
+        for (auto& counter : m_paths)
+        {
+            counter = 0;
+        }
+
+        m_failed = 0;
+    }
+
+    const wchar_t* SampleAccess::PathName(Path path) noexcept
+    {
+        switch (path)
+        {
+        case Path::Lock2DSize: return L"Lock2DSize";
+        case Path::Lock2D: return L"Lock2D";
+        case Path::Lock: return L"Lock";
+        case Path::Contiguous: return L"Contiguous";
+        default: return L"Unknown";
+        }
+    }
+
+    void SampleAccess::Count(Path path) noexcept
+    {
+        m_paths[static_cast<size_t>(path)] += 1;
+    }
+}
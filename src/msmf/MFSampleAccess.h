@@ -0,0 +1,72 @@
+#pragma once
+
+#include <atomic>
+#include <mfobjects.h>
+#include "ComUtils.h"
+#include "FrameView.h"
+
+namespace mf
+{
+    //
+    // Maps the buffer of a sample in place and describes it as a FrameView.
+    // IMFSample::ConvertToContiguousBuffer is used only for samples with several buffers
+    //
+    class SampleAccess
+    {
+    public:
+        enum class Path
+        {
+            Lock2DSize = 0, // IMF2DBuffer2::Lock2DSize on the sample's buffer
+            Lock2D,         // IMF2DBuffer::Lock2D on the sample's buffer
+            Lock,           // IMFMediaBuffer::Lock with the default stride
+            Contiguous,     // ConvertToContiguousBuffer, may allocate and copy
+            Count
+        };
+
+        struct Statistics
+        {
+            uint64_t paths[static_cast<size_t>(Path::Count)];
+            uint64_t failed;
+        };
+
+        SampleAccess() noexcept;
+        ~SampleAccess();
+
+        SampleAccess(const SampleAccess&) = delete;
+        SampleAccess& operator=(const SampleAccess&) = delete;
+
+        //
+        // defaultStride is used for buffers without IMF2DBuffer,
+        // 0 means width * bytes per pixel
+        //
+        void SetFormat(video::PixelFormat format, UINT32 width, UINT32 height, LONG defaultStride) noexcept;
+
+        //
+        // Fails with MF_E_BUFFERTOOSMALL if the locked buffer is shorter than
+        // the frame, the sample is counted as failed
+        //
+        HRESULT Lock(IMFSample* pSample, video::FrameView& view);
+        void Unlock() noexcept;
+
+        Statistics GetStatistics() const noexcept;
+        void ResetStatistics() noexcept;
+
+        static const wchar_t* PathName(Path path) noexcept;
+
+    private:
+        HRESULT LockBuffer(ComPtr<IMFMediaBuffer> buffer, bool contiguous, video::FrameView& view);
+        void Count(Path path) noexcept;
+
+    private:
+        video::PixelFormat m_format;
+        UINT32 m_width;
+        UINT32 m_height;
+        LONG m_defaultStride;
+
+        ComPtr<IMFMediaBuffer> m_buffer;
+        ComPtr<IMF2DBuffer> m_buffer2d;
+
+        std::atomic<uint64_t> m_paths[static_cast<size_t>(Path::Count)];
+        std::atomic<uint64_t> m_failed;
+    };
+}
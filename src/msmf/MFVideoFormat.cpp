@@ -0,0 +1,57 @@
+#include "stdafx.h"
+#include "MFVideoFormat.h"
+
+namespace mf
+{
+    video::PixelFormat ToPixelFormat(const GUID& subtype) noexcept
+    {
+        if (subtype == MFVideoFormat_NV12)
+        {
+            return video::PixelFormat::NV12;
+        }
+        if (subtype == MFVideoFormat_I420 || subtype == MFVideoFormat_IYUV)
+        {
+            return video::PixelFormat::I420;
+        }
+        if (subtype == MFVideoFormat_YV12)
+        {
+            return video::PixelFormat::YV12;
+        }
+        if (subtype == MFVideoFormat_YUY2)
+        {
+            return video::PixelFormat::YUY2;
+        }
+        if (subtype == MFVideoFormat_UYVY)
+        {
+            return video::PixelFormat::UYVY;
+        }
+        if (subtype == MFVideoFormat_RGB24)
+        {
+            return video::PixelFormat::RGB24;
+        }
+        if (subtype == MFVideoFormat_RGB32 || subtype == MFVideoFormat_ARGB32)
+        {
+            return video::PixelFormat::RGB32;
+        }
+
+        return video::PixelFormat::Unknown;
+    }
+
+    video::ColorSpace GetColorSpace(IMFAttributes* pType) noexcept
+    {
+        video::ColorSpace colorSpace;
+        UINT32 value = 0;
+
+        if (SUCCEEDED(pType->GetUINT32(MF_MT_YUV_MATRIX, &value)) && value == MFVideoTransferMatrix_BT709)
+        {
+            colorSpace.matrix = video::YuvMatrix::BT709;
+        }
+
+        if (SUCCEEDED(pType->GetUINT32(MF_MT_VIDEO_NOMINAL_RANGE, &value)) && value == MFNominalRange_0_255)
+        {
+            colorSpace.range = video::YuvRange::Full;
+        }
+
+        return colorSpace;
+    }
+}
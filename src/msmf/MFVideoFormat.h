@@ -0,0 +1,19 @@
+#pragma once
+
+#include "ComUtils.h"
+#include "PixelFormat.h"
+
+namespace mf
+{
+    //
+    // Maps Media Foundation video subtypes to the formats of the conversion engine,
+    // returns PixelFormat::Unknown for compressed or unsupported subtypes
+    //
+    video::PixelFormat ToPixelFormat(const GUID& subtype) noexcept;
+
+    //
+    // Reads MF_MT_YUV_MATRIX and MF_MT_VIDEO_NOMINAL_RANGE,
+    // missing attributes default to BT.601 studio range
+    //
+    video::ColorSpace GetColorSpace(IMFAttributes* pType) noexcept;
+}
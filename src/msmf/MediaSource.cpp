@@ -1,174 +1,360 @@
-#include "stdafx.h"
-#include "MediaSource.h"
-#include "MFAttributes.h"
-#include "ComUtils.h"
-
-namespace mf
-{
-    MediaSource::MediaSource(const GUID& sourceType) noexcept
-        : m_sourceType(sourceType)
-    {
-    }
-
-    HRESULT MediaSource::OpenDeviceBySymLink(const std::wstring& symbolicLink, MFActivate& dev) const
-    {
-        MFActivateList devList;
-        HRCHK(EnumDevice(devList));
-
-        for (auto& device : devList)
-        {
-            mf::MFAttributes attr(device);
-            std::wstring symLink = attr.GetString(MF_DEVSOURCE_ATTRIBUTE_SOURCE_TYPE_VIDCAP_SYMBOLIC_LINK);
-
-            if (0 == _wcsicmp(symLink.c_str(), symbolicLink.c_str()))
-            {
-                dev = device;
-                return S_OK;
-            }
-
-            symLink = attr.GetString(MF_DEVSOURCE_ATTRIBUTE_SOURCE_TYPE_AUDCAP_SYMBOLIC_LINK);
-
-            if (0 == _wcsicmp(symLink.c_str(), symbolicLink.c_str()))
-            {
-                dev = device;
-                return S_OK;
-            }
-        }
-
-        return E_FAIL;
-    }
-
-    HRESULT MediaSource::OpenDeviceByFriendlyName(const std::wstring& friendlyName, MFActivateList& devs) const
-    {
-        MFActivateList devList;
-        HRCHK(EnumDevice(devList));
-
-        devs.clear();
-
-        for (auto& dev : devList)
-        {
-            utils::TaskMemFreeTraits<LPWSTR>::Handle fn;
-
-            UINT32 cchName = 0;
-            HRESULT hr = dev->GetAllocatedString(
-                MF_DEVSOURCE_ATTRIBUTE_FRIENDLY_NAME,
-                fn.ReleaseAndGetAddressOf(),
-                &cchName);
-
-            if (FAILED(hr))
-            {
-                continue;
-            }
-
-            if (0 == _wcsicmp(fn.Get(), friendlyName.c_str()))
-            {
-                devs.push_back(dev);
-            }
-        }
-
-        if (devs.empty())
-        {
-            return E_FAIL;
-        }
-
-        return S_OK;
-    }
-
-    HRESULT MediaSource::OpenDevice(const std::wstring& device, MFActivateList& devs) const
-    {
-        bool foundDevice = false;
-        MFActivate dev;
-
-        //
-        // Try to open device by symbolic link
-        //
-        HRESULT hr = OpenDeviceBySymLink(device, dev);
-
-        if (SUCCEEDED(hr))
-        {
-            devs.push_back(dev);
-            foundDevice = true;
-        }
-
-        //
-        // Try to open device by number in device's list
-        //
-        ULONG deviceNumber = 0;
-
-        try
-        {
-            size_t pos = 0;
-            deviceNumber = std::stoul(device, &pos);
-            hr = (pos != device.size()) ? E_FAIL : S_OK;
-        }
-        catch (const std::invalid_argument&)
-        {
-            // Cannot convert 'device' to a device number
-            hr = E_FAIL;
-        }
-
-        if (SUCCEEDED(hr))
-        {
-            hr = OpenDeviceByNumber(deviceNumber, dev);
-
-            if (SUCCEEDED(hr))
-            {
-                devs.push_back(dev);
-                foundDevice = true;
-            }
-        }
-
-        //
-        // Try to open device by Friendly Name
-        //
-        mf::MFActivateList devsByFriendlyName;
-        hr = OpenDeviceByFriendlyName(device, devsByFriendlyName);
-
-        if (SUCCEEDED(hr))
-        {
-            devs.insert(devs.end(), devsByFriendlyName.begin(), devsByFriendlyName.end());
-            foundDevice = true;
-        }
-
-        return foundDevice ? S_OK : E_FAIL;
-    }
-
-    HRESULT MediaSource::OpenDeviceByNumber(ULONG deviceNumber, MFActivate& dev) const
-    {
-        MFActivateList devs;
-        HRCHK(EnumDevice(devs));
-
-        if (deviceNumber >= devs.size())
-        {
-            return E_FAIL;
-        }
-
-        dev = devs.at(deviceNumber);
-        return S_OK;
-    }
-
-    HRESULT MediaSource::EnumDevice(MFActivateList& devs) const
-    {
-        ComPtr<IMFAttributes> pAttributes;
-        HRCHK(MFCreateAttributes(&pAttributes, 1));
-
-        HRCHK(pAttributes->SetGUID(
-            MF_DEVSOURCE_ATTRIBUTE_SOURCE_TYPE,
-            m_sourceType));
-
-        UINT32 count = 0;
-
-        utils::TaskMemFreeTraits<IMFActivate**>::Handle ppDevices;
-        HR_CHECK2(MFEnumDeviceSources(pAttributes.Get(), ppDevices.GetAddressOf(), &count));
-
-        devs.clear();
-        devs.resize(count);
-
-        for (DWORD i = 0; i < count; i++)
-        {
-            devs[i].Attach(ppDevices.Get()[i]);
-        }
-
-        return S_OK;
-    }
-}
+#include "stdafx.h"
+#include "MediaSource.h"
+#include "MFAttributes.h"
+#include "ComUtils.h"
+#include <cwctype>
+
+#pragma comment(lib, "Cfgmgr32.lib")
+
+namespace
+{
+    //
+    // Device interface classes of capture devices,
+    // KSCATEGORY_CAPTURE and KSCATEGORY_VIDEO_CAMERA
+    //
+    const GUID CaptureInterfaceClasses[] =
+    {
+        { 0x65e8773d, 0x8f56, 0x11d0, { 0xa3, 0xb9, 0x00, 0xa0, 0xc9, 0x22, 0x31, 0x96 } },
+        { 0xe5323777, 0xf976, 0x4f5b, { 0x9b, 0x55, 0xb9, 0x46, 0x99, 0xc4, 0x6e, 0x44 } },
+    };
+}
+
+namespace mf
+{
+    DeviceRegistry::DeviceRegistry(const GUID& sourceType) noexcept
+        : m_sourceType(sourceType)
+        , m_stale(true)
+        , m_enumerations(0)
+    {
+    }
+
+    DeviceRegistry::~DeviceRegistry()
+    {
+        StopWatching();
+    }
+
+    void DeviceRegistry::Invalidate() noexcept
+    {
+        m_stale = true;
+    }
+
+    HRESULT DeviceRegistry::WatchDevices()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        if (!m_notifications.empty())
+        {
+            return S_FALSE;
+        }
+
+        for (const auto& interfaceClass : CaptureInterfaceClasses)
+        {
+            CM_NOTIFY_FILTER filter = {};
+            filter.cbSize = sizeof(filter);
+            filter.FilterType = CM_NOTIFY_FILTER_TYPE_DEVICEINTERFACE;
+            filter.u.DeviceInterface.ClassGuid = interfaceClass;
+
+            HCMNOTIFICATION notification = NULL;
+            const CONFIGRET cr = CM_Register_Notification(&filter, this, OnDeviceChange, &notification);
+
+            if (cr != CR_SUCCESS)
+            {
+                const DWORD err = CM_MapCrToWin32Err(cr, ERROR_NOT_SUPPORTED);
+                StopWatching();
+                return HRESULT_FROM_WIN32(err);
+            }
+
+            m_notifications.push_back(notification);
+        }
+
+        return S_OK;
+    }
+
+    HRESULT DeviceRegistry::GetDevices(MFActivateList& devs)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        HRCHK(Refresh());
+
+        devs.clear();
+        devs.reserve(m_entries.size());
+
+        for (const auto& entry : m_entries)
+        {
+            devs.push_back(entry.activate);
+        }
+
+        return S_OK;
+    }
+
+    HRESULT DeviceRegistry::FindBySymLink(const std::wstring& symbolicLink, MFActivate& dev)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        HRCHK(Refresh());
+
+        const auto it = m_bySymLink.find(FoldCase(symbolicLink));
+
+        if (it == m_bySymLink.end())
+        {
+            return E_FAIL;
+        }
+
+        dev = m_entries[it->second].activate;
+        return S_OK;
+    }
+
+    HRESULT DeviceRegistry::FindByNumber(ULONG deviceNumber, MFActivate& dev)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        HRCHK(Refresh());
+
+        if (deviceNumber >= m_entries.size())
+        {
+            return E_FAIL;
+        }
+
+        dev = m_entries[deviceNumber].activate;
+        return S_OK;
+    }
+
+    HRESULT DeviceRegistry::FindByFriendlyName(const std::wstring& friendlyName, MFActivateList& devs)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        HRCHK(Refresh());
+
+        devs.clear();
+
+        const auto it = m_byFriendlyName.find(FoldCase(friendlyName));
+
+        if (it == m_byFriendlyName.end())
+        {
+            return E_FAIL;
+        }
+
+        for (size_t index : it->second)
+        {
+            devs.push_back(m_entries[index].activate);
+        }
+
+        return S_OK;
+    }
+
+    uint64_t DeviceRegistry::GetEnumerations() const noexcept
+    {
+        return m_enumerations;
+    }
+
+    HRESULT DeviceRegistry::Refresh()
+    {
+        //
+        // Called under the lock
+        //
+        if (!m_stale.exchange(false))
+        {
+            return S_OK;
+        }
+
+        m_entries.clear();
+        m_bySymLink.clear();
+        m_byFriendlyName.clear();
+
+        ComPtr<IMFAttributes> pAttributes;
+        HRESULT hr = MFCreateAttributes(&pAttributes, 1);
+
+        if (SUCCEEDED(hr))
+        {
+            hr = pAttributes->SetGUID(MF_DEVSOURCE_ATTRIBUTE_SOURCE_TYPE, m_sourceType);
+        }
+
+        UINT32 count = 0;
+        utils::TaskMemFreeTraits<IMFActivate**>::Handle ppDevices;
+
+        if (SUCCEEDED(hr))
+        {
+            hr = MFEnumDeviceSources(pAttributes.Get(), ppDevices.GetAddressOf(), &count);
+            m_enumerations += 1;
+        }
+
+        if (FAILED(hr))
+        {
+            m_stale = true;
+            return hr;
+        }
+
+        m_entries.resize(count);
+        utils::AttributeSnapshot snapshot;
+
+        for (UINT32 i = 0; i < count; i++)
+        {
+            Entry& entry = m_entries[i];
+            entry.activate.Attach(ppDevices.Get()[i]);
+
+            MFAttributes(entry.activate).GetSnapshot(snapshot);
+            entry.friendlyName = snapshot.GetString(MF_DEVSOURCE_ATTRIBUTE_FRIENDLY_NAME);
+            entry.symbolicLink = snapshot.GetString(MF_DEVSOURCE_ATTRIBUTE_SOURCE_TYPE_VIDCAP_SYMBOLIC_LINK);
+
+            const std::wstring audioLink(snapshot.GetString(MF_DEVSOURCE_ATTRIBUTE_SOURCE_TYPE_AUDCAP_SYMBOLIC_LINK));
+
+            if (entry.symbolicLink.empty())
+            {
+                entry.symbolicLink = audioLink;
+            }
+
+            //
+            // The first device wins a duplicate symbolic link, as the linear search did
+            //
+            for (const auto& link : { entry.symbolicLink, audioLink })
+            {
+                if (!link.empty())
+                {
+                    m_bySymLink.emplace(FoldCase(link), i);
+                }
+            }
+
+            if (!entry.friendlyName.empty())
+            {
+                m_byFriendlyName[FoldCase(entry.friendlyName)].push_back(i);
+            }
+        }
+
+        return S_OK;
+    }
+
+    void DeviceRegistry::StopWatching() noexcept
+    {
+        for (HCMNOTIFICATION notification : m_notifications)
+        {
+            //
+            // Waits for the callbacks in progress
+            //
+            CM_Unregister_Notification(notification);
+        }
+
+        m_notifications.clear();
+    }
+
+    std::wstring DeviceRegistry::FoldCase(const std::wstring& str)
+    {
+        std::wstring folded(str);
+
+        for (auto& ch : folded)
+        {
+            ch = static_cast<wchar_t>(std::towlower(ch));
+        }
+
+        return folded;
+    }
+
+    DWORD CALLBACK DeviceRegistry::OnDeviceChange(
+        HCMNOTIFICATION hNotify,
+        PVOID context,
+        CM_NOTIFY_ACTION action,
+        PCM_NOTIFY_EVENT_DATA eventData,
+        DWORD eventDataSize)
+    {
+        UNREFERENCED_PARAMETER(hNotify);
+        UNREFERENCED_PARAMETER(eventData);
+        UNREFERENCED_PARAMETER(eventDataSize);
+
+        if (action == CM_NOTIFY_ACTION_DEVICEINTERFACEARRIVAL ||
+            action == CM_NOTIFY_ACTION_DEVICEINTERFACEREMOVAL)
+        {
+            static_cast<DeviceRegistry*>(context)->Invalidate();
+        }
+
+        return ERROR_SUCCESS;
+    }
+
+    //
+    // MediaSource
+    //
+
+    MediaSource::MediaSource(const GUID& sourceType) noexcept
+        : m_sourceType(sourceType)
+        , m_registry(sourceType)
+    {
+    }
+
+    HRESULT MediaSource::OpenDeviceBySymLink(const std::wstring& symbolicLink, MFActivate& dev) const
+    {
+        return m_registry.FindBySymLink(symbolicLink, dev);
+    }
+
+    HRESULT MediaSource::OpenDeviceByFriendlyName(const std::wstring& friendlyName, MFActivateList& devs) const
+    {
+        return m_registry.FindByFriendlyName(friendlyName, devs);
+    }
+
+    HRESULT MediaSource::OpenDevice(const std::wstring& device, MFActivateList& devs) const
+    {
+        bool foundDevice = false;
+        MFActivate dev;
+
+        //
+        // Try to open device by symbolic link
+        //
+        HRESULT hr = OpenDeviceBySymLink(device, dev);
+
+        if (SUCCEEDED(hr))
+        {
+            devs.push_back(dev);
+            foundDevice = true;
+        }
+
+        //
+        // Try to open device by number in device's list
+        //
+        ULONG deviceNumber = 0;
+
+        try
+        {
+            size_t pos = 0;
+            deviceNumber = std::stoul(device, &pos);
+            hr = (pos != device.size()) ? E_FAIL : S_OK;
+        }
+        catch (const std::invalid_argument&)
+        {
+            // Cannot convert 'device' to a device number
+            hr = E_FAIL;
+        }
+
+        if (SUCCEEDED(hr))
+        {
+            hr = OpenDeviceByNumber(deviceNumber, dev);
+
+            if (SUCCEEDED(hr))
+            {
+                devs.push_back(dev);
+                foundDevice = true;
+            }
+        }
+
+        //
+        // Try to open device by Friendly Name
+        //
+        mf::MFActivateList devsByFriendlyName;
+        hr = OpenDeviceByFriendlyName(device, devsByFriendlyName);
+
+        if (SUCCEEDED(hr))
+        {
+            devs.insert(devs.end(), devsByFriendlyName.begin(), devsByFriendlyName.end());
+            foundDevice = true;
+        }
+
+        return foundDevice ? S_OK : E_FAIL;
+    }
+
+    HRESULT MediaSource::OpenDeviceByNumber(ULONG deviceNumber, MFActivate& dev) const
+    {
+        return m_registry.FindByNumber(deviceNumber, dev);
+    }
+
+    HRESULT MediaSource::EnumDevice(MFActivateList& devs) const
+    {
+        return m_registry.GetDevices(devs);
+    }
+
+    DeviceRegistry& MediaSource::GetRegistry() const noexcept
+    {
+        return m_registry;
+    }
+}
@@ -1,38 +1,113 @@
-#pragma once
-
-#include <vector>
-#include <mfidl.h>
-#include "ComUtils.h"
-
-namespace mf
-{
-    using MFMediaSource = ComPtr<IMFMediaSource>;
-    using MFMediaSourceList = std::vector<MFMediaSource>;
-
-    using MFActivate = ComPtr<IMFActivate>;
-    using MFActivateList = std::vector<MFActivate>;
-
-    class MediaSource
-    {
-    public:
-        explicit MediaSource(const GUID& sourceType) noexcept;
-
-        HRESULT OpenDeviceBySymLink(const std::wstring& symbolicLink, MFActivate& dev) const;
-        HRESULT OpenDeviceByNumber(ULONG deviceNumber, MFActivate& dev) const;
-        HRESULT OpenDeviceByFriendlyName(const std::wstring& friendlyName, MFActivateList& devs) const;
-        HRESULT OpenDevice(const std::wstring& device, MFActivateList& devs) const;
-
-        HRESULT EnumDevice(MFActivateList& devs) const;
-
-    private:
-        const GUID& m_sourceType;
-    };
-
-    struct MediaVideoSource : MediaSource
-    {
-        MediaVideoSource() noexcept
-            : MediaSource(MF_DEVSOURCE_ATTRIBUTE_SOURCE_TYPE_VIDCAP_GUID)
-        {
-        }
-    };
-}
+#pragma once
+
+#include <vector>
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <mfidl.h>
+#include <cfgmgr32.h>
+#include "ComUtils.h"
+
+namespace mf
+{
+    using MFMediaSource = ComPtr<IMFMediaSource>;
+    using MFMediaSourceList = std::vector<MFMediaSource>;
+
+    using MFActivate = ComPtr<IMFActivate>;
+    using MFActivateList = std::vector<MFActivate>;
+
+    //
+    // Snapshot of the devices of one source type. MFEnumDeviceSources runs once,
+    // symbolic links and friendly names are hashed, so every lookup is O(1)
+    // until the snapshot is invalidated
+    //
+    class DeviceRegistry
+    {
+    public:
+        struct Entry
+        {
+            MFActivate activate;
+            std::wstring symbolicLink;
+            std::wstring friendlyName;
+        };
+
+        explicit DeviceRegistry(const GUID& sourceType) noexcept;
+        ~DeviceRegistry();
+
+        DeviceRegistry(const DeviceRegistry&) = delete;
+        DeviceRegistry& operator=(const DeviceRegistry&) = delete;
+
+        //
+        // The next lookup enumerates the devices again
+        //
+        void Invalidate() noexcept;
+
+        //
+        // Invalidates the snapshot on device interface arrival and removal
+        //
+        HRESULT WatchDevices();
+
+        HRESULT GetDevices(MFActivateList& devs);
+        HRESULT FindBySymLink(const std::wstring& symbolicLink, MFActivate& dev);
+        HRESULT FindByNumber(ULONG deviceNumber, MFActivate& dev);
+        HRESULT FindByFriendlyName(const std::wstring& friendlyName, MFActivateList& devs);
+
+        //
+        // Number of MFEnumDeviceSources calls so far
+        //
+        uint64_t GetEnumerations() const noexcept;
+
+    private:
+        HRESULT Refresh();
+        void StopWatching() noexcept;
+
+        static std::wstring FoldCase(const std::wstring& str);
+        static DWORD CALLBACK OnDeviceChange(
+            HCMNOTIFICATION hNotify,
+            PVOID context,
+            CM_NOTIFY_ACTION action,
+            PCM_NOTIFY_EVENT_DATA eventData,
+            DWORD eventDataSize);
+
+    private:
+        const GUID& m_sourceType;
+        std::mutex m_mutex;
+        std::atomic<bool> m_stale;
+        std::atomic<uint64_t> m_enumerations;
+        std::vector<Entry> m_entries;
+        std::unordered_map<std::wstring, size_t> m_bySymLink;
+        std::unordered_map<std::wstring, std::vector<size_t>> m_byFriendlyName;
+        std::vector<HCMNOTIFICATION> m_notifications;
+    };
+
+    class MediaSource
+    {
+    public:
+        explicit MediaSource(const GUID& sourceType) noexcept;
+
+        HRESULT OpenDeviceBySymLink(const std::wstring& symbolicLink, MFActivate& dev) const;
+        HRESULT OpenDeviceByNumber(ULONG deviceNumber, MFActivate& dev) const;
+        HRESULT OpenDeviceByFriendlyName(const std::wstring& friendlyName, MFActivateList& devs) const;
+        HRESULT OpenDevice(const std::wstring& device, MFActivateList& devs) const;
+
+        HRESULT EnumDevice(MFActivateList& devs) const;
+
+        //
+        // Lookups share one enumeration until the registry is invalidated
+        //
+        DeviceRegistry& GetRegistry() const noexcept;
+
+    private:
+        const GUID& m_sourceType;
+        mutable DeviceRegistry m_registry;
+    };
+
+    struct MediaVideoSource : MediaSource
+    {
+        MediaVideoSource() noexcept
+            : MediaSource(MF_DEVSOURCE_ATTRIBUTE_SOURCE_TYPE_VIDCAP_GUID)
+        {
+        }
+    };
+}
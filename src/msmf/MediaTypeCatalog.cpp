@@ -0,0 +1,413 @@
+#include "MediaTypeCatalog.h"
+
+#include <cstring>
+#include <filesystem>
+#include <system_error>
+
+namespace
+{
+    using namespace capture;
+
+    //
+    // Strings are stored as UTF-16 whatever the size of wchar_t
+    //
+    void AppendUtf16(const std::wstring& str, std::vector<uint16_t>& pool, uint32_t& offset, uint32_t& length)
+    {
+        offset = static_cast<uint32_t>(pool.size());
+
+        for (wchar_t ch : str)
+        {
+            const uint32_t code = static_cast<uint32_t>(ch);
+
+            if (code > 0xFFFF)
+            {
+                pool.push_back(static_cast<uint16_t>(0xD800 + ((code - 0x10000) >> 10)));
+                pool.push_back(static_cast<uint16_t>(0xDC00 + ((code - 0x10000) & 0x3FF)));
+            }
+            else
+            {
+                pool.push_back(static_cast<uint16_t>(code));
+            }
+        }
+
+        length = static_cast<uint32_t>(pool.size()) - offset;
+    }
+
+    std::wstring ToWide(const uint16_t* units, size_t length)
+    {
+        std::wstring str;
+        str.reserve(length);
+
+        for (size_t i = 0; i < length; ++i)
+        {
+            uint32_t code = units[i];
+
+            if (sizeof(wchar_t) > 2
+                && code >= 0xD800 && code < 0xDC00
+                && i + 1 < length
+                && units[i + 1] >= 0xDC00 && units[i + 1] < 0xE000)
+            {
+                code = 0x10000 + ((code - 0xD800) << 10) + (units[i + 1] - 0xDC00);
+                ++i;
+            }
+
+            str.push_back(static_cast<wchar_t>(code));
+        }
+
+        return str;
+    }
+
+    bool ContainsSymLink(const std::vector<MediaTypeCatalog::DeviceEntry>& devices, const std::wstring& symbolicLink)
+    {
+        for (const auto& device : devices)
+        {
+            if (device.symbolicLink == symbolicLink)
+            {
+                return true;
+            }
+        }
+
+        return false;
+    }
+}
+
+namespace capture
+{
+    //
+    // MediaTypeCatalog
+    //
+
+    MediaTypeCatalog::MediaTypeCatalog() noexcept
+        : m_header(nullptr)
+        , m_devices(nullptr)
+        , m_mediaTypes(nullptr)
+        , m_strings(nullptr)
+    {
+    }
+
+    HRESULT MediaTypeCatalog::Load(const std::wstring& path)
+    {
+        Close();
+        HRCHK(m_file.Open(path));
+
+        const uint8_t* data = m_file.Data();
+        const uint64_t size = m_file.Size();
+
+        if (size < sizeof(CatalogHeader))
+        {
+            Close();
+            return E_INVALIDARG;
+        }
+
+        auto header = reinterpret_cast<const CatalogHeader*>(data);
+
+        const uint64_t devicesOffset = sizeof(CatalogHeader);
+        const uint64_t mediaTypesOffset = devicesOffset + uint64_t(header->deviceCount) * sizeof(CatalogDevice);
+        const uint64_t stringsOffset = mediaTypesOffset + uint64_t(header->mediaTypeCount) * sizeof(CatalogMediaType);
+        const uint64_t expectedSize = stringsOffset + uint64_t(header->stringUnits) * sizeof(uint16_t);
+
+        if (header->magic != CatalogMagic ||
+            header->version != CatalogVersion ||
+            header->fileSize != size ||
+            expectedSize != size)
+        {
+            Close();
+            return E_INVALIDARG;
+        }
+
+        m_header = header;
+        m_devices = reinterpret_cast<const CatalogDevice*>(data + devicesOffset);
+        m_mediaTypes = reinterpret_cast<const CatalogMediaType*>(data + mediaTypesOffset);
+        m_strings = reinterpret_cast<const uint16_t*>(data + stringsOffset);
+
+        m_bySymLink.reserve(header->deviceCount);
+
+        for (uint32_t i = 0; i < header->deviceCount; ++i)
+        {
+            const CatalogDevice& device = m_devices[i];
+
+            if (uint64_t(device.firstMediaType) + device.mediaTypeCount > header->mediaTypeCount ||
+                uint64_t(device.symbolicLink) + device.symbolicLinkLength > header->stringUnits)
+            {
+                Close();
+                return E_INVALIDARG;
+            }
+
+            m_bySymLink.emplace(GetString(device.symbolicLink, device.symbolicLinkLength), i);
+        }
+
+        return S_OK;
+    }
+
+    void MediaTypeCatalog::Close() noexcept
+    {
+        m_bySymLink.clear();
+        m_header = nullptr;
+        m_devices = nullptr;
+        m_mediaTypes = nullptr;
+        m_strings = nullptr;
+        m_file.Close();
+    }
+
+    size_t MediaTypeCatalog::GetDeviceCount() const noexcept
+    {
+        return m_header ? m_header->deviceCount : 0;
+    }
+
+    HRESULT MediaTypeCatalog::Find(const std::wstring& symbolicLink, uint64_t fingerprint, size_t& device) const
+    {
+        const auto it = m_bySymLink.find(symbolicLink);
+
+        if (it == m_bySymLink.end())
+        {
+            return E_FAIL;
+        }
+
+        device = it->second;
+        return (m_devices[device].fingerprint == fingerprint) ? S_OK : S_FALSE;
+    }
+
+    HRESULT MediaTypeCatalog::GetDevice(size_t device, DeviceEntry& entry) const
+    {
+        if (device >= GetDeviceCount())
+        {
+            return E_INVALIDARG;
+        }
+
+        const CatalogDevice& info = m_devices[device];
+
+        entry.symbolicLink = GetString(info.symbolicLink, info.symbolicLinkLength);
+        entry.friendlyName = GetString(info.friendlyName, info.friendlyNameLength);
+        entry.fingerprint = info.fingerprint;
+        entry.streams.clear();
+
+        for (uint32_t i = 0; i < info.mediaTypeCount; ++i)
+        {
+            const CatalogMediaType& type = m_mediaTypes[info.firstMediaType + i];
+
+            //
+            // The types of a stream are contiguous
+            //
+            if (entry.streams.empty() || entry.streams.back().index != type.stream)
+            {
+                entry.streams.emplace_back();
+                entry.streams.back().index = type.stream;
+            }
+
+            MediaTypeInfo mediaType;
+            mediaType.index = type.index;
+            mediaType.subtype = GetString(type.subtype, type.subtypeLength);
+            mediaType.format = static_cast<video::PixelFormat>(type.format);
+            mediaType.width = type.width;
+            mediaType.height = type.height;
+            mediaType.fpsNumerator = type.fpsNumerator;
+            mediaType.fpsDenominator = type.fpsDenominator;
+            mediaType.defaultStride = type.defaultStride;
+            mediaType.colorSpace.matrix = static_cast<video::YuvMatrix>(type.matrix);
+            mediaType.colorSpace.range = static_cast<video::YuvRange>(type.range);
+            entry.streams.back().mediaTypes.push_back(std::move(mediaType));
+        }
+
+        return S_OK;
+    }
+
+    HRESULT MediaTypeCatalog::Write(const std::wstring& path, const std::vector<DeviceEntry>& devices)
+    {
+        std::vector<CatalogDevice> deviceTable;
+        std::vector<CatalogMediaType> mediaTypeTable;
+        std::vector<uint16_t> strings;
+
+        deviceTable.reserve(devices.size());
+
+        for (const auto& device : devices)
+        {
+            CatalogDevice info = {};
+            info.fingerprint = device.fingerprint;
+            info.firstMediaType = static_cast<uint32_t>(mediaTypeTable.size());
+            AppendUtf16(device.symbolicLink, strings, info.symbolicLink, info.symbolicLinkLength);
+            AppendUtf16(device.friendlyName, strings, info.friendlyName, info.friendlyNameLength);
+
+            for (const auto& stream : device.streams)
+            {
+                for (const auto& mediaType : stream.mediaTypes)
+                {
+                    CatalogMediaType type = {};
+                    type.stream = stream.index;
+                    type.index = mediaType.index;
+                    type.format = static_cast<uint32_t>(mediaType.format);
+                    type.width = mediaType.width;
+                    type.height = mediaType.height;
+                    type.fpsNumerator = mediaType.fpsNumerator;
+                    type.fpsDenominator = mediaType.fpsDenominator;
+                    type.defaultStride = mediaType.defaultStride;
+                    type.matrix = static_cast<uint32_t>(mediaType.colorSpace.matrix);
+                    type.range = static_cast<uint32_t>(mediaType.colorSpace.range);
+                    AppendUtf16(mediaType.subtype, strings, type.subtype, type.subtypeLength);
+                    mediaTypeTable.push_back(type);
+                }
+            }
+
+            info.mediaTypeCount = static_cast<uint32_t>(mediaTypeTable.size()) - info.firstMediaType;
+            deviceTable.push_back(info);
+        }
+
+        CatalogHeader header = {};
+        header.magic = CatalogMagic;
+        header.version = CatalogVersion;
+        header.deviceCount = static_cast<uint32_t>(deviceTable.size());
+        header.mediaTypeCount = static_cast<uint32_t>(mediaTypeTable.size());
+        header.stringUnits = static_cast<uint32_t>(strings.size());
+        header.fileSize = sizeof(header)
+            + deviceTable.size() * sizeof(CatalogDevice)
+            + mediaTypeTable.size() * sizeof(CatalogMediaType)
+            + strings.size() * sizeof(uint16_t);
+
+        //
+        // Written aside and renamed, so a reader never maps a partial catalog
+        //
+        const std::wstring tempPath = path + L".tmp";
+        HRESULT hr = S_OK;
+
+        {
+            video::File file;
+            HRCHK(file.Create(tempPath));
+
+            hr = file.Write(&header, sizeof(header));
+
+            if (SUCCEEDED(hr) && !deviceTable.empty())
+            {
+                hr = file.Write(deviceTable.data(), deviceTable.size() * sizeof(CatalogDevice));
+            }
+
+            if (SUCCEEDED(hr) && !mediaTypeTable.empty())
+            {
+                hr = file.Write(mediaTypeTable.data(), mediaTypeTable.size() * sizeof(CatalogMediaType));
+            }
+
+            if (SUCCEEDED(hr) && !strings.empty())
+            {
+                hr = file.Write(strings.data(), strings.size() * sizeof(uint16_t));
+            }
+        }
+
+        std::error_code ec;
+
+        if (SUCCEEDED(hr))
+        {
+            std::filesystem::rename(std::filesystem::path(tempPath), std::filesystem::path(path), ec);
+            hr = ec ? E_FAIL : S_OK;
+        }
+
+        if (FAILED(hr))
+        {
+            std::filesystem::remove(std::filesystem::path(tempPath), ec);
+        }
+
+        return hr;
+    }
+
+    std::wstring MediaTypeCatalog::GetString(uint32_t offset, uint32_t length) const
+    {
+        if (!m_header || uint64_t(offset) + length > m_header->stringUnits)
+        {
+            return std::wstring();
+        }
+
+        return ToWide(m_strings + offset, length);
+    }
+
+    //
+    // StreamCache
+    //
+
+    StreamCache::StreamCache(std::wstring path)
+        : m_path(std::move(path))
+        , m_dirty(false)
+        , m_hits(0)
+        , m_misses(0)
+    {
+        //
+        // A missing or damaged catalog is rebuilt from the devices
+        //
+        if (FAILED(m_catalog.Load(m_path)))
+        {
+            m_catalog.Close();
+        }
+    }
+
+    HRESULT StreamCache::GetStreams(Device& device, std::vector<StreamInfo>& streams)
+    {
+        MediaTypeCatalog::DeviceEntry entry;
+        entry.symbolicLink = device.GetSymbolicLink();
+        entry.fingerprint = device.GetFingerprint();
+
+        size_t index = 0;
+
+        //
+        // An unknown fingerprint cannot tell a driver update, such devices are always enumerated
+        //
+        if (0 != entry.fingerprint
+            && S_OK == m_catalog.Find(entry.symbolicLink, entry.fingerprint, index)
+            && SUCCEEDED(m_catalog.GetDevice(index, entry)))
+        {
+            m_hits += 1;
+        }
+        else
+        {
+            HRCHK(device.GetStreams(entry.streams));
+            entry.friendlyName = device.GetFriendlyName();
+            m_misses += 1;
+            m_dirty = true;
+        }
+
+        streams = entry.streams;
+
+        if (!ContainsSymLink(m_seen, entry.symbolicLink))
+        {
+            m_seen.push_back(std::move(entry));
+        }
+
+        return S_OK;
+    }
+
+    HRESULT StreamCache::Save()
+    {
+        if (!m_dirty)
+        {
+            return S_FALSE;
+        }
+
+        //
+        // Devices not seen this time are kept, they may be unplugged for now
+        //
+        std::vector<MediaTypeCatalog::DeviceEntry> devices = m_seen;
+
+        for (size_t i = 0; i < m_catalog.GetDeviceCount(); ++i)
+        {
+            MediaTypeCatalog::DeviceEntry entry;
+
+            if (SUCCEEDED(m_catalog.GetDevice(i, entry)) && !ContainsSymLink(devices, entry.symbolicLink))
+            {
+                devices.push_back(std::move(entry));
+            }
+        }
+
+        //
+        // The mapping must be gone before the file is replaced
+        //
+        m_catalog.Close();
+
+        std::error_code ec;
+        const std::filesystem::path parent = std::filesystem::path(m_path).parent_path();
+
+        if (!parent.empty())
+        {
+            std::filesystem::create_directories(parent, ec);
+        }
+
+        HRCHK(MediaTypeCatalog::Write(m_path, devices));
+
+        m_dirty = false;
+        return m_catalog.Load(m_path);
+    }
+}
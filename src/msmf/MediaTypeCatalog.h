@@ -0,0 +1,132 @@
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "CaptureBackend.h"
+#include "RecordFile.h"
+
+namespace capture
+{
+    //
+    // A catalog file is:
+    //  CatalogHeader
+    //  CatalogDevice[deviceCount]
+    //  CatalogMediaType[mediaTypeCount], the types of each device are contiguous
+    //  UTF-16 string pool
+    //
+    constexpr uint64_t CatalogMagic = 0x3154414346534d4dull; // "MMSFCAT1"
+    constexpr uint32_t CatalogVersion = 1;
+
+    struct CatalogHeader
+    {
+        uint64_t magic;
+        uint32_t version;
+        uint32_t deviceCount;
+        uint32_t mediaTypeCount;
+        uint32_t stringUnits;       // UTF-16 code units in the pool
+        uint64_t fileSize;
+    };
+
+    struct CatalogDevice
+    {
+        uint64_t fingerprint;
+        uint32_t symbolicLink;      // offset in the string pool
+        uint32_t symbolicLinkLength;
+        uint32_t friendlyName;
+        uint32_t friendlyNameLength;
+        uint32_t firstMediaType;
+        uint32_t mediaTypeCount;
+    };
+
+    struct CatalogMediaType
+    {
+        uint32_t stream;
+        uint32_t index;
+        uint32_t format;            // video::PixelFormat
+        uint32_t width;
+        uint32_t height;
+        uint32_t fpsNumerator;
+        uint32_t fpsDenominator;
+        int32_t defaultStride;
+        uint32_t matrix;            // video::YuvMatrix
+        uint32_t range;             // video::YuvRange
+        uint32_t subtype;           // offset in the string pool
+        uint32_t subtypeLength;
+    };
+
+    static_assert(sizeof(CatalogHeader) == 32, "CatalogHeader is a file format");
+    static_assert(sizeof(CatalogDevice) == 32, "CatalogDevice is a file format");
+    static_assert(sizeof(CatalogMediaType) == 48, "CatalogMediaType is a file format");
+
+    //
+    // Streams and media types of devices, keyed by symbolic link and
+    // the device fingerprint. Loading maps the file and hashes the
+    // symbolic links, entries are decoded on lookup
+    //
+    class MediaTypeCatalog
+    {
+    public:
+        struct DeviceEntry
+        {
+            std::wstring symbolicLink;
+            std::wstring friendlyName;
+            uint64_t fingerprint = 0;
+            std::vector<StreamInfo> streams;
+        };
+
+        MediaTypeCatalog() noexcept;
+
+        HRESULT Load(const std::wstring& path);
+        void Close() noexcept;
+
+        size_t GetDeviceCount() const noexcept;
+
+        //
+        // Finds the device by symbolic link, S_FALSE if its fingerprint differs
+        //
+        HRESULT Find(const std::wstring& symbolicLink, uint64_t fingerprint, size_t& device) const;
+        HRESULT GetDevice(size_t device, DeviceEntry& entry) const;
+
+        static HRESULT Write(const std::wstring& path, const std::vector<DeviceEntry>& devices);
+
+    private:
+        std::wstring GetString(uint32_t offset, uint32_t length) const;
+
+    private:
+        video::MappedFile m_file;
+        const CatalogHeader* m_header;
+        const CatalogDevice* m_devices;
+        const CatalogMediaType* m_mediaTypes;
+        const uint16_t* m_strings;
+        std::unordered_map<std::wstring, size_t> m_bySymLink;
+    };
+
+    //
+    // Answers GetStreams from the catalog file. Devices missing from it or
+    // with another fingerprint are enumerated, Save rewrites the file then
+    //
+    class StreamCache
+    {
+    public:
+        explicit StreamCache(std::wstring path);
+
+        HRESULT GetStreams(Device& device, std::vector<StreamInfo>& streams);
+
+        //
+        // Writes the catalog if a device was enumerated, S_FALSE if nothing changed
+        //
+        HRESULT Save();
+
+        uint64_t GetHits() const noexcept { return m_hits; }
+        uint64_t GetMisses() const noexcept { return m_misses; }
+
+    private:
+        const std::wstring m_path;
+        MediaTypeCatalog m_catalog;
+        std::vector<MediaTypeCatalog::DeviceEntry> m_seen;
+        bool m_dirty;
+        uint64_t m_hits;
+        uint64_t m_misses;
+    };
+}
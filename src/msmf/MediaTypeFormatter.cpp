@@ -0,0 +1,437 @@
+#include "MediaTypeFormatter.h"
+
+#include <cwchar>
+
+namespace
+{
+    using capture::FieldDescriptor;
+    using capture::ValueKind;
+
+    //
+    // MediaTypeInfo fields, the first three make the compact form
+    //
+    const FieldDescriptor MediaTypeInfoFields[] =
+    {
+        { L"SUBTYPE", ValueKind::Guid, L"" },
+        { L"FRAME_SIZE", ValueKind::Size, L"" },
+        { L"FRAME_RATE", ValueKind::Ratio, L"@FPS" },
+        { L"DEFAULT_STRIDE", ValueKind::Int, nullptr },
+        { L"COLOR_MATRIX", ValueKind::Guid, nullptr },
+        { L"COLOR_RANGE", ValueKind::Guid, nullptr },
+    };
+
+    const wchar_t* YuvMatrixName(video::YuvMatrix matrix) noexcept
+    {
+        return matrix == video::YuvMatrix::BT709 ? L"BT709" : L"BT601";
+    }
+
+    const wchar_t* YuvRangeName(video::YuvRange range) noexcept
+    {
+        return range == video::YuvRange::Full ? L"full" : L"studio";
+    }
+}
+
+namespace capture
+{
+    const wchar_t* OutputFormatName(OutputFormat format) noexcept
+    {
+        switch (format)
+        {
+        case OutputFormat::Text: return L"text";
+        case OutputFormat::Json: return L"json";
+        case OutputFormat::Csv: return L"csv";
+        default: return L"unknown";
+        }
+    }
+
+    MediaTypeFormatter::MediaTypeFormatter(OutputFormat format, bool compact)
+        : m_format(format)
+        , m_compact(compact && format == OutputFormat::Text)
+        , m_stream(0)
+        , m_mediaType(0)
+        , m_firstField(true)
+        , m_csvHeader(false)
+    {
+    }
+
+    void MediaTypeFormatter::BeginRecord(const std::wstring& device, uint32_t stream, uint32_t mediaType)
+    {
+        m_device = device;
+        m_stream = stream;
+        m_mediaType = mediaType;
+        m_firstField = true;
+
+        switch (m_format)
+        {
+        case OutputFormat::Text:
+            if (m_compact)
+            {
+                m_buffer += L"\n  [";
+                AppendUint(stream);
+                m_buffer += L", ";
+                AppendUint(mediaType);
+                m_buffer += L"]:";
+            }
+            else
+            {
+                m_buffer += L"\n\n Stream ID : ";
+                AppendUint(stream);
+                m_buffer += L"\n Media type ID : ";
+                AppendUint(mediaType);
+            }
+            break;
+
+        case OutputFormat::Json:
+            m_buffer += L"{\"device\":";
+            AppendQuoted(device);
+            m_buffer += L",\"stream\":";
+            AppendUint(stream);
+            m_buffer += L",\"mediaType\":";
+            AppendUint(mediaType);
+            m_firstField = false;
+            break;
+
+        case OutputFormat::Csv:
+            if (!m_csvHeader)
+            {
+                m_buffer += L"device,stream,media_type,attribute,value\n";
+                m_csvHeader = true;
+            }
+            break;
+        }
+    }
+
+    void MediaTypeFormatter::EndRecord()
+    {
+        if (m_format == OutputFormat::Json)
+        {
+            m_buffer += L"}\n";
+        }
+    }
+
+    void MediaTypeFormatter::Ratio(const FieldDescriptor& field, uint32_t numerator, uint32_t denominator)
+    {
+        if (!BeginField(field))
+        {
+            return;
+        }
+
+        switch (m_format)
+        {
+        case OutputFormat::Text:
+            AppendDouble(denominator ? static_cast<double>(numerator) / denominator : 0);
+            break;
+
+        case OutputFormat::Json:
+            m_buffer += L'[';
+            AppendUint(numerator);
+            m_buffer += L',';
+            AppendUint(denominator);
+            m_buffer += L']';
+            break;
+
+        case OutputFormat::Csv:
+            AppendUint(numerator);
+            m_buffer += L'/';
+            AppendUint(denominator);
+            break;
+        }
+
+        EndField(field);
+    }
+
+    void MediaTypeFormatter::Size(const FieldDescriptor& field, uint32_t width, uint32_t height)
+    {
+        if (!BeginField(field))
+        {
+            return;
+        }
+
+        switch (m_format)
+        {
+        case OutputFormat::Text:
+            AppendUint(width);
+            m_buffer += L" x ";
+            AppendUint(height);
+            break;
+
+        case OutputFormat::Json:
+            m_buffer += L'[';
+            AppendUint(width);
+            m_buffer += L',';
+            AppendUint(height);
+            m_buffer += L']';
+            break;
+
+        case OutputFormat::Csv:
+            AppendUint(width);
+            m_buffer += L'x';
+            AppendUint(height);
+            break;
+        }
+
+        EndField(field);
+    }
+
+    void MediaTypeFormatter::Uint(const FieldDescriptor& field, uint64_t value)
+    {
+        if (BeginField(field))
+        {
+            AppendUint(value);
+            EndField(field);
+        }
+    }
+
+    void MediaTypeFormatter::Int(const FieldDescriptor& field, int64_t value)
+    {
+        if (BeginField(field))
+        {
+            AppendInt(value);
+            EndField(field);
+        }
+    }
+
+    void MediaTypeFormatter::Text(const FieldDescriptor& field, std::wstring_view value)
+    {
+        if (!BeginField(field))
+        {
+            return;
+        }
+
+        if (m_format == OutputFormat::Text)
+        {
+            m_buffer += value;
+        }
+        else
+        {
+            AppendQuoted(value);
+        }
+
+        EndField(field);
+    }
+
+    void MediaTypeFormatter::Unknown(std::wstring_view name)
+    {
+        switch (m_format)
+        {
+        case OutputFormat::Text:
+            if (!m_compact)
+            {
+                m_buffer += L"\n\r UNKNOWN GUID : ";
+                m_buffer += name;
+            }
+            break;
+
+        case OutputFormat::Json:
+            m_buffer += L',';
+            AppendQuoted(name);
+            m_buffer += L":null";
+            break;
+
+        case OutputFormat::Csv:
+            AppendQuoted(m_device);
+            m_buffer += L',';
+            AppendUint(m_stream);
+            m_buffer += L',';
+            AppendUint(m_mediaType);
+            m_buffer += L',';
+            AppendQuoted(name);
+            m_buffer += L",\n";
+            break;
+        }
+    }
+
+    void MediaTypeFormatter::Error(const std::wstring& message)
+    {
+        if (m_format == OutputFormat::Text && !m_compact)
+        {
+            m_buffer += L"\n\r ";
+            m_buffer += message;
+        }
+    }
+
+    void MediaTypeFormatter::Clear() noexcept
+    {
+        m_buffer.clear();
+    }
+
+    void MediaTypeFormatter::Flush(std::wostream& st)
+    {
+        st.write(m_buffer.data(), static_cast<std::streamsize>(m_buffer.size()));
+        m_buffer.clear();
+    }
+
+    bool MediaTypeFormatter::BeginField(const FieldDescriptor& field)
+    {
+        switch (m_format)
+        {
+        case OutputFormat::Text:
+            if (m_compact)
+            {
+                if (!field.compactSuffix)
+                {
+                    return false;
+                }
+
+                m_buffer += L' ';
+            }
+            else
+            {
+                m_buffer += L"\n\r ";
+                m_buffer += field.label;
+                m_buffer += L" : ";
+            }
+            break;
+
+        case OutputFormat::Json:
+            if (!m_firstField)
+            {
+                m_buffer += L',';
+            }
+
+            m_buffer += L'"';
+            m_buffer += field.label;
+            m_buffer += L"\":";
+            m_firstField = false;
+            break;
+
+        case OutputFormat::Csv:
+            AppendQuoted(m_device);
+            m_buffer += L',';
+            AppendUint(m_stream);
+            m_buffer += L',';
+            AppendUint(m_mediaType);
+            m_buffer += L',';
+            m_buffer += field.label;
+            m_buffer += L',';
+            break;
+        }
+
+        return true;
+    }
+
+    void MediaTypeFormatter::EndField(const FieldDescriptor& field)
+    {
+        if (m_compact)
+        {
+            m_buffer += field.compactSuffix;
+        }
+        else if (m_format == OutputFormat::Csv)
+        {
+            m_buffer += L'\n';
+        }
+    }
+
+    void MediaTypeFormatter::AppendUint(uint64_t value)
+    {
+        wchar_t digits[24];
+        size_t count = 0;
+
+        do
+        {
+            digits[count++] = static_cast<wchar_t>(L'0' + value % 10);
+            value /= 10;
+        } while (value);
+
+        while (count)
+        {
+            m_buffer += digits[--count];
+        }
+    }
+
+    void MediaTypeFormatter::AppendInt(int64_t value)
+    {
+        if (value < 0)
+        {
+            m_buffer += L'-';
+            AppendUint(0 - static_cast<uint64_t>(value));
+        }
+        else
+        {
+            AppendUint(static_cast<uint64_t>(value));
+        }
+    }
+
+    void MediaTypeFormatter::AppendDouble(double value)
+    {
+        //
+        // %g matches the default precision of std::wostream
+        //
+        wchar_t text[32];
+        const int length = std::swprintf(text, sizeof(text) / sizeof(text[0]), L"%g", value);
+
+        if (length > 0)
+        {
+            m_buffer.append(text, static_cast<size_t>(length));
+        }
+    }
+
+    void MediaTypeFormatter::AppendQuoted(std::wstring_view value)
+    {
+        if (m_format == OutputFormat::Csv)
+        {
+            //
+            // RFC 4180: quoted only if needed, quotes doubled
+            //
+            if (value.find_first_of(L",\"\r\n") == std::wstring_view::npos)
+            {
+                m_buffer += value;
+                return;
+            }
+
+            m_buffer += L'"';
+
+            for (wchar_t ch : value)
+            {
+                if (ch == L'"')
+                {
+                    m_buffer += L'"';
+                }
+
+                m_buffer += ch;
+            }
+
+            m_buffer += L'"';
+            return;
+        }
+
+        m_buffer += L'"';
+
+        for (wchar_t ch : value)
+        {
+            switch (ch)
+            {
+            case L'"': m_buffer += L"\\\""; break;
+            case L'\\': m_buffer += L"\\\\"; break;
+            case L'\n': m_buffer += L"\\n"; break;
+            case L'\r': m_buffer += L"\\r"; break;
+            case L'\t': m_buffer += L"\\t"; break;
+            default:
+                if (ch < 0x20)
+                {
+                    static const wchar_t hex[] = L"0123456789abcdef";
+                    m_buffer += L"\\u00";
+                    m_buffer += hex[(ch >> 4) & 0xF];
+                    m_buffer += hex[ch & 0xF];
+                }
+                else
+                {
+                    m_buffer += ch;
+                }
+                break;
+            }
+        }
+
+        m_buffer += L'"';
+    }
+
+    void FormatMediaTypeInfo(const MediaTypeInfo& mediaType, MediaTypeFormatter& formatter)
+    {
+        formatter.Text(MediaTypeInfoFields[0], mediaType.subtype);
+        formatter.Size(MediaTypeInfoFields[1], mediaType.width, mediaType.height);
+        formatter.Ratio(MediaTypeInfoFields[2], mediaType.fpsNumerator, mediaType.fpsDenominator);
+        formatter.Int(MediaTypeInfoFields[3], mediaType.defaultStride);
+        formatter.Text(MediaTypeInfoFields[4], YuvMatrixName(mediaType.colorSpace.matrix));
+        formatter.Text(MediaTypeInfoFields[5], YuvRangeName(mediaType.colorSpace.range));
+    }
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <ostream>
+#include <string>
+#include <string_view>
+#include "CaptureBackend.h"
+
+namespace capture
+{
+    enum class OutputFormat
+    {
+        Text = 0,
+        Json,       // one object per media type and line
+        Csv,        // one row per attribute
+    };
+
+    const wchar_t* OutputFormatName(OutputFormat format) noexcept;
+
+    enum class ValueKind
+    {
+        Ratio,      // numerator and denominator packed in a UINT64
+        Size,       // width and height packed in a UINT64
+        Uint,
+        Int,
+        Guid,       // printed by name
+    };
+
+    //
+    // One row of an attribute table
+    //
+    struct FieldDescriptor
+    {
+        const wchar_t* label;
+        ValueKind kind;
+        const wchar_t* compactSuffix;   // nullptr if the compact text form skips the field
+    };
+
+    //
+    // Formats media types into a reusable buffer, the caller flushes it once per device.
+    // The compact text form is " <subtype> <width> x <height> <fps>@FPS"
+    //
+    class MediaTypeFormatter
+    {
+    public:
+        explicit MediaTypeFormatter(OutputFormat format, bool compact = false);
+
+        OutputFormat GetFormat() const noexcept { return m_format; }
+        bool IsCompact() const noexcept { return m_compact; }
+
+        void BeginRecord(const std::wstring& device, uint32_t stream, uint32_t mediaType);
+        void EndRecord();
+
+        void Ratio(const FieldDescriptor& field, uint32_t numerator, uint32_t denominator);
+        void Size(const FieldDescriptor& field, uint32_t width, uint32_t height);
+        void Uint(const FieldDescriptor& field, uint64_t value);
+        void Int(const FieldDescriptor& field, int64_t value);
+        void Text(const FieldDescriptor& field, std::wstring_view value);
+
+        //
+        // An attribute without a descriptor, or a text-only diagnostic line
+        //
+        void Unknown(std::wstring_view name);
+        void Error(const std::wstring& message);
+
+        const std::wstring& GetBuffer() const noexcept { return m_buffer; }
+        void Clear() noexcept;
+        void Flush(std::wostream& st);
+
+    private:
+        bool BeginField(const FieldDescriptor& field);
+        void EndField(const FieldDescriptor& field);
+        void AppendUint(uint64_t value);
+        void AppendInt(int64_t value);
+        void AppendDouble(double value);
+        void AppendQuoted(std::wstring_view value);
+
+    private:
+        const OutputFormat m_format;
+        const bool m_compact;
+        std::wstring m_buffer;
+        std::wstring m_device;
+        uint32_t m_stream;
+        uint32_t m_mediaType;
+        bool m_firstField;
+        bool m_csvHeader;
+    };
+
+    //
+    // The fields of MediaTypeInfo in the formatter's terms
+    //
+    void FormatMediaTypeInfo(const MediaTypeInfo& mediaType, MediaTypeFormatter& formatter);
+}
@@ -0,0 +1,458 @@
+#include "MosaicCompositor.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+namespace
+{
+    using namespace video;
+
+    constexpr uint32_t LabelScale = 2;
+    constexpr uint32_t LabelMargin = 4;
+
+    uint32_t PackColorSpace(ColorSpace colorSpace) noexcept
+    {
+        return static_cast<uint32_t>(colorSpace.matrix) | (static_cast<uint32_t>(colorSpace.range) << 8);
+    }
+
+    ColorSpace UnpackColorSpace(uint32_t value) noexcept
+    {
+        ColorSpace colorSpace;
+        colorSpace.matrix = static_cast<YuvMatrix>(value & 0xFF);
+        colorSpace.range = static_cast<YuvRange>(value >> 8);
+        return colorSpace;
+    }
+}
+
+namespace video
+{
+    std::vector<TileRect> GridLayout(size_t tiles, uint32_t width, uint32_t height, uint32_t gap)
+    {
+        std::vector<TileRect> cells;
+
+        if (0 == tiles)
+        {
+            return cells;
+        }
+
+        const uint32_t columns = static_cast<uint32_t>(std::ceil(std::sqrt(static_cast<double>(tiles))));
+        const uint32_t rows = static_cast<uint32_t>((tiles + columns - 1) / columns);
+
+        for (size_t i = 0; i < tiles; ++i)
+        {
+            const uint32_t column = static_cast<uint32_t>(i % columns);
+            const uint32_t row = static_cast<uint32_t>(i / columns);
+
+            //
+            // Edges are computed from the grid lines, so rounding leaves no holes
+            //
+            const uint32_t left = column * width / columns;
+            const uint32_t right = (column + 1) * width / columns;
+            const uint32_t top = row * height / rows;
+            const uint32_t bottom = (row + 1) * height / rows;
+
+            TileRect cell;
+            cell.x = left + (column ? gap / 2 : 0);
+            cell.y = top + (row ? gap / 2 : 0);
+            cell.width = right - cell.x - (column + 1 < columns ? gap - gap / 2 : 0);
+            cell.height = bottom - cell.y - (row + 1 < rows ? gap - gap / 2 : 0);
+            cells.push_back(cell);
+        }
+
+        return cells;
+    }
+
+    TileRect FitRect(const TileRect& cell, uint32_t frameWidth, uint32_t frameHeight) noexcept
+    {
+        if (0 == frameWidth || 0 == frameHeight)
+        {
+            return TileRect();
+        }
+
+        TileRect rect = cell;
+
+        if (static_cast<uint64_t>(cell.width) * frameHeight > static_cast<uint64_t>(cell.height) * frameWidth)
+        {
+            rect.width = static_cast<uint32_t>(static_cast<uint64_t>(cell.height) * frameWidth / frameHeight);
+        }
+        else
+        {
+            rect.height = static_cast<uint32_t>(static_cast<uint64_t>(cell.width) * frameHeight / frameWidth);
+        }
+
+        rect.width = std::max(rect.width, 1u);
+        rect.height = std::max(rect.height, 1u);
+        rect.x = cell.x + (cell.width - rect.width) / 2;
+        rect.y = cell.y + (cell.height - rect.height) / 2;
+        return rect;
+    }
+
+    FrameView DecimateRows(const FrameView& frame, uint32_t height) noexcept
+    {
+        if (0 == height || frame.height < 2 * height)
+        {
+            return frame;
+        }
+
+        //
+        // Chroma row i of 4:2:0 formats stays under luma row 2i with the same step
+        //
+        const uint32_t step = frame.height / height;
+
+        FrameView view = frame;
+        view.height = frame.height / step;
+
+        for (size_t plane = 0; plane < view.planeCount; ++plane)
+        {
+            view.planes[plane].stride *= step;
+        }
+
+        return view;
+    }
+
+    void ScaleRgb32(
+        const uint8_t* src,
+        ptrdiff_t srcStride,
+        uint32_t srcWidth,
+        uint32_t srcHeight,
+        uint8_t* dst,
+        ptrdiff_t dstStride,
+        uint32_t dstWidth,
+        uint32_t dstHeight) noexcept
+    {
+        if (!srcWidth || !srcHeight || !dstWidth || !dstHeight)
+        {
+            return;
+        }
+
+        //
+        // Source columns of every destination pixel: [columns[x], columns[x + 1])
+        //
+        std::vector<uint32_t> columns(dstWidth + 1);
+
+        for (uint32_t x = 0; x <= dstWidth; ++x)
+        {
+            columns[x] = static_cast<uint32_t>(static_cast<uint64_t>(x) * srcWidth / dstWidth);
+        }
+
+        //
+        // B G R sums of the source pixels under every destination pixel
+        //
+        std::vector<uint32_t> sums(static_cast<size_t>(dstWidth) * 3);
+
+        for (uint32_t y = 0; y < dstHeight; ++y)
+        {
+            const uint32_t y0 = static_cast<uint32_t>(static_cast<uint64_t>(y) * srcHeight / dstHeight);
+            const uint32_t y1 = std::max(y0 + 1, static_cast<uint32_t>(static_cast<uint64_t>(y + 1) * srcHeight / dstHeight));
+
+            std::fill(sums.begin(), sums.end(), 0);
+
+            for (uint32_t sy = y0; sy < y1; ++sy)
+            {
+                const uint8_t* row = src + sy * srcStride;
+                uint32_t* sum = sums.data();
+
+                for (uint32_t x = 0; x < dstWidth; ++x, sum += 3)
+                {
+                    const uint32_t x0 = columns[x];
+                    const uint32_t x1 = std::max(x0 + 1, columns[x + 1]);
+                    uint32_t b = 0;
+                    uint32_t g = 0;
+                    uint32_t r = 0;
+
+                    for (const uint8_t* pixel = row + x0 * 4; pixel != row + x1 * 4; pixel += 4)
+                    {
+                        b += pixel[0];
+                        g += pixel[1];
+                        r += pixel[2];
+                    }
+
+                    sum[0] += b;
+                    sum[1] += g;
+                    sum[2] += r;
+                }
+            }
+
+            //
+            // One division per pixel, the sums are scaled by a 24-bit reciprocal of the area
+            //
+            uint8_t* out = dst + y * dstStride;
+            const uint32_t* sum = sums.data();
+
+            for (uint32_t x = 0; x < dstWidth; ++x, sum += 3)
+            {
+                const uint64_t area = static_cast<uint64_t>(std::max(columns[x] + 1, columns[x + 1]) - columns[x]) * (y1 - y0);
+                const uint64_t reciprocal = ((1ull << 24) + area / 2) / area;
+
+                out[x * 4 + 0] = static_cast<uint8_t>(std::min<uint64_t>((sum[0] * reciprocal + (1u << 23)) >> 24, 255));
+                out[x * 4 + 1] = static_cast<uint8_t>(std::min<uint64_t>((sum[1] * reciprocal + (1u << 23)) >> 24, 255));
+                out[x * 4 + 2] = static_cast<uint8_t>(std::min<uint64_t>((sum[2] * reciprocal + (1u << 23)) >> 24, 255));
+                out[x * 4 + 3] = 0xFF;
+            }
+        }
+    }
+
+    //
+    // MosaicCompositor
+    //
+
+    MosaicCompositor::TileSink::TileSink(MosaicCompositor& owner, size_t tile) noexcept
+        : m_owner(owner)
+        , m_tile(tile)
+    {
+    }
+
+    void MosaicCompositor::TileSink::OnFrame(const FrameView& frame, int64_t timestamp)
+    {
+        m_owner.Submit(m_tile, frame, timestamp);
+    }
+
+    MosaicCompositor::Tile::Tile(MosaicCompositor& owner, size_t index, const TileRect& rect)
+        : cell(rect)
+        , sink(owner, index)
+        , pendingHeight(0)
+        , received(0)
+        , replaced(0)
+        , rejected(0)
+        , colorSpace(PackColorSpace(ColorSpace()))
+        , converterColorSpace(0)
+        , composed(0)
+        , fpsReceived(0)
+        , fps(0)
+        , labelDirty(true)
+    {
+    }
+
+    MosaicCompositor::MosaicCompositor(size_t tiles, uint32_t width, uint32_t height, size_t poolLimit)
+        : m_width(width)
+        , m_height(height)
+        , m_stride(static_cast<ptrdiff_t>(width) * 4)
+        , m_canvas(static_cast<size_t>(width) * height * 4)
+        , m_pool(poolLimit)
+    {
+        ClearRect({ 0, 0, width, height });
+
+        const auto cells = GridLayout(tiles, width, height, 2);
+        const auto now = Clock::now();
+
+        for (size_t i = 0; i < cells.size(); ++i)
+        {
+            m_tiles.emplace_back(new Tile(*this, i, cells[i]));
+            m_tiles.back()->fpsStart = now;
+        }
+    }
+
+    MosaicCompositor::~MosaicCompositor()
+    {
+        //
+        // Pending frames go back to the pool before it is destroyed
+        //
+        m_tiles.clear();
+    }
+
+    size_t MosaicCompositor::GetTileCount() const noexcept
+    {
+        return m_tiles.size();
+    }
+
+    uint32_t MosaicCompositor::GetWidth() const noexcept
+    {
+        return m_width;
+    }
+
+    uint32_t MosaicCompositor::GetHeight() const noexcept
+    {
+        return m_height;
+    }
+
+    const uint8_t* MosaicCompositor::GetCanvas() const noexcept
+    {
+        return m_canvas.data();
+    }
+
+    ptrdiff_t MosaicCompositor::GetStride() const noexcept
+    {
+        return m_stride;
+    }
+
+    void MosaicCompositor::SetColorSpace(size_t tile, ColorSpace colorSpace) noexcept
+    {
+        m_tiles[tile]->colorSpace = PackColorSpace(colorSpace);
+    }
+
+    void MosaicCompositor::Submit(size_t tile, const FrameView& frame, int64_t timestamp)
+    {
+        Tile& slot = *m_tiles[tile];
+        slot.received.fetch_add(1, std::memory_order_relaxed);
+
+        //
+        // Only the rows the tile can show are copied
+        //
+        FrameRef copy = m_pool.Copy(DecimateRows(frame, slot.cell.height));
+
+        if (!copy)
+        {
+            slot.rejected.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        copy->timestamp = timestamp;
+
+        {
+            std::lock_guard<std::mutex> lock(slot.mutex);
+            std::swap(slot.pending, copy);
+            slot.pendingHeight = frame.height;
+        }
+
+        if (copy)
+        {
+            slot.replaced.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    FrameSink& MosaicCompositor::GetTileSink(size_t tile) noexcept
+    {
+        return m_tiles[tile]->sink;
+    }
+
+    size_t MosaicCompositor::Compose()
+    {
+        return Compose(Clock::now());
+    }
+
+    size_t MosaicCompositor::Compose(Clock::time_point now)
+    {
+        size_t drawn = 0;
+
+        for (auto& item : m_tiles)
+        {
+            Tile& tile = *item;
+            FrameRef frame;
+            uint32_t frameHeight = 0;
+
+            {
+                std::lock_guard<std::mutex> lock(tile.mutex);
+                std::swap(frame, tile.pending);
+                frameHeight = tile.pendingHeight;
+            }
+
+            if (frame)
+            {
+                if (DrawFrame(tile, frame->View(), frameHeight))
+                {
+                    tile.composed.fetch_add(1, std::memory_order_relaxed);
+                    tile.labelDirty = true;
+                    drawn += 1;
+                }
+                else
+                {
+                    tile.rejected.fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+
+            //
+            // The rate of the stream, not of the display, once a second
+            //
+            const double elapsed = std::chrono::duration<double>(now - tile.fpsStart).count();
+
+            if (elapsed >= 1.0)
+            {
+                const uint64_t received = tile.received.load(std::memory_order_relaxed);
+                tile.fps = (received - tile.fpsReceived) / elapsed;
+                tile.fpsReceived = received;
+                tile.fpsStart = now;
+                tile.labelDirty = true;
+            }
+
+            if (tile.labelDirty)
+            {
+                DrawTileLabel(tile);
+                tile.labelDirty = false;
+            }
+        }
+
+        return drawn;
+    }
+
+    MosaicCompositor::TileStatistics MosaicCompositor::GetTileStatistics(size_t tile) const noexcept
+    {
+        const Tile& slot = *m_tiles[tile];
+
+        TileStatistics stat;
+        stat.received = slot.received.load(std::memory_order_relaxed);
+        stat.composed = slot.composed.load(std::memory_order_relaxed);
+        stat.replaced = slot.replaced.load(std::memory_order_relaxed);
+        stat.rejected = slot.rejected.load(std::memory_order_relaxed);
+        stat.fps = slot.fps.load(std::memory_order_relaxed);
+        return stat;
+    }
+
+    bool MosaicCompositor::DrawFrame(Tile& tile, const FrameView& frame, uint32_t frameHeight)
+    {
+        //
+        // Frames are stored decimated, only the rows the tile shows are converted
+        //
+        const TileRect rect = FitRect(tile.cell, frame.width, frameHeight);
+        const uint32_t colorSpace = tile.colorSpace.load(std::memory_order_relaxed);
+
+        FrameFormat format;
+        format.format = frame.format;
+        format.width = frame.width;
+        format.height = frame.height;
+
+        if (format != tile.converterFormat || colorSpace != tile.converterColorSpace)
+        {
+            tile.converter = PixelConverter(frame.format, PixelFormat::RGB32, frame.width, frame.height, UnpackColorSpace(colorSpace));
+            tile.converterFormat = format;
+            tile.converterColorSpace = colorSpace;
+            tile.scratch.resize(static_cast<size_t>(frame.width) * frame.height * 4);
+        }
+
+        if (!tile.converter.Convert(frame.planes, tile.scratch.data(), static_cast<ptrdiff_t>(frame.width) * 4))
+        {
+            return false;
+        }
+
+        if (rect.x != tile.drawn.x || rect.y != tile.drawn.y || rect.width != tile.drawn.width || rect.height != tile.drawn.height)
+        {
+            //
+            // The letterbox of the previous frame size
+            //
+            ClearRect(tile.cell);
+            tile.drawn = rect;
+        }
+
+        ScaleRgb32(
+            tile.scratch.data(),
+            static_cast<ptrdiff_t>(frame.width) * 4,
+            frame.width,
+            frame.height,
+            m_canvas.data() + rect.y * m_stride + rect.x * 4,
+            m_stride,
+            rect.width,
+            rect.height);
+
+        return true;
+    }
+
+    void MosaicCompositor::DrawTileLabel(Tile& tile)
+    {
+        char text[32];
+        snprintf(text, sizeof(text), "%.1f fps", tile.fps.load(std::memory_order_relaxed));
+
+        DrawLabel(
+            m_canvas.data(),
+            m_stride,
+            tile.cell,
+            tile.cell.x + LabelMargin,
+            tile.cell.y + LabelMargin,
+            text,
+            LabelScale);
+    }
+
+    void MosaicCompositor::ClearRect(const TileRect& rect) noexcept
+    {
+        FillRect(m_canvas.data(), m_stride, rect, 0xFF000000);
+    }
+}
@@ -0,0 +1,149 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "FramePool.h"
+#include "FrameSink.h"
+#include "PixelConvert.h"
+#include "TextOverlay.h"
+
+namespace video
+{
+    //
+    // Cells of a near square grid covering the canvas, row by row
+    //
+    std::vector<TileRect> GridLayout(size_t tiles, uint32_t width, uint32_t height, uint32_t gap);
+
+    //
+    // The largest rect of the frame aspect ratio centered in the cell
+    //
+    TileRect FitRect(const TileRect& cell, uint32_t frameWidth, uint32_t frameHeight) noexcept;
+
+    //
+    // Keeps every n-th row by multiplying the strides, so the frame is not
+    // copied and is at least 'height' rows high
+    //
+    FrameView DecimateRows(const FrameView& frame, uint32_t height) noexcept;
+
+    //
+    // Box filter downscale of B G R X pixels, upscaling repeats pixels
+    //
+    void ScaleRgb32(
+        const uint8_t* src,
+        ptrdiff_t srcStride,
+        uint32_t srcWidth,
+        uint32_t srcHeight,
+        uint8_t* dst,
+        ptrdiff_t dstStride,
+        uint32_t dstWidth,
+        uint32_t dstHeight) noexcept;
+
+    //
+    // Composites the frames of many streams into one RGB32 canvas.
+    // Capture threads Submit frames to their tiles, one thread composes
+    // at the display rate: only the latest frame of a tile is converted,
+    // its rows are decimated on the way into the pool and it is scaled once
+    //
+    class MosaicCompositor
+    {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        struct TileStatistics
+        {
+            uint64_t received;
+            uint64_t composed;
+            uint64_t replaced;  // received frames replaced by a newer one before composing
+            uint64_t rejected;  // the pool had no memory or the format is not supported
+            double fps;
+        };
+
+        MosaicCompositor(size_t tiles, uint32_t width, uint32_t height, size_t poolLimit = 256 * 1024 * 1024);
+        ~MosaicCompositor();
+
+        MosaicCompositor(const MosaicCompositor&) = delete;
+        MosaicCompositor& operator=(const MosaicCompositor&) = delete;
+
+        size_t GetTileCount() const noexcept;
+        uint32_t GetWidth() const noexcept;
+        uint32_t GetHeight() const noexcept;
+        const uint8_t* GetCanvas() const noexcept;
+        ptrdiff_t GetStride() const noexcept;
+
+        //
+        // Applies to the frames composed after the call
+        //
+        void SetColorSpace(size_t tile, ColorSpace colorSpace) noexcept;
+
+        //
+        // Any thread, one producer per tile
+        //
+        void Submit(size_t tile, const FrameView& frame, int64_t timestamp);
+        FrameSink& GetTileSink(size_t tile) noexcept;
+
+        //
+        // Composing thread, returns the number of tiles drawn
+        //
+        size_t Compose();
+        size_t Compose(Clock::time_point now);
+
+        TileStatistics GetTileStatistics(size_t tile) const noexcept;
+
+    private:
+        class TileSink : public FrameSink
+        {
+        public:
+            TileSink(MosaicCompositor& owner, size_t tile) noexcept;
+            void OnFrame(const FrameView& frame, int64_t timestamp) override;
+
+        private:
+            MosaicCompositor& m_owner;
+            const size_t m_tile;
+        };
+
+        struct Tile
+        {
+            Tile(MosaicCompositor& owner, size_t index, const TileRect& rect);
+
+            const TileRect cell;
+            TileSink sink;
+
+            std::mutex mutex;
+            FrameRef pending;
+            uint32_t pendingHeight;     // before the rows were decimated
+            std::atomic<uint64_t> received;
+            std::atomic<uint64_t> replaced;
+            std::atomic<uint64_t> rejected;
+            std::atomic<uint32_t> colorSpace;
+
+            //
+            // Composing thread only
+            //
+            PixelConverter converter;
+            FrameFormat converterFormat;
+            uint32_t converterColorSpace;
+            std::vector<uint8_t> scratch;
+            TileRect drawn;
+            std::atomic<uint64_t> composed;
+            uint64_t fpsReceived;
+            Clock::time_point fpsStart;
+            std::atomic<double> fps;
+            bool labelDirty;
+        };
+
+        bool DrawFrame(Tile& tile, const FrameView& frame, uint32_t frameHeight);
+        void DrawTileLabel(Tile& tile);
+        void ClearRect(const TileRect& rect) noexcept;
+
+    private:
+        const uint32_t m_width;
+        const uint32_t m_height;
+        const ptrdiff_t m_stride;
+        std::vector<uint8_t> m_canvas;
+        FramePool m_pool;
+        std::vector<std::unique_ptr<Tile>> m_tiles;
+    };
+}
@@ -0,0 +1,463 @@
+#include "stdafx.h"
+#include "MosaicWindow.h"
+#include <algorithm>
+#include <iomanip>
+
+namespace
+{
+    //
+    // Used when the adapter does not report its refresh rate
+    //
+    constexpr UINT DefaultRefreshRate = 60;
+}
+
+namespace mf
+{
+    MosaicWindow::MosaicWindow() noexcept
+        : m_hwnd(nullptr)
+        , m_readDepth(1)
+        , m_started(0)
+        , m_presented(0)
+        , m_presentedPrev(0)
+        , m_composeMsTotal(0)
+        , m_composeMsMax(0)
+    {
+    }
+
+    MosaicWindow::~MosaicWindow()
+    {
+        Close();
+    }
+
+    HRESULT MosaicWindow::SetTitle(std::wstring title)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_title = std::move(title);
+        return S_OK;
+    }
+
+    HRESULT MosaicWindow::SetReadDepth(ULONG depth)
+    {
+        if (0 == depth)
+        {
+            return E_INVALIDARG;
+        }
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_readDepth = depth;
+        return S_OK;
+    }
+
+    HRESULT MosaicWindow::Show(const std::vector<capture::FrameSource*>& sources, uint32_t width, uint32_t height)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+
+        if (m_hwnd)
+        {
+            return S_FALSE;
+        }
+
+        if (sources.empty() || 0 == width || 0 == height)
+        {
+            HR_CHECK(E_INVALIDARG, "no sources or an empty canvas");
+        }
+
+        for (const auto source : sources)
+        {
+            const auto& mediaType = source->GetMediaType();
+
+            if (!video::PixelConverter::IsSupported(mediaType.format, video::PixelFormat::RGB32))
+            {
+                HR_CHECK(MF_E_INVALIDMEDIATYPE, "unsupported subtype " << static_cast<uint32_t>(mediaType.format));
+            }
+        }
+
+        m_sources = sources;
+        m_started = 0;
+        m_compositor.reset(new video::MosaicCompositor(sources.size(), width, height));
+        m_presented = 0;
+        m_presentedPrev = 0;
+        m_composeMsTotal = 0;
+        m_composeMsMax = 0;
+
+        for (size_t i = 0; i < sources.size(); ++i)
+        {
+            m_compositor->SetColorSpace(i, sources[i]->GetMediaType().colorSpace);
+        }
+
+        HRESULT hr = CreateWnd();
+
+        if (SUCCEEDED(hr))
+        {
+            hr = AttachWindow();
+        }
+
+        if (SUCCEEDED(hr))
+        {
+            hr = StartSources();
+        }
+
+        if (FAILED(hr))
+        {
+            DestroyWnd();
+            return hr;
+        }
+
+        HWND hwnd = m_hwnd;
+        lock.unlock();
+
+        ShowWindow(hwnd, SW_SHOW);
+        UpdateWindow(hwnd);
+
+        //
+        // One frame per display refresh, whatever the rates of the streams are
+        //
+        D3DDISPLAYMODE mode = {};
+        m_pDirect3D9->GetAdapterDisplayMode(D3DADAPTER_DEFAULT, &mode);
+
+        const auto period = std::chrono::microseconds(1000000 / (mode.RefreshRate ? mode.RefreshRate : DefaultRefreshRate));
+        auto deadline = std::chrono::steady_clock::now();
+
+        MSG msg = { 0 };
+        bool quit = false;
+
+        while (!quit)
+        {
+            const auto now = std::chrono::steady_clock::now();
+
+            if (now >= deadline)
+            {
+                Present();
+
+                //
+                // A late frame moves the schedule instead of presenting twice in a row
+                //
+                deadline += period;
+
+                if (deadline < now)
+                {
+                    deadline = now + period;
+                }
+            }
+
+            const auto timeout = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+            const DWORD res = MsgWaitForMultipleObjects(0, NULL, FALSE, timeout.count() > 0 ? static_cast<DWORD>(timeout.count()) : 0, QS_ALLINPUT);
+
+            if (res == WAIT_TIMEOUT)
+            {
+                continue;
+            }
+
+            if (res != WAIT_OBJECT_0)
+            {
+                break;
+            }
+
+            while (PeekMessage(&msg, NULL, 0, 0, PM_REMOVE))
+            {
+                if (msg.message == WM_QUIT)
+                {
+                    quit = true;
+                    break;
+                }
+                TranslateMessage(&msg);
+                DispatchMessage(&msg);
+            }
+        }
+
+        lock.lock();
+        DestroyWnd();
+        return S_OK;
+    }
+
+    HRESULT MosaicWindow::Close() noexcept
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        if (m_hwnd && !PostMessageW(m_hwnd, WM_CLOSE, 0, 0))
+        {
+            return E_FAIL;
+        }
+
+        return S_OK;
+    }
+
+    MosaicWindow::Statistics MosaicWindow::GetStatistics()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        Statistics stat = {};
+        stat.presented = m_presented;
+        stat.composeMsAvg = m_presented ? m_composeMsTotal / m_presented : 0;
+        stat.composeMsMax = m_composeMsMax;
+
+        const auto stopTime = m_hwnd ? std::chrono::steady_clock::now() : m_stopTime;
+        stat.seconds = std::chrono::duration<double>(stopTime - m_startTime).count();
+
+        if (m_compositor)
+        {
+            for (size_t i = 0; i < m_compositor->GetTileCount(); ++i)
+            {
+                stat.tiles.push_back(m_compositor->GetTileStatistics(i));
+            }
+        }
+
+        return stat;
+    }
+
+    HRESULT MosaicWindow::CreateWnd()
+    {
+        WNDCLASSEX wc = { 0 };
+        wc.cbSize = sizeof(wc);
+        wc.hbrBackground = reinterpret_cast<HBRUSH>(COLOR_WINDOW + 1);
+        wc.lpfnWndProc = WndProc;
+        wc.lpszClassName = L"msmf mosaic window";
+        wc.style = CS_HREDRAW | CS_VREDRAW;
+        RegisterClassEx(&wc);
+
+        const DWORD wndStyle = WS_CAPTION | WS_SYSMENU | WS_MINIMIZEBOX;
+
+        RECT rect = { 0 };
+        rect.right = m_compositor->GetWidth();
+        rect.bottom = m_compositor->GetHeight();
+
+        if (!AdjustWindowRect(&rect, wndStyle, FALSE))
+        {
+            const DWORD err = GetLastError();
+            return HRESULT_FROM_WIN32(err);
+        }
+
+        m_hwnd = CreateWindowW(wc.lpszClassName
+            , m_title.c_str()
+            , wndStyle
+            , 0, 0
+            , rect.right - rect.left
+            , rect.bottom - rect.top
+            , NULL, NULL, NULL, NULL);
+
+        if (!m_hwnd)
+        {
+            const DWORD err = GetLastError();
+            return HRESULT_FROM_WIN32(err);
+        }
+
+        if (0 != SetWindowLongPtr(m_hwnd, GWLP_USERDATA, reinterpret_cast<ULONG_PTR>(this)))
+        {
+            const DWORD err = GetLastError();
+            return HRESULT_FROM_WIN32(err);
+        }
+
+        if (0 == SetTimer(m_hwnd, 0, 1000, FpsTimer))
+        {
+            const DWORD err = GetLastError();
+            return HRESULT_FROM_WIN32(err);
+        }
+
+        return S_OK;
+    }
+
+    HRESULT MosaicWindow::AttachWindow()
+    {
+        ComPtr<IDirect3D9> direct3D9 = Direct3DCreate9(D3D_SDK_VERSION);
+        if (!direct3D9)
+        {
+            return E_FAIL;
+        }
+
+        D3DPRESENT_PARAMETERS d3dpp = { 0 };
+        d3dpp.Windowed = TRUE;
+        d3dpp.SwapEffect = D3DSWAPEFFECT_DISCARD;
+        d3dpp.BackBufferFormat = D3DFMT_UNKNOWN;
+        d3dpp.PresentationInterval = D3DPRESENT_INTERVAL_IMMEDIATE;
+
+        ComPtr<IDirect3DDevice9> direct3DDevice;
+        HRCHK(IDirect3D9_CreateDevice(direct3D9
+            , D3DADAPTER_DEFAULT
+            , D3DDEVTYPE_HAL
+            , m_hwnd
+            , D3DCREATE_SOFTWARE_VERTEXPROCESSING
+            , &d3dpp
+            , &direct3DDevice));
+
+        ComPtr<IDirect3DSurface9> direct3DSurface;
+        HRCHK(IDirect3DDevice9_CreateOffscreenPlainSurface(direct3DDevice
+            , m_compositor->GetWidth()
+            , m_compositor->GetHeight()
+            , D3DFMT_X8R8G8B8
+            , D3DPOOL_DEFAULT
+            , &direct3DSurface
+            , NULL));
+
+        m_pDirect3D9.Swap(direct3D9);
+        m_pDirect3DDevice.Swap(direct3DDevice);
+        m_pDirect3DSurface.Swap(direct3DSurface);
+        return S_OK;
+    }
+
+    HRESULT MosaicWindow::StartSources()
+    {
+        m_startTime = std::chrono::steady_clock::now();
+        m_stopTime = m_startTime;
+
+        for (; m_started < m_sources.size(); ++m_started)
+        {
+            HRCHK(m_sources[m_started]->Start(m_compositor->GetTileSink(m_started), m_readDepth));
+        }
+
+        return S_OK;
+    }
+
+    void MosaicWindow::StopSources() noexcept
+    {
+        //
+        // The tiles take no window lock, so every source can finish its frame
+        //
+        for (size_t i = 0; i < m_started; ++i)
+        {
+            m_sources[i]->Stop();
+        }
+
+        m_started = 0;
+    }
+
+    HRESULT MosaicWindow::Present()
+    {
+        //
+        // Runs on the window thread only, as the compositor requires
+        //
+        const auto begin = std::chrono::steady_clock::now();
+        m_compositor->Compose(begin);
+        const double composeMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_presented += 1;
+            m_composeMsTotal += composeMs;
+            m_composeMsMax = std::max(m_composeMsMax, composeMs);
+        }
+
+        if (!m_pDirect3DSurface || !m_pDirect3DDevice)
+        {
+            return E_FAIL;
+        }
+
+        D3DLOCKED_RECT d3dRect = {};
+        HRCHK(IDirect3DSurface9_LockRect(m_pDirect3DSurface
+            , &d3dRect
+            , NULL
+            , D3DLOCK_DONOTWAIT));
+
+        auto dest = static_cast<uint8_t*>(d3dRect.pBits);
+
+        if (!dest)
+        {
+            // check dest just for VS static analyzer
+            return E_FAIL;
+        }
+
+        const uint8_t* canvas = m_compositor->GetCanvas();
+        const size_t rowBytes = static_cast<size_t>(m_compositor->GetWidth()) * 4;
+
+        for (uint32_t y = 0; y < m_compositor->GetHeight(); ++y)
+        {
+            memcpy(dest + y * d3dRect.Pitch, canvas + y * m_compositor->GetStride(), rowBytes);
+        }
+
+        HRCHK(IDirect3DSurface9_UnlockRect(m_pDirect3DSurface));
+        HRCHK(IDirect3DDevice9_BeginScene(m_pDirect3DDevice));
+
+        IDirect3DSurface9 * pBackBuffer = NULL;
+        HRCHK(IDirect3DDevice9_GetBackBuffer(m_pDirect3DDevice
+            , 0
+            , 0
+            , D3DBACKBUFFER_TYPE_MONO
+            , &pBackBuffer));
+
+        HRESULT hr = IDirect3DDevice9_StretchRect(m_pDirect3DDevice
+            , m_pDirect3DSurface.Get()
+            , NULL
+            , pBackBuffer
+            , NULL
+            , D3DTEXF_NONE);
+
+        pBackBuffer->Release();
+        HRCHK(hr);
+
+        HRCHK(IDirect3DDevice9_EndScene(m_pDirect3DDevice));
+        HRCHK(IDirect3DDevice9_Present(m_pDirect3DDevice
+            , NULL
+            , NULL
+            , NULL
+            , NULL));
+
+        return S_OK;
+    }
+
+    HRESULT MosaicWindow::DestroyWnd()
+    {
+        HWND hwnd = m_hwnd;
+        m_hwnd = nullptr;
+
+        StopSources();
+
+        if (hwnd)
+        {
+            m_stopTime = std::chrono::steady_clock::now();
+        }
+
+        m_pDirect3DSurface.Reset();
+        m_pDirect3DDevice.Reset();
+        m_pDirect3D9.Reset();
+
+        if (hwnd && !DestroyWindow(hwnd))
+        {
+            const DWORD err = GetLastError();
+            return HRESULT_FROM_WIN32(err);
+        }
+
+        return S_OK;
+    }
+
+    MosaicWindow* MosaicWindow::GetThis(HWND hwnd)
+    {
+        return reinterpret_cast<MosaicWindow*>(GetWindowLongPtr(hwnd, GWLP_USERDATA));
+    }
+
+    LRESULT WINAPI MosaicWindow::WndProc(HWND hwnd, UINT msg, WPARAM wparam, LPARAM lparam)
+    {
+        switch (msg)
+        {
+        case WM_CLOSE:
+            //
+            // The loop of Show destroys the window once it leaves
+            //
+            PostQuitMessage(0);
+            return 0;
+        }
+
+        return DefWindowProc(hwnd, msg, wparam, lparam);
+    }
+
+    VOID CALLBACK MosaicWindow::FpsTimer(HWND hwnd, UINT msg, UINT_PTR idEvent, DWORD dwTime)
+    {
+        UNREFERENCED_PARAMETER(msg);
+        UNREFERENCED_PARAMETER(idEvent);
+        UNREFERENCED_PARAMETER(dwTime);
+
+        auto pThis = GetThis(hwnd);
+
+        std::wstringstream st;
+        std::lock_guard<std::mutex> lock(pThis->m_mutex);
+
+        const uint64_t presentFps = pThis->m_presented - pThis->m_presentedPrev;
+        pThis->m_presentedPrev = pThis->m_presented;
+
+        st << pThis->m_title << " " << pThis->m_sources.size() << " streams"
+            << " present FPS " << presentFps
+            << " compose ms avg " << std::fixed << std::setprecision(2)
+            << (pThis->m_presented ? pThis->m_composeMsTotal / pThis->m_presented : 0)
+            << " max " << pThis->m_composeMsMax;
+
+        SetWindowTextW(hwnd, st.str().c_str());
+    }
+}
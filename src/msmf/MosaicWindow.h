@@ -0,0 +1,88 @@
+#pragma once
+#include <windows.h>
+#include <wrl.h>
+#include <wrl/client.h>
+#include <d3d9.h>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "ComUtils.h"
+#include "CaptureBackend.h"
+#include "MosaicCompositor.h"
+
+#pragma comment(lib, "d3d9.lib")
+
+namespace mf
+{
+    //
+    // One window, one thread and one D3D device for any number of streams.
+    // The sources feed the tiles of a MosaicCompositor from their own threads,
+    // the window thread composes and presents the canvas at the display rate
+    //
+    class MosaicWindow
+    {
+    public:
+        struct Statistics
+        {
+            uint64_t presented;
+            double composeMsAvg;    // CPU time of Compose per presented frame
+            double composeMsMax;
+            double seconds;
+            std::vector<video::MosaicCompositor::TileStatistics> tiles;
+        };
+
+        MosaicWindow() noexcept;
+        ~MosaicWindow();
+
+        MosaicWindow(const MosaicWindow&) = delete;
+        MosaicWindow& operator=(const MosaicWindow&) = delete;
+
+        HRESULT SetTitle(std::wstring title);
+        HRESULT SetReadDepth(ULONG depth);
+
+        //
+        // Runs the window on the calling thread until it is closed.
+        // The sources are started by the window and stopped when it closes,
+        // they must outlive the window
+        //
+        HRESULT Show(const std::vector<capture::FrameSource*>& sources, uint32_t width, uint32_t height);
+        HRESULT Close() noexcept;
+
+        Statistics GetStatistics();
+
+    private:
+        HRESULT CreateWnd();
+        HRESULT AttachWindow();
+        HRESULT StartSources();
+        void StopSources() noexcept;
+        HRESULT Present();
+        HRESULT DestroyWnd();
+
+        static MosaicWindow* GetThis(HWND hwnd);
+        static LRESULT WINAPI WndProc(HWND hwnd, UINT msg, WPARAM wparam, LPARAM lparam);
+        static VOID CALLBACK FpsTimer(HWND hwnd, UINT msg, UINT_PTR idEvent, DWORD dwTime);
+
+    private:
+        std::mutex m_mutex;
+        std::wstring m_title;
+        HWND m_hwnd;
+        ULONG m_readDepth;
+        ComPtr<IDirect3D9> m_pDirect3D9;
+        ComPtr<IDirect3DDevice9> m_pDirect3DDevice;
+        ComPtr<IDirect3DSurface9> m_pDirect3DSurface;
+
+        //
+        // The compositor outlives the sources writing to its tiles
+        //
+        std::unique_ptr<video::MosaicCompositor> m_compositor;
+        std::vector<capture::FrameSource*> m_sources;
+        size_t m_started;
+
+        uint64_t m_presented;
+        uint64_t m_presentedPrev;
+        double m_composeMsTotal;
+        double m_composeMsMax;
+        std::chrono::steady_clock::time_point m_startTime;
+        std::chrono::steady_clock::time_point m_stopTime;
+    };
+}
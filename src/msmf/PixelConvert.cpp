@@ -0,0 +1,659 @@
+#include "PixelConvert.h"
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#define PIXEL_CONVERT_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace
+{
+    using namespace video;
+
+    constexpr uint32_t SimdPixels = 16;
+
+    inline int Sat16(int value) noexcept
+    {
+        return std::min(std::max(value, -32768), 32767);
+    }
+
+    inline uint8_t Clamp8(int value) noexcept
+    {
+        return static_cast<uint8_t>(std::min(std::max(value, 0), 255));
+    }
+
+    //
+    // The scalar math is the reference for the SIMD kernels:
+    // 16 bit saturated sums, arithmetic shift and unsigned saturation
+    //
+    inline void YuvToBgra(const YuvCoefficients& c, int y, int u, int v, uint8_t* dst) noexcept
+    {
+        const int yt = (y - c.yOffset) * c.yScale + 32;
+        u -= 128;
+        v -= 128;
+
+        dst[0] = Clamp8(Sat16(yt + u * c.bu) >> 6);
+        dst[1] = Clamp8(Sat16(Sat16(yt - u * c.gu) - v * c.gv) >> 6);
+        dst[2] = Clamp8(Sat16(yt + v * c.rv) >> 6);
+        dst[3] = 0xFF;
+    }
+
+    inline uint8_t RgbToY(const YuvCoefficients& c, int r, int g, int b) noexcept
+    {
+        return Clamp8(((c.toY[0] * r + c.toY[1] * g + c.toY[2] * b + 128) >> 8) + c.yOffset);
+    }
+
+    inline uint8_t RgbToU(const YuvCoefficients& c, int r, int g, int b) noexcept
+    {
+        return Clamp8(((c.toU[0] * r + c.toU[1] * g + c.toU[2] * b + 128) >> 8) + 128);
+    }
+
+    inline uint8_t RgbToV(const YuvCoefficients& c, int r, int g, int b) noexcept
+    {
+        return Clamp8(((c.toV[0] * r + c.toV[1] * g + c.toV[2] * b + 128) >> 8) + 128);
+    }
+
+    //
+    // Scalar row kernels
+    //
+
+    void Nv12ToBgraRow(const YuvCoefficients& c, const uint8_t* const* src, uint8_t* dst, uint32_t begin, uint32_t end)
+    {
+        for (uint32_t x = begin; x < end; ++x)
+        {
+            const uint8_t* uv = src[1] + (x & ~1u);
+            YuvToBgra(c, src[0][x], uv[0], uv[1], dst + x * 4);
+        }
+    }
+
+    void I420ToBgraRow(const YuvCoefficients& c, const uint8_t* const* src, uint8_t* dst, uint32_t begin, uint32_t end)
+    {
+        for (uint32_t x = begin; x < end; ++x)
+        {
+            YuvToBgra(c, src[0][x], src[1][x / 2], src[2][x / 2], dst + x * 4);
+        }
+    }
+
+    template<size_t Y, size_t U, size_t V>
+    void PackedToBgraRow(const YuvCoefficients& c, const uint8_t* const* src, uint8_t* dst, uint32_t begin, uint32_t end)
+    {
+        for (uint32_t x = begin; x < end; ++x)
+        {
+            const uint8_t* pair = src[0] + (x / 2) * 4;
+            YuvToBgra(c, pair[Y + (x & 1) * 2], pair[U], pair[V], dst + x * 4);
+        }
+    }
+
+    void Rgb24ToBgraRow(const YuvCoefficients&, const uint8_t* const* src, uint8_t* dst, uint32_t begin, uint32_t end)
+    {
+        for (uint32_t x = begin; x < end; ++x)
+        {
+            const uint8_t* rgb = src[0] + x * 3;
+            uint8_t* bgra = dst + x * 4;
+            bgra[0] = rgb[0];
+            bgra[1] = rgb[1];
+            bgra[2] = rgb[2];
+            bgra[3] = 0xFF;
+        }
+    }
+
+    void Rgb32ToBgraRow(const YuvCoefficients&, const uint8_t* const* src, uint8_t* dst, uint32_t begin, uint32_t end)
+    {
+        memcpy(dst + begin * 4, src[0] + begin * 4, (end - begin) * 4);
+    }
+
+    //
+    // YUY2 destination rows work on pixel pairs, odd widths are rounded up
+    //
+
+    void Nv12ToYuy2Row(const YuvCoefficients&, const uint8_t* const* src, uint8_t* dst, uint32_t begin, uint32_t end)
+    {
+        for (uint32_t x = begin; x < end; x += 2)
+        {
+            uint8_t* out = dst + x * 2;
+            out[0] = src[0][x];
+            out[1] = src[1][x];
+            out[2] = src[0][(x + 1 < end) ? x + 1 : x];
+            out[3] = src[1][x + 1];
+        }
+    }
+
+    void I420ToYuy2Row(const YuvCoefficients&, const uint8_t* const* src, uint8_t* dst, uint32_t begin, uint32_t end)
+    {
+        for (uint32_t x = begin; x < end; x += 2)
+        {
+            uint8_t* out = dst + x * 2;
+            out[0] = src[0][x];
+            out[1] = src[1][x / 2];
+            out[2] = src[0][(x + 1 < end) ? x + 1 : x];
+            out[3] = src[2][x / 2];
+        }
+    }
+
+    void UyvyToYuy2Row(const YuvCoefficients&, const uint8_t* const* src, uint8_t* dst, uint32_t begin, uint32_t end)
+    {
+        for (uint32_t x = begin; x < end; x += 2)
+        {
+            const uint8_t* in = src[0] + x * 2;
+            uint8_t* out = dst + x * 2;
+            out[0] = in[1];
+            out[1] = in[0];
+            out[2] = in[3];
+            out[3] = in[2];
+        }
+    }
+
+    void Yuy2ToYuy2Row(const YuvCoefficients&, const uint8_t* const* src, uint8_t* dst, uint32_t begin, uint32_t end)
+    {
+        end = (end + 1) & ~1u;
+        memcpy(dst + begin * 2, src[0] + begin * 2, (end - begin) * 2);
+    }
+
+    void Rgb24ToYuy2Row(const YuvCoefficients& c, const uint8_t* const* src, uint8_t* dst, uint32_t begin, uint32_t end)
+    {
+        for (uint32_t x = begin; x < end; x += 2)
+        {
+            const uint8_t* p0 = src[0] + x * 3;
+            const uint8_t* p1 = (x + 1 < end) ? p0 + 3 : p0;
+            uint8_t* out = dst + x * 2;
+
+            const int r = (p0[2] + p1[2] + 1) / 2;
+            const int g = (p0[1] + p1[1] + 1) / 2;
+            const int b = (p0[0] + p1[0] + 1) / 2;
+
+            out[0] = RgbToY(c, p0[2], p0[1], p0[0]);
+            out[1] = RgbToU(c, r, g, b);
+            out[2] = RgbToY(c, p1[2], p1[1], p1[0]);
+            out[3] = RgbToV(c, r, g, b);
+        }
+    }
+
+#ifdef PIXEL_CONVERT_SSE2
+
+    //
+    // SSE2 kernels, 16 pixels per iteration. Bit exact with the scalar kernels
+    //
+
+    struct Sse2Coefficients
+    {
+        __m128i yOffset;
+        __m128i yScale;
+        __m128i rv;
+        __m128i gu;
+        __m128i gv;
+        __m128i bu;
+        __m128i round;
+        __m128i chroma;
+
+        explicit Sse2Coefficients(const YuvCoefficients& c) noexcept
+            : yOffset(_mm_set1_epi16(c.yOffset))
+            , yScale(_mm_set1_epi16(c.yScale))
+            , rv(_mm_set1_epi16(c.rv))
+            , gu(_mm_set1_epi16(c.gu))
+            , gv(_mm_set1_epi16(c.gv))
+            , bu(_mm_set1_epi16(c.bu))
+            , round(_mm_set1_epi16(32))
+            , chroma(_mm_set1_epi16(128))
+        {
+        }
+    };
+
+    //
+    // y, u, v: 8 pixels as 16 bit values, returns 8 bit b, g, r in the low 8 bytes
+    //
+    inline void YuvToBgr8(const Sse2Coefficients& c, __m128i y, __m128i u, __m128i v, __m128i& b, __m128i& g, __m128i& r) noexcept
+    {
+        const __m128i yt = _mm_add_epi16(_mm_mullo_epi16(_mm_sub_epi16(y, c.yOffset), c.yScale), c.round);
+        u = _mm_sub_epi16(u, c.chroma);
+        v = _mm_sub_epi16(v, c.chroma);
+
+        b = _mm_srai_epi16(_mm_adds_epi16(yt, _mm_mullo_epi16(u, c.bu)), 6);
+        g = _mm_srai_epi16(_mm_subs_epi16(_mm_subs_epi16(yt, _mm_mullo_epi16(u, c.gu)), _mm_mullo_epi16(v, c.gv)), 6);
+        r = _mm_srai_epi16(_mm_adds_epi16(yt, _mm_mullo_epi16(v, c.rv)), 6);
+    }
+
+    //
+    // y: 16 luma bytes, u/v: 8 chroma values (16 bit) for the 16 pixels
+    //
+    inline void StoreBgra16(const Sse2Coefficients& c, __m128i y, __m128i u, __m128i v, uint8_t* dst) noexcept
+    {
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i alpha = _mm_set1_epi8(static_cast<char>(0xFF));
+
+        __m128i b0, g0, r0, b1, g1, r1;
+        YuvToBgr8(c, _mm_unpacklo_epi8(y, zero), _mm_unpacklo_epi16(u, u), _mm_unpacklo_epi16(v, v), b0, g0, r0);
+        YuvToBgr8(c, _mm_unpackhi_epi8(y, zero), _mm_unpackhi_epi16(u, u), _mm_unpackhi_epi16(v, v), b1, g1, r1);
+
+        const __m128i b = _mm_packus_epi16(b0, b1);
+        const __m128i g = _mm_packus_epi16(g0, g1);
+        const __m128i r = _mm_packus_epi16(r0, r1);
+
+        const __m128i bgLo = _mm_unpacklo_epi8(b, g);
+        const __m128i bgHi = _mm_unpackhi_epi8(b, g);
+        const __m128i raLo = _mm_unpacklo_epi8(r, alpha);
+        const __m128i raHi = _mm_unpackhi_epi8(r, alpha);
+
+        __m128i* out = reinterpret_cast<__m128i*>(dst);
+        _mm_storeu_si128(out + 0, _mm_unpacklo_epi16(bgLo, raLo));
+        _mm_storeu_si128(out + 1, _mm_unpackhi_epi16(bgLo, raLo));
+        _mm_storeu_si128(out + 2, _mm_unpacklo_epi16(bgHi, raHi));
+        _mm_storeu_si128(out + 3, _mm_unpackhi_epi16(bgHi, raHi));
+    }
+
+    inline __m128i Load(const uint8_t* src) noexcept
+    {
+        return _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+    }
+
+    inline __m128i Load64(const uint8_t* src) noexcept
+    {
+        return _mm_loadl_epi64(reinterpret_cast<const __m128i*>(src));
+    }
+
+    void Nv12ToBgraRowSse2(const YuvCoefficients& coeffs, const uint8_t* const* src, uint8_t* dst, uint32_t begin, uint32_t end)
+    {
+        const Sse2Coefficients c(coeffs);
+        const __m128i mask = _mm_set1_epi16(0x00FF);
+
+        for (uint32_t x = begin; x < end; x += SimdPixels)
+        {
+            const __m128i uv = Load(src[1] + x);
+            StoreBgra16(c, Load(src[0] + x), _mm_and_si128(uv, mask), _mm_srli_epi16(uv, 8), dst + x * 4);
+        }
+    }
+
+    void I420ToBgraRowSse2(const YuvCoefficients& coeffs, const uint8_t* const* src, uint8_t* dst, uint32_t begin, uint32_t end)
+    {
+        const Sse2Coefficients c(coeffs);
+        const __m128i zero = _mm_setzero_si128();
+
+        for (uint32_t x = begin; x < end; x += SimdPixels)
+        {
+            const __m128i u = _mm_unpacklo_epi8(Load64(src[1] + x / 2), zero);
+            const __m128i v = _mm_unpacklo_epi8(Load64(src[2] + x / 2), zero);
+            StoreBgra16(c, Load(src[0] + x), u, v, dst + x * 4);
+        }
+    }
+
+    //
+    // Splits 16 bit [c0 c1 c2 c3 ...] chroma words into 32 bit lanes of the even and the odd words
+    //
+    inline void SplitChroma(__m128i chroma, __m128i& even, __m128i& odd) noexcept
+    {
+        even = _mm_srli_epi32(_mm_slli_epi32(chroma, 16), 16);
+        odd = _mm_srli_epi32(chroma, 16);
+    }
+
+    template<bool Uyvy>
+    void PackedToBgraRowSse2(const YuvCoefficients& coeffs, const uint8_t* const* src, uint8_t* dst, uint32_t begin, uint32_t end)
+    {
+        const Sse2Coefficients c(coeffs);
+        const __m128i mask = _mm_set1_epi16(0x00FF);
+
+        for (uint32_t x = begin; x < end; x += SimdPixels)
+        {
+            const __m128i p0 = Load(src[0] + x * 2);
+            const __m128i p1 = Load(src[0] + x * 2 + 16);
+
+            __m128i y0, y1, c0, c1;
+
+            if (Uyvy)
+            {
+                y0 = _mm_srli_epi16(p0, 8);
+                y1 = _mm_srli_epi16(p1, 8);
+                c0 = _mm_and_si128(p0, mask);
+                c1 = _mm_and_si128(p1, mask);
+            }
+            else
+            {
+                y0 = _mm_and_si128(p0, mask);
+                y1 = _mm_and_si128(p1, mask);
+                c0 = _mm_srli_epi16(p0, 8);
+                c1 = _mm_srli_epi16(p1, 8);
+            }
+
+            //
+            // c0/c1 are [U V U V ...] words, pack them to 8 U and 8 V words
+            //
+            __m128i u0, v0, u1, v1;
+            SplitChroma(c0, u0, v0);
+            SplitChroma(c1, u1, v1);
+
+            const __m128i u = _mm_packs_epi32(u0, u1);
+            const __m128i v = _mm_packs_epi32(v0, v1);
+
+            StoreBgra16(c, _mm_packus_epi16(y0, y1), u, v, dst + x * 4);
+        }
+    }
+
+    void Nv12ToYuy2RowSse2(const YuvCoefficients&, const uint8_t* const* src, uint8_t* dst, uint32_t begin, uint32_t end)
+    {
+        for (uint32_t x = begin; x < end; x += SimdPixels)
+        {
+            const __m128i y = Load(src[0] + x);
+            const __m128i uv = Load(src[1] + x);
+
+            __m128i* out = reinterpret_cast<__m128i*>(dst + x * 2);
+            _mm_storeu_si128(out + 0, _mm_unpacklo_epi8(y, uv));
+            _mm_storeu_si128(out + 1, _mm_unpackhi_epi8(y, uv));
+        }
+    }
+
+    void I420ToYuy2RowSse2(const YuvCoefficients&, const uint8_t* const* src, uint8_t* dst, uint32_t begin, uint32_t end)
+    {
+        for (uint32_t x = begin; x < end; x += SimdPixels)
+        {
+            const __m128i y = Load(src[0] + x);
+            const __m128i uv = _mm_unpacklo_epi8(Load64(src[1] + x / 2), Load64(src[2] + x / 2));
+
+            __m128i* out = reinterpret_cast<__m128i*>(dst + x * 2);
+            _mm_storeu_si128(out + 0, _mm_unpacklo_epi8(y, uv));
+            _mm_storeu_si128(out + 1, _mm_unpackhi_epi8(y, uv));
+        }
+    }
+
+    void UyvyToYuy2RowSse2(const YuvCoefficients&, const uint8_t* const* src, uint8_t* dst, uint32_t begin, uint32_t end)
+    {
+        for (uint32_t x = begin; x < end; x += SimdPixels)
+        {
+            const __m128i p0 = Load(src[0] + x * 2);
+            const __m128i p1 = Load(src[0] + x * 2 + 16);
+
+            __m128i* out = reinterpret_cast<__m128i*>(dst + x * 2);
+            _mm_storeu_si128(out + 0, _mm_or_si128(_mm_slli_epi16(p0, 8), _mm_srli_epi16(p0, 8)));
+            _mm_storeu_si128(out + 1, _mm_or_si128(_mm_slli_epi16(p1, 8), _mm_srli_epi16(p1, 8)));
+        }
+    }
+
+    //
+    // 4 RGB24 pixels in the low 12 bytes to 4 BGRX pixels, X taken from fill
+    //
+    inline __m128i ExpandRgb24(__m128i p, __m128i fill) noexcept
+    {
+        const __m128i p0 = _mm_and_si128(p, _mm_set_epi32(0, 0, 0, 0x00FFFFFF));
+        const __m128i p1 = _mm_and_si128(_mm_slli_si128(p, 1), _mm_set_epi32(0, 0, 0x00FFFFFF, 0));
+        const __m128i p2 = _mm_and_si128(_mm_slli_si128(p, 2), _mm_set_epi32(0, 0x00FFFFFF, 0, 0));
+        const __m128i p3 = _mm_and_si128(_mm_slli_si128(p, 3), _mm_set_epi32(0x00FFFFFF, 0, 0, 0));
+        return _mm_or_si128(_mm_or_si128(p0, p1), _mm_or_si128(_mm_or_si128(p2, p3), fill));
+    }
+
+    //
+    // 16 RGB24 pixels (48 bytes) to 16 BGRX pixels, the last load
+    // is shifted so nothing past the 48 bytes is read
+    //
+    inline void LoadRgb24(const uint8_t* src, __m128i fill, __m128i* px) noexcept
+    {
+        px[0] = ExpandRgb24(Load(src), fill);
+        px[1] = ExpandRgb24(Load(src + 12), fill);
+        px[2] = ExpandRgb24(Load(src + 24), fill);
+        px[3] = ExpandRgb24(_mm_srli_si128(Load(src + 32), 4), fill);
+    }
+
+    void Rgb24ToBgraRowSse2(const YuvCoefficients&, const uint8_t* const* src, uint8_t* dst, uint32_t begin, uint32_t end)
+    {
+        const __m128i alpha = _mm_set1_epi32(static_cast<int>(0xFF000000u));
+
+        for (uint32_t x = begin; x < end; x += SimdPixels)
+        {
+            __m128i px[4];
+            LoadRgb24(src[0] + x * 3, alpha, px);
+
+            __m128i* out = reinterpret_cast<__m128i*>(dst + x * 4);
+
+            for (size_t i = 0; i < 4; ++i)
+            {
+                _mm_storeu_si128(out + i, px[i]);
+            }
+        }
+    }
+
+    //
+    // RGB to YUV weights as 16 bit [b g r 128] per pixel, X of the pixels is 1
+    // so the weighted sum includes the rounding
+    //
+    inline __m128i RgbWeights(const int16_t* weights) noexcept
+    {
+        return _mm_set_epi16(128, weights[0], weights[1], weights[2], 128, weights[0], weights[1], weights[2]);
+    }
+
+    //
+    // (weights . pixel + 128) >> 8 of 4 BGRX pixels as 32 bit values
+    //
+    inline __m128i Dot4(__m128i px, __m128i weights) noexcept
+    {
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i lo = _mm_shuffle_epi32(_mm_madd_epi16(_mm_unpacklo_epi8(px, zero), weights), _MM_SHUFFLE(3, 1, 2, 0));
+        const __m128i hi = _mm_shuffle_epi32(_mm_madd_epi16(_mm_unpackhi_epi8(px, zero), weights), _MM_SHUFFLE(3, 1, 2, 0));
+        return _mm_srai_epi32(_mm_add_epi32(_mm_unpacklo_epi64(lo, hi), _mm_unpackhi_epi64(lo, hi)), 8);
+    }
+
+    //
+    // Rounded averages of the pixel pairs of two 4 pixel vectors, (a + b + 1) / 2 as the scalar kernel
+    //
+    inline __m128i AveragePairs(__m128i px0, __m128i px1) noexcept
+    {
+        const __m128i a0 = _mm_shuffle_epi32(_mm_avg_epu8(px0, _mm_srli_si128(px0, 4)), _MM_SHUFFLE(3, 1, 2, 0));
+        const __m128i a1 = _mm_shuffle_epi32(_mm_avg_epu8(px1, _mm_srli_si128(px1, 4)), _MM_SHUFFLE(3, 1, 2, 0));
+        return _mm_unpacklo_epi64(a0, a1);
+    }
+
+    void Rgb24ToYuy2RowSse2(const YuvCoefficients& c, const uint8_t* const* src, uint8_t* dst, uint32_t begin, uint32_t end)
+    {
+        const __m128i one = _mm_set1_epi32(0x01000000);
+        const __m128i toY = RgbWeights(c.toY);
+        const __m128i toU = RgbWeights(c.toU);
+        const __m128i toV = RgbWeights(c.toV);
+        const __m128i yOffset = _mm_set1_epi16(c.yOffset);
+        const __m128i chroma = _mm_set1_epi16(128);
+
+        for (uint32_t x = begin; x < end; x += SimdPixels)
+        {
+            __m128i px[4];
+            LoadRgb24(src[0] + x * 3, one, px);
+
+            const __m128i y = _mm_packus_epi16(
+                _mm_add_epi16(_mm_packs_epi32(Dot4(px[0], toY), Dot4(px[1], toY)), yOffset),
+                _mm_add_epi16(_mm_packs_epi32(Dot4(px[2], toY), Dot4(px[3], toY)), yOffset));
+
+            const __m128i pairs0 = AveragePairs(px[0], px[1]);
+            const __m128i pairs1 = AveragePairs(px[2], px[3]);
+            const __m128i u = _mm_add_epi16(_mm_packs_epi32(Dot4(pairs0, toU), Dot4(pairs1, toU)), chroma);
+            const __m128i v = _mm_add_epi16(_mm_packs_epi32(Dot4(pairs0, toV), Dot4(pairs1, toV)), chroma);
+            const __m128i uv = _mm_packus_epi16(_mm_unpacklo_epi16(u, v), _mm_unpackhi_epi16(u, v));
+
+            __m128i* out = reinterpret_cast<__m128i*>(dst + x * 2);
+            _mm_storeu_si128(out + 0, _mm_unpacklo_epi8(y, uv));
+            _mm_storeu_si128(out + 1, _mm_unpackhi_epi8(y, uv));
+        }
+    }
+
+#endif // PIXEL_CONVERT_SSE2
+
+    struct RowKernels
+    {
+        PixelConverter::RowFunc scalar;
+        PixelConverter::RowFunc simd;
+    };
+
+    RowKernels FindRowKernels(PixelFormat src, PixelFormat dst) noexcept
+    {
+#ifdef PIXEL_CONVERT_SSE2
+#define SIMD_KERNEL(fn) fn
+#else
+#define SIMD_KERNEL(fn) nullptr
+#endif
+        if (dst == PixelFormat::RGB32)
+        {
+            switch (src)
+            {
+            case PixelFormat::NV12:
+                return { Nv12ToBgraRow, SIMD_KERNEL(Nv12ToBgraRowSse2) };
+            case PixelFormat::I420:
+            case PixelFormat::YV12:
+                return { I420ToBgraRow, SIMD_KERNEL(I420ToBgraRowSse2) };
+            case PixelFormat::YUY2:
+                return { PackedToBgraRow<0, 1, 3>, SIMD_KERNEL(PackedToBgraRowSse2<false>) };
+            case PixelFormat::UYVY:
+                return { PackedToBgraRow<1, 0, 2>, SIMD_KERNEL(PackedToBgraRowSse2<true>) };
+            case PixelFormat::RGB24:
+                return { Rgb24ToBgraRow, SIMD_KERNEL(Rgb24ToBgraRowSse2) };
+            case PixelFormat::RGB32:
+                return { Rgb32ToBgraRow, nullptr };
+            default:
+                break;
+            }
+        }
+        else if (dst == PixelFormat::YUY2)
+        {
+            switch (src)
+            {
+            case PixelFormat::NV12:
+                return { Nv12ToYuy2Row, SIMD_KERNEL(Nv12ToYuy2RowSse2) };
+            case PixelFormat::I420:
+            case PixelFormat::YV12:
+                return { I420ToYuy2Row, SIMD_KERNEL(I420ToYuy2RowSse2) };
+            case PixelFormat::UYVY:
+                return { UyvyToYuy2Row, SIMD_KERNEL(UyvyToYuy2RowSse2) };
+            case PixelFormat::YUY2:
+                return { Yuy2ToYuy2Row, nullptr };
+            case PixelFormat::RGB24:
+                return { Rgb24ToYuy2Row, SIMD_KERNEL(Rgb24ToYuy2RowSse2) };
+            default:
+                break;
+            }
+        }
+#undef SIMD_KERNEL
+
+        return { nullptr, nullptr };
+    }
+}
+
+namespace video
+{
+    YuvCoefficients GetYuvCoefficients(ColorSpace colorSpace) noexcept
+    {
+        const bool bt709 = colorSpace.matrix == YuvMatrix::BT709;
+
+        if (colorSpace.range == YuvRange::Full)
+        {
+            return bt709
+                ? YuvCoefficients{ 0, 64, 101, 12, 30, 119, { 54, 183, 18 }, { -29, -99, 128 }, { 128, -116, -12 } }
+                : YuvCoefficients{ 0, 64, 90, 22, 46, 113, { 77, 150, 29 }, { -43, -85, 128 }, { 128, -107, -21 } };
+        }
+
+        return bt709
+            ? YuvCoefficients{ 16, 75, 115, 14, 34, 135, { 47, 157, 16 }, { -26, -87, 112 }, { 112, -102, -10 } }
+            : YuvCoefficients{ 16, 75, 102, 25, 52, 129, { 66, 129, 25 }, { -38, -74, 112 }, { 112, -94, -18 } };
+    }
+
+    PixelConverter::PixelConverter() noexcept
+        : m_src(PixelFormat::Unknown)
+        , m_dst(PixelFormat::Unknown)
+        , m_width(0)
+        , m_height(0)
+        , m_kernel(ConvertKernel::Scalar)
+        , m_coeffs(GetYuvCoefficients(ColorSpace()))
+        , m_scalarRow(nullptr)
+        , m_simdRow(nullptr)
+    {
+    }
+
+    PixelConverter::PixelConverter(
+        PixelFormat src,
+        PixelFormat dst,
+        uint32_t width,
+        uint32_t height,
+        ColorSpace colorSpace,
+        ConvertKernel kernel) noexcept
+        : m_src(src)
+        , m_dst(dst)
+        , m_width(width)
+        , m_height(height)
+        , m_kernel(ConvertKernel::Scalar)
+        , m_coeffs(GetYuvCoefficients(colorSpace))
+        , m_scalarRow(nullptr)
+        , m_simdRow(nullptr)
+    {
+        const RowKernels kernels = FindRowKernels(src, dst);
+        m_scalarRow = kernels.scalar;
+
+        if (kernel != ConvertKernel::Scalar && kernels.simd)
+        {
+            m_simdRow = kernels.simd;
+            m_kernel = ConvertKernel::Sse2;
+        }
+    }
+
+    bool PixelConverter::Convert(const Plane* src, uint8_t* dst, ptrdiff_t dstStride) const noexcept
+    {
+        if (!m_scalarRow || !src || !dst)
+        {
+            return false;
+        }
+
+        //
+        // Kernels see YV12 as I420
+        //
+        Plane planes[MaxPlanes] = {};
+        std::copy(src, src + PlaneCount(m_src), planes);
+
+        if (m_src == PixelFormat::YV12)
+        {
+            std::swap(planes[1], planes[2]);
+        }
+
+        const bool subsampled = m_src == PixelFormat::NV12 || m_src == PixelFormat::I420 || m_src == PixelFormat::YV12;
+        const uint32_t simdEnd = m_simdRow ? (m_width & ~(SimdPixels - 1)) : 0;
+
+        for (uint32_t row = 0; row < m_height; ++row)
+        {
+            const uint32_t chromaRow = subsampled ? row / 2 : row;
+            const uint8_t* rows[MaxPlanes] =
+            {
+                planes[0].data + planes[0].stride * static_cast<ptrdiff_t>(row),
+                planes[1].data + planes[1].stride * static_cast<ptrdiff_t>(chromaRow),
+                planes[2].data + planes[2].stride * static_cast<ptrdiff_t>(chromaRow),
+            };
+
+            uint8_t* out = dst + dstStride * static_cast<ptrdiff_t>(row);
+
+            if (simdEnd)
+            {
+                m_simdRow(m_coeffs, rows, out, 0, simdEnd);
+            }
+
+            if (simdEnd < m_width)
+            {
+                m_scalarRow(m_coeffs, rows, out, simdEnd, m_width);
+            }
+        }
+
+        return true;
+    }
+
+    bool PixelConverter::IsValid() const noexcept
+    {
+        return m_scalarRow != nullptr;
+    }
+
+    ConvertKernel PixelConverter::GetKernel() const noexcept
+    {
+        return m_kernel;
+    }
+
+    bool PixelConverter::IsSupported(PixelFormat src, PixelFormat dst) noexcept
+    {
+        return FindRowKernels(src, dst).scalar != nullptr;
+    }
+
+    bool PixelConverter::IsSimdAvailable() noexcept
+    {
+#ifdef PIXEL_CONVERT_SSE2
+        return true;
+#else
+        return false;
+#endif
+    }
+}
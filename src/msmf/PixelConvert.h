@@ -0,0 +1,82 @@
+#pragma once
+
+#include "PixelFormat.h"
+
+namespace video
+{
+    struct YuvCoefficients
+    {
+        //
+        // YUV to RGB, 6 fraction bits
+        //
+        int16_t yOffset;
+        int16_t yScale;
+        int16_t rv;
+        int16_t gu;
+        int16_t gv;
+        int16_t bu;
+
+        //
+        // RGB to YUV, 8 fraction bits, { r, g, b } weights
+        //
+        int16_t toY[3];
+        int16_t toU[3];
+        int16_t toV[3];
+    };
+
+    YuvCoefficients GetYuvCoefficients(ColorSpace colorSpace) noexcept;
+
+    enum class ConvertKernel
+    {
+        Auto = 0,
+        Scalar,
+        Sse2,
+    };
+
+    class PixelConverter
+    {
+    public:
+        PixelConverter() noexcept;
+        PixelConverter(
+            PixelFormat src,
+            PixelFormat dst,
+            uint32_t width,
+            uint32_t height,
+            ColorSpace colorSpace,
+            ConvertKernel kernel = ConvertKernel::Auto) noexcept;
+
+        //
+        // Converts one frame, src must contain PlaneCount(src format) planes.
+        // Returns false if the conversion is not supported
+        //
+        bool Convert(const Plane* src, uint8_t* dst, ptrdiff_t dstStride) const noexcept;
+
+        bool IsValid() const noexcept;
+        ConvertKernel GetKernel() const noexcept;
+
+        static bool IsSupported(PixelFormat src, PixelFormat dst) noexcept;
+        static bool IsSimdAvailable() noexcept;
+
+    public:
+        //
+        // Row kernel: src contains row pointers of each plane,
+        // converts pixels [begin, end) of the row
+        //
+        using RowFunc = void(*)(
+            const YuvCoefficients& coeffs,
+            const uint8_t* const* src,
+            uint8_t* dst,
+            uint32_t begin,
+            uint32_t end);
+
+    private:
+        PixelFormat m_src;
+        PixelFormat m_dst;
+        uint32_t m_width;
+        uint32_t m_height;
+        ConvertKernel m_kernel;
+        YuvCoefficients m_coeffs;
+        RowFunc m_scalarRow;
+        RowFunc m_simdRow;
+    };
+}
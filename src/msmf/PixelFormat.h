@@ -0,0 +1,106 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace video
+{
+    //
+    // Uncompressed formats the capture path can consume natively,
+    // everything else is decoded by Media Foundation to YUY2
+    //
+    enum class PixelFormat : uint32_t
+    {
+        Unknown = 0,
+        NV12,   // Y plane, interleaved UV plane 2x2 subsampled
+        I420,   // Y plane, U plane, V plane 2x2 subsampled
+        YV12,   // Y plane, V plane, U plane 2x2 subsampled
+        YUY2,   // Y0 U Y1 V
+        UYVY,   // U Y0 V Y1
+        RGB24,  // B G R
+        RGB32,  // B G R X, the same layout as D3DFMT_X8R8G8B8
+    };
+
+    enum class YuvMatrix : uint32_t
+    {
+        BT601 = 0,
+        BT709,
+    };
+
+    enum class YuvRange : uint32_t
+    {
+        Studio = 0, // 16..235
+        Full,       // 0..255
+    };
+
+    struct ColorSpace
+    {
+        YuvMatrix matrix = YuvMatrix::BT601;
+        YuvRange range = YuvRange::Studio;
+    };
+
+    struct Plane
+    {
+        const uint8_t* data = nullptr;
+        ptrdiff_t stride = 0;
+    };
+
+    constexpr size_t MaxPlanes = 3;
+
+    inline size_t PlaneCount(PixelFormat format) noexcept
+    {
+        switch (format)
+        {
+        case PixelFormat::NV12:
+            return 2;
+        case PixelFormat::I420:
+        case PixelFormat::YV12:
+            return 3;
+        case PixelFormat::YUY2:
+        case PixelFormat::UYVY:
+        case PixelFormat::RGB24:
+        case PixelFormat::RGB32:
+            return 1;
+        default:
+            return 0;
+        }
+    }
+
+    //
+    // Bytes per pixel of the first plane
+    //
+    inline size_t BytesPerPixel(PixelFormat format) noexcept
+    {
+        switch (format)
+        {
+        case PixelFormat::NV12:
+        case PixelFormat::I420:
+        case PixelFormat::YV12:
+            return 1;
+        case PixelFormat::YUY2:
+        case PixelFormat::UYVY:
+            return 2;
+        case PixelFormat::RGB24:
+            return 3;
+        case PixelFormat::RGB32:
+            return 4;
+        default:
+            return 0;
+        }
+    }
+
+    inline const wchar_t* PixelFormatName(PixelFormat format) noexcept
+    {
+        switch (format)
+        {
+        case PixelFormat::NV12: return L"NV12";
+        case PixelFormat::I420: return L"I420";
+        case PixelFormat::YV12: return L"YV12";
+        case PixelFormat::YUY2: return L"YUY2";
+        case PixelFormat::UYVY: return L"UYVY";
+        case PixelFormat::RGB24: return L"RGB24";
+        case PixelFormat::RGB32: return L"RGB32";
+        default: return L"Unknown";
+        }
+    }
+}
@@ -0,0 +1,354 @@
+#include "PlanScheduler.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iomanip>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <unordered_map>
+
+namespace
+{
+    using namespace capture;
+
+    //
+    // Width of the table columns after the device name
+    //
+    constexpr int DetailWidth = 133;
+
+    double SecondsSince(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    void RunJob(const PlanEntry& entry, PlanResult& result, std::chrono::steady_clock::time_point start)
+    {
+        const PlanJob& job = result.job;
+        result.start = SecondsSince(start);
+
+        std::unique_ptr<FrameSource> source;
+        result.hr = job.device->OpenFrameSource(job.streamIndex, job.mediaType.index, source);
+
+        if (SUCCEEDED(result.hr))
+        {
+            video::NullSink nullSink;
+            video::ChecksumSink checksumSink;
+            video::VerifySink verifySink(entry.pattern, source->GetMediaType().colorSpace);
+
+            video::FrameSink* sink = &nullSink;
+
+            if (entry.sink == PlanSink::Checksum)
+            {
+                sink = &checksumSink;
+            }
+            else if (entry.sink == PlanSink::Verify)
+            {
+                sink = &verifySink;
+            }
+
+            result.hr = RunBench(*source, *sink, entry.readDepth, entry.seconds, result.bench, entry.adaptive);
+
+            if (entry.sink == PlanSink::Verify)
+            {
+                result.verified = true;
+                result.verify = verifySink.GetReport();
+            }
+        }
+
+        result.seconds = SecondsSince(start) - result.start;
+    }
+
+    void PrintResultStatus(const PlanResult& result, std::wostream& st)
+    {
+        if (!result.job.device)
+        {
+            st << "not found";
+        }
+        else if (result.hr == S_FALSE && result.job.status == S_FALSE)
+        {
+            st << "no match";
+        }
+        else if (FAILED(result.hr))
+        {
+            st << "0x" << std::hex << std::setw(8) << std::setfill(L'0') << static_cast<uint32_t>(result.hr)
+                << std::setfill(L' ') << std::dec;
+        }
+        else
+        {
+            st << "ok";
+        }
+    }
+}
+
+namespace capture
+{
+    HRESULT ExpandPlan(Backend& backend, const CapturePlan& plan, std::vector<PlanJob>& jobs)
+    {
+        jobs.clear();
+
+        for (uint32_t e = 0; e < plan.entries.size(); ++e)
+        {
+            const auto& entry = plan.entries[e];
+
+            PlanJob failed;
+            failed.entry = e;
+
+            DeviceList found;
+            failed.status = backend.OpenDevice(entry.device, found);
+
+            if (FAILED(failed.status))
+            {
+                jobs.push_back(failed);
+                continue;
+            }
+
+            //
+            // A device can be found twice, by its number and by its name
+            //
+            DeviceList devices;
+
+            for (auto& device : found)
+            {
+                const auto same = std::find_if(devices.begin(), devices.end(), [&](const DevicePtr& other)
+                {
+                    return other->GetSymbolicLink() == device->GetSymbolicLink();
+                });
+
+                if (same == devices.end())
+                {
+                    devices.push_back(device);
+                }
+            }
+
+            for (auto& device : devices)
+            {
+                failed.device = device;
+
+                std::vector<StreamInfo> streams;
+                failed.status = device->GetStreams(streams);
+
+                if (FAILED(failed.status))
+                {
+                    jobs.push_back(failed);
+                    continue;
+                }
+
+                const size_t first = jobs.size();
+
+                for (const auto& stream : streams)
+                {
+                    for (const auto& mediaType : stream.mediaTypes)
+                    {
+                        if (!entry.Matches(stream, mediaType))
+                        {
+                            continue;
+                        }
+
+                        PlanJob job;
+                        job.entry = e;
+                        job.device = device;
+                        job.streamIndex = stream.index;
+                        job.mediaType = mediaType;
+                        jobs.push_back(std::move(job));
+                    }
+                }
+
+                if (first == jobs.size())
+                {
+                    failed.status = S_FALSE;
+                    jobs.push_back(failed);
+                }
+            }
+        }
+
+        return S_OK;
+    }
+
+    HRESULT RunPlan(
+        Backend& backend,
+        const CapturePlan& plan,
+        const std::vector<PlanJob>& jobs,
+        std::vector<PlanResult>& results,
+        const PlanCallback& callback)
+    {
+        results.assign(jobs.size(), PlanResult());
+
+        //
+        // Jobs are grouped by device in the order of their first job,
+        // a group runs on one thread
+        //
+        std::vector<std::vector<size_t>> groups;
+        std::unordered_map<std::wstring, size_t> groupByDevice;
+
+        for (size_t i = 0; i < jobs.size(); ++i)
+        {
+            auto& result = results[i];
+            result.job = jobs[i];
+            result.hr = jobs[i].status;
+            result.device = jobs[i].device
+                ? jobs[i].device->GetFriendlyName()
+                : plan.entries.at(jobs[i].entry).device;
+
+            if (!jobs[i].device || jobs[i].status != S_OK)
+            {
+                callback(result);
+                continue;
+            }
+
+            const auto inserted = groupByDevice.emplace(jobs[i].device->GetSymbolicLink(), groups.size());
+
+            if (inserted.second)
+            {
+                groups.emplace_back();
+            }
+
+            groups[inserted.first->second].push_back(i);
+        }
+
+        const size_t workers = plan.concurrency
+            ? std::min<size_t>(plan.concurrency, groups.size())
+            : groups.size();
+
+        const auto start = std::chrono::steady_clock::now();
+        std::atomic<size_t> nextGroup(0);
+        std::mutex callbackMutex;
+
+        auto worker = [&]()
+        {
+            const HRESULT hrAttach = backend.AttachThread();
+
+            for (size_t group = nextGroup++; group < groups.size(); group = nextGroup++)
+            {
+                for (size_t i : groups[group])
+                {
+                    auto& result = results[i];
+
+                    if (FAILED(hrAttach))
+                    {
+                        result.hr = hrAttach;
+                    }
+                    else
+                    {
+                        try
+                        {
+                            RunJob(plan.entries[result.job.entry], result, start);
+                        }
+                        catch (const std::bad_alloc&)
+                        {
+                            result.hr = E_OUTOFMEMORY;
+                        }
+                    }
+
+                    std::lock_guard<std::mutex> lock(callbackMutex);
+                    callback(result);
+                }
+            }
+
+            if (SUCCEEDED(hrAttach))
+            {
+                backend.DetachThread();
+            }
+        };
+
+        std::vector<std::thread> threads;
+        threads.reserve(workers);
+
+        for (size_t i = 0; i < workers; ++i)
+        {
+            threads.emplace_back(worker);
+        }
+
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
+
+        return S_OK;
+    }
+
+    void PrintPlanResults(const std::vector<PlanResult>& results, std::wostream& st)
+    {
+        st << std::left
+            << std::setw(4) << L"#"
+            << std::setw(26) << L"Device"
+            << std::setw(8) << L"Stream"
+            << std::setw(6) << L"Mode"
+            << std::setw(8) << L"Format"
+            << std::setw(12) << L"Size"
+            << std::setw(9) << L"FPS"
+            << std::setw(9) << L"Start s"
+            << std::setw(9) << L"1st ms"
+            << std::setw(9) << L"Dwell s"
+            << std::setw(6) << L"Conv"
+            << std::setw(9) << L"Frames"
+            << std::setw(9) << L"Got FPS"
+            << std::setw(9) << L"Missing"
+            << std::setw(11) << L"Jitter us"
+            << std::setw(9) << L"Unique"
+            << std::setw(10) << L"Verify"
+            << L"Result\n";
+
+        st << std::fixed << std::setprecision(2);
+
+        for (size_t i = 0; i < results.size(); ++i)
+        {
+            const auto& result = results[i];
+            const auto& mediaType = result.job.mediaType;
+
+            std::wstring device = result.device;
+
+            if (device.size() > 25)
+            {
+                device.resize(25);
+            }
+
+            st << std::left << std::setw(4) << i << std::setw(26) << device;
+
+            if (result.job.status != S_OK)
+            {
+                st << std::setw(DetailWidth) << L"-";
+                PrintResultStatus(result, st);
+                st << L"\n";
+                continue;
+            }
+
+            const std::wstring format = mediaType.format == video::PixelFormat::Unknown
+                ? mediaType.subtype
+                : video::PixelFormatName(mediaType.format);
+
+            st << std::setw(8) << result.job.streamIndex
+                << std::setw(6) << mediaType.index
+                << std::setw(8) << format
+                << std::setw(12) << (std::to_wstring(mediaType.width) + L"x" + std::to_wstring(mediaType.height))
+                << std::setw(9) << mediaType.Fps()
+                << std::setw(9) << result.start
+                << std::setw(9) << result.bench.dwell.firstFrameMs
+                << std::setw(9) << result.bench.bench.seconds
+                << std::setw(6) << (result.bench.dwell.converged ? L"yes" : L"no")
+                << std::setw(9) << result.bench.bench.frames
+                << std::setw(9) << result.bench.bench.fps
+                << std::setw(9) << result.bench.timing.droppedFrames
+                << std::setw(11) << result.bench.timing.jitterP99
+                << std::setw(9) << result.bench.frameDiff.unique;
+
+            if (!result.verified)
+            {
+                st << std::setw(10) << L"-";
+            }
+            else
+            {
+                const auto& verify = result.verify;
+                const uint64_t issues = verify.identical + verify.mismatched + verify.repeated + verify.skipped;
+                st << std::setw(10) << (issues ? std::to_wstring(issues) + L" bad" : std::wstring(L"ok"));
+            }
+
+            PrintResultStatus(result, st);
+            st << L"\n";
+        }
+
+        st << std::right;
+        st.unsetf(std::ios_base::floatfield);
+    }
+}
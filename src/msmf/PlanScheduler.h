@@ -0,0 +1,61 @@
+#pragma once
+
+#include <functional>
+#include "BenchRunner.h"
+#include "CapturePlan.h"
+#include "FrameVerifier.h"
+
+namespace capture
+{
+    //
+    // One media type of one device a plan captures
+    //
+    struct PlanJob
+    {
+        uint32_t entry = 0;         // in CapturePlan::entries
+        DevicePtr device;           // null if the device was not found
+        uint32_t streamIndex = 0;
+        MediaTypeInfo mediaType;
+        HRESULT status = S_OK;      // not S_OK when there is nothing to run: an error, S_FALSE for no matching media type
+    };
+
+    struct PlanResult
+    {
+        PlanJob job;
+        std::wstring device;        // the friendly name, the plan name when the device was not found
+        HRESULT hr = S_OK;
+        BenchResult bench;
+        bool verified = false;
+        video::VerifySink::Report verify = {};
+        double start = 0;           // seconds since the start of the plan
+        double seconds = 0;
+    };
+
+    //
+    // Opens the devices of the plan and selects their media types,
+    // jobs are in the order of the plan entries, streams and media types
+    //
+    HRESULT ExpandPlan(Backend& backend, const CapturePlan& plan, std::vector<PlanJob>& jobs);
+
+    using PlanCallback = std::function<void(const PlanResult& result)>;
+
+    //
+    // Runs the jobs of each device one after another and the devices in parallel,
+    // at most plan.concurrency at once. Jobs of entries naming the same device
+    // are serialized too. Results are in the order of the jobs, the callback
+    // is called as each one completes, one call at a time
+    //
+    HRESULT RunPlan(
+        Backend& backend,
+        const CapturePlan& plan,
+        const std::vector<PlanJob>& jobs,
+        std::vector<PlanResult>& results,
+        const PlanCallback& callback);
+
+    //
+    // One line per result with the first frame latency, the dwell time,
+    // the measured fps, the missing frames, the jitter, the unique frames
+    // and the verification
+    //
+    void PrintPlanResults(const std::vector<PlanResult>& results, std::wostream& st);
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+//
+// The HRESULT subset used by the portable code,
+// so it builds where the Windows SDK is not available
+//
+#ifdef _WIN32
+
+#include <windows.h>
+
+#else
+
+#include <cstdint>
+#include <cstring>
+
+using HRESULT = int32_t;
+
+#define S_OK                    ((HRESULT)0)
+#define S_FALSE                 ((HRESULT)1)
+#define E_NOTIMPL               ((HRESULT)0x80004001L)
+#define E_POINTER               ((HRESULT)0x80004003L)
+#define E_FAIL                  ((HRESULT)0x80004005L)
+#define E_UNEXPECTED            ((HRESULT)0x8000FFFFL)
+#define E_OUTOFMEMORY           ((HRESULT)0x8007000EL)
+#define E_INVALIDARG            ((HRESULT)0x80070057L)
+#define E_BOUNDS                ((HRESULT)0x8000000BL)
+#define E_HANDLE                ((HRESULT)0x80070006L)
+
+#define SUCCEEDED(hr)           (((HRESULT)(hr)) >= 0)
+#define FAILED(hr)              (((HRESULT)(hr)) < 0)
+
+//
+// The same layout as the Windows GUID
+//
+struct GUID
+{
+    uint32_t Data1;
+    uint16_t Data2;
+    uint16_t Data3;
+    uint8_t Data4[8];
+};
+
+inline bool operator==(const GUID& left, const GUID& right) noexcept
+{
+    return left.Data1 == right.Data1
+        && left.Data2 == right.Data2
+        && left.Data3 == right.Data3
+        && 0 == memcmp(left.Data4, right.Data4, sizeof(left.Data4));
+}
+
+inline bool operator!=(const GUID& left, const GUID& right) noexcept
+{
+    return !(left == right);
+}
+
+#endif
+
+#define HRCHK($$hr, ...) {      \
+    HRESULT $hr = ($$hr);       \
+    if (FAILED($hr)) { /*__debugbreak();*/ return $hr; }\
+}
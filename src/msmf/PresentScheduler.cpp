@@ -0,0 +1,83 @@
+#include "PresentScheduler.h"
+
+namespace
+{
+    constexpr int64_t NanosecondsPerSecond = 1000000000;
+}
+
+namespace video
+{
+    PresentScheduler::PresentScheduler(int64_t period) noexcept
+        : m_period(period > 0 ? period : 0)
+        , m_deadline(0)
+        , m_started(false)
+        , m_pending(false)
+        , m_statistics{}
+    {
+    }
+
+    void PresentScheduler::SetPeriod(int64_t period) noexcept
+    {
+        m_period = period > 0 ? period : 0;
+    }
+
+    void PresentScheduler::SetRefreshRate(uint32_t hz) noexcept
+    {
+        m_period = hz ? NanosecondsPerSecond / hz : 0;
+    }
+
+    void PresentScheduler::Reset() noexcept
+    {
+        m_deadline = 0;
+        m_started = false;
+        m_pending = false;
+        m_statistics = Statistics{};
+    }
+
+    void PresentScheduler::OnFrame() noexcept
+    {
+        m_statistics.frames += 1;
+
+        if (m_pending)
+        {
+            m_statistics.skipped += 1;
+        }
+
+        m_pending = true;
+    }
+
+    bool PresentScheduler::OnTick(int64_t now) noexcept
+    {
+        if (!m_pending || (m_started && now < m_deadline))
+        {
+            return false;
+        }
+
+        //
+        // A frame after an idle period is presented at once and starts
+        // a new schedule, so the preview never presents twice in a row
+        // to catch up
+        //
+        m_deadline = m_started ? m_deadline + m_period : now + m_period;
+
+        if (m_deadline <= now)
+        {
+            m_deadline = now + m_period;
+        }
+
+        m_started = true;
+        m_pending = false;
+        m_statistics.presented += 1;
+        return true;
+    }
+
+    int64_t PresentScheduler::GetWaitTime(int64_t now) const noexcept
+    {
+        if (!m_pending)
+        {
+            return WaitInfinite;
+        }
+
+        return m_started && now < m_deadline ? m_deadline - now : 0;
+    }
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstdint>
+
+namespace video
+{
+    //
+    // Paces a preview to the display: frames are taken at the capture rate,
+    // only the newest one is presented once per display period.
+    // Times are steady clock nanoseconds passed in by the caller,
+    // e.g. TimingAnalyzer::Now, so a test can drive it with a virtual clock
+    //
+    class PresentScheduler
+    {
+    public:
+        struct Statistics
+        {
+            uint64_t frames;
+            uint64_t presented;
+            uint64_t skipped;   // replaced by a newer frame before their turn, not dropped
+        };
+
+        //
+        // GetWaitTime without a frame to present
+        //
+        static constexpr int64_t WaitInfinite = -1;
+
+        //
+        // 0 presents every frame as it comes
+        //
+        explicit PresentScheduler(int64_t period = 0) noexcept;
+
+        void SetPeriod(int64_t period) noexcept;
+        void SetRefreshRate(uint32_t hz) noexcept;
+        int64_t GetPeriod() const noexcept { return m_period; }
+
+        void Reset() noexcept;
+
+        //
+        // A new frame replaces the pending one, which is counted as skipped
+        //
+        void OnFrame() noexcept;
+
+        //
+        // True when the pending frame is due, the caller presents it then
+        //
+        bool OnTick(int64_t now) noexcept;
+
+        //
+        // Nanoseconds until the pending frame is due
+        //
+        int64_t GetWaitTime(int64_t now) const noexcept;
+
+        bool HasPending() const noexcept { return m_pending; }
+        Statistics GetStatistics() const noexcept { return m_statistics; }
+
+    private:
+        int64_t m_period;
+        int64_t m_deadline;
+        bool m_started;
+        bool m_pending;
+        Statistics m_statistics;
+    };
+}
@@ -0,0 +1,389 @@
+#include "RecordFile.h"
+
+#include <algorithm>
+#include <filesystem>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace video
+{
+    std::wstring RecordIndexPath(const std::wstring& path)
+    {
+        return path + L".idx";
+    }
+
+#ifdef _WIN32
+
+    File::File() noexcept
+        : m_handle(INVALID_HANDLE_VALUE)
+    {
+    }
+
+    HRESULT File::Create(const std::wstring& path)
+    {
+        Close();
+
+        m_handle = CreateFileW(
+            path.c_str(),
+            GENERIC_WRITE,
+            FILE_SHARE_READ,
+            NULL,
+            CREATE_ALWAYS,
+            FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN,
+            NULL);
+
+        if (m_handle == INVALID_HANDLE_VALUE)
+        {
+            return HRESULT_FROM_WIN32(GetLastError());
+        }
+
+        return S_OK;
+    }
+
+    HRESULT File::Append(const std::wstring& path)
+    {
+        Close();
+
+        m_handle = CreateFileW(
+            path.c_str(),
+            FILE_APPEND_DATA,
+            FILE_SHARE_READ,
+            NULL,
+            OPEN_ALWAYS,
+            FILE_ATTRIBUTE_NORMAL,
+            NULL);
+
+        if (m_handle == INVALID_HANDLE_VALUE)
+        {
+            return HRESULT_FROM_WIN32(GetLastError());
+        }
+
+        return S_OK;
+    }
+
+    void File::Close() noexcept
+    {
+        if (m_handle != INVALID_HANDLE_VALUE)
+        {
+            CloseHandle(m_handle);
+            m_handle = INVALID_HANDLE_VALUE;
+        }
+    }
+
+    bool File::IsOpen() const noexcept
+    {
+        return m_handle != INVALID_HANDLE_VALUE;
+    }
+
+    HRESULT File::Write(const void* data, size_t size)
+    {
+        auto bytes = static_cast<const uint8_t*>(data);
+
+        while (size > 0)
+        {
+            const DWORD chunk = static_cast<DWORD>(std::min<size_t>(size, 1u << 30));
+            DWORD written = 0;
+
+            if (!WriteFile(m_handle, bytes, chunk, &written, NULL))
+            {
+                return HRESULT_FROM_WIN32(GetLastError());
+            }
+
+            bytes += written;
+            size -= written;
+        }
+
+        return S_OK;
+    }
+
+    HRESULT File::WriteAt(uint64_t offset, const void* data, size_t size)
+    {
+        LARGE_INTEGER current = {};
+        LARGE_INTEGER target = {};
+        target.QuadPart = static_cast<LONGLONG>(offset);
+
+        if (!SetFilePointerEx(m_handle, LARGE_INTEGER(), &current, FILE_CURRENT)
+            || !SetFilePointerEx(m_handle, target, NULL, FILE_BEGIN))
+        {
+            return HRESULT_FROM_WIN32(GetLastError());
+        }
+
+        const HRESULT hr = Write(data, size);
+        SetFilePointerEx(m_handle, current, NULL, FILE_BEGIN);
+        return hr;
+    }
+
+    HRESULT File::Reserve(uint64_t size)
+    {
+        FILE_ALLOCATION_INFO info = {};
+        info.AllocationSize.QuadPart = static_cast<LONGLONG>(size);
+
+        if (!SetFileInformationByHandle(m_handle, FileAllocationInfo, &info, sizeof(info)))
+        {
+            return HRESULT_FROM_WIN32(GetLastError());
+        }
+
+        return S_OK;
+    }
+
+    MappedFile::MappedFile() noexcept
+        : m_data(nullptr)
+        , m_size(0)
+        , m_file(INVALID_HANDLE_VALUE)
+        , m_mapping(NULL)
+    {
+    }
+
+    HRESULT MappedFile::Open(const std::wstring& path)
+    {
+        Close();
+
+        m_file = CreateFileW(
+            path.c_str(),
+            GENERIC_READ,
+            FILE_SHARE_READ,
+            NULL,
+            OPEN_EXISTING,
+            FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN,
+            NULL);
+
+        if (m_file == INVALID_HANDLE_VALUE)
+        {
+            return HRESULT_FROM_WIN32(GetLastError());
+        }
+
+        LARGE_INTEGER size = {};
+
+        if (!GetFileSizeEx(m_file, &size))
+        {
+            const DWORD err = GetLastError();
+            Close();
+            return HRESULT_FROM_WIN32(err);
+        }
+
+        if (0 == size.QuadPart)
+        {
+            //
+            // Empty files cannot be mapped
+            //
+            return S_OK;
+        }
+
+        m_mapping = CreateFileMappingW(m_file, NULL, PAGE_READONLY, 0, 0, NULL);
+
+        if (!m_mapping)
+        {
+            const DWORD err = GetLastError();
+            Close();
+            return HRESULT_FROM_WIN32(err);
+        }
+
+        m_data = static_cast<const uint8_t*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+
+        if (!m_data)
+        {
+            const DWORD err = GetLastError();
+            Close();
+            return HRESULT_FROM_WIN32(err);
+        }
+
+        m_size = static_cast<uint64_t>(size.QuadPart);
+        return S_OK;
+    }
+
+    void MappedFile::Close() noexcept
+    {
+        if (m_data)
+        {
+            UnmapViewOfFile(m_data);
+            m_data = nullptr;
+        }
+
+        if (m_mapping)
+        {
+            CloseHandle(m_mapping);
+            m_mapping = NULL;
+        }
+
+        if (m_file != INVALID_HANDLE_VALUE)
+        {
+            CloseHandle(m_file);
+            m_file = INVALID_HANDLE_VALUE;
+        }
+
+        m_size = 0;
+    }
+
+#else
+
+    File::File() noexcept
+        : m_fd(-1)
+    {
+    }
+
+    HRESULT File::Create(const std::wstring& path)
+    {
+        Close();
+
+        m_fd = open(std::filesystem::path(path).c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        return (m_fd < 0) ? E_FAIL : S_OK;
+    }
+
+    HRESULT File::Append(const std::wstring& path)
+    {
+        Close();
+
+        m_fd = open(std::filesystem::path(path).c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+        return (m_fd < 0) ? E_FAIL : S_OK;
+    }
+
+    void File::Close() noexcept
+    {
+        if (m_fd >= 0)
+        {
+            close(m_fd);
+            m_fd = -1;
+        }
+    }
+
+    bool File::IsOpen() const noexcept
+    {
+        return m_fd >= 0;
+    }
+
+    HRESULT File::Write(const void* data, size_t size)
+    {
+        auto bytes = static_cast<const uint8_t*>(data);
+
+        while (size > 0)
+        {
+            const ssize_t written = write(m_fd, bytes, std::min<size_t>(size, 1u << 30));
+
+            if (written <= 0)
+            {
+                return E_FAIL;
+            }
+
+            bytes += written;
+            size -= static_cast<size_t>(written);
+        }
+
+        return S_OK;
+    }
+
+    HRESULT File::WriteAt(uint64_t offset, const void* data, size_t size)
+    {
+        auto bytes = static_cast<const uint8_t*>(data);
+
+        while (size > 0)
+        {
+            const ssize_t written = pwrite(m_fd, bytes, std::min<size_t>(size, 1u << 30), static_cast<off_t>(offset));
+
+            if (written <= 0)
+            {
+                return E_FAIL;
+            }
+
+            bytes += written;
+            offset += static_cast<uint64_t>(written);
+            size -= static_cast<size_t>(written);
+        }
+
+        return S_OK;
+    }
+
+    HRESULT File::Reserve(uint64_t size)
+    {
+#ifdef __linux__
+        //
+        // Allocates the blocks without changing the file size
+        //
+        if (0 != fallocate(m_fd, FALLOC_FL_KEEP_SIZE, 0, static_cast<off_t>(size)))
+        {
+            return E_FAIL;
+        }
+#else
+        (void)size;
+#endif
+        return S_OK;
+    }
+
+    MappedFile::MappedFile() noexcept
+        : m_data(nullptr)
+        , m_size(0)
+    {
+    }
+
+    HRESULT MappedFile::Open(const std::wstring& path)
+    {
+        Close();
+
+        const int fd = open(std::filesystem::path(path).c_str(), O_RDONLY);
+
+        if (fd < 0)
+        {
+            return E_FAIL;
+        }
+
+        struct stat st = {};
+
+        if (0 != fstat(fd, &st))
+        {
+            close(fd);
+            return E_FAIL;
+        }
+
+        if (st.st_size > 0)
+        {
+            void* data = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+
+            if (data == MAP_FAILED)
+            {
+                close(fd);
+                return E_FAIL;
+            }
+
+            //
+            // Frames are read once front to back
+            //
+            madvise(data, static_cast<size_t>(st.st_size), MADV_SEQUENTIAL);
+
+            m_data = static_cast<const uint8_t*>(data);
+            m_size = static_cast<uint64_t>(st.st_size);
+        }
+
+        //
+        // The mapping keeps the file referenced
+        //
+        close(fd);
+        return S_OK;
+    }
+
+    void MappedFile::Close() noexcept
+    {
+        if (m_data)
+        {
+            munmap(const_cast<uint8_t*>(m_data), static_cast<size_t>(m_size));
+            m_data = nullptr;
+        }
+
+        m_size = 0;
+    }
+
+#endif
+
+    File::~File()
+    {
+        Close();
+    }
+
+    MappedFile::~MappedFile()
+    {
+        Close();
+    }
+}
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <string>
+#include "Platform.h"
+#include "FramePool.h"
+
+namespace video
+{
+    //
+    // A recording is two files:
+    //  <name>      RecordHeader padded to RecordDataOffset, then the frames
+    //              in the FramePool layout (64-byte aligned rows, planes back to back)
+    //  <name>.idx  one RecordIndexEntry per frame
+    //
+    constexpr uint64_t RecordMagic = 0x3157415246534d4dull; // "MMSFRAW1"
+    constexpr uint32_t RecordVersion = 1;
+    constexpr uint64_t RecordDataOffset = 4096;
+
+    struct RecordHeader
+    {
+        uint64_t magic;
+        uint32_t version;
+        uint32_t format;            // PixelFormat
+        uint32_t width;
+        uint32_t height;
+        uint32_t stride;            // of the first plane
+        uint32_t fpsNumerator;
+        uint32_t fpsDenominator;
+        uint32_t reserved;
+        uint64_t frameCount;        // 0 if the recording was not closed
+        uint64_t dataSize;          // frame bytes after RecordDataOffset
+    };
+
+    struct RecordIndexEntry
+    {
+        int64_t timestamp;          // 100 ns units
+        uint32_t flags;
+        uint32_t reserved;
+        uint64_t offset;            // from the beginning of the data file
+        uint64_t size;
+    };
+
+    static_assert(sizeof(RecordHeader) == 56, "RecordHeader is a file format");
+    static_assert(sizeof(RecordIndexEntry) == 32, "RecordIndexEntry is a file format");
+
+    std::wstring RecordIndexPath(const std::wstring& path);
+
+    //
+    // Sequential file writer over the native file API
+    //
+    class File
+    {
+    public:
+        File() noexcept;
+        ~File();
+
+        File(const File&) = delete;
+        File& operator=(const File&) = delete;
+
+        HRESULT Create(const std::wstring& path);
+
+        //
+        // Opens or creates the file, every write goes to its end
+        //
+        HRESULT Append(const std::wstring& path);
+
+        void Close() noexcept;
+        bool IsOpen() const noexcept;
+
+        HRESULT Write(const void* data, size_t size);
+        HRESULT WriteAt(uint64_t offset, const void* data, size_t size);
+
+        //
+        // Extends the file to size without moving the write position,
+        // so appends do not grow the file one write at a time
+        //
+        HRESULT Reserve(uint64_t size);
+
+    private:
+#ifdef _WIN32
+        HANDLE m_handle;
+#else
+        int m_fd;
+#endif
+    };
+
+    //
+    // Read-only mapping of a whole file
+    //
+    class MappedFile
+    {
+    public:
+        MappedFile() noexcept;
+        ~MappedFile();
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        HRESULT Open(const std::wstring& path);
+        void Close() noexcept;
+
+        const uint8_t* Data() const noexcept { return m_data; }
+        uint64_t Size() const noexcept { return m_size; }
+
+    private:
+        const uint8_t* m_data;
+        uint64_t m_size;
+#ifdef _WIN32
+        HANDLE m_file;
+        HANDLE m_mapping;
+#endif
+    };
+}
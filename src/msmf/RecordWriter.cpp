@@ -0,0 +1,358 @@
+#include "RecordWriter.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+namespace
+{
+    //
+    // Frames smaller than this are gathered in the staging buffer,
+    // larger ones are written straight from the pooled buffer
+    //
+    constexpr size_t StagingSize = 8 * 1024 * 1024;
+    constexpr size_t StagingFrameLimit = StagingSize / 4;
+
+    //
+    // The data file grows in big steps, so the file system allocates it in long runs
+    //
+    constexpr uint64_t ReserveStep = 256ull * 1024 * 1024;
+
+    constexpr size_t IndexStagingEntries = 4096;
+
+    constexpr auto IdleWait = std::chrono::milliseconds(5);
+}
+
+namespace video
+{
+    RecordWriter::RecordWriter(size_t queueDepth)
+        : m_queueDepth(queueDepth)
+        , m_stopping(false)
+        , m_error(S_OK)
+        , m_header()
+        , m_dataOffset(0)
+        , m_reserved(0)
+        , m_stagingUsed(0)
+        , m_written(0)
+        , m_bytes(0)
+        , m_rejected(0)
+        , m_maxBacklog(0)
+    {
+    }
+
+    RecordWriter::~RecordWriter()
+    {
+        Close();
+    }
+
+    HRESULT RecordWriter::Open(
+        const std::wstring& path,
+        PixelFormat format,
+        uint32_t width,
+        uint32_t height,
+        uint32_t fpsNumerator,
+        uint32_t fpsDenominator)
+    {
+        if (IsOpen())
+        {
+            return E_UNEXPECTED;
+        }
+
+        m_format = FramePool::AlignedFormat(format, width, height);
+
+        if (0 == m_format.BufferSize())
+        {
+            return E_INVALIDARG;
+        }
+
+        HRCHK(m_data.Create(path));
+        HRCHK(m_index.Create(RecordIndexPath(path)));
+
+        m_header = RecordHeader();
+        m_header.magic = RecordMagic;
+        m_header.version = RecordVersion;
+        m_header.format = static_cast<uint32_t>(format);
+        m_header.width = width;
+        m_header.height = height;
+        m_header.stride = m_format.stride;
+        m_header.fpsNumerator = fpsNumerator;
+        m_header.fpsDenominator = fpsDenominator;
+
+        //
+        // The header is rewritten with the frame count by Close
+        //
+        std::vector<uint8_t> head(RecordDataOffset);
+        memcpy(head.data(), &m_header, sizeof(m_header));
+        HRCHK(m_data.Write(head.data(), head.size()));
+
+        m_dataOffset = RecordDataOffset;
+        m_reserved = 0;
+        m_staging.resize(StagingSize);
+        m_stagingUsed = 0;
+        m_indexStaging.clear();
+        m_indexStaging.reserve(IndexStagingEntries);
+
+        m_written = 0;
+        m_bytes = 0;
+        m_rejected = 0;
+        m_maxBacklog = 0;
+        m_error = S_OK;
+        m_stopping = false;
+
+        m_queue.reset(new SpscQueue<FrameRef>(m_queueDepth, QueuePolicy::DropNewest));
+        m_thread = std::thread(&RecordWriter::Run, this);
+        return S_OK;
+    }
+
+    HRESULT RecordWriter::Close()
+    {
+        if (!m_thread.joinable())
+        {
+            return m_error;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stopping = true;
+        }
+
+        m_wake.notify_one();
+        m_thread.join();
+
+        if (SUCCEEDED(m_error))
+        {
+            m_header.frameCount = m_written;
+            m_header.dataSize = m_dataOffset - RecordDataOffset;
+
+            const HRESULT hr = m_data.WriteAt(0, &m_header, sizeof(m_header));
+
+            if (FAILED(hr))
+            {
+                m_error = hr;
+            }
+        }
+
+        m_data.Close();
+        m_index.Close();
+        m_staging.clear();
+        m_staging.shrink_to_fit();
+        return m_error;
+    }
+
+    bool RecordWriter::IsOpen() const noexcept
+    {
+        return m_data.IsOpen();
+    }
+
+    bool RecordWriter::Write(FrameRef frame) noexcept
+    {
+        if (!m_queue || !frame || m_stopping)
+        {
+            return false;
+        }
+
+        if (!m_queue->Push(std::move(frame)))
+        {
+            return false;
+        }
+
+        const size_t backlog = m_queue->Size();
+        size_t maxBacklog = m_maxBacklog.load(std::memory_order_relaxed);
+
+        while (backlog > maxBacklog && !m_maxBacklog.compare_exchange_weak(maxBacklog, backlog))
+        {
+        }
+
+        //
+        // The writer also polls, a lost wake-up only delays it by IdleWait
+        //
+        m_wake.notify_one();
+        return true;
+    }
+
+    RecordWriter::Statistics RecordWriter::GetStatistics() const noexcept
+    {
+        Statistics stat = {};
+        stat.written = m_written;
+        stat.bytes = m_bytes;
+        stat.rejected = m_rejected;
+        stat.maxBacklog = m_maxBacklog;
+
+        if (m_queue)
+        {
+            const auto queueStat = m_queue->GetStatistics();
+            stat.queued = queueStat.pushed;
+            stat.dropped = queueStat.droppedNewest;
+            stat.backlog = m_queue->Size();
+        }
+
+        return stat;
+    }
+
+    HRESULT RecordWriter::GetError() const noexcept
+    {
+        return m_error;
+    }
+
+    void RecordWriter::Run()
+    {
+        FrameRef frame;
+
+        for (;;)
+        {
+            while (m_queue->Pop(frame))
+            {
+                if (SUCCEEDED(m_error))
+                {
+                    const HRESULT hr = WriteFrame(frame);
+
+                    if (FAILED(hr))
+                    {
+                        m_error = hr;
+                    }
+                }
+
+                frame.Reset();
+            }
+
+            std::unique_lock<std::mutex> lock(m_mutex);
+
+            if (m_stopping)
+            {
+                break;
+            }
+
+            m_wake.wait_for(lock, IdleWait);
+        }
+
+        //
+        // Write does not queue after m_stopping, take what was queued before it
+        //
+        while (m_queue->Pop(frame))
+        {
+            if (SUCCEEDED(m_error))
+            {
+                const HRESULT hr = WriteFrame(frame);
+
+                if (FAILED(hr))
+                {
+                    m_error = hr;
+                }
+            }
+
+            frame.Reset();
+        }
+
+        if (SUCCEEDED(m_error))
+        {
+            const HRESULT hr = Flush();
+
+            if (FAILED(hr))
+            {
+                m_error = hr;
+            }
+        }
+    }
+
+    HRESULT RecordWriter::WriteFrame(const FrameRef& frame)
+    {
+        if (frame->Format() != m_format)
+        {
+            m_rejected += 1;
+            return S_OK;
+        }
+
+        const size_t size = frame->Size();
+
+        if (m_dataOffset + size > m_reserved)
+        {
+            //
+            // Best effort, the writes extend the file anyway
+            //
+            m_reserved = m_dataOffset + size + ReserveStep;
+            m_data.Reserve(m_reserved);
+        }
+
+        if (size <= StagingFrameLimit)
+        {
+            if (m_stagingUsed + size > m_staging.size())
+            {
+                HRCHK(m_data.Write(m_staging.data(), m_stagingUsed));
+                m_stagingUsed = 0;
+            }
+
+            memcpy(m_staging.data() + m_stagingUsed, frame->Data(), size);
+            m_stagingUsed += size;
+        }
+        else
+        {
+            if (m_stagingUsed)
+            {
+                HRCHK(m_data.Write(m_staging.data(), m_stagingUsed));
+                m_stagingUsed = 0;
+            }
+
+            HRCHK(m_data.Write(frame->Data(), size));
+        }
+
+        RecordIndexEntry entry = {};
+        entry.timestamp = frame->timestamp;
+        entry.flags = frame->flags;
+        entry.offset = m_dataOffset;
+        entry.size = size;
+        m_indexStaging.push_back(entry);
+
+        if (m_indexStaging.size() == IndexStagingEntries)
+        {
+            HRCHK(m_index.Write(m_indexStaging.data(), m_indexStaging.size() * sizeof(RecordIndexEntry)));
+            m_indexStaging.clear();
+        }
+
+        m_dataOffset += size;
+        m_written += 1;
+        m_bytes += size;
+        return S_OK;
+    }
+
+    HRESULT RecordWriter::Flush()
+    {
+        if (m_stagingUsed)
+        {
+            HRCHK(m_data.Write(m_staging.data(), m_stagingUsed));
+            m_stagingUsed = 0;
+        }
+
+        if (!m_indexStaging.empty())
+        {
+            HRCHK(m_index.Write(m_indexStaging.data(), m_indexStaging.size() * sizeof(RecordIndexEntry)));
+            m_indexStaging.clear();
+        }
+
+        return S_OK;
+    }
+
+    //
+    // RecordSink
+    //
+
+    RecordSink::RecordSink(RecordWriter& writer, FramePool& pool) noexcept
+        : m_writer(writer)
+        , m_pool(pool)
+        , m_poolDrops(0)
+    {
+    }
+
+    void RecordSink::OnFrame(const FrameView& frame, int64_t timestamp)
+    {
+        FrameRef ref = m_pool.Copy(frame);
+
+        if (!ref)
+        {
+            m_poolDrops += 1;
+            return;
+        }
+
+        ref->timestamp = timestamp;
+        m_writer.Write(std::move(ref));
+    }
+}
@@ -0,0 +1,120 @@
+#pragma once
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "RecordFile.h"
+#include "FrameSink.h"
+#include "SpscQueue.h"
+
+namespace video
+{
+    //
+    // Writes frames to a recording on a background thread.
+    // Write only queues a reference to the pooled frame, so the capture callback
+    // never waits for the disk: a full queue drops the frame and counts it
+    //
+    class RecordWriter
+    {
+    public:
+        struct Statistics
+        {
+            uint64_t queued;        // frames accepted by Write
+            uint64_t written;       // frames on disk
+            uint64_t bytes;         // frame bytes on disk
+            uint64_t dropped;       // queue full, the disk does not keep up
+            uint64_t rejected;      // frames of another format
+            size_t backlog;         // frames waiting for the disk
+            size_t maxBacklog;
+        };
+
+        explicit RecordWriter(size_t queueDepth = 64);
+        ~RecordWriter();
+
+        RecordWriter(const RecordWriter&) = delete;
+        RecordWriter& operator=(const RecordWriter&) = delete;
+
+        //
+        // Frames must have the FramePool::AlignedFormat layout of the format
+        //
+        HRESULT Open(
+            const std::wstring& path,
+            PixelFormat format,
+            uint32_t width,
+            uint32_t height,
+            uint32_t fpsNumerator,
+            uint32_t fpsDenominator);
+
+        //
+        // Writes the backlog, the header and the index
+        //
+        HRESULT Close();
+
+        bool IsOpen() const noexcept;
+
+        //
+        // Never blocks, returns false if the frame was dropped.
+        // timestamp and flags are taken from the frame
+        //
+        bool Write(FrameRef frame) noexcept;
+
+        Statistics GetStatistics() const noexcept;
+
+        //
+        // The first write error, the writer stops writing after it
+        //
+        HRESULT GetError() const noexcept;
+
+    private:
+        void Run();
+        HRESULT WriteFrame(const FrameRef& frame);
+        HRESULT Flush();
+
+    private:
+        const size_t m_queueDepth;
+        std::unique_ptr<SpscQueue<FrameRef>> m_queue;
+        std::thread m_thread;
+        std::mutex m_mutex;
+        std::condition_variable m_wake;
+        std::atomic<bool> m_stopping;
+        std::atomic<HRESULT> m_error;
+
+        //
+        // Writer thread state
+        //
+        File m_data;
+        File m_index;
+        RecordHeader m_header;
+        FrameFormat m_format;
+        uint64_t m_dataOffset;
+        uint64_t m_reserved;
+        std::vector<uint8_t> m_staging;
+        size_t m_stagingUsed;
+        std::vector<RecordIndexEntry> m_indexStaging;
+
+        std::atomic<uint64_t> m_written;
+        std::atomic<uint64_t> m_bytes;
+        std::atomic<uint64_t> m_rejected;
+        std::atomic<size_t> m_maxBacklog;
+    };
+
+    //
+    // Copies frames into the pool and hands them to a RecordWriter
+    //
+    class RecordSink : public FrameSink
+    {
+    public:
+        RecordSink(RecordWriter& writer, FramePool& pool) noexcept;
+
+        void OnFrame(const FrameView& frame, int64_t timestamp) override;
+
+        uint64_t GetPoolDrops() const noexcept { return m_poolDrops; }
+
+    private:
+        RecordWriter& m_writer;
+        FramePool& m_pool;
+        uint64_t m_poolDrops;
+    };
+}
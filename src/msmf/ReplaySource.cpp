@@ -0,0 +1,221 @@
+#include "ReplaySource.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace capture
+{
+    ReplaySource::ReplaySource() noexcept
+        : m_entries(nullptr)
+        , m_frameCount(0)
+        , m_realtime(false)
+        , m_stopping(false)
+        , m_done(false)
+        , m_frames(0)
+        , m_bytes(0)
+    {
+    }
+
+    ReplaySource::~ReplaySource()
+    {
+        Stop();
+    }
+
+    HRESULT ReplaySource::Open(const std::wstring& path, bool realtime)
+    {
+        if (m_thread.joinable())
+        {
+            return E_UNEXPECTED;
+        }
+
+        HRCHK(m_data.Open(path));
+        HRCHK(m_index.Open(video::RecordIndexPath(path)));
+
+        if (m_data.Size() < video::RecordDataOffset)
+        {
+            return E_INVALIDARG;
+        }
+
+        video::RecordHeader header;
+        memcpy(&header, m_data.Data(), sizeof(header));
+
+        if (header.magic != video::RecordMagic || header.version != video::RecordVersion)
+        {
+            return E_INVALIDARG;
+        }
+
+        m_format.format = static_cast<video::PixelFormat>(header.format);
+        m_format.width = header.width;
+        m_format.height = header.height;
+        m_format.stride = header.stride;
+
+        const size_t frameSize = m_format.BufferSize();
+
+        if (0 == video::PlaneCount(m_format.format) || 0 == frameSize)
+        {
+            return E_INVALIDARG;
+        }
+
+        //
+        // A recording that was not closed has no frame count in the header,
+        // the index is the reference then
+        //
+        uint64_t frameCount = m_index.Size() / sizeof(video::RecordIndexEntry);
+
+        if (header.frameCount)
+        {
+            frameCount = std::min(frameCount, header.frameCount);
+        }
+
+        m_entries = reinterpret_cast<const video::RecordIndexEntry*>(m_index.Data());
+        m_frameCount = 0;
+
+        //
+        // The index of an interrupted recording can get ahead of the data,
+        // the replay stops at the first frame that is not in the file
+        //
+        while (m_frameCount < frameCount)
+        {
+            const video::RecordIndexEntry& entry = m_entries[m_frameCount];
+
+            if (entry.size < frameSize ||
+                entry.offset < video::RecordDataOffset ||
+                entry.offset > m_data.Size() - frameSize)
+            {
+                break;
+            }
+
+            m_frameCount += 1;
+        }
+
+        m_mediaType = MediaTypeInfo();
+        m_mediaType.subtype = video::PixelFormatName(m_format.format);
+        m_mediaType.format = m_format.format;
+        m_mediaType.width = header.width;
+        m_mediaType.height = header.height;
+        m_mediaType.fpsNumerator = header.fpsNumerator;
+        m_mediaType.fpsDenominator = header.fpsDenominator;
+        m_mediaType.defaultStride = static_cast<int32_t>(header.stride);
+        m_realtime = realtime;
+        return S_OK;
+    }
+
+    uint64_t ReplaySource::GetFrameCount() const noexcept
+    {
+        return m_frameCount;
+    }
+
+    ReplaySource::Statistics ReplaySource::GetStatistics() const noexcept
+    {
+        Statistics stat;
+        stat.frames = m_frames.load(std::memory_order_relaxed);
+        stat.bytes = m_bytes.load(std::memory_order_relaxed);
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        const auto stop = m_done ? m_stopTime : std::chrono::steady_clock::now();
+        stat.seconds = std::chrono::duration<double>(stop - m_startTime).count();
+        return stat;
+    }
+
+    const MediaTypeInfo& ReplaySource::GetMediaType() const noexcept
+    {
+        return m_mediaType;
+    }
+
+    HRESULT ReplaySource::Start(video::FrameSink& sink, uint32_t readDepth)
+    {
+        if (0 == readDepth)
+        {
+            return E_INVALIDARG;
+        }
+
+        if (!m_entries || m_thread.joinable())
+        {
+            return E_UNEXPECTED;
+        }
+
+        m_frames = 0;
+        m_bytes = 0;
+        m_stopping = false;
+        m_done = false;
+        m_startTime = std::chrono::steady_clock::now();
+        m_stopTime = m_startTime;
+        m_thread = std::thread(&ReplaySource::Run, this, std::ref(sink));
+        return S_OK;
+    }
+
+    HRESULT ReplaySource::Wait(uint32_t timeoutMs)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+
+        if (WaitInfinite == timeoutMs)
+        {
+            m_event.wait(lock, [this] { return m_done; });
+            return S_OK;
+        }
+
+        const bool done = m_event.wait_for(lock, std::chrono::milliseconds(timeoutMs), [this] { return m_done; });
+        return done ? S_OK : S_FALSE;
+    }
+
+    HRESULT ReplaySource::Stop()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stopping = true;
+        }
+
+        m_event.notify_all();
+
+        if (m_thread.joinable())
+        {
+            m_thread.join();
+        }
+
+        return S_OK;
+    }
+
+    void ReplaySource::Run(video::FrameSink& sink)
+    {
+        const size_t frameSize = m_format.BufferSize();
+        const int64_t firstTimestamp = m_frameCount ? m_entries[0].timestamp : 0;
+
+        for (uint64_t i = 0; i < m_frameCount; ++i)
+        {
+            const video::RecordIndexEntry& entry = m_entries[i];
+
+            if (m_realtime)
+            {
+                //
+                // Timestamps are 100 ns units, the wait is woken up by Stop
+                //
+                const auto due = m_startTime + std::chrono::nanoseconds((entry.timestamp - firstTimestamp) * 100);
+
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_event.wait_until(lock, due, [this] { return m_stopping.load(); });
+            }
+
+            if (m_stopping)
+            {
+                break;
+            }
+
+            const video::FrameView frame = video::MakeFrameView(
+                m_format.format,
+                m_format.width,
+                m_format.height,
+                m_data.Data() + entry.offset,
+                m_format.stride);
+
+            sink.OnFrame(frame, entry.timestamp);
+
+            m_frames.fetch_add(1, std::memory_order_relaxed);
+            m_bytes.fetch_add(frameSize, std::memory_order_relaxed);
+        }
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopTime = std::chrono::steady_clock::now();
+        m_done = true;
+        m_event.notify_all();
+    }
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include "CaptureBackend.h"
+#include "RecordFile.h"
+
+namespace capture
+{
+    //
+    // Streams a recording written by video::RecordWriter back to a sink.
+    // The data file and the index are mapped, frames are delivered straight
+    // from the mapping at the recorded timing or as fast as the sink takes them
+    //
+    class ReplaySource : public FrameSource
+    {
+    public:
+        struct Statistics
+        {
+            uint64_t frames;
+            uint64_t bytes;
+            double seconds;
+        };
+
+        ReplaySource() noexcept;
+        ~ReplaySource();
+
+        //
+        // Realtime replay sleeps for the timestamp delta between frames
+        //
+        HRESULT Open(const std::wstring& path, bool realtime);
+        uint64_t GetFrameCount() const noexcept;
+        Statistics GetStatistics() const noexcept;
+
+        const MediaTypeInfo& GetMediaType() const noexcept override;
+        HRESULT Start(video::FrameSink& sink, uint32_t readDepth) override;
+        HRESULT Wait(uint32_t timeoutMs) override;
+        HRESULT Stop() override;
+
+    private:
+        void Run(video::FrameSink& sink);
+
+    private:
+        video::MappedFile m_data;
+        video::MappedFile m_index;
+        video::FrameFormat m_format;
+        const video::RecordIndexEntry* m_entries;
+        uint64_t m_frameCount;
+        MediaTypeInfo m_mediaType;
+        bool m_realtime;
+
+        std::thread m_thread;
+        mutable std::mutex m_mutex;
+        std::condition_variable m_event;
+        std::atomic<bool> m_stopping;
+        bool m_done;
+
+        std::atomic<uint64_t> m_frames;
+        std::atomic<uint64_t> m_bytes;
+        std::chrono::steady_clock::time_point m_startTime;
+        std::chrono::steady_clock::time_point m_stopTime;
+    };
+}
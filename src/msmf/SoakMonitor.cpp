@@ -0,0 +1,433 @@
+#include "SoakMonitor.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <filesystem>
+#include <memory>
+#include <thread>
+
+#ifdef _WIN32
+#include <psapi.h>
+#pragma comment(lib, "Psapi.lib")
+#else
+#include <unistd.h>
+#endif
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    //
+    // Supervision period: how soon a stopped source is noticed
+    //
+    constexpr auto SuperviseTick = std::chrono::milliseconds(100);
+
+    //
+    // Times the frames of one stream, the source thread calls OnFrame
+    // while the soak thread takes the interval
+    //
+    class SoakSink : public video::FrameSink
+    {
+    public:
+        explicit SoakSink(const capture::MediaTypeInfo& mediaType) noexcept
+            : m_framesBefore(0)
+            , m_restarted(false)
+        {
+            m_timing.SetFrameRate(mediaType.fpsNumerator, mediaType.fpsDenominator);
+        }
+
+        void OnFrame(const video::FrameView& frame, int64_t timestamp) override
+        {
+            (void)frame;
+            std::lock_guard<std::mutex> lock(m_mutex);
+
+            if (m_restarted)
+            {
+                //
+                // Keeps the frames of the interval, the timing starts over
+                //
+                m_framesBefore += m_timing.GetReport().frames;
+                m_timing.Reset();
+                m_restarted = false;
+            }
+
+            m_timing.OnSample(timestamp, video::TimingAnalyzer::Now());
+        }
+
+        void Restart() noexcept
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_restarted = true;
+        }
+
+        //
+        // The report of the frames since the previous call
+        //
+        video::TimingAnalyzer::Report TakeInterval() noexcept
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            auto report = m_timing.GetReport();
+            report.frames += m_framesBefore;
+            m_timing.Reset();
+            m_framesBefore = 0;
+            return report;
+        }
+
+    private:
+        std::mutex m_mutex;
+        video::TimingAnalyzer m_timing;
+        uint64_t m_framesBefore;    // of the interval, before the source restarted
+        bool m_restarted;
+    };
+
+    struct StreamState
+    {
+        const capture::SoakStream* config;
+        std::unique_ptr<SoakSink> sink;  // outlives the source
+        std::unique_ptr<capture::FrameSource> source;
+        uint64_t restarts;
+        HRESULT error;
+        Clock::time_point retryAt;
+    };
+
+    HRESULT StartStream(StreamState& state, uint32_t readDepth)
+    {
+        std::unique_ptr<capture::FrameSource> source;
+        HRCHK(state.config->device->OpenFrameSource(state.config->streamIndex, state.config->mediaTypeIndex, source));
+
+        if (!state.sink)
+        {
+            state.sink.reset(new SoakSink(source->GetMediaType()));
+        }
+        else
+        {
+            //
+            // Timestamps of a reopened source start over
+            //
+            state.sink->Restart();
+        }
+
+        HRCHK(source->Start(*state.sink, readDepth));
+        state.source = std::move(source);
+        return S_OK;
+    }
+}
+
+namespace capture
+{
+    ProcessHealth GetProcessHealth() noexcept
+    {
+        ProcessHealth health = {};
+
+#ifdef _WIN32
+        PROCESS_MEMORY_COUNTERS counters = {};
+
+        if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+        {
+            health.workingSet = counters.WorkingSetSize;
+        }
+
+        DWORD handles = 0;
+
+        if (GetProcessHandleCount(GetCurrentProcess(), &handles))
+        {
+            health.handles = handles;
+        }
+#else
+        //
+        // The second field of statm is the resident set in pages
+        //
+        if (FILE* statm = fopen("/proc/self/statm", "r"))
+        {
+            unsigned long long size = 0;
+            unsigned long long resident = 0;
+
+            if (2 == fscanf(statm, "%llu %llu", &size, &resident))
+            {
+                health.workingSet = resident * static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+            }
+
+            fclose(statm);
+        }
+
+        std::error_code ec;
+
+        for (std::filesystem::directory_iterator it("/proc/self/fd", ec), end; !ec && it != end; it.increment(ec))
+        {
+            health.handles += 1;
+        }
+#endif
+
+        return health;
+    }
+
+    //
+    // TimeSeriesWriter
+    //
+
+    HRESULT TimeSeriesWriter::Open(const std::wstring& path)
+    {
+        std::error_code ec;
+        const bool empty = !std::filesystem::exists(path, ec) || 0 == std::filesystem::file_size(path, ec);
+
+        HRCHK(m_file.Append(path));
+
+        if (empty)
+        {
+            const std::string header = std::string(Header()) + "\n";
+            HRCHK(m_file.Write(header.data(), header.size()));
+        }
+
+        return S_OK;
+    }
+
+    HRESULT TimeSeriesWriter::Append(const SoakSample& sample)
+    {
+        if (!m_file.IsOpen())
+        {
+            return E_UNEXPECTED;
+        }
+
+        FormatSample(sample, m_line);
+        return m_file.Write(m_line.data(), m_line.size());
+    }
+
+    void TimeSeriesWriter::Close() noexcept
+    {
+        m_file.Close();
+    }
+
+    const char* TimeSeriesWriter::Header() noexcept
+    {
+        return "elapsed_s,stream,frames,fps,jitter_p99_us,interval_max_us,dropped,restarts,error,working_set_bytes,handles";
+    }
+
+    void TimeSeriesWriter::FormatSample(const SoakSample& sample, std::string& line)
+    {
+        char buffer[256];
+        const int length = snprintf(
+            buffer,
+            sizeof(buffer),
+            "%.3f,%" PRIu32 ",%" PRIu64 ",%.3f,%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",0x%08" PRIx32 ",%" PRIu64 ",%" PRIu32 "\n",
+            sample.elapsed,
+            sample.stream,
+            sample.frames,
+            sample.fps,
+            sample.jitterP99,
+            sample.intervalMax,
+            sample.dropped,
+            sample.restarts,
+            static_cast<uint32_t>(sample.error),
+            sample.workingSet,
+            sample.handles);
+
+        line.assign(buffer, length > 0 ? std::min<size_t>(length, sizeof(buffer) - 1) : 0);
+    }
+
+    //
+    // SoakAggregate
+    //
+
+    SoakAggregate::SoakAggregate() noexcept
+        : m_process()
+        , m_samples(0)
+    {
+    }
+
+    void SoakAggregate::Add(const SoakSample& sample)
+    {
+        if (sample.stream >= m_streams.size())
+        {
+            m_streams.resize(sample.stream + 1, Stream());
+        }
+
+        Stream& stream = m_streams[sample.stream];
+        StreamSummary& summary = stream.summary;
+
+        if (0 == summary.samples)
+        {
+            summary.fpsMin = sample.fps;
+            summary.fpsMax = sample.fps;
+        }
+
+        summary.samples += 1;
+        summary.frames += sample.frames;
+        summary.dropped += sample.dropped;
+        summary.restarts = sample.restarts;
+        summary.fpsMin = std::min(summary.fpsMin, sample.fps);
+        summary.fpsMax = std::max(summary.fpsMax, sample.fps);
+        summary.jitterP99Max = std::max(summary.jitterP99Max, sample.jitterP99);
+        summary.intervalMax = std::max(summary.intervalMax, sample.intervalMax);
+        summary.lastError = sample.error;
+
+        stream.sampledSeconds += sample.elapsed - stream.lastElapsed;
+        stream.lastElapsed = sample.elapsed;
+        summary.fpsAvg = stream.sampledSeconds > 0 ? summary.frames / stream.sampledSeconds : 0;
+
+        //
+        // The process values are the same in every stream of a sample
+        //
+        if (0 == m_samples++)
+        {
+            m_process.workingSetFirst = sample.workingSet;
+            m_process.handlesFirst = sample.handles;
+        }
+
+        m_process.seconds = std::max(m_process.seconds, sample.elapsed);
+        m_process.workingSetLast = sample.workingSet;
+        m_process.workingSetMax = std::max(m_process.workingSetMax, sample.workingSet);
+        m_process.handlesLast = sample.handles;
+        m_process.handlesMax = std::max(m_process.handlesMax, sample.handles);
+    }
+
+    SoakAggregate::Summary SoakAggregate::GetSummary() const
+    {
+        Summary summary = m_process;
+        summary.streams.clear();
+
+        for (const auto& stream : m_streams)
+        {
+            summary.streams.push_back(stream.summary);
+        }
+
+        return summary;
+    }
+
+    //
+    // RunSoak
+    //
+
+    HRESULT RunSoak(
+        const std::vector<SoakStream>& streams,
+        const SoakSettings& settings,
+        TimeSeriesWriter& writer,
+        SoakAggregate& aggregate,
+        const SoakCallback& callback)
+    {
+        if (streams.empty() || 0 == settings.intervalSeconds || 0 == settings.readDepth)
+        {
+            return E_INVALIDARG;
+        }
+
+        std::vector<StreamState> states(streams.size());
+
+        //
+        // Sources that stopped are stopped again by their destructors on the way out
+        //
+        for (size_t i = 0; i < streams.size(); ++i)
+        {
+            states[i].config = &streams[i];
+            states[i].restarts = 0;
+            states[i].error = S_OK;
+            HRCHK(StartStream(states[i], settings.readDepth));
+        }
+
+        const auto start = Clock::now();
+        const auto end = start + std::chrono::seconds(settings.seconds);
+        const auto interval = std::chrono::seconds(settings.intervalSeconds);
+        auto nextSample = start + interval;
+        auto lastSample = start;
+        HRESULT hr = S_OK;
+
+        while (SUCCEEDED(hr))
+        {
+            const auto now = Clock::now();
+
+            for (auto& state : states)
+            {
+                if (state.source)
+                {
+                    const HRESULT status = state.source->Wait(0);
+
+                    if (status == S_FALSE)
+                    {
+                        continue;
+                    }
+
+                    //
+                    // A live source ends only on an error, S_OK tells the stream just ended
+                    //
+                    state.error = status;
+                    state.source->Stop();
+                    state.source.reset();
+                    state.retryAt = now + std::chrono::milliseconds(settings.restartDelayMs);
+                }
+                else if (now >= state.retryAt)
+                {
+                    state.restarts += 1;
+                    const HRESULT restart = StartStream(state, settings.readDepth);
+
+                    if (FAILED(restart))
+                    {
+                        state.error = restart;
+                        state.retryAt = now + std::chrono::milliseconds(settings.restartDelayMs);
+                    }
+                }
+            }
+
+            const bool last = now >= end;
+
+            if (now >= nextSample || (last && now > lastSample))
+            {
+                const ProcessHealth health = GetProcessHealth();
+                const double elapsed = std::chrono::duration<double>(now - start).count();
+                const double seconds = std::chrono::duration<double>(now - lastSample).count();
+
+                for (size_t i = 0; i < states.size() && SUCCEEDED(hr); ++i)
+                {
+                    const auto timing = states[i].sink->TakeInterval();
+
+                    SoakSample sample = {};
+                    sample.elapsed = elapsed;
+                    sample.stream = static_cast<uint32_t>(i);
+                    sample.frames = timing.frames;
+                    sample.fps = seconds > 0 ? timing.frames / seconds : 0;
+                    sample.jitterP99 = timing.jitterP99;
+                    sample.intervalMax = timing.intervalMax;
+                    sample.dropped = timing.droppedFrames;
+                    sample.restarts = states[i].restarts;
+                    sample.error = states[i].error;
+                    sample.workingSet = health.workingSet;
+                    sample.handles = health.handles;
+
+                    hr = writer.Append(sample);
+                    aggregate.Add(sample);
+
+                    if (callback)
+                    {
+                        callback(sample);
+                    }
+                }
+
+                lastSample = now;
+
+                //
+                // A stalled loop skips the missed samples instead of writing them back to back
+                //
+                while (nextSample <= now)
+                {
+                    nextSample += interval;
+                }
+            }
+
+            if (last)
+            {
+                break;
+            }
+
+            std::this_thread::sleep_until(std::min({ now + SuperviseTick, nextSample, end }));
+        }
+
+        for (auto& state : states)
+        {
+            if (state.source)
+            {
+                state.source->Stop();
+            }
+        }
+
+        return hr;
+    }
+}
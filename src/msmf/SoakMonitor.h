@@ -0,0 +1,146 @@
+#pragma once
+
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "CaptureBackend.h"
+#include "RecordFile.h"
+#include "TimingAnalyzer.h"
+
+namespace capture
+{
+    //
+    // Health of one stream over one sampling interval
+    //
+    struct SoakSample
+    {
+        double elapsed;         // seconds since the start of the run
+        uint32_t stream;        // position in the soak streams
+        uint64_t frames;        // in the interval
+        double fps;
+        uint64_t jitterP99;     // microseconds, in the interval
+        uint64_t intervalMax;   // microseconds, in the interval
+        uint64_t dropped;       // frames missing between the timestamps, in the interval
+        uint64_t restarts;      // since the start of the run
+        HRESULT error;          // the last status a stopped source reported, S_OK while it never stopped
+        uint64_t workingSet;    // bytes, the whole process
+        uint32_t handles;       // handles or file descriptors, the whole process
+    };
+
+    struct ProcessHealth
+    {
+        uint64_t workingSet;
+        uint32_t handles;
+    };
+
+    ProcessHealth GetProcessHealth() noexcept;
+
+    //
+    // Appends one CSV line per sample to the time-series file. The header
+    // is written when the file is empty, so runs can share one file.
+    // Every line is written at once, a crashed run leaves whole lines
+    //
+    class TimeSeriesWriter
+    {
+    public:
+        TimeSeriesWriter() = default;
+
+        TimeSeriesWriter(const TimeSeriesWriter&) = delete;
+        TimeSeriesWriter& operator=(const TimeSeriesWriter&) = delete;
+
+        HRESULT Open(const std::wstring& path);
+        HRESULT Append(const SoakSample& sample);
+        void Close() noexcept;
+
+        static const char* Header() noexcept;
+        static void FormatSample(const SoakSample& sample, std::string& line);
+
+    private:
+        video::File m_file;
+        std::string m_line;
+    };
+
+    //
+    // Totals and extremes of the samples of a run
+    //
+    class SoakAggregate
+    {
+    public:
+        struct StreamSummary
+        {
+            uint64_t samples;
+            uint64_t frames;
+            uint64_t dropped;
+            uint64_t restarts;
+            double fpsMin;
+            double fpsMax;
+            double fpsAvg;          // frames over the sampled time
+            uint64_t jitterP99Max;
+            uint64_t intervalMax;
+            HRESULT lastError;
+        };
+
+        struct Summary
+        {
+            double seconds;
+            std::vector<StreamSummary> streams;
+
+            //
+            // The first and the last samples tell leaks from peaks
+            //
+            uint64_t workingSetFirst;
+            uint64_t workingSetLast;
+            uint64_t workingSetMax;
+            uint32_t handlesFirst;
+            uint32_t handlesLast;
+            uint32_t handlesMax;
+        };
+
+        SoakAggregate() noexcept;
+
+        void Add(const SoakSample& sample);
+        Summary GetSummary() const;
+
+    private:
+        struct Stream
+        {
+            StreamSummary summary;
+            double sampledSeconds;
+            double lastElapsed;
+        };
+
+        std::vector<Stream> m_streams;
+        Summary m_process;
+        uint64_t m_samples;
+    };
+
+    struct SoakStream
+    {
+        DevicePtr device;
+        uint32_t streamIndex = 0;
+        uint32_t mediaTypeIndex = 0;
+    };
+
+    struct SoakSettings
+    {
+        uint64_t seconds = 3600;
+        uint32_t intervalSeconds = 10;
+        uint32_t readDepth = 1;
+        uint32_t restartDelayMs = 1000;  // between a failure and the next open
+    };
+
+    using SoakCallback = std::function<void(const SoakSample& sample)>;
+
+    //
+    // Captures the streams for settings.seconds, sampling every stream each interval.
+    // A source that stops is reopened after the restart delay, the first open
+    // of every source must succeed. Fails only if the time series cannot be written
+    //
+    HRESULT RunSoak(
+        const std::vector<SoakStream>& streams,
+        const SoakSettings& settings,
+        TimeSeriesWriter& writer,
+        SoakAggregate& aggregate,
+        const SoakCallback& callback);
+}
@@ -0,0 +1,292 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <thread>
+
+namespace video
+{
+    //
+    // What Push does when the queue is full
+    //
+    enum class QueuePolicy
+    {
+        DropOldest = 0, // discard the oldest queued item, keep the new one
+        DropNewest,     // discard the new item
+        Block,          // wait until the consumer frees a slot or the queue is closed
+    };
+
+    inline const wchar_t* QueuePolicyName(QueuePolicy policy) noexcept
+    {
+        switch (policy)
+        {
+        case QueuePolicy::DropOldest: return L"drop-oldest";
+        case QueuePolicy::DropNewest: return L"drop-newest";
+        case QueuePolicy::Block: return L"block";
+        default: return L"unknown";
+        }
+    }
+
+    //
+    // Bounded lock-free single-producer/single-consumer ring.
+    // Slots carry sequence numbers (Vyukov's bounded queue), so with DropOldest
+    // the producer can discard the oldest item while the consumer reads another one
+    //
+    template<typename T>
+    class SpscQueue
+    {
+    public:
+        struct Statistics
+        {
+            uint64_t pushed;
+            uint64_t popped;
+            uint64_t droppedOldest;
+            uint64_t droppedNewest;
+            uint64_t blocked;       // Push calls that had to wait
+        };
+
+        //
+        // The capacity is rounded up to a power of two
+        //
+        SpscQueue(size_t capacity, QueuePolicy policy)
+            : m_policy(policy)
+            , m_closed(false)
+        {
+            size_t size = 2;
+
+            while (size < capacity)
+            {
+                size *= 2;
+            }
+
+            m_mask = size - 1;
+            m_cells.reset(new Cell[size]);
+
+            for (size_t i = 0; i < size; ++i)
+            {
+                m_cells[i].sequence.store(i, std::memory_order_relaxed);
+            }
+
+            m_enqueuePos.store(0, std::memory_order_relaxed);
+            m_dequeuePos.store(0, std::memory_order_relaxed);
+            ResetStatistics();
+        }
+
+        SpscQueue(const SpscQueue&) = delete;
+        SpscQueue& operator=(const SpscQueue&) = delete;
+
+        //
+        // Producer side. Returns false if the item was dropped or the queue is closed
+        //
+        bool Push(T&& item)
+        {
+            if (TryEnqueue(item))
+            {
+                return true;
+            }
+
+            switch (m_policy)
+            {
+            case QueuePolicy::DropNewest:
+                m_droppedNewest.fetch_add(1, std::memory_order_relaxed);
+                return false;
+
+            case QueuePolicy::DropOldest:
+                while (!TryEnqueue(item))
+                {
+                    T oldest;
+
+                    if (TryDequeue(oldest))
+                    {
+                        m_droppedOldest.fetch_add(1, std::memory_order_relaxed);
+                    }
+                    else
+                    {
+                        //
+                        // The consumer is reading the slot we need
+                        //
+                        std::this_thread::yield();
+                    }
+                }
+                return true;
+
+            case QueuePolicy::Block:
+                m_blocked.fetch_add(1, std::memory_order_relaxed);
+
+                while (!TryEnqueue(item))
+                {
+                    if (m_closed.load(std::memory_order_acquire))
+                    {
+                        m_droppedNewest.fetch_add(1, std::memory_order_relaxed);
+                        return false;
+                    }
+
+                    std::this_thread::yield();
+                }
+                return true;
+
+            default:
+                return false;
+            }
+        }
+
+        //
+        // Consumer side
+        //
+        bool Pop(T& item)
+        {
+            if (TryDequeue(item))
+            {
+                m_popped.fetch_add(1, std::memory_order_relaxed);
+                return true;
+            }
+
+            return false;
+        }
+
+        //
+        // Releases a producer blocked in Push, new items are still accepted
+        // by the drop policies so the queue can be drained and reused
+        //
+        void Close() noexcept
+        {
+            m_closed.store(true, std::memory_order_release);
+        }
+
+        void Open() noexcept
+        {
+            m_closed.store(false, std::memory_order_release);
+        }
+
+        bool IsClosed() const noexcept
+        {
+            return m_closed.load(std::memory_order_acquire);
+        }
+
+        //
+        // Consumer side, drops everything queued
+        //
+        void Clear()
+        {
+            T item;
+            while (TryDequeue(item))
+            {
+            }
+        }
+
+        size_t Capacity() const noexcept
+        {
+            return m_mask + 1;
+        }
+
+        size_t Size() const noexcept
+        {
+            const size_t tail = m_enqueuePos.load(std::memory_order_acquire);
+            const size_t head = m_dequeuePos.load(std::memory_order_acquire);
+            return tail - head;
+        }
+
+        QueuePolicy Policy() const noexcept
+        {
+            return m_policy;
+        }
+
+        Statistics GetStatistics() const noexcept
+        {
+            Statistics stat;
+            stat.pushed = m_pushed.load(std::memory_order_relaxed);
+            stat.popped = m_popped.load(std::memory_order_relaxed);
+            stat.droppedOldest = m_droppedOldest.load(std::memory_order_relaxed);
+            stat.droppedNewest = m_droppedNewest.load(std::memory_order_relaxed);
+            stat.blocked = m_blocked.load(std::memory_order_relaxed);
+            return stat;
+        }
+
+        void ResetStatistics() noexcept
+        {
+            m_pushed.store(0, std::memory_order_relaxed);
+            m_popped.store(0, std::memory_order_relaxed);
+            m_droppedOldest.store(0, std::memory_order_relaxed);
+            m_droppedNewest.store(0, std::memory_order_relaxed);
+            m_blocked.store(0, std::memory_order_relaxed);
+        }
+
+    private:
+        bool TryEnqueue(T& item)
+        {
+            //
+            // Only the producer moves the enqueue position
+            //
+            const size_t pos = m_enqueuePos.load(std::memory_order_relaxed);
+            Cell& cell = m_cells[pos & m_mask];
+
+            if (cell.sequence.load(std::memory_order_acquire) != pos)
+            {
+                return false;
+            }
+
+            cell.value = std::move(item);
+            cell.sequence.store(pos + 1, std::memory_order_release);
+            m_enqueuePos.store(pos + 1, std::memory_order_release);
+            m_pushed.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+
+        bool TryDequeue(T& item)
+        {
+            //
+            // Both the consumer and the DropOldest producer dequeue, the slot is claimed by CAS
+            //
+            size_t pos = m_dequeuePos.load(std::memory_order_relaxed);
+
+            for (;;)
+            {
+                Cell& cell = m_cells[pos & m_mask];
+                const size_t sequence = cell.sequence.load(std::memory_order_acquire);
+                const intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos + 1);
+
+                if (diff == 0)
+                {
+                    if (m_dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_acq_rel, std::memory_order_relaxed))
+                    {
+                        item = std::move(cell.value);
+                        cell.value = T();
+                        cell.sequence.store(pos + m_mask + 1, std::memory_order_release);
+                        return true;
+                    }
+                }
+                else if (diff < 0)
+                {
+                    return false;
+                }
+                else
+                {
+                    pos = m_dequeuePos.load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+    private:
+        struct Cell
+        {
+            std::atomic<size_t> sequence;
+            T value;
+        };
+
+        const QueuePolicy m_policy;
+        size_t m_mask;
+        std::unique_ptr<Cell[]> m_cells;
+        std::atomic<bool> m_closed;
+
+        alignas(64) std::atomic<size_t> m_enqueuePos;
+        alignas(64) std::atomic<size_t> m_dequeuePos;
+
+        alignas(64) std::atomic<uint64_t> m_pushed;
+        std::atomic<uint64_t> m_popped;
+        std::atomic<uint64_t> m_droppedOldest;
+        std::atomic<uint64_t> m_droppedNewest;
+        std::atomic<uint64_t> m_blocked;
+    };
+}
@@ -0,0 +1,101 @@
+#include "StreamDispatcher.h"
+
+namespace capture
+{
+    StreamDispatcher::StreamDispatcher(size_t expectedFramesPerStream)
+        : m_expectedFrames(expectedFramesPerStream)
+        , m_unrouted(0)
+    {
+    }
+
+    HRESULT StreamDispatcher::AddStream(uint32_t streamIndex, video::FrameSink& sink)
+    {
+        if (streamIndex > MaxStreamIndex || m_streams.size() >= NoRoute)
+        {
+            return E_BOUNDS;
+        }
+
+        if (streamIndex < m_routes.size() && m_routes[streamIndex] != NoRoute)
+        {
+            return E_INVALIDARG;
+        }
+
+        if (streamIndex >= m_routes.size())
+        {
+            m_routes.resize(streamIndex + 1, NoRoute);
+        }
+
+        m_routes[streamIndex] = static_cast<uint8_t>(m_streams.size());
+        m_streams.push_back({ streamIndex, &sink, video::BenchStatistics(m_expectedFrames), 0 });
+        return S_OK;
+    }
+
+    size_t StreamDispatcher::GetStreamCount() const noexcept
+    {
+        return m_streams.size();
+    }
+
+    void StreamDispatcher::Start() noexcept
+    {
+        //
+        // Every stream is timed from the same point, so the rates add up
+        //
+        const auto now = video::BenchStatistics::Clock::now();
+        const double cpuSeconds = video::BenchStatistics::ProcessCpuSeconds();
+
+        for (auto& stream : m_streams)
+        {
+            stream.statistics.Start(now, cpuSeconds);
+            stream.bytes = 0;
+        }
+
+        m_unrouted = 0;
+    }
+
+    void StreamDispatcher::Stop() noexcept
+    {
+        const auto now = video::BenchStatistics::Clock::now();
+        const double cpuSeconds = video::BenchStatistics::ProcessCpuSeconds();
+
+        for (auto& stream : m_streams)
+        {
+            stream.statistics.Stop(now, cpuSeconds);
+        }
+    }
+
+    void StreamDispatcher::OnFrame(uint32_t streamIndex, const video::FrameView& frame, int64_t timestamp)
+    {
+        if (streamIndex >= m_routes.size() || m_routes[streamIndex] == NoRoute)
+        {
+            m_unrouted += 1;
+            return;
+        }
+
+        Stream& stream = m_streams[m_routes[streamIndex]];
+        stream.statistics.OnFrame();
+        stream.bytes += frame.Bytes();
+        stream.sink->OnFrame(frame, timestamp);
+    }
+
+    StreamDispatcher::Report StreamDispatcher::GetReport() const
+    {
+        Report report = {};
+        report.unrouted = m_unrouted;
+
+        for (const auto& stream : m_streams)
+        {
+            StreamReport streamReport;
+            streamReport.streamIndex = stream.streamIndex;
+            streamReport.bench = stream.statistics.GetReport();
+            streamReport.bytes = stream.bytes;
+
+            report.frames += streamReport.bench.frames;
+            report.bytes += streamReport.bytes;
+            report.seconds = streamReport.bench.seconds;
+            report.streams.push_back(streamReport);
+        }
+
+        report.fps = report.seconds > 0 ? report.frames / report.seconds : 0;
+        return report;
+    }
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <vector>
+#include "Platform.h"
+#include "FrameSink.h"
+#include "BenchStatistics.h"
+
+namespace capture
+{
+    //
+    // Routes the frames of a multi-stream source to one sink per stream
+    // and times every stream. The source calls OnFrame from one thread
+    // at a time and not after Stop, as FrameSource does with its sink
+    //
+    class StreamDispatcher
+    {
+    public:
+        struct StreamReport
+        {
+            uint32_t streamIndex;
+            video::BenchStatistics::Report bench;
+            uint64_t bytes;
+        };
+
+        struct Report
+        {
+            std::vector<StreamReport> streams;
+            uint64_t frames;
+            uint64_t bytes;
+            double seconds;
+            double fps;
+            uint64_t unrouted;  // frames of streams without a sink
+        };
+
+        //
+        // Stream indexes are small, the route table is indexed by them
+        //
+        static constexpr uint32_t MaxStreamIndex = 255;
+
+        explicit StreamDispatcher(size_t expectedFramesPerStream = 0);
+
+        StreamDispatcher(const StreamDispatcher&) = delete;
+        StreamDispatcher& operator=(const StreamDispatcher&) = delete;
+
+        //
+        // E_INVALIDARG if the stream already has a sink
+        //
+        HRESULT AddStream(uint32_t streamIndex, video::FrameSink& sink);
+        size_t GetStreamCount() const noexcept;
+
+        void Start() noexcept;
+        void Stop() noexcept;
+
+        void OnFrame(uint32_t streamIndex, const video::FrameView& frame, int64_t timestamp);
+
+        Report GetReport() const;
+
+    private:
+        struct Stream
+        {
+            uint32_t streamIndex;
+            video::FrameSink* sink;
+            video::BenchStatistics statistics;
+            uint64_t bytes;
+        };
+
+        static constexpr uint8_t NoRoute = 0xFF;
+
+        const size_t m_expectedFrames;
+        std::vector<Stream> m_streams;
+        std::vector<uint8_t> m_routes;  // stream index to m_streams position
+        uint64_t m_unrouted;
+    };
+}
@@ -0,0 +1,773 @@
+#include "SweepBaseline.h"
+#include "RecordFile.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cinttypes>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <iomanip>
+#include <sstream>
+#include <unordered_map>
+
+namespace
+{
+    using namespace capture;
+
+    //
+    // Two-sided 95% quantile of the normal distribution
+    //
+    constexpr double Z95 = 1.96;
+
+    enum class Column : uint32_t
+    {
+        SymbolicLink = 0,
+        Device,
+        Stream,
+        MediaType,
+        Subtype,
+        Width,
+        Height,
+        FpsNumerator,
+        FpsDenominator,
+        Hr,
+        Frames,
+        Seconds,
+        Converged,
+        Batches,
+        Fps,
+        FpsHalfWidth,
+        JitterUs,
+        JitterHalfWidthUs,
+        JitterP50,
+        JitterP99,
+        JitterP999,
+        Dropped,
+        FirstFrameMs,
+        CpuPerFrameMs,
+        Count
+    };
+
+    constexpr const char* ColumnNames[] =
+    {
+        "symbolic_link",
+        "device",
+        "stream",
+        "media_type",
+        "subtype",
+        "width",
+        "height",
+        "fps_numerator",
+        "fps_denominator",
+        "hr",
+        "frames",
+        "seconds",
+        "converged",
+        "batches",
+        "fps",
+        "fps_ci",
+        "jitter_us",
+        "jitter_ci_us",
+        "jitter_p50_us",
+        "jitter_p99_us",
+        "jitter_p999_us",
+        "dropped",
+        "first_frame_ms",
+        "cpu_per_frame_ms",
+    };
+
+    static_assert(sizeof(ColumnNames) / sizeof(ColumnNames[0]) == static_cast<size_t>(Column::Count),
+        "a name for every column");
+
+    std::string WideToUtf8(const std::wstring& wide)
+    {
+        try
+        {
+            return std::filesystem::path(wide).u8string();
+        }
+        catch (const std::exception&)
+        {
+            return std::string();
+        }
+    }
+
+    bool Utf8ToWide(const std::string& str, std::wstring& wide)
+    {
+        try
+        {
+            wide = std::filesystem::u8path(str).wstring();
+            return true;
+        }
+        catch (const std::exception&)
+        {
+            return false;
+        }
+    }
+
+    //
+    // RFC 4180: quoted only if needed, quotes doubled
+    //
+    void AppendQuoted(const std::string& value, std::string& line)
+    {
+        if (value.find_first_of(",\"\r\n") == std::string::npos)
+        {
+            line += value;
+            return;
+        }
+
+        line += '"';
+
+        for (char ch : value)
+        {
+            if (ch == '"')
+            {
+                line += '"';
+            }
+
+            line += ch;
+        }
+
+        line += '"';
+    }
+
+    //
+    // Splits one CSV line, false for an unterminated quote
+    //
+    bool SplitCsv(const std::string& line, std::vector<std::string>& fields)
+    {
+        fields.clear();
+        fields.emplace_back();
+
+        bool quoted = false;
+
+        for (size_t i = 0; i < line.size(); ++i)
+        {
+            const char ch = line[i];
+
+            if (quoted)
+            {
+                if (ch != '"')
+                {
+                    fields.back() += ch;
+                }
+                else if (i + 1 < line.size() && line[i + 1] == '"')
+                {
+                    fields.back() += '"';
+                    ++i;
+                }
+                else
+                {
+                    quoted = false;
+                }
+            }
+            else if (ch == '"')
+            {
+                quoted = true;
+            }
+            else if (ch == ',')
+            {
+                fields.emplace_back();
+            }
+            else if (ch != '\r')
+            {
+                fields.back() += ch;
+            }
+        }
+
+        return !quoted;
+    }
+
+    template <typename T>
+    bool ParseUnsigned(const std::string& str, T& value)
+    {
+        if (str.empty() || str.find_first_not_of("0123456789") != std::string::npos)
+        {
+            return false;
+        }
+
+        errno = 0;
+        const unsigned long long number = std::strtoull(str.c_str(), nullptr, 10);
+
+        if (errno || static_cast<T>(number) != number)
+        {
+            return false;
+        }
+
+        value = static_cast<T>(number);
+        return true;
+    }
+
+    bool ParseDouble(const std::string& str, double& value)
+    {
+        if (str.empty())
+        {
+            return false;
+        }
+
+        char* end = nullptr;
+        value = std::strtod(str.c_str(), &end);
+        return end == str.c_str() + str.size() && std::isfinite(value);
+    }
+
+    bool ParseHresult(const std::string& str, HRESULT& hr)
+    {
+        if (str.size() < 3 || str[0] != '0' || (str[1] != 'x' && str[1] != 'X'))
+        {
+            return false;
+        }
+
+        char* end = nullptr;
+        const unsigned long long number = std::strtoull(str.c_str() + 2, &end, 16);
+
+        if (end != str.c_str() + str.size() || number > UINT32_MAX)
+        {
+            return false;
+        }
+
+        hr = static_cast<HRESULT>(static_cast<uint32_t>(number));
+        return true;
+    }
+
+    bool SetField(Column column, const std::string& value, BaselineRecord& record)
+    {
+        switch (column)
+        {
+        case Column::SymbolicLink: return Utf8ToWide(value, record.symbolicLink);
+        case Column::Device: return Utf8ToWide(value, record.device);
+        case Column::Stream: return ParseUnsigned(value, record.stream);
+        case Column::MediaType: return ParseUnsigned(value, record.mediaType);
+        case Column::Subtype: return Utf8ToWide(value, record.subtype);
+        case Column::Width: return ParseUnsigned(value, record.width);
+        case Column::Height: return ParseUnsigned(value, record.height);
+        case Column::FpsNumerator: return ParseUnsigned(value, record.fpsNumerator);
+        case Column::FpsDenominator: return ParseUnsigned(value, record.fpsDenominator);
+        case Column::Hr: return ParseHresult(value, record.hr);
+        case Column::Frames: return ParseUnsigned(value, record.frames);
+        case Column::Seconds: return ParseDouble(value, record.seconds);
+        case Column::Converged:
+            record.converged = value == "1";
+            return value == "0" || value == "1";
+        case Column::Batches: return ParseUnsigned(value, record.batches);
+        case Column::Fps: return ParseDouble(value, record.fps);
+        case Column::FpsHalfWidth: return ParseDouble(value, record.fpsHalfWidth);
+        case Column::JitterUs: return ParseDouble(value, record.jitterUs);
+        case Column::JitterHalfWidthUs: return ParseDouble(value, record.jitterHalfWidthUs);
+        case Column::JitterP50: return ParseUnsigned(value, record.jitterP50);
+        case Column::JitterP99: return ParseUnsigned(value, record.jitterP99);
+        case Column::JitterP999: return ParseUnsigned(value, record.jitterP999);
+        case Column::Dropped: return ParseUnsigned(value, record.dropped);
+        case Column::FirstFrameMs: return ParseDouble(value, record.firstFrameMs);
+        case Column::CpuPerFrameMs: return ParseDouble(value, record.cpuPerFrameMs);
+        default: return false;
+        }
+    }
+
+    bool HasFrames(const BaselineRecord& record) noexcept
+    {
+        return SUCCEEDED(record.hr) && record.frames > 0;
+    }
+
+    //
+    // The difference is beyond the 95% intervals of both means combined.
+    // A mean of fewer than 2 batches has no interval, it is never significant
+    //
+    bool Significant(double difference, const BaselineRecord& a, double halfWidthA, const BaselineRecord& b, double halfWidthB) noexcept
+    {
+        if (a.batches < 2 || b.batches < 2)
+        {
+            return false;
+        }
+
+        return difference > std::sqrt(halfWidthA * halfWidthA + halfWidthB * halfWidthB);
+    }
+
+    //
+    // One-sided growth of the missing frames share, two-proportion z-test
+    //
+    bool DropsGrew(const BaselineRecord& baseline, const BaselineRecord& current, double tolerance) noexcept
+    {
+        const double baseTotal = static_cast<double>(baseline.frames + baseline.dropped);
+        const double curTotal = static_cast<double>(current.frames + current.dropped);
+
+        if (baseTotal <= 0 || curTotal <= 0)
+        {
+            return false;
+        }
+
+        const double baseShare = baseline.dropped / baseTotal;
+        const double curShare = current.dropped / curTotal;
+
+        if (curShare - baseShare <= tolerance)
+        {
+            return false;
+        }
+
+        const double pooled = (baseline.dropped + current.dropped) / (baseTotal + curTotal);
+        const double error = std::sqrt(pooled * (1 - pooled) * (1 / baseTotal + 1 / curTotal));
+        return error > 0 && (curShare - baseShare) / error > Z95;
+    }
+
+    void Compare(BaselineComparison& comparison, const CompareSettings& settings) noexcept
+    {
+        const auto& base = comparison.baseline;
+        const auto& cur = comparison.current;
+
+        if (!HasFrames(base))
+        {
+            //
+            // Nothing measured before, nothing to regress from
+            //
+            return;
+        }
+
+        if (!HasFrames(cur))
+        {
+            comparison.failed = true;
+            return;
+        }
+
+        const double fpsLoss = base.fps - cur.fps;
+        comparison.fps = fpsLoss > settings.fpsTolerance * base.fps
+            && Significant(fpsLoss, base, base.fpsHalfWidth, cur, cur.fpsHalfWidth);
+
+        const double jitterGrowth = cur.jitterUs - base.jitterUs;
+        comparison.jitter = jitterGrowth > std::max(settings.jitterTolerance * base.jitterUs, settings.jitterFloorUs)
+            && Significant(jitterGrowth, base, base.jitterHalfWidthUs, cur, cur.jitterHalfWidthUs);
+
+        comparison.drops = DropsGrew(base, cur, settings.dropTolerance);
+
+        comparison.firstFrame = base.firstFrameMs >= 0 && cur.firstFrameMs - base.firstFrameMs
+            > std::max(settings.firstFrameTolerance * base.firstFrameMs, settings.firstFrameFloorMs);
+
+        comparison.cpu = cur.cpuPerFrameMs - base.cpuPerFrameMs
+            > std::max(settings.cpuTolerance * base.cpuPerFrameMs, settings.cpuFloorMs);
+    }
+
+    //
+    // "30.00 -> 24.10 (-19.7%)"
+    //
+    std::wstring FormatChange(double before, double after, int precision)
+    {
+        std::wostringstream st;
+        st << std::fixed << std::setprecision(precision) << before << L" -> " << after;
+
+        if (before > 0)
+        {
+            st << L" (" << std::showpos << std::setprecision(1) << (after - before) * 100 / before << L"%)";
+        }
+
+        return st.str();
+    }
+
+    void PrintRegressions(const BaselineComparison& comparison, std::wostream& st)
+    {
+        if (!comparison.hasBaseline)
+        {
+            st << L"new";
+            return;
+        }
+
+        if (!comparison.Regressed())
+        {
+            st << (comparison.hasCurrent ? L"ok" : L"not run");
+            return;
+        }
+
+        const wchar_t* separator = L"";
+
+        auto flag = [&](bool regressed, const wchar_t* name)
+        {
+            if (regressed)
+            {
+                st << separator << name;
+                separator = L", ";
+            }
+        };
+
+        flag(comparison.missing, L"missing");
+        flag(comparison.failed, L"failed");
+        flag(comparison.fps, L"fps");
+        flag(comparison.jitter, L"jitter");
+        flag(comparison.drops, L"drops");
+        flag(comparison.firstFrame, L"first frame");
+        flag(comparison.cpu, L"cpu");
+    }
+}
+
+namespace capture
+{
+    std::wstring BaselineRecord::Key() const
+    {
+        return symbolicLink + L"|" + subtype
+            + L"|" + std::to_wstring(width) + L"x" + std::to_wstring(height)
+            + L"|" + std::to_wstring(fpsNumerator) + L"/" + std::to_wstring(fpsDenominator);
+    }
+
+    BaselineRecord MakeBaselineRecord(
+        const std::wstring& symbolicLink,
+        const std::wstring& device,
+        uint32_t stream,
+        const MediaTypeInfo& mediaType,
+        HRESULT hr,
+        const BenchResult& result)
+    {
+        BaselineRecord record;
+        record.symbolicLink = symbolicLink;
+        record.device = device;
+        record.stream = stream;
+        record.mediaType = mediaType.index;
+        record.subtype = mediaType.subtype;
+        record.width = mediaType.width;
+        record.height = mediaType.height;
+        record.fpsNumerator = mediaType.fpsNumerator;
+        record.fpsDenominator = mediaType.fpsDenominator;
+        record.hr = hr;
+
+        if (FAILED(hr))
+        {
+            return record;
+        }
+
+        record.frames = result.bench.frames;
+        record.seconds = result.bench.seconds;
+        record.converged = result.dwell.converged;
+        record.batches = result.dwell.batches;
+        record.fps = result.dwell.fps;
+        record.fpsHalfWidth = result.dwell.fpsHalfWidth;
+        record.jitterUs = result.dwell.jitterUs;
+        record.jitterHalfWidthUs = result.dwell.jitterHalfWidthUs;
+        record.jitterP50 = result.timing.jitterP50;
+        record.jitterP99 = result.timing.jitterP99;
+        record.jitterP999 = result.timing.jitterP999;
+        record.dropped = result.timing.droppedFrames;
+        record.firstFrameMs = result.dwell.firstFrameMs;
+        record.cpuPerFrameMs = result.bench.cpuPerFrameMs;
+        return record;
+    }
+
+    std::string BaselineHeader()
+    {
+        std::string header;
+
+        for (const char* name : ColumnNames)
+        {
+            header += header.empty() ? "" : ",";
+            header += name;
+        }
+
+        return header;
+    }
+
+    void FormatBaselineRecord(const BaselineRecord& record, std::string& line)
+    {
+        line.clear();
+        AppendQuoted(WideToUtf8(record.symbolicLink), line);
+        line += ',';
+        AppendQuoted(WideToUtf8(record.device), line);
+        line += ',';
+
+        char buffer[64];
+        snprintf(buffer, sizeof(buffer), "%" PRIu32 ",%" PRIu32 ",", record.stream, record.mediaType);
+        line += buffer;
+
+        AppendQuoted(WideToUtf8(record.subtype), line);
+
+        char numbers[512];
+        const int length = snprintf(
+            numbers,
+            sizeof(numbers),
+            ",%" PRIu32 ",%" PRIu32 ",%" PRIu32 ",%" PRIu32 ",0x%08" PRIx32 ",%" PRIu64 ",%.3f,%d,%" PRIu32
+            ",%.4f,%.4f,%.3f,%.3f,%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%.3f,%.4f\n",
+            record.width,
+            record.height,
+            record.fpsNumerator,
+            record.fpsDenominator,
+            static_cast<uint32_t>(record.hr),
+            record.frames,
+            record.seconds,
+            record.converged ? 1 : 0,
+            record.batches,
+            record.fps,
+            record.fpsHalfWidth,
+            record.jitterUs,
+            record.jitterHalfWidthUs,
+            record.jitterP50,
+            record.jitterP99,
+            record.jitterP999,
+            record.dropped,
+            record.firstFrameMs,
+            record.cpuPerFrameMs);
+
+        line.append(numbers, length > 0 ? std::min<size_t>(length, sizeof(numbers) - 1) : 0);
+    }
+
+    HRESULT WriteBaseline(const std::wstring& path, const std::vector<BaselineRecord>& records)
+    {
+        video::File file;
+        HRCHK(file.Create(path));
+
+        std::string text = BaselineHeader() + "\n";
+        std::string line;
+
+        for (const auto& record : records)
+        {
+            FormatBaselineRecord(record, line);
+            text += line;
+        }
+
+        HRCHK(file.Write(text.data(), text.size()));
+        file.Close();
+        return S_OK;
+    }
+
+    HRESULT ParseBaseline(const std::string& text, std::vector<BaselineRecord>& records, std::string& error)
+    {
+        records.clear();
+        error.clear();
+
+        size_t pos = 0;
+
+        //
+        // UTF-8 BOM
+        //
+        if (text.compare(0, 3, "\xEF\xBB\xBF") == 0)
+        {
+            pos = 3;
+        }
+
+        std::vector<int> columns;   // Column of each field, -1 for an unknown one
+        std::vector<std::string> fields;
+        uint32_t lineNumber = 0;
+
+        while (pos < text.size())
+        {
+            const size_t end = std::min(text.find('\n', pos), text.size());
+            const std::string line = text.substr(pos, end - pos);
+            pos = end + 1;
+            lineNumber += 1;
+
+            if (line.empty() || line == "\r")
+            {
+                continue;
+            }
+
+            if (!SplitCsv(line, fields))
+            {
+                error = "line " + std::to_string(lineNumber) + ": unterminated quote";
+                return E_INVALIDARG;
+            }
+
+            if (columns.empty())
+            {
+                bool key[static_cast<size_t>(Column::Count)] = {};
+
+                for (const auto& name : fields)
+                {
+                    const auto found = std::find_if(std::begin(ColumnNames), std::end(ColumnNames), [&](const char* column)
+                    {
+                        return name == column;
+                    });
+
+                    const int column = found == std::end(ColumnNames) ? -1 : static_cast<int>(found - std::begin(ColumnNames));
+                    columns.push_back(column);
+
+                    if (column >= 0)
+                    {
+                        key[column] = true;
+                    }
+                }
+
+                for (Column column : { Column::SymbolicLink, Column::Subtype, Column::Width, Column::Height,
+                    Column::FpsNumerator, Column::FpsDenominator })
+                {
+                    if (!key[static_cast<size_t>(column)])
+                    {
+                        error = "line " + std::to_string(lineNumber) + ": no "
+                            + ColumnNames[static_cast<size_t>(column)] + " column";
+                        return E_INVALIDARG;
+                    }
+                }
+
+                continue;
+            }
+
+            if (fields.size() != columns.size())
+            {
+                error = "line " + std::to_string(lineNumber) + ": " + std::to_string(fields.size())
+                    + " fields of " + std::to_string(columns.size());
+                return E_INVALIDARG;
+            }
+
+            BaselineRecord record;
+
+            for (size_t i = 0; i < fields.size(); ++i)
+            {
+                if (columns[i] >= 0 && !SetField(static_cast<Column>(columns[i]), fields[i], record))
+                {
+                    error = "line " + std::to_string(lineNumber) + ": bad "
+                        + ColumnNames[columns[i]] + " '" + fields[i] + "'";
+                    return E_INVALIDARG;
+                }
+            }
+
+            records.push_back(std::move(record));
+        }
+
+        if (columns.empty())
+        {
+            error = "no header";
+            return E_INVALIDARG;
+        }
+
+        return S_OK;
+    }
+
+    HRESULT LoadBaseline(const std::wstring& path, std::vector<BaselineRecord>& records, std::string& error)
+    {
+        video::MappedFile file;
+
+        if (FAILED(file.Open(path)))
+        {
+            error = "cannot open the baseline file";
+            return E_FAIL;
+        }
+
+        std::string text;
+
+        if (file.Size())
+        {
+            text.assign(reinterpret_cast<const char*>(file.Data()), static_cast<size_t>(file.Size()));
+        }
+
+        return ParseBaseline(text, records, error);
+    }
+
+    std::vector<BaselineComparison> CompareBaseline(
+        const std::vector<BaselineRecord>& baseline,
+        const std::vector<BaselineRecord>& current,
+        const CompareSettings& settings)
+    {
+        //
+        // The first record of a key wins on both sides
+        //
+        std::unordered_map<std::wstring, size_t> currentByKey;
+
+        for (size_t i = 0; i < current.size(); ++i)
+        {
+            currentByKey.emplace(current[i].Key(), i);
+        }
+
+        std::vector<BaselineComparison> comparisons;
+        std::vector<bool> matched(current.size(), false);
+        std::unordered_map<std::wstring, bool> seen;
+
+        for (const auto& record : baseline)
+        {
+            const std::wstring key = record.Key();
+
+            if (!seen.emplace(key, true).second)
+            {
+                continue;
+            }
+
+            BaselineComparison comparison;
+            comparison.baseline = record;
+            comparison.hasBaseline = true;
+
+            const auto found = currentByKey.find(key);
+
+            if (found == currentByKey.end())
+            {
+                comparison.missing = HasFrames(record);
+            }
+            else
+            {
+                comparison.current = current[found->second];
+                comparison.hasCurrent = true;
+                matched[found->second] = true;
+                Compare(comparison, settings);
+            }
+
+            comparisons.push_back(std::move(comparison));
+        }
+
+        for (size_t i = 0; i < current.size(); ++i)
+        {
+            if (matched[i] || currentByKey.at(current[i].Key()) != i)
+            {
+                continue;
+            }
+
+            BaselineComparison comparison;
+            comparison.current = current[i];
+            comparison.hasCurrent = true;
+            comparisons.push_back(std::move(comparison));
+        }
+
+        return comparisons;
+    }
+
+    size_t CountRegressions(const std::vector<BaselineComparison>& comparisons) noexcept
+    {
+        return std::count_if(comparisons.begin(), comparisons.end(), [](const BaselineComparison& comparison)
+        {
+            return comparison.Regressed();
+        });
+    }
+
+    void PrintComparison(const std::vector<BaselineComparison>& comparisons, std::wostream& st)
+    {
+        st << std::left
+            << std::setw(26) << L"Device"
+            << std::setw(8) << L"Format"
+            << std::setw(12) << L"Size"
+            << std::setw(9) << L"FPS"
+            << std::setw(28) << L"Got FPS"
+            << std::setw(28) << L"Jitter us"
+            << std::setw(16) << L"Missing"
+            << std::setw(26) << L"1st ms"
+            << L"Result\n";
+
+        for (const auto& comparison : comparisons)
+        {
+            const auto& record = comparison.hasBaseline ? comparison.baseline : comparison.current;
+            const auto& base = comparison.baseline;
+            const auto& cur = comparison.current;
+
+            std::wstring device = record.device;
+
+            if (device.size() > 25)
+            {
+                device.resize(25);
+            }
+
+            std::wostringstream fps;
+            fps << std::fixed << std::setprecision(2)
+                << (record.fpsDenominator ? static_cast<double>(record.fpsNumerator) / record.fpsDenominator : 0);
+
+            st << std::setw(26) << device
+                << std::setw(8) << record.subtype
+                << std::setw(12) << (std::to_wstring(record.width) + L"x" + std::to_wstring(record.height))
+                << std::setw(9) << fps.str();
+
+            if (comparison.hasBaseline && comparison.hasCurrent)
+            {
+                st << std::setw(28) << FormatChange(base.fps, cur.fps, 2)
+                    << std::setw(28) << FormatChange(base.jitterUs, cur.jitterUs, 0)
+                    << std::setw(16) << (std::to_wstring(base.dropped) + L" -> " + std::to_wstring(cur.dropped))
+                    << std::setw(26) << FormatChange(base.firstFrameMs, cur.firstFrameMs, 1);
+            }
+            else
+            {
+                st << std::setw(98) << L"-";
+            }
+
+            PrintRegressions(comparison, st);
+            st << L"\n";
+        }
+
+        st << std::right;
+    }
+}
@@ -0,0 +1,125 @@
+#pragma once
+
+#include <ostream>
+#include <string>
+#include <vector>
+#include "BenchRunner.h"
+
+namespace capture
+{
+    //
+    // The measurements of one media type of a sweep, a baseline file
+    // is one BaselineRecord per line of UTF-8 CSV after a header line
+    //
+    struct BaselineRecord
+    {
+        std::wstring symbolicLink;
+        std::wstring device;            // the friendly name
+        uint32_t stream = 0;
+        uint32_t mediaType = 0;
+        std::wstring subtype;
+        uint32_t width = 0;
+        uint32_t height = 0;
+        uint32_t fpsNumerator = 0;
+        uint32_t fpsDenominator = 0;
+        HRESULT hr = S_OK;
+        uint64_t frames = 0;
+        double seconds = 0;
+        bool converged = false;
+        uint32_t batches = 0;
+        double fps = 0;                 // the mean of the dwell batches
+        double fpsHalfWidth = 0;        // of its 95% confidence interval
+        double jitterUs = 0;            // the mean of the dwell batches
+        double jitterHalfWidthUs = 0;
+        uint64_t jitterP50 = 0;         // us
+        uint64_t jitterP99 = 0;
+        uint64_t jitterP999 = 0;
+        uint64_t dropped = 0;           // frames missing from the timestamps
+        double firstFrameMs = -1;       // negative without a frame
+        double cpuPerFrameMs = 0;
+
+        //
+        // Matches the same mode across runs whatever its stream and media type IDs:
+        // symbolic link, subtype, size and frame rate
+        //
+        std::wstring Key() const;
+    };
+
+    BaselineRecord MakeBaselineRecord(
+        const std::wstring& symbolicLink,
+        const std::wstring& device,
+        uint32_t stream,
+        const MediaTypeInfo& mediaType,
+        HRESULT hr,
+        const BenchResult& result);
+
+    //
+    // The CSV columns, in the order FormatBaselineRecord writes them
+    //
+    std::string BaselineHeader();
+    void FormatBaselineRecord(const BaselineRecord& record, std::string& line);
+
+    HRESULT WriteBaseline(const std::wstring& path, const std::vector<BaselineRecord>& records);
+
+    //
+    // Columns are found by the header, unknown ones are skipped.
+    // E_INVALIDARG with "line N: ..." in error for a malformed file
+    //
+    HRESULT ParseBaseline(const std::string& text, std::vector<BaselineRecord>& records, std::string& error);
+    HRESULT LoadBaseline(const std::wstring& path, std::vector<BaselineRecord>& records, std::string& error);
+
+    //
+    // A regression is flagged when the change is both larger than the
+    // tolerance and, for the fps, jitter and drops, larger than the
+    // measurement noise at 95% confidence. The first frame latency and
+    // the CPU time are single measurements, they are held to the tolerance only
+    //
+    struct CompareSettings
+    {
+        double fpsTolerance = 0.02;         // relative fps loss
+        double jitterTolerance = 0.25;      // relative mean jitter growth
+        double jitterFloorUs = 100;
+        double dropTolerance = 0.001;       // growth of the missing frames share
+        double firstFrameTolerance = 0.5;
+        double firstFrameFloorMs = 50;
+        double cpuTolerance = 0.25;
+        double cpuFloorMs = 0.05;
+    };
+
+    struct BaselineComparison
+    {
+        BaselineRecord baseline;        // empty for a new mode
+        BaselineRecord current;         // empty for a missing mode
+        bool hasBaseline = false;
+        bool hasCurrent = false;
+
+        //
+        // Regressions
+        //
+        bool missing = false;           // in the baseline, not in the run
+        bool failed = false;            // failed or no frames, the baseline had frames
+        bool fps = false;
+        bool jitter = false;
+        bool drops = false;
+        bool firstFrame = false;
+        bool cpu = false;
+
+        bool Regressed() const noexcept
+        {
+            return missing || failed || fps || jitter || drops || firstFrame || cpu;
+        }
+    };
+
+    //
+    // One comparison per mode of the baseline in its order,
+    // then the new modes of the run in theirs
+    //
+    std::vector<BaselineComparison> CompareBaseline(
+        const std::vector<BaselineRecord>& baseline,
+        const std::vector<BaselineRecord>& current,
+        const CompareSettings& settings = CompareSettings());
+
+    size_t CountRegressions(const std::vector<BaselineComparison>& comparisons) noexcept;
+
+    void PrintComparison(const std::vector<BaselineComparison>& comparisons, std::wostream& st);
+}
@@ -0,0 +1,54 @@
+#include "SyntheticSource.h"
+
+namespace video
+{
+    SyntheticSource::SyntheticSource(
+        PixelFormat format,
+        uint32_t width,
+        uint32_t height,
+        uint32_t fpsNumerator,
+        uint32_t fpsDenominator,
+        TestPattern pattern,
+        ColorSpace colorSpace)
+        : m_format(FramePool::AlignedFormat(format, width, height))
+        , m_pattern(pattern)
+        , m_colorSpace(colorSpace)
+        , m_frameDuration(0)
+        , m_frameIndex(0)
+    {
+        if (fpsNumerator && fpsDenominator)
+        {
+            m_frameDuration = static_cast<int64_t>(10000000ull * fpsDenominator / fpsNumerator);
+        }
+
+        m_buffer.resize(m_format.BufferSize());
+    }
+
+    bool SyntheticSource::IsValid() const noexcept
+    {
+        return !m_buffer.empty() && m_frameDuration > 0;
+    }
+
+    FrameView SyntheticSource::Next(int64_t& timestamp) noexcept
+    {
+        timestamp = static_cast<int64_t>(m_frameIndex) * m_frameDuration;
+
+        if (!IsValid())
+        {
+            return FrameView();
+        }
+
+        const FrameView view = MakeFrameView(m_format.format, m_format.width, m_format.height, m_buffer.data(), m_format.stride);
+
+        //
+        // The bars do not move, they are drawn once
+        //
+        if (m_pattern != TestPattern::ColorBars || 0 == m_frameIndex)
+        {
+            RenderPattern(m_pattern, view, m_frameIndex, m_colorSpace);
+        }
+
+        m_frameIndex += 1;
+        return view;
+    }
+}
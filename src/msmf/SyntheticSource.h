@@ -0,0 +1,45 @@
+#pragma once
+
+#include <vector>
+#include "FramePool.h"
+#include "TestPattern.h"
+
+namespace video
+{
+    //
+    // Generates frames of a test pattern at a nominal frame rate,
+    // stands in for a capture device where Media Foundation is not available
+    //
+    class SyntheticSource
+    {
+    public:
+        SyntheticSource(
+            PixelFormat format,
+            uint32_t width,
+            uint32_t height,
+            uint32_t fpsNumerator,
+            uint32_t fpsDenominator,
+            TestPattern pattern = TestPattern::Gradient,
+            ColorSpace colorSpace = ColorSpace());
+
+        bool IsValid() const noexcept;
+
+        //
+        // Renders the next frame, the view is valid until the next call.
+        // Timestamps are 100 ns units as in Media Foundation
+        //
+        FrameView Next(int64_t& timestamp) noexcept;
+
+        const FrameFormat& Format() const noexcept { return m_format; }
+        uint64_t GetFrameIndex() const noexcept { return m_frameIndex; }
+        int64_t GetFrameDuration() const noexcept { return m_frameDuration; }
+
+    private:
+        FrameFormat m_format;
+        std::vector<uint8_t> m_buffer;
+        TestPattern m_pattern;
+        ColorSpace m_colorSpace;
+        int64_t m_frameDuration;
+        uint64_t m_frameIndex;
+    };
+}
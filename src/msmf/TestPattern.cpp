@@ -0,0 +1,484 @@
+#include "TestPattern.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include "PixelConvert.h"
+
+namespace
+{
+    using namespace video;
+
+    //
+    // Bytes of the ramp copied or compared at once, a ramp row repeats every 256 bytes
+    //
+    constexpr size_t RampChunk = 256;
+
+    constexpr uint8_t CounterOne = 235;
+    constexpr uint8_t CounterZero = 16;
+    constexpr uint8_t Grey = 128;
+
+    //
+    // A decoded pattern may be off by this many codes, e.g. after MJPG
+    //
+    constexpr int BarTolerance = 24;
+    constexpr uint32_t BarCount = 8;
+    constexpr int BarLevel = 191;
+
+    struct Tables
+    {
+        uint8_t ramp[2 * RampChunk];
+        uint8_t grey[RampChunk];
+
+        Tables() noexcept
+        {
+            for (size_t i = 0; i < sizeof(ramp); ++i)
+            {
+                ramp[i] = static_cast<uint8_t>(i);
+            }
+
+            memset(grey, Grey, sizeof(grey));
+        }
+    };
+
+    const Tables& GetTables() noexcept
+    {
+        static const Tables tables;
+        return tables;
+    }
+
+    bool IsYuv(PixelFormat format) noexcept
+    {
+        return format != PixelFormat::RGB24 && format != PixelFormat::RGB32;
+    }
+
+    //
+    // { Y, U, V } or { B, G, R } of the bar as stored in the format
+    //
+    void BarColor(uint32_t bar, PixelFormat format, const YuvCoefficients& c, int color[3]) noexcept
+    {
+        //
+        // White, yellow, cyan, green, magenta, red, blue, black
+        //
+        static const uint8_t Rgb[BarCount] = { 7, 6, 3, 2, 5, 4, 1, 0 };
+
+        const int r = (Rgb[bar] & 4) ? BarLevel : 0;
+        const int g = (Rgb[bar] & 2) ? BarLevel : 0;
+        const int b = (Rgb[bar] & 1) ? BarLevel : 0;
+
+        if (!IsYuv(format))
+        {
+            color[0] = b;
+            color[1] = g;
+            color[2] = r;
+            return;
+        }
+
+        color[0] = ((c.toY[0] * r + c.toY[1] * g + c.toY[2] * b + 128) >> 8) + c.yOffset;
+        color[1] = ((c.toU[0] * r + c.toU[1] * g + c.toU[2] * b + 128) >> 8) + 128;
+        color[2] = ((c.toV[0] * r + c.toV[1] * g + c.toV[2] * b + 128) >> 8) + 128;
+    }
+
+    //
+    // Addresses of the three components of a pixel: { Y, U, V } or { B, G, R }
+    //
+    void PixelAddress(const FrameView& frame, uint32_t x, uint32_t y, const uint8_t* p[3]) noexcept
+    {
+        const uint8_t* row = frame.planes[0].data + frame.planes[0].stride * static_cast<ptrdiff_t>(y);
+
+        switch (frame.format)
+        {
+        case PixelFormat::NV12:
+        {
+            const uint8_t* uv = frame.planes[1].data + frame.planes[1].stride * static_cast<ptrdiff_t>(y / 2) + (x & ~1u);
+            p[0] = row + x;
+            p[1] = uv;
+            p[2] = uv + 1;
+            break;
+        }
+        case PixelFormat::I420:
+        case PixelFormat::YV12:
+        {
+            //
+            // YV12 stores the V plane first
+            //
+            const size_t u = frame.format == PixelFormat::I420 ? 1 : 2;
+            const size_t v = 3 - u;
+            p[0] = row + x;
+            p[1] = frame.planes[u].data + frame.planes[u].stride * static_cast<ptrdiff_t>(y / 2) + x / 2;
+            p[2] = frame.planes[v].data + frame.planes[v].stride * static_cast<ptrdiff_t>(y / 2) + x / 2;
+            break;
+        }
+        case PixelFormat::YUY2:
+        {
+            const uint8_t* pair = row + (x & ~1u) * 2;
+            p[0] = pair + (x & 1) * 2;
+            p[1] = pair + 1;
+            p[2] = pair + 3;
+            break;
+        }
+        case PixelFormat::UYVY:
+        {
+            const uint8_t* pair = row + (x & ~1u) * 2;
+            p[0] = pair + 1 + (x & 1) * 2;
+            p[1] = pair;
+            p[2] = pair + 2;
+            break;
+        }
+        default:
+        {
+            const uint8_t* pixel = row + x * BytesPerPixel(frame.format);
+            p[0] = pixel;
+            p[1] = pixel + 1;
+            p[2] = pixel + 2;
+            break;
+        }
+        }
+    }
+
+    void RenderGradient(const FrameView& frame, uint64_t frameIndex) noexcept
+    {
+        const Tables& tables = GetTables();
+        const size_t phase = static_cast<size_t>(frameIndex * GradientStep);
+
+        for (size_t plane = 0; plane < frame.planeCount; ++plane)
+        {
+            const size_t rowBytes = frame.RowBytes(plane);
+            const size_t rows = frame.Rows(plane);
+            auto row = const_cast<uint8_t*>(frame.planes[plane].data);
+
+            for (size_t y = 0; y < rows; ++y)
+            {
+                if (plane == 0)
+                {
+                    const uint8_t* ramp = &tables.ramp[(y + phase) & 255];
+
+                    for (size_t x = 0; x < rowBytes; x += RampChunk)
+                    {
+                        memcpy(row + x, ramp, std::min(RampChunk, rowBytes - x));
+                    }
+                }
+                else
+                {
+                    memset(row, Grey, rowBytes);
+                }
+
+                row += frame.planes[plane].stride;
+            }
+        }
+    }
+
+    void RenderCounter(const FrameView& frame, uint64_t frameIndex) noexcept
+    {
+        if (frame.RowBytes(0) < CounterBits * CounterCellBytes)
+        {
+            return;
+        }
+
+        auto cell = const_cast<uint8_t*>(frame.planes[0].data);
+
+        for (size_t bit = 0; bit < CounterBits; ++bit)
+        {
+            const bool one = 0 != ((frameIndex >> (CounterBits - 1 - bit)) & 1);
+            memset(cell, one ? CounterOne : CounterZero, CounterCellBytes);
+            cell += CounterCellBytes;
+        }
+    }
+
+    void RenderColorBars(const FrameView& frame, ColorSpace colorSpace) noexcept
+    {
+        const YuvCoefficients c = GetYuvCoefficients(colorSpace);
+
+        for (uint32_t bar = 0; bar < BarCount; ++bar)
+        {
+            int color[3];
+            BarColor(bar, frame.format, c, color);
+
+            const uint32_t x0 = bar * frame.width / BarCount;
+            const uint32_t x1 = (bar + 1) * frame.width / BarCount;
+
+            for (uint32_t y = 0; y < frame.height; ++y)
+            {
+                for (uint32_t x = x0; x < x1; ++x)
+                {
+                    const uint8_t* p[3];
+                    PixelAddress(frame, x, y, p);
+
+                    for (size_t i = 0; i < 3; ++i)
+                    {
+                        *const_cast<uint8_t*>(p[i]) = static_cast<uint8_t>(color[i]);
+                    }
+                }
+            }
+        }
+    }
+}
+
+namespace video
+{
+    const char* TestPatternName(TestPattern pattern) noexcept
+    {
+        switch (pattern)
+        {
+        case TestPattern::None: return "none";
+        case TestPattern::Gradient: return "gradient";
+        case TestPattern::ColorBars: return "bars";
+        case TestPattern::Counter: return "counter";
+        default: return "unknown";
+        }
+    }
+
+    void RenderPattern(TestPattern pattern, const FrameView& frame, uint64_t frameIndex, ColorSpace colorSpace) noexcept
+    {
+        if (!frame.IsValid())
+        {
+            return;
+        }
+
+        switch (pattern)
+        {
+        case TestPattern::Gradient:
+            RenderGradient(frame, frameIndex);
+            break;
+        case TestPattern::ColorBars:
+            RenderColorBars(frame, colorSpace);
+            break;
+        case TestPattern::Counter:
+            RenderGradient(frame, frameIndex);
+            RenderCounter(frame, frameIndex);
+            break;
+        default:
+            break;
+        }
+    }
+
+    PatternChecker::PatternChecker(TestPattern pattern, ColorSpace colorSpace) noexcept
+        : m_pattern(pattern)
+        , m_colorSpace(colorSpace)
+        , m_lastPosition(0)
+        , m_hasLast(false)
+    {
+    }
+
+    void PatternChecker::Reset() noexcept
+    {
+        m_lastPosition = 0;
+        m_hasLast = false;
+    }
+
+    PatternChecker::Result PatternChecker::Check(const FrameView& frame, uint32_t& row, uint64_t& skipped) noexcept
+    {
+        row = 0;
+        skipped = 0;
+
+        if (m_pattern == TestPattern::None)
+        {
+            return Result::Match;
+        }
+
+        if (!frame.IsValid())
+        {
+            return Result::Mismatch;
+        }
+
+        uint32_t phase = 0;
+
+        switch (m_pattern)
+        {
+        case TestPattern::Gradient:
+            if (!CheckGradient(frame, 0, row, phase) || 0 != phase % GradientStep)
+            {
+                return Result::Mismatch;
+            }
+
+            //
+            // The ramp repeats every 256 / GradientStep frames,
+            // longer gaps are seen modulo that
+            //
+            return Advance(phase / GradientStep, 256 / GradientStep, skipped);
+
+        case TestPattern::ColorBars:
+            return CheckColorBars(frame, row) ? Result::Match : Result::Mismatch;
+
+        case TestPattern::Counter:
+        {
+            uint32_t counter = 0;
+
+            if (!ReadCounter(frame, counter) || !CheckGradient(frame, 1, row, phase))
+            {
+                return Result::Mismatch;
+            }
+
+            return Advance(counter, uint64_t(1) << CounterBits, skipped);
+        }
+
+        default:
+            return Result::Match;
+        }
+    }
+
+    const char* PatternChecker::ResultName(Result result) noexcept
+    {
+        switch (result)
+        {
+        case Result::Match: return "match";
+        case Result::Mismatch: return "mismatch";
+        case Result::Repeated: return "repeated";
+        case Result::Skipped: return "skipped";
+        default: return "unknown";
+        }
+    }
+
+    bool PatternChecker::CheckGradient(const FrameView& frame, uint32_t firstRow, uint32_t& row, uint32_t& phase) const noexcept
+    {
+        const Tables& tables = GetTables();
+
+        if (firstRow >= frame.height)
+        {
+            phase = 0;
+            return true;
+        }
+
+        //
+        // The first pixel tells the phase, every other byte must follow it
+        //
+        const uint8_t* first = frame.planes[0].data + frame.planes[0].stride * static_cast<ptrdiff_t>(firstRow);
+        phase = (first[0] - firstRow) & 255;
+
+        for (size_t plane = 0; plane < frame.planeCount; ++plane)
+        {
+            const size_t rowBytes = frame.RowBytes(plane);
+            const size_t rows = frame.Rows(plane);
+            const size_t begin = plane == 0 ? firstRow : 0;
+            const uint8_t* data = frame.planes[plane].data + frame.planes[plane].stride * static_cast<ptrdiff_t>(begin);
+
+            for (size_t y = begin; y < rows; ++y)
+            {
+                const uint8_t* expected = plane == 0 ? &tables.ramp[(y + phase) & 255] : tables.grey;
+
+                for (size_t x = 0; x < rowBytes; x += RampChunk)
+                {
+                    if (0 != memcmp(data + x, expected, std::min(RampChunk, rowBytes - x)))
+                    {
+                        //
+                        // Rows of the chroma planes are reported as luma rows
+                        //
+                        row = static_cast<uint32_t>(y * frame.height / rows);
+                        return false;
+                    }
+                }
+
+                data += frame.planes[plane].stride;
+            }
+        }
+
+        return true;
+    }
+
+    bool PatternChecker::CheckColorBars(const FrameView& frame, uint32_t& row) const noexcept
+    {
+        const YuvCoefficients c = GetYuvCoefficients(m_colorSpace);
+        int colors[BarCount][3];
+
+        for (uint32_t bar = 0; bar < BarCount; ++bar)
+        {
+            BarColor(bar, frame.format, c, colors[bar]);
+        }
+
+        //
+        // Three points inside every bar, away from the edges
+        // where subsampled chroma mixes the neighbours
+        //
+        for (uint32_t y = 0; y < frame.height; ++y)
+        {
+            for (uint32_t bar = 0; bar < BarCount; ++bar)
+            {
+                const uint32_t x0 = bar * frame.width / BarCount;
+                const uint32_t width = (bar + 1) * frame.width / BarCount - x0;
+
+                for (uint32_t point = 1; point <= 3; ++point)
+                {
+                    const uint8_t* p[3];
+                    PixelAddress(frame, x0 + width * point / 4, y, p);
+
+                    for (size_t i = 0; i < 3; ++i)
+                    {
+                        if (std::abs(*p[i] - colors[bar][i]) > BarTolerance)
+                        {
+                            row = y;
+                            return false;
+                        }
+                    }
+                }
+            }
+        }
+
+        return true;
+    }
+
+    bool PatternChecker::ReadCounter(const FrameView& frame, uint32_t& counter) const noexcept
+    {
+        if (frame.RowBytes(0) < CounterBits * CounterCellBytes)
+        {
+            return false;
+        }
+
+        //
+        // Every byte of a cell must be clearly one or zero,
+        // a torn or scaled frame blurs the cells
+        //
+        const uint8_t* cell = frame.planes[0].data;
+        counter = 0;
+
+        for (size_t bit = 0; bit < CounterBits; ++bit)
+        {
+            const bool one = cell[0] >= 128;
+
+            for (size_t i = 0; i < CounterCellBytes; ++i)
+            {
+                if (std::abs(cell[i] - (one ? CounterOne : CounterZero)) > BarTolerance)
+                {
+                    return false;
+                }
+            }
+
+            counter = (counter << 1) | (one ? 1 : 0);
+            cell += CounterCellBytes;
+        }
+
+        return true;
+    }
+
+    PatternChecker::Result PatternChecker::Advance(uint64_t position, uint64_t period, uint64_t& skipped) noexcept
+    {
+        const uint64_t last = m_lastPosition;
+        const bool hasLast = m_hasLast;
+
+        m_lastPosition = position;
+        m_hasLast = true;
+
+        if (!hasLast)
+        {
+            return Result::Match;
+        }
+
+        //
+        // Periods are powers of two. Going back by up to half a period
+        // is a frame out of order rather than a skip
+        //
+        const uint64_t delta = (position - last) & (period - 1);
+
+        if (0 == delta)
+        {
+            return Result::Repeated;
+        }
+
+        if (delta >= period / 2)
+        {
+            return Result::Mismatch;
+        }
+
+        skipped = delta - 1;
+        return skipped ? Result::Skipped : Result::Match;
+    }
+}
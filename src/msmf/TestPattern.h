@@ -0,0 +1,81 @@
+#pragma once
+
+#include "FrameView.h"
+
+namespace video
+{
+    //
+    // Deterministic frame content emitted by a driver under test
+    // or by the synthetic source, so the captured pixels can be checked
+    //
+    enum class TestPattern : uint32_t
+    {
+        None = 0,
+        Gradient,   // diagonal ramp of plane 0 moving GradientStep codes per frame, other planes 128
+        ColorBars,  // eight vertical 75% bars: white, yellow, cyan, green, magenta, red, blue, black
+        Counter,    // the gradient with the frame index in the first row of plane 0
+    };
+
+    const char* TestPatternName(TestPattern pattern) noexcept;
+
+    constexpr uint32_t GradientStep = 4;
+
+    //
+    // The counter is 32 cells of CounterCellBytes bytes at the start
+    // of the first row of plane 0, the most significant bit first,
+    // 235 for one and 16 for zero
+    //
+    constexpr size_t CounterBits = 32;
+    constexpr size_t CounterCellBytes = 8;
+
+    //
+    // Draws the pattern of the frameIndex-th frame over the planes of the view
+    //
+    void RenderPattern(
+        TestPattern pattern,
+        const FrameView& frame,
+        uint64_t frameIndex,
+        ColorSpace colorSpace = ColorSpace()) noexcept;
+
+    //
+    // Checks every frame of a stream against the pattern and the previous frame.
+    // Check does not allocate, a 4K frame costs about one memcmp of its luma
+    //
+    class PatternChecker
+    {
+    public:
+        enum class Result : uint32_t
+        {
+            Match = 0,
+            Mismatch,   // the pixels do not form the pattern: tearing, a wrong stride, corruption
+            Repeated,   // the pattern did not advance, a stale frame
+            Skipped,    // the pattern advanced by more than one frame
+        };
+
+        PatternChecker(TestPattern pattern, ColorSpace colorSpace = ColorSpace()) noexcept;
+
+        //
+        // row is the first row not matching the pattern,
+        // skipped the number of frames missing before this one
+        //
+        Result Check(const FrameView& frame, uint32_t& row, uint64_t& skipped) noexcept;
+
+        void Reset() noexcept;
+
+        TestPattern GetPattern() const noexcept { return m_pattern; }
+
+        static const char* ResultName(Result result) noexcept;
+
+    private:
+        bool CheckGradient(const FrameView& frame, uint32_t firstRow, uint32_t& row, uint32_t& phase) const noexcept;
+        bool CheckColorBars(const FrameView& frame, uint32_t& row) const noexcept;
+        bool ReadCounter(const FrameView& frame, uint32_t& counter) const noexcept;
+        Result Advance(uint64_t position, uint64_t period, uint64_t& skipped) noexcept;
+
+    private:
+        TestPattern m_pattern;
+        ColorSpace m_colorSpace;
+        uint64_t m_lastPosition;
+        bool m_hasLast;
+    };
+}
@@ -0,0 +1,130 @@
+#include "TextOverlay.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+    //
+    // 3x5 glyphs, one row per byte, bit 2 is the left column
+    //
+    struct Glyph
+    {
+        char ch;
+        uint8_t rows[5];
+    };
+
+    const Glyph Glyphs[] =
+    {
+        { '0', { 7, 5, 5, 5, 7 } },
+        { '1', { 2, 6, 2, 2, 7 } },
+        { '2', { 7, 1, 7, 4, 7 } },
+        { '3', { 7, 1, 7, 1, 7 } },
+        { '4', { 5, 5, 7, 1, 1 } },
+        { '5', { 7, 4, 7, 1, 7 } },
+        { '6', { 7, 4, 7, 5, 7 } },
+        { '7', { 7, 1, 1, 1, 1 } },
+        { '8', { 7, 5, 7, 5, 7 } },
+        { '9', { 7, 5, 7, 1, 7 } },
+        { '.', { 0, 0, 0, 0, 2 } },
+        { ' ', { 0, 0, 0, 0, 0 } },
+        { 'f', { 3, 4, 7, 4, 4 } },
+        { 'p', { 7, 5, 7, 4, 4 } },
+        { 's', { 3, 4, 2, 1, 6 } },
+    };
+
+    const Glyph* FindGlyph(char ch) noexcept
+    {
+        for (const auto& glyph : Glyphs)
+        {
+            if (glyph.ch == ch)
+            {
+                return &glyph;
+            }
+        }
+
+        return nullptr;
+    }
+}
+
+namespace video
+{
+    void FillRect(uint8_t* canvas, ptrdiff_t stride, const TileRect& rect, uint32_t color) noexcept
+    {
+        for (uint32_t y = 0; y < rect.height; ++y)
+        {
+            auto row = reinterpret_cast<uint32_t*>(canvas + (rect.y + y) * stride) + rect.x;
+            std::fill(row, row + rect.width, color);
+        }
+    }
+
+    TileRect Intersect(const TileRect& a, const TileRect& b) noexcept
+    {
+        const uint32_t left = std::max(a.x, b.x);
+        const uint32_t top = std::max(a.y, b.y);
+        const uint32_t right = std::min(a.x + a.width, b.x + b.width);
+        const uint32_t bottom = std::min(a.y + a.height, b.y + b.height);
+
+        TileRect rect;
+
+        if (right > left && bottom > top)
+        {
+            rect.x = left;
+            rect.y = top;
+            rect.width = right - left;
+            rect.height = bottom - top;
+        }
+
+        return rect;
+    }
+
+    void DrawLabel(
+        uint8_t* canvas,
+        ptrdiff_t stride,
+        const TileRect& clip,
+        uint32_t x,
+        uint32_t y,
+        const char* text,
+        uint32_t scale) noexcept
+    {
+        const uint32_t advance = 4 * scale;
+        const uint32_t length = static_cast<uint32_t>(strlen(text));
+
+        TileRect box;
+        box.x = x;
+        box.y = y;
+        box.width = length * advance + scale;
+        box.height = 7 * scale;
+
+        FillRect(canvas, stride, Intersect(box, clip), 0xFF000000);
+
+        for (uint32_t i = 0; i < length; ++i)
+        {
+            const Glyph* glyph = FindGlyph(text[i]);
+
+            if (!glyph)
+            {
+                continue;
+            }
+
+            for (uint32_t row = 0; row < 5; ++row)
+            {
+                for (uint32_t column = 0; column < 3; ++column)
+                {
+                    if (0 == (glyph->rows[row] & (4 >> column)))
+                    {
+                        continue;
+                    }
+
+                    TileRect dot;
+                    dot.x = x + scale + i * advance + column * scale;
+                    dot.y = y + scale + row * scale;
+                    dot.width = scale;
+                    dot.height = scale;
+
+                    FillRect(canvas, stride, Intersect(dot, clip), 0xFFFFFFFF);
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace video
+{
+    //
+    // Pixels of a canvas
+    //
+    struct TileRect
+    {
+        uint32_t x = 0;
+        uint32_t y = 0;
+        uint32_t width = 0;
+        uint32_t height = 0;
+    };
+
+    //
+    // Fills the rect of a B G R X canvas with one color
+    //
+    void FillRect(uint8_t* canvas, ptrdiff_t stride, const TileRect& rect, uint32_t color) noexcept;
+
+    TileRect Intersect(const TileRect& a, const TileRect& b) noexcept;
+
+    //
+    // Digits, '.', ' ' and the letters of "fps" on a black box, 3x5 glyphs scaled up
+    //
+    void DrawLabel(
+        uint8_t* canvas,
+        ptrdiff_t stride,
+        const TileRect& clip,
+        uint32_t x,
+        uint32_t y,
+        const char* text,
+        uint32_t scale) noexcept;
+}
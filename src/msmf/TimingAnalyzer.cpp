@@ -0,0 +1,113 @@
+#include "TimingAnalyzer.h"
+
+#include <chrono>
+#include <cstdlib>
+
+namespace video
+{
+    TimingAnalyzer::TimingAnalyzer() noexcept
+        : m_fpsNumerator(0)
+        , m_fpsDenominator(0)
+        , m_nominalInterval(0)
+    {
+        Reset();
+    }
+
+    void TimingAnalyzer::SetFrameRate(uint32_t numerator, uint32_t denominator) noexcept
+    {
+        m_fpsNumerator = numerator;
+        m_fpsDenominator = denominator;
+        m_nominalInterval = (numerator && denominator)
+            ? static_cast<int64_t>(10000000ull * denominator / numerator)
+            : 0;
+    }
+
+    void TimingAnalyzer::Reset() noexcept
+    {
+        m_intervals.Reset();
+        m_jitter.Reset();
+        m_firstTimestamp = 0;
+        m_lastTimestamp = 0;
+        m_lastArrival = 0;
+        m_frames = 0;
+        m_droppedFrames = 0;
+        m_gaps = 0;
+        m_nonMonotonic = 0;
+    }
+
+    void TimingAnalyzer::OnSample(int64_t timestamp, int64_t arrival) noexcept
+    {
+        if (0 == m_frames)
+        {
+            m_firstTimestamp = timestamp;
+            m_lastTimestamp = timestamp;
+            m_lastArrival = arrival;
+            m_frames = 1;
+            return;
+        }
+
+        m_frames += 1;
+
+        const int64_t interval = timestamp - m_lastTimestamp;
+        const int64_t arrivalInterval = arrival - m_lastArrival;
+        m_lastArrival = arrival;
+
+        if (interval <= 0)
+        {
+            //
+            // A repeated or reordered timestamp does not move the stream position
+            //
+            m_nonMonotonic += 1;
+            return;
+        }
+
+        m_lastTimestamp = timestamp;
+        m_intervals.Add(static_cast<uint64_t>(interval / 10));
+        m_jitter.Add(static_cast<uint64_t>(std::llabs(arrivalInterval / 1000 - interval / 10)));
+
+        if (m_nominalInterval > 0 && 2 * interval > 3 * m_nominalInterval)
+        {
+            //
+            // Rounded to the nearest whole number of frame intervals
+            //
+            const int64_t missing = (interval + m_nominalInterval / 2) / m_nominalInterval - 1;
+            m_droppedFrames += static_cast<uint64_t>(missing);
+            m_gaps += 1;
+        }
+    }
+
+    TimingAnalyzer::Report TimingAnalyzer::GetReport() const noexcept
+    {
+        Report report = {};
+        report.frames = m_frames;
+        report.droppedFrames = m_droppedFrames;
+        report.gaps = m_gaps;
+        report.nonMonotonic = m_nonMonotonic;
+
+        if (m_fpsDenominator)
+        {
+            report.nominalFps = static_cast<double>(m_fpsNumerator) / m_fpsDenominator;
+        }
+
+        if (m_frames > 1 && m_lastTimestamp > m_firstTimestamp)
+        {
+            report.measuredFps = (m_frames - 1 - m_nonMonotonic) * 1e7 / (m_lastTimestamp - m_firstTimestamp);
+        }
+
+        report.intervalP50 = m_intervals.Percentile(0.5);
+        report.intervalP99 = m_intervals.Percentile(0.99);
+        report.intervalP999 = m_intervals.Percentile(0.999);
+        report.intervalMax = m_intervals.Max();
+        report.jitterP50 = m_jitter.Percentile(0.5);
+        report.jitterP99 = m_jitter.Percentile(0.99);
+        report.jitterP999 = m_jitter.Percentile(0.999);
+        report.jitterMax = m_jitter.Max();
+        return report;
+    }
+
+    int64_t TimingAnalyzer::Now() noexcept
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include "LogHistogram.h"
+
+namespace video
+{
+    //
+    // Per-frame timing of a capture stream, fed by the sample timestamp
+    // and the host arrival time of every frame. Frames missing from the stream
+    // are inferred from timestamp gaps against the nominal frame rate.
+    // OnSample never allocates
+    //
+    class TimingAnalyzer
+    {
+    public:
+        struct Report
+        {
+            uint64_t frames;
+            uint64_t droppedFrames; // frames missing between the timestamps
+            uint64_t gaps;          // intervals longer than 1.5 nominal intervals
+            uint64_t nonMonotonic;  // timestamps that did not increase
+            double nominalFps;
+            double measuredFps;     // from the sample timestamps
+
+            //
+            // Microseconds
+            //
+            uint64_t intervalP50;
+            uint64_t intervalP99;
+            uint64_t intervalP999;
+            uint64_t intervalMax;
+            uint64_t jitterP50;
+            uint64_t jitterP99;
+            uint64_t jitterP999;
+            uint64_t jitterMax;
+        };
+
+        TimingAnalyzer() noexcept;
+
+        //
+        // MF_MT_FRAME_RATE, 0 disables drop detection
+        //
+        void SetFrameRate(uint32_t numerator, uint32_t denominator) noexcept;
+        void Reset() noexcept;
+
+        //
+        // timestamp is the sample time in 100 ns units,
+        // arrival is the host steady clock in nanoseconds
+        //
+        void OnSample(int64_t timestamp, int64_t arrival) noexcept;
+
+        Report GetReport() const noexcept;
+
+        //
+        // Inter-frame intervals of the sample timestamps, microseconds
+        //
+        const LogHistogram& GetIntervals() const noexcept { return m_intervals; }
+
+        //
+        // Difference between the arrival interval and the timestamp interval,
+        // how unevenly the frames reach the application, microseconds
+        //
+        const LogHistogram& GetJitter() const noexcept { return m_jitter; }
+
+        static int64_t Now() noexcept;
+
+    private:
+        LogHistogram m_intervals;
+        LogHistogram m_jitter;
+        uint32_t m_fpsNumerator;
+        uint32_t m_fpsDenominator;
+        int64_t m_nominalInterval; // 100 ns
+        int64_t m_firstTimestamp;
+        int64_t m_lastTimestamp;
+        int64_t m_lastArrival;
+        uint64_t m_frames;
+        uint64_t m_droppedFrames;
+        uint64_t m_gaps;
+        uint64_t m_nonMonotonic;
+    };
+}
@@ -1,489 +1,1232 @@
-#include "stdafx.h"
-#include "msmf.h"
-#include "MediaSource.h"
-#include "MFAttributes.h"
-#include "CaptureWindow.h"
-
-namespace console
-{
-    HRESULT DeviceList(bool verbose)
-    {
-        mf::MediaVideoSource sources;
-        mf::MFActivateList devs;
-        HRCHK(sources.EnumDevice(devs));
-
-        size_t deviceNumber = 0;
-
-        for (auto& dev : devs)
-        {
-            mf::MFAttributes attr(dev);
-
-            std::wcout << "Device #" << deviceNumber++;
-            std::wcout << "\n  Friendly name: " << attr.GetString(MF_DEVSOURCE_ATTRIBUTE_FRIENDLY_NAME);
-            std::wcout << "\n  Sym link: " << attr.GetString(MF_DEVSOURCE_ATTRIBUTE_SOURCE_TYPE_VIDCAP_SYMBOLIC_LINK);
-            std::wcout << "\n  Buffered frames: " << std::dec << attr.GetUint32(MF_DEVSOURCE_ATTRIBUTE_SOURCE_TYPE_VIDCAP_MAX_BUFFERS);
-            std::wcout << "\n  Video category: " << attr.GetGuidName(MF_DEVSOURCE_ATTRIBUTE_SOURCE_TYPE_VIDCAP_CATEGORY);
-
-            if (0 == attr.GetUint32(MF_DEVSOURCE_ATTRIBUTE_SOURCE_TYPE_VIDCAP_HW_SOURCE))
-            {
-                std::wcout << "\n  Software device";
-            }
-            else
-            {
-                std::wcout << "\n  Hardware device";
-            }
-
-            std::vector<UINT8> data;
-            HRESULT hr = attr.GetBlob(MF_DEVSOURCE_ATTRIBUTE_MEDIA_TYPE, data);
-
-            if (SUCCEEDED(hr) && !data.empty())
-            {
-                auto typeInfo = reinterpret_cast<MFT_REGISTER_TYPE_INFO*>(data.data());
-                size_t count = data.size() / sizeof(*typeInfo);
-                assert(0 == (data.size() % sizeof(*typeInfo)));
-
-                for (size_t i = 0; i < count; ++i)
-                {
-                    std::wcout << "\n  Media major type: " << attr.GuidToName(typeInfo[i].guidMajorType);
-                    std::wcout << "\n  Media subtype:    " << attr.GuidToName(typeInfo[i].guidSubtype);
-                }
-            }
-
-            std::wcout << "\n";
-
-            if (verbose)
-            {
-                DeviceMediaTypeList(dev, false);
-                std::wcout << "\n\n";
-            }
-        }
-
-        return S_OK;
-    }
-
-    HRESULT DeviceMediaTypeList(ComPtr<IMFActivate>& pActivate, bool verbose)
-    {
-        ComPtr<IMFMediaSource> pSource;
-        HRCHK(pActivate->ActivateObject(
-            __uuidof(IMFMediaSource),
-            reinterpret_cast<void**>(pSource.GetAddressOf())));
-
-        ComPtr<IMFSourceReader> pVideoFileSource;
-        HRCHK(MFCreateSourceReaderFromMediaSource(
-            pSource.Get(), 
-            NULL, 
-            pVideoFileSource.GetAddressOf()));
-
-        HRCHK(pVideoFileSource->SetStreamSelection(
-            static_cast<DWORD>(MF_SOURCE_READER_ALL_STREAMS), 
-            TRUE));
-
-        DWORD dwMediaTypeTest = 0;
-        DWORD dwStreamTest = 0;
-        HRESULT hr = S_OK;
-
-        while (SUCCEEDED(hr))
-        {
-            ComPtr<IMFMediaType> pType;
-            hr = pVideoFileSource->GetNativeMediaType(
-                dwStreamTest, 
-                dwMediaTypeTest, 
-                pType.GetAddressOf());
-
-            if (hr == MF_E_NO_MORE_TYPES)
-            {
-                hr = S_OK;
-                dwMediaTypeTest = 0;
-                ++dwStreamTest;
-                continue;
-            }
-
-            if (hr == MF_E_INVALIDSTREAMNUMBER)
-            {
-                break;
-            }
-
-            if (SUCCEEDED(hr))
-            {
-                if (verbose)
-                {
-                    std::wcout << "\n\n Stream ID : " << std::dec << dwStreamTest;
-                    std::wcout << "\n Media type ID : " << std::dec << dwMediaTypeTest;
-                }
-                else
-                {
-                    std::wcout << "\n  [" << std::dec << dwStreamTest << ", " << dwMediaTypeTest << "]:";
-                }
-
-                if (SUCCEEDED(pType->LockStore()))
-                {
-                    if (verbose)
-                    {
-                        PrintMediaType(pType.Get());
-                    }
-                    else
-                    {
-                        PrintBaseVideoMediaType(pType.Get(), std::wcout);
-                    }
-                    pType->UnlockStore();
-                }
-            }
-
-            ++dwMediaTypeTest;
-        }
-
-        return S_OK;
-    }
-
-    HRESULT PrintBaseVideoMediaType(IMFMediaType * pMediaType, std::wostream& st)
-    {
-        UINT32 count = 0;
-        HRCHK(pMediaType->GetCount(&count));
-
-        GUID guid = { 0 };
-
-        for (UINT32 i = 0; i < count; ++i)
-        {
-            PROPVARIANT var;
-            PropVariantInit(&var);
-
-            if (FAILED(pMediaType->GetItemByIndex(i, &guid, &var)))
-            {
-                continue;
-            }
-
-            if (guid == MF_MT_FRAME_RATE && var.vt == VT_UI8)
-            {
-                ULONG numerator = HI32(var.uhVal.QuadPart);
-                ULONG denominator = LO32(var.uhVal.QuadPart);
-                double val = 0;
-
-                if (0 != denominator)
-                {
-                    val = static_cast<double>(numerator) / static_cast<double>(denominator);
-                }
-
-                st << " " << val << "@FPS";
-            }
-            // else if (guid == MF_MT_MAJOR_TYPE && var.vt == VT_CLSID)
-            // {
-            //     st << " " << mf::MFAttributes::GuidToName(*var.puuid);
-            // }
-            else if (guid == MF_MT_SUBTYPE && var.vt == VT_CLSID)
-            {
-                st << " " << mf::MFAttributes::GuidToName(*var.puuid);
-            }
-            else if (guid == MF_MT_FRAME_SIZE && var.vt == VT_UI8)
-            {
-                ULONG width = HI32(var.uhVal.QuadPart);
-                ULONG height = LO32(var.uhVal.QuadPart);
-                st << " " << std::dec << width << " x " << std::dec << height;
-            }
-
-            PropVariantClear(&var);
-        }
-
-        return S_OK;
-    }
-
-    HRESULT PrintMediaType(IMFMediaType * pMediaType)
-    {
-        UINT32 count = 0;
-        HRCHK(pMediaType->GetCount(&count));
-
-        GUID guid = { 0 };
-
-        for (UINT32 i = 0; i < count; ++i)
-        {
-            PROPVARIANT var;
-            PropVariantInit(&var);
-
-            if (FAILED(pMediaType->GetItemByIndex(i, &guid, &var)))
-            {
-                std::wcout << "\n\r " << "CANNOT GET GUID #" << std::dec << i;
-                continue;
-            }
-
-            if (guid == MF_MT_FRAME_RATE && var.vt == VT_UI8)
-            {
-                ULONG numerator = HI32(var.uhVal.QuadPart);
-                ULONG denominator = LO32(var.uhVal.QuadPart);
-                double val = 0;
-                
-                if (0 != denominator)
-                {
-                    val = static_cast<double>(numerator) / static_cast<double>(denominator);
-                }
-
-                std::wcout << "\n\r FRAME_RATE : " << val;
-            }
-            else if (guid == MF_MT_MAJOR_TYPE && var.vt == VT_CLSID)
-            {
-                std::wcout << "\n\r MAJOR_TYPE : " << mf::MFAttributes::GuidToName(*var.puuid);
-            }
-            else if (guid == MF_MT_SUBTYPE && var.vt == VT_CLSID)
-            {
-                std::wcout << "\n\r SUBTYPE : " << mf::MFAttributes::GuidToName(*var.puuid);
-            }
-            else if (guid == MF_MT_FRAME_SIZE && var.vt == VT_UI8)
-            {
-                ULONG width = HI32(var.uhVal.QuadPart);
-                ULONG height = LO32(var.uhVal.QuadPart);
-                std::wcout << "\n\r FRAME_SIZE : " << std::dec << width << " x " << std::dec << height;
-            }
-            else if (guid == MF_MT_AM_FORMAT_TYPE && var.vt == VT_CLSID)
-            {
-                std::wcout << "\n\r AM_FORMAT_TYPE : " << mf::MFAttributes::GuidToName(*var.puuid);
-            }
-            else if (guid == MF_MT_DEFAULT_STRIDE && var.vt == VT_UI4)
-            {
-                std::wcout << "\n\r DEFAULT_STRIDE : " << std::dec << var.ulVal;
-            }
-            else if (guid == MF_MT_FRAME_RATE_RANGE_MAX && var.vt == VT_UI8)
-            {
-                ULONG numerator = HI32(var.uhVal.QuadPart);
-                ULONG denominator = LO32(var.uhVal.QuadPart);
-
-                double val = 0;
-
-                if (0 != denominator)
-                {
-                    val = static_cast<double>(numerator) / static_cast<double>(denominator);
-                }
-
-                std::wcout << "\n\r FRAME_RATE_RANGE_MAX : " << std::dec << val;
-            }
-            else if (guid == MF_MT_FRAME_RATE_RANGE_MIN && var.vt == VT_UI8)
-            {
-                ULONG numerator = HI32(var.uhVal.QuadPart);
-                ULONG denominator = LO32(var.uhVal.QuadPart);
-
-                double val = 0;
-
-                if (0 != denominator)
-                {
-                    val = static_cast<double>(numerator) / static_cast<double>(denominator);
-                }
-
-                std::wcout << "\n\r FRAME_RATE_RANGE_MIN : " << val;
-            }
-            else if (guid == MF_MT_PIXEL_ASPECT_RATIO && var.vt == VT_UI8)
-            {
-                ULONG numerator = HI32(var.uhVal.QuadPart);
-                ULONG denominator = LO32(var.uhVal.QuadPart);
-
-                double val = 0;
-
-                if (0 != denominator)
-                {
-                    val = static_cast<double>(numerator) / static_cast<double>(denominator);
-                }
-
-                std::wcout << "\n\r PIXEL_ASPECT_RATIO : " << val;
-            }
-            else if (guid == MF_MT_YUV_MATRIX && var.vt == VT_UI4)
-            {
-                std::wcout << "\n\r YUV_MATRIX : " << std::dec << var.ulVal;
-            }
-            else if (guid == MF_MT_VIDEO_LIGHTING && var.vt == VT_UI4)
-            {
-                std::wcout << "\n\r VIDEO_LIGHTING : " << std::dec << var.ulVal;
-            }
-            else if (guid == MF_MT_VIDEO_CHROMA_SITING && var.vt == VT_UI4)
-            {
-                std::wcout << "\n\r VIDEO_CHROMA_SITING : " << std::dec << var.ulVal;
-            }
-            else if (guid == MF_MT_VIDEO_NOMINAL_RANGE && var.vt == VT_UI4)
-            {
-                std::wcout << "\n\r VIDEO_NOMINAL_RANGE : " << std::dec << var.ulVal;
-            }
-            else if (guid == MF_MT_ALL_SAMPLES_INDEPENDENT && var.vt == VT_UI4)
-            {
-                std::wcout << "\n\r ALL_SAMPLES_INDEPENDENT : " << std::dec << var.ulVal;
-            }
-            else if (guid == MF_MT_FIXED_SIZE_SAMPLES && var.vt == VT_UI4)
-            {
-                std::wcout << "\n\r FIXED_SIZE_SAMPLES : " << std::dec << var.ulVal;
-            }
-            else if (guid == MF_MT_SAMPLE_SIZE && var.vt == VT_UI4)
-            {
-                std::wcout << "\n\r SAMPLE_SIZE : " << std::dec << var.ulVal;
-            }
-            else if (guid == MF_MT_VIDEO_PRIMARIES && var.vt == VT_UI4)
-            {
-                std::wcout << "\n\r VIDEO_PRIMARIES : " << std::dec << var.ulVal;
-            }
-            else if (guid == MF_MT_INTERLACE_MODE && var.vt == VT_UI4)
-            {
-                std::wcout << "\n\r INTERLACE_MODE : " << std::dec << var.ulVal;
-            }
-            else if (guid == MF_MT_AVG_BITRATE && var.vt == VT_UI4)
-            {
-                std::wcout << "\n\r AVG_BITRATE : " << std::dec << var.ulVal;
-            }
-            else
-            {
-                std::wcout << "\n\r " << "UNKNOWN GUID : " << mf::MFAttributes::GuidToName(guid);
-            }
-
-            PropVariantClear(&var);
-        }
-
-        return S_OK;
-    }
-
-    HRESULT StartCapture(mf::CaptureWindow& window, ComPtr<IMFActivate>& pActivate, ULONG streamId, ULONG mediaId, bool inThread)
-    {
-        ComPtr<IMFMediaSource> pSource;
-        HRCHK(pActivate->ActivateObject(
-            __uuidof(IMFMediaSource),
-            reinterpret_cast<void**>(pSource.GetAddressOf())));
-
-        ComPtr<IMFAttributes> pAttributes;
-        HRCHK(MFCreateAttributes(&pAttributes, 10));
-        HRCHK(pAttributes->SetUINT32(MF_READWRITE_ENABLE_HARDWARE_TRANSFORMS, TRUE));
-        HRCHK(pAttributes->SetUINT32(MF_SOURCE_READER_DISABLE_DXVA, FALSE));
-        HRCHK(pAttributes->SetUINT32(MF_SOURCE_READER_ENABLE_VIDEO_PROCESSING, FALSE));
-        HRCHK(pAttributes->SetUINT32(MF_SOURCE_READER_ENABLE_ADVANCED_VIDEO_PROCESSING, TRUE));
-        HRCHK(pAttributes->SetUnknown(MF_SOURCE_READER_ASYNC_CALLBACK, &window));
-
-        ComPtr<IMFSourceReader> pVideoFileSource;
-        HRCHK(MFCreateSourceReaderFromMediaSource(
-            pSource.Get(),
-            pAttributes.Get(),
-            pVideoFileSource.GetAddressOf()));
-
-        HRCHK(pVideoFileSource->SetStreamSelection(static_cast<DWORD>(MF_SOURCE_READER_ALL_STREAMS), TRUE));
-
-        ComPtr<IMFMediaType> pType;
-        HRCHK(pVideoFileSource->GetNativeMediaType(
-            streamId,
-            mediaId,
-            pType.GetAddressOf()));
-
-        {
-            mf::MFAttributes attr(pActivate);
-            std::wstringstream title;
-
-            title << attr.GetString(MF_DEVSOURCE_ATTRIBUTE_FRIENDLY_NAME);
-            title << ":";
-            PrintBaseVideoMediaType(pType.Get(), title);
-
-            std::wcout << title.str() << "\n";
-            HRCHK(window.SetTitle(title.str()));
-        }
-
-        HRCHK(pType->SetGUID(MF_MT_SUBTYPE, MFVideoFormat_YUY2));
-        HRCHK(pVideoFileSource->SetStreamSelection(static_cast<DWORD>(MF_SOURCE_READER_ALL_STREAMS), FALSE));
-        HRCHK(pVideoFileSource->SetStreamSelection(streamId, TRUE));
-        HRCHK(pVideoFileSource->SetCurrentMediaType(streamId, NULL, pType.Get()));
-
-        HRCHK(window.Show(std::move(pVideoFileSource), std::move(pType), streamId, inThread));
-        return S_OK;
-    }
-
-    HRESULT DeviceCaptureOneByOne(ULONG timeoutSeconds)
-    {
-        //
-        // Enums all device, stream and media type,
-        // starts video capture for each avaliable config
-        // waits for timeout and continue enumeration
-        //
-
-        mf::MediaVideoSource sources;
-        mf::MFActivateList devs;
-        HRCHK(sources.EnumDevice(devs));
-
-        size_t deviceNumber = 0;
-
-        for (auto& dev : devs)
-        {
-            ComPtr<IMFAttributes> pAttributes = dev;
-            mf::MFAttributes attr(pAttributes);
-
-            std::wcout << "Device #" << deviceNumber++ << " " << attr.GetString(MF_DEVSOURCE_ATTRIBUTE_FRIENDLY_NAME) << "\n";
-
-            ComPtr<IMFMediaSource> pSource;
-            HRCHK(dev->ActivateObject(__uuidof(IMFMediaSource), reinterpret_cast<void**>(pSource.GetAddressOf())));
-
-            mf::CaptureWindow window;
-            ComPtr<IMFAttributes> pVideoAttributes;
-            HRCHK(MFCreateAttributes(&pVideoAttributes, 10));
-            HRCHK(pVideoAttributes->SetUINT32(MF_READWRITE_ENABLE_HARDWARE_TRANSFORMS, TRUE));
-            HRCHK(pVideoAttributes->SetUINT32(MF_SOURCE_READER_DISABLE_DXVA, FALSE));
-            HRCHK(pVideoAttributes->SetUINT32(MF_SOURCE_READER_ENABLE_VIDEO_PROCESSING, FALSE));
-            HRCHK(pVideoAttributes->SetUINT32(MF_SOURCE_READER_ENABLE_ADVANCED_VIDEO_PROCESSING, TRUE));
-            HRCHK(pVideoAttributes->SetUnknown(MF_SOURCE_READER_ASYNC_CALLBACK, &window));
-
-            ComPtr<IMFMediaType> pType;
-            ComPtr<IMFSourceReader> pVideoFileSource;
-            HRCHK(MFCreateSourceReaderFromMediaSource(pSource.Get(), pVideoAttributes.Get(), pVideoFileSource.ReleaseAndGetAddressOf()));
-
-            DWORD dwMediaTypeTest = 0;
-            DWORD dwStreamTest = 0;
-            HRESULT hr = S_OK;
-
-            while (SUCCEEDED(hr))
-            {
-                HRCHK(pVideoFileSource->SetStreamSelection(static_cast<DWORD>(MF_SOURCE_READER_ALL_STREAMS), TRUE));
-                hr = pVideoFileSource->GetNativeMediaType(dwStreamTest, dwMediaTypeTest, pType.ReleaseAndGetAddressOf());
-
-                if (hr == MF_E_NO_MORE_TYPES)
-                {
-                    hr = S_OK;
-                    dwMediaTypeTest = 0;
-                    ++dwStreamTest;
-                    continue;
-                }
-
-                if (hr == MF_E_INVALIDSTREAMNUMBER)
-                {
-                    break;
-                }
-
-                if (SUCCEEDED(hr))
-                {
-                    if (SUCCEEDED(pType->LockStore()))
-                    {
-                        //
-                        // Print basic media type info
-                        //
-                        PrintBaseVideoMediaType(pType.Get(), std::wcout);
-                        pType->UnlockStore();
-                    }
-
-                    //
-                    // Use YUY2 as output format,
-                    // because CreateOffscreenPlainSurface is failed for some formats
-                    //
-                    HRCHK(pType->SetGUID(MF_MT_SUBTYPE, MFVideoFormat_YUY2));
-
-                    //
-                    // Start the video capture
-                    //
-                    HRCHK(pVideoFileSource->SetStreamSelection(static_cast<DWORD>(MF_SOURCE_READER_ALL_STREAMS), FALSE));
-                    HRCHK(pVideoFileSource->SetStreamSelection(dwStreamTest, TRUE));
-                    HRCHK(pVideoFileSource->SetCurrentMediaType(dwStreamTest, NULL, pType.Get()));
-
-                    hr = window.Show(pVideoFileSource, std::move(pType), dwStreamTest, true);
-
-                    if (FAILED(hr))
-                    {
-                        std::wcout << "   <== error 0x" << hr;
-                        hr = S_OK;
-                    }
-                    else if (!window.WaitForExit(timeoutSeconds * 1000))
-                    {
-                        window.Close();
-                    }
-
-                    std::wcout << "\n";
-                }
-
-                ++dwMediaTypeTest;
-            }
-        }
-
-        return S_OK;
-    }
-}
+#include "stdafx.h"
+#include "msmf.h"
+#include "MediaSource.h"
+#include "MFAttributes.h"
+#include "CaptureWindow.h"
+#include "MFBackend.h"
+#include "BenchRunner.h"
+#include "ReplaySource.h"
+#include "SoakMonitor.h"
+#include <iomanip>
+#include <filesystem>
+#include <shlobj.h>
+
+#pragma comment(lib, "Shell32.lib")
+
+namespace
+{
+    using capture::ValueKind;
+
+    //
+    // Canvas of --mosaic, the window is not resizable
+    //
+    constexpr uint32_t MosaicWidth = 1280;
+    constexpr uint32_t MosaicHeight = 720;
+
+    struct AttributeDescriptor
+    {
+        const GUID& key;
+        capture::FieldDescriptor field;
+    };
+
+    //
+    // Media type attributes the formatter knows, the compact form
+    // is made of the ones with a suffix
+    //
+    const AttributeDescriptor MediaTypeAttributes[] =
+    {
+        { MF_MT_MAJOR_TYPE, { L"MAJOR_TYPE", ValueKind::Guid, nullptr } },
+        { MF_MT_SUBTYPE, { L"SUBTYPE", ValueKind::Guid, L"" } },
+        { MF_MT_FRAME_SIZE, { L"FRAME_SIZE", ValueKind::Size, L"" } },
+        { MF_MT_FRAME_RATE, { L"FRAME_RATE", ValueKind::Ratio, L"@FPS" } },
+        { MF_MT_AM_FORMAT_TYPE, { L"AM_FORMAT_TYPE", ValueKind::Guid, nullptr } },
+        { MF_MT_DEFAULT_STRIDE, { L"DEFAULT_STRIDE", ValueKind::Int, nullptr } },
+        { MF_MT_FRAME_RATE_RANGE_MAX, { L"FRAME_RATE_RANGE_MAX", ValueKind::Ratio, nullptr } },
+        { MF_MT_FRAME_RATE_RANGE_MIN, { L"FRAME_RATE_RANGE_MIN", ValueKind::Ratio, nullptr } },
+        { MF_MT_PIXEL_ASPECT_RATIO, { L"PIXEL_ASPECT_RATIO", ValueKind::Ratio, nullptr } },
+        { MF_MT_YUV_MATRIX, { L"YUV_MATRIX", ValueKind::Uint, nullptr } },
+        { MF_MT_VIDEO_LIGHTING, { L"VIDEO_LIGHTING", ValueKind::Uint, nullptr } },
+        { MF_MT_VIDEO_CHROMA_SITING, { L"VIDEO_CHROMA_SITING", ValueKind::Uint, nullptr } },
+        { MF_MT_VIDEO_NOMINAL_RANGE, { L"VIDEO_NOMINAL_RANGE", ValueKind::Uint, nullptr } },
+        { MF_MT_ALL_SAMPLES_INDEPENDENT, { L"ALL_SAMPLES_INDEPENDENT", ValueKind::Uint, nullptr } },
+        { MF_MT_FIXED_SIZE_SAMPLES, { L"FIXED_SIZE_SAMPLES", ValueKind::Uint, nullptr } },
+        { MF_MT_SAMPLE_SIZE, { L"SAMPLE_SIZE", ValueKind::Uint, nullptr } },
+        { MF_MT_VIDEO_PRIMARIES, { L"VIDEO_PRIMARIES", ValueKind::Uint, nullptr } },
+        { MF_MT_INTERLACE_MODE, { L"INTERLACE_MODE", ValueKind::Uint, nullptr } },
+        { MF_MT_AVG_BITRATE, { L"AVG_BITRATE", ValueKind::Uint, nullptr } },
+    };
+
+    const AttributeDescriptor* FindAttribute(const GUID& key) noexcept
+    {
+        for (const auto& attribute : MediaTypeAttributes)
+        {
+            if (attribute.key == key)
+            {
+                return &attribute;
+            }
+        }
+
+        return nullptr;
+    }
+
+    //
+    // Returns false if the variant type does not match the descriptor
+    //
+    bool FormatAttribute(const capture::FieldDescriptor& field, const PROPVARIANT& var, capture::MediaTypeFormatter& formatter)
+    {
+        switch (field.kind)
+        {
+        case ValueKind::Ratio:
+            if (var.vt != VT_UI8)
+            {
+                return false;
+            }
+            formatter.Ratio(field, HI32(var.uhVal.QuadPart), LO32(var.uhVal.QuadPart));
+            return true;
+
+        case ValueKind::Size:
+            if (var.vt != VT_UI8)
+            {
+                return false;
+            }
+            formatter.Size(field, HI32(var.uhVal.QuadPart), LO32(var.uhVal.QuadPart));
+            return true;
+
+        case ValueKind::Uint:
+            if (var.vt != VT_UI4)
+            {
+                return false;
+            }
+            formatter.Uint(field, var.ulVal);
+            return true;
+
+        case ValueKind::Int:
+            if (var.vt != VT_UI4)
+            {
+                return false;
+            }
+            formatter.Int(field, static_cast<INT32>(var.ulVal));
+            return true;
+
+        case ValueKind::Guid:
+            if (var.vt != VT_CLSID)
+            {
+                return false;
+            }
+            {
+                mf::GuidString unknown;
+                formatter.Text(field, mf::MFAttributes::GuidToName(*var.puuid, unknown));
+            }
+            return true;
+
+        default:
+            return false;
+        }
+    }
+}
+
+namespace console
+{
+    HRESULT DeviceList(bool verbose, capture::OutputFormat format)
+    {
+        mf::MediaVideoSource sources;
+        mf::MFActivateList devs;
+        HRCHK(sources.EnumDevice(devs));
+
+        capture::StreamCache cache(CatalogPath());
+        capture::MediaTypeFormatter formatter(format, true);
+        utils::AttributeSnapshot snapshot;
+        mf::GuidString unknown;
+        size_t deviceNumber = 0;
+
+        for (auto& dev : devs)
+        {
+            mf::MFAttributes attr(dev);
+
+            if (format != capture::OutputFormat::Text)
+            {
+                //
+                // Machine readable output is made of media types only
+                //
+                mf::MFDevice device(dev);
+                PrintCachedMediaTypes(cache, device, formatter);
+                formatter.Flush(std::wcout);
+                continue;
+            }
+
+            //
+            // One pass over the attribute store instead of a COM call per line
+            //
+            HRCHK(attr.GetSnapshot(snapshot));
+            GUID category = { 0 };
+
+            std::wcout << "Device #" << deviceNumber++;
+            std::wcout << "\n  Friendly name: " << snapshot.GetString(MF_DEVSOURCE_ATTRIBUTE_FRIENDLY_NAME);
+            std::wcout << "\n  Sym link: " << snapshot.GetString(MF_DEVSOURCE_ATTRIBUTE_SOURCE_TYPE_VIDCAP_SYMBOLIC_LINK);
+            std::wcout << "\n  Buffered frames: " << std::dec << snapshot.GetUint32Or(MF_DEVSOURCE_ATTRIBUTE_SOURCE_TYPE_VIDCAP_MAX_BUFFERS, 0);
+            std::wcout << "\n  Video category: ";
+
+            if (snapshot.GetGuid(MF_DEVSOURCE_ATTRIBUTE_SOURCE_TYPE_VIDCAP_CATEGORY, category))
+            {
+                std::wcout << mf::MFAttributes::GuidToName(category, unknown);
+            }
+            else
+            {
+                std::wcout << "<not found>";
+            }
+
+            if (0 == snapshot.GetUint32Or(MF_DEVSOURCE_ATTRIBUTE_SOURCE_TYPE_VIDCAP_HW_SOURCE, 0))
+            {
+                std::wcout << "\n  Software device";
+            }
+            else
+            {
+                std::wcout << "\n  Hardware device";
+            }
+
+            const uint8_t* data = nullptr;
+            size_t size = 0;
+
+            if (snapshot.GetBlob(MF_DEVSOURCE_ATTRIBUTE_MEDIA_TYPE, data, size) && size)
+            {
+                auto typeInfo = reinterpret_cast<const MFT_REGISTER_TYPE_INFO*>(data);
+                size_t count = size / sizeof(*typeInfo);
+                assert(0 == (size % sizeof(*typeInfo)));
+
+                for (size_t i = 0; i < count; ++i)
+                {
+                    std::wcout << "\n  Media major type: " << mf::MFAttributes::GuidToName(typeInfo[i].guidMajorType, unknown);
+                    std::wcout << "\n  Media subtype:    " << mf::MFAttributes::GuidToName(typeInfo[i].guidSubtype, unknown);
+                }
+            }
+
+            std::wcout << "\n";
+
+            if (verbose)
+            {
+                mf::MFDevice device(dev);
+                PrintCachedMediaTypes(cache, device, formatter);
+                formatter.Flush(std::wcout);
+                std::wcout << "\n\n";
+            }
+        }
+
+        if (verbose || format != capture::OutputFormat::Text)
+        {
+            cache.Save();
+        }
+
+        return S_OK;
+    }
+
+    std::wstring CatalogPath()
+    {
+        //
+        // %LOCALAPPDATA%\msmf, the temp directory if it is not available
+        //
+        utils::TaskMemFreeTraits<PWSTR>::Handle folder;
+
+        if (SUCCEEDED(SHGetKnownFolderPath(FOLDERID_LocalAppData, 0, NULL, folder.ReleaseAndGetAddressOf())))
+        {
+            return std::wstring(folder.Get()) + L"\\msmf\\media-types.catalog";
+        }
+
+        return (std::filesystem::temp_directory_path() / L"msmf-media-types.catalog").wstring();
+    }
+
+    HRESULT PrintCachedMediaTypes(capture::StreamCache& cache, capture::Device& device, capture::MediaTypeFormatter& formatter)
+    {
+        //
+        // DeviceMediaTypeList answered from the catalog
+        //
+        std::vector<capture::StreamInfo> streams;
+        HRCHK(cache.GetStreams(device, streams));
+
+        const std::wstring name = device.GetFriendlyName();
+
+        for (const auto& stream : streams)
+        {
+            for (const auto& mediaType : stream.mediaTypes)
+            {
+                formatter.BeginRecord(name, stream.index, mediaType.index);
+                capture::FormatMediaTypeInfo(mediaType, formatter);
+                formatter.EndRecord();
+            }
+        }
+
+        return S_OK;
+    }
+
+    HRESULT DeviceMediaTypeList(ComPtr<IMFActivate>& pActivate, capture::MediaTypeFormatter& formatter)
+    {
+        ComPtr<IMFMediaSource> pSource;
+        HRCHK(pActivate->ActivateObject(
+            __uuidof(IMFMediaSource),
+            reinterpret_cast<void**>(pSource.GetAddressOf())));
+
+        ComPtr<IMFSourceReader> pVideoFileSource;
+        HRCHK(MFCreateSourceReaderFromMediaSource(
+            pSource.Get(), 
+            NULL, 
+            pVideoFileSource.GetAddressOf()));
+
+        HRCHK(pVideoFileSource->SetStreamSelection(
+            static_cast<DWORD>(MF_SOURCE_READER_ALL_STREAMS), 
+            TRUE));
+
+        const std::wstring device = mf::MFAttributes(pActivate).GetString(MF_DEVSOURCE_ATTRIBUTE_FRIENDLY_NAME);
+
+        DWORD dwMediaTypeTest = 0;
+        DWORD dwStreamTest = 0;
+        HRESULT hr = S_OK;
+
+        while (SUCCEEDED(hr))
+        {
+            ComPtr<IMFMediaType> pType;
+            hr = pVideoFileSource->GetNativeMediaType(
+                dwStreamTest, 
+                dwMediaTypeTest, 
+                pType.GetAddressOf());
+
+            if (hr == MF_E_NO_MORE_TYPES)
+            {
+                hr = S_OK;
+                dwMediaTypeTest = 0;
+                ++dwStreamTest;
+                continue;
+            }
+
+            if (hr == MF_E_INVALIDSTREAMNUMBER)
+            {
+                break;
+            }
+
+            if (SUCCEEDED(hr))
+            {
+                formatter.BeginRecord(device, dwStreamTest, dwMediaTypeTest);
+
+                if (SUCCEEDED(pType->LockStore()))
+                {
+                    FormatMediaType(pType.Get(), formatter);
+                    pType->UnlockStore();
+                }
+
+                formatter.EndRecord();
+            }
+
+            ++dwMediaTypeTest;
+        }
+
+        return S_OK;
+    }
+
+    HRESULT FormatMediaType(IMFMediaType * pMediaType, capture::MediaTypeFormatter& formatter)
+    {
+        UINT32 count = 0;
+        HRCHK(pMediaType->GetCount(&count));
+
+        GUID guid = { 0 };
+        mf::GuidString unknown;
+
+        for (UINT32 i = 0; i < count; ++i)
+        {
+            PROPVARIANT var;
+            PropVariantInit(&var);
+
+            if (FAILED(pMediaType->GetItemByIndex(i, &guid, &var)))
+            {
+                formatter.Error(L"CANNOT GET GUID #" + std::to_wstring(i));
+                continue;
+            }
+
+            const AttributeDescriptor* attribute = FindAttribute(guid);
+
+            if (!attribute || !FormatAttribute(attribute->field, var, formatter))
+            {
+                formatter.Unknown(mf::MFAttributes::GuidToName(guid, unknown));
+            }
+
+            PropVariantClear(&var);
+        }
+
+        return S_OK;
+    }
+
+    HRESULT PrintBaseVideoMediaType(IMFMediaType * pMediaType, std::wostream& st)
+    {
+        capture::MediaTypeFormatter formatter(capture::OutputFormat::Text, true);
+        HRCHK(FormatMediaType(pMediaType, formatter));
+        formatter.Flush(st);
+        return S_OK;
+    }
+
+    HRESULT PrintMediaType(IMFMediaType * pMediaType)
+    {
+        capture::MediaTypeFormatter formatter(capture::OutputFormat::Text);
+        HRCHK(FormatMediaType(pMediaType, formatter));
+        formatter.Flush(std::wcout);
+        return S_OK;
+    }
+
+    HRESULT OpenSourceReader(
+        ComPtr<IMFActivate>& pActivate,
+        IMFSourceReaderCallback* pCallback,
+        ULONG streamId,
+        ULONG mediaId,
+        ComPtr<IMFSourceReader>& pReader,
+        ComPtr<IMFMediaType>& pType,
+        std::wstring& title)
+    {
+        ComPtr<IMFMediaType> pNativeType;
+        HRCHK(mf::OpenSourceReader(pActivate, pCallback, streamId, mediaId, pReader, pNativeType, pType));
+
+        mf::MFAttributes attr(pActivate);
+        std::wstringstream st;
+
+        st << attr.GetString(MF_DEVSOURCE_ATTRIBUTE_FRIENDLY_NAME);
+        st << ":";
+        PrintBaseVideoMediaType(pNativeType.Get(), st);
+        title = st.str();
+        return S_OK;
+    }
+
+    HRESULT StartCapture(mf::CaptureWindow& window, ComPtr<IMFActivate>& pActivate, ULONG streamId, ULONG mediaId, bool inThread)
+    {
+        ComPtr<IMFSourceReader> pVideoFileSource;
+        ComPtr<IMFMediaType> pType;
+        std::wstring title;
+        HRCHK(OpenSourceReader(pActivate, &window, streamId, mediaId, pVideoFileSource, pType, title));
+
+        std::wcout << title << "\n";
+        HRCHK(window.SetTitle(title));
+
+        HRCHK(window.Show(std::move(pVideoFileSource), std::move(pType), streamId, inThread));
+        return S_OK;
+    }
+
+    void PrintTimingReport(const video::TimingAnalyzer::Report& report, std::wostream& st)
+    {
+        st << "\n Timestamps  : " << report.frames << " frames, "
+            << report.measuredFps << " fps of nominal " << report.nominalFps;
+        st << "\n Missing     : " << report.droppedFrames << " frames in " << report.gaps << " gaps"
+            << ", non-monotonic " << report.nonMonotonic;
+        st << "\n Interval us : p50 " << report.intervalP50
+            << " p99 " << report.intervalP99
+            << " p99.9 " << report.intervalP999
+            << " max " << report.intervalMax;
+        st << "\n Jitter us   : p50 " << report.jitterP50
+            << " p99 " << report.jitterP99
+            << " p99.9 " << report.jitterP999
+            << " max " << report.jitterMax;
+    }
+
+    void PrintLatencyReport(const video::LatencyTracker::Report& report, std::wostream& st)
+    {
+        st << "\n Latency     : " << report.frames << " frames";
+
+        if (report.unmapped)
+        {
+            st << ", " << report.unmapped << " device times not on the host clock";
+        }
+
+        for (uint32_t i = 0; i < static_cast<uint32_t>(video::LatencyTracker::Span::Count); ++i)
+        {
+            const auto span = static_cast<video::LatencyTracker::Span>(i);
+            const auto& spanReport = report[span];
+
+            if (0 == spanReport.count)
+            {
+                continue;
+            }
+
+            st << "\n  " << std::left << std::setw(7) << video::LatencyTracker::SpanName(span) << std::right
+                << " us : p50 " << spanReport.p50
+                << " p99 " << spanReport.p99
+                << " max " << spanReport.max
+                << " mean " << static_cast<uint64_t>(spanReport.mean);
+        }
+    }
+
+    void PrintFrameDiffReport(const video::FrameDiffDetector::Report& report, double seconds, std::wostream& st)
+    {
+        //
+        // Unique fps falls below the callback fps when the driver repeats its buffers
+        //
+        st << "\n Unique      : " << report.unique << " of " << report.frames << " frames, "
+            << (seconds > 0 ? report.unique / seconds : 0) << " fps";
+        st << "\n Frozen      : " << report.frozen << " frames in " << report.frozenRuns << " runs"
+            << ", longest " << report.longestRun
+            << ", partial updates " << report.partial;
+    }
+
+    void PrintDwellReport(const video::DwellMonitor::Report& report, std::wostream& st)
+    {
+        st << "\n First frame : ";
+
+        if (report.firstFrameMs < 0)
+        {
+            st << "none";
+        }
+        else
+        {
+            st << report.firstFrameMs << " ms";
+        }
+
+        st << "\n Dwell       : " << (report.converged ? "converged in " : "not converged in ")
+            << report.seconds << " s, " << report.batches << " batches"
+            << ", fps " << report.fps << " +- " << report.fpsHalfWidth
+            << ", jitter " << report.jitterUs << " +- " << report.jitterHalfWidthUs << " us";
+    }
+
+    void PrintBenchResult(const capture::BenchResult& result, std::wostream& st)
+    {
+        const auto& report = result.bench;
+
+        st << std::fixed << std::setprecision(3);
+        st << "\n Frames      : " << report.frames;
+        st << "\n Duration    : " << report.seconds << " s";
+        st << "\n FPS         : " << report.fps;
+        st << "\n Throughput  : " << (report.seconds > 0 ? result.bytes / report.seconds / 1e9 : 0) << " GB/s";
+        st << "\n Interval ms : min " << report.intervalMin
+            << " p50 " << report.intervalP50
+            << " p90 " << report.intervalP90
+            << " p99 " << report.intervalP99
+            << " max " << report.intervalMax;
+        st << "\n CPU         : " << report.cpuSeconds << " s, " << report.cpuPerFrameMs << " ms per frame";
+
+        PrintTimingReport(result.timing, st);
+        PrintLatencyReport(result.latency, st);
+        PrintFrameDiffReport(result.frameDiff, report.seconds, st);
+        PrintDwellReport(result.dwell, st);
+        st.unsetf(std::ios_base::floatfield);
+    }
+
+    void PrintVerifyReport(const video::VerifySink& sink, std::wostream& st)
+    {
+        const auto report = sink.GetReport();
+
+        st << "\n Verified    : " << report.frames << " frames, hash " << std::hex << report.hash << std::dec;
+        st << "\n Identical   : " << report.identical << " frames equal to the previous one";
+
+        if (sink.GetPattern() != video::TestPattern::None)
+        {
+            st << "\n Pattern     : " << video::TestPatternName(sink.GetPattern())
+                << ", mismatched " << report.mismatched
+                << ", repeated " << report.repeated
+                << ", skipped " << report.skipped << " frames";
+        }
+
+        for (const auto& event : sink.GetEvents())
+        {
+            st << "\n  frame " << event.frame
+                << " at " << event.timestamp / 10000 << " ms: "
+                << video::VerifySink::IssueName(event.issue);
+
+            if (event.issue == video::VerifySink::Issue::Mismatch)
+            {
+                st << " at row " << event.row;
+            }
+            else if (event.issue == video::VerifySink::Issue::Skipped)
+            {
+                st << " " << event.skipped << " frames";
+            }
+        }
+
+        if (report.lostEvents)
+        {
+            st << "\n  " << report.lostEvents << " more";
+        }
+    }
+
+    void PrintRecordStatistics(const video::RecordWriter::Statistics& stat, HRESULT hr, std::wostream& st)
+    {
+        st << "\n Recorded    : " << stat.written << " frames, " << stat.bytes / (1024 * 1024) << " MB";
+        st << "\n Disk        : dropped " << stat.dropped
+            << ", max backlog " << stat.maxBacklog
+            << ", rejected " << stat.rejected;
+
+        if (FAILED(hr))
+        {
+            st << "\n Write error : 0x" << std::hex << hr << std::dec;
+        }
+    }
+
+    HRESULT OpenFirstDevice(capture::Backend& backend, const std::wstring& device, capture::DevicePtr& dev)
+    {
+        capture::DeviceList devices;
+        HRESULT hr = backend.OpenDevice(device, devices);
+
+        if (FAILED(hr))
+        {
+            std::wcout << "Cannot open device '" << device << "'\n";
+            return hr;
+        }
+
+        if (devices.size() > 1)
+        {
+            std::wcout << "WARNING!"
+                << " Found " << devices.size() << " devices by '"
+                << device << "'. Use the first one...\n";
+        }
+
+        dev = devices.at(0);
+        return hr;
+    }
+
+    HRESULT StartBench(
+        capture::Backend& backend,
+        const std::wstring& device,
+        ULONG streamId,
+        ULONG mediaId,
+        ULONG seconds,
+        const CaptureOptions& options)
+    {
+        capture::DevicePtr dev;
+        HRCHK(OpenFirstDevice(backend, device, dev));
+
+        std::unique_ptr<capture::FrameSource> source;
+        HRCHK(dev->OpenFrameSource(streamId, mediaId, source));
+
+        std::wcout << dev->GetFriendlyName() << ":";
+        capture::PrintMediaTypeInfo(source->GetMediaType(), std::wcout);
+        std::wcout << "\nBenchmark for " << seconds << " s, read depth " << options.readDepth
+            << ", " << (options.verify ? "verify" : options.checksum ? "checksum" : "null") << " sink"
+            << ", " << backend.GetName() << " backend\n";
+
+        const auto& mediaType = source->GetMediaType();
+
+        //
+        // --record copies the frames to the pool and writes them on the writer thread
+        //
+        video::FramePool pool(512 * 1024 * 1024);
+        video::RecordWriter recorder;
+        video::RecordSink recordSink(recorder, pool);
+
+        if (!options.recordPath.empty())
+        {
+            HRCHK(recorder.Open(
+                options.recordPath,
+                mediaType.format,
+                mediaType.width,
+                mediaType.height,
+                mediaType.fpsNumerator,
+                mediaType.fpsDenominator));
+        }
+
+        video::NullSink nullSink;
+        video::ChecksumSink checksumSink;
+        video::VerifySink verifySink(options.pattern, mediaType.colorSpace);
+        video::FrameSink& sink = !options.recordPath.empty()
+            ? static_cast<video::FrameSink&>(recordSink)
+            : options.verify
+            ? static_cast<video::FrameSink&>(verifySink)
+            : options.checksum
+            ? static_cast<video::FrameSink&>(checksumSink)
+            : static_cast<video::FrameSink&>(nullSink);
+
+        capture::BenchResult result;
+        HRCHK(capture::RunBench(*source, sink, options.readDepth, seconds, result));
+
+        PrintBenchResult(result, std::wcout);
+
+        if (!options.recordPath.empty())
+        {
+            const HRESULT hr = recorder.Close();
+            PrintRecordStatistics(recorder.GetStatistics(), hr, std::wcout);
+            std::wcout << "\n Pool drops  : " << recordSink.GetPoolDrops();
+        }
+
+        if (options.checksum && options.recordPath.empty())
+        {
+            std::wcout << "\n Checksum    : " << std::hex << checksumSink.GetChecksum() << std::dec;
+        }
+
+        if (options.verify && options.recordPath.empty())
+        {
+            PrintVerifyReport(verifySink, std::wcout);
+        }
+
+        std::wcout << "\n";
+        return S_OK;
+    }
+
+    HRESULT StartMultiStreamBench(
+        capture::Backend& backend,
+        const std::wstring& device,
+        const std::vector<capture::StreamSelection>& selections,
+        ULONG seconds,
+        const CaptureOptions& options)
+    {
+        capture::DevicePtr dev;
+        HRCHK(OpenFirstDevice(backend, device, dev));
+
+        std::unique_ptr<capture::MultiStreamSource> source;
+        HRESULT hr = dev->OpenMultiStreamSource(selections, source);
+
+        if (hr == E_NOTIMPL)
+        {
+            std::wcout << "The " << backend.GetName() << " backend reads one stream at a time\n";
+        }
+
+        HRCHK(hr);
+
+        std::wcout << dev->GetFriendlyName() << ":";
+
+        for (size_t i = 0; i < source->GetStreamCount(); ++i)
+        {
+            std::wcout << "\n  [" << source->GetStreamIndex(i) << ", " << selections[i].mediaTypeIndex << "]:";
+            capture::PrintMediaTypeInfo(source->GetMediaType(i), std::wcout);
+        }
+
+        std::wcout << "\nBenchmark " << source->GetStreamCount() << " streams for " << seconds << " s"
+            << ", read depth " << options.readDepth
+            << ", " << (options.checksum ? "checksum" : "null") << " sinks"
+            << ", " << backend.GetName() << " backend\n";
+
+        //
+        // One consumer per stream, as preview and record pins have
+        //
+        std::vector<video::NullSink> nullSinks(source->GetStreamCount());
+        std::vector<video::ChecksumSink> checksumSinks(source->GetStreamCount());
+        std::vector<video::FrameSink*> sinks;
+
+        for (size_t i = 0; i < source->GetStreamCount(); ++i)
+        {
+            sinks.push_back(options.checksum
+                ? static_cast<video::FrameSink*>(&checksumSinks[i])
+                : static_cast<video::FrameSink*>(&nullSinks[i]));
+        }
+
+        capture::StreamDispatcher::Report report;
+        HRCHK(capture::RunMultiStreamBench(*source, sinks, options.readDepth, seconds, report));
+
+        PrintMultiStreamReport(report, std::wcout);
+
+        if (options.checksum)
+        {
+            for (size_t i = 0; i < checksumSinks.size(); ++i)
+            {
+                std::wcout << "\n Checksum #" << source->GetStreamIndex(i) << " : "
+                    << std::hex << checksumSinks[i].GetChecksum() << std::dec;
+            }
+        }
+
+        std::wcout << "\n";
+        return S_OK;
+    }
+
+    void PrintMultiStreamReport(const capture::StreamDispatcher::Report& report, std::wostream& st)
+    {
+        st << std::fixed << std::setprecision(3);
+
+        for (const auto& stream : report.streams)
+        {
+            const auto& bench = stream.bench;
+
+            st << "\n Stream #" << stream.streamIndex
+                << " : " << bench.frames << " frames"
+                << ", " << bench.fps << " fps"
+                << ", " << (bench.seconds > 0 ? stream.bytes / bench.seconds / 1e6 : 0) << " MB/s"
+                << ", interval ms p50 " << bench.intervalP50
+                << " p99 " << bench.intervalP99
+                << " max " << bench.intervalMax;
+        }
+
+        st << "\n Total       : " << report.frames << " frames in " << report.seconds << " s"
+            << ", " << report.fps << " fps"
+            << ", " << (report.seconds > 0 ? report.bytes / report.seconds / 1e6 : 0) << " MB/s";
+
+        if (report.unrouted)
+        {
+            st << "\n Unrouted    : " << report.unrouted << " frames";
+        }
+
+        st.unsetf(std::ios_base::floatfield);
+    }
+
+    HRESULT StartMosaic(capture::Backend& backend, const std::vector<StreamSpec>& tiles, const CaptureOptions& options)
+    {
+        //
+        // The devices are kept open as long as their sources
+        //
+        std::vector<capture::DevicePtr> devices;
+        std::vector<std::unique_ptr<capture::FrameSource>> sources;
+        std::vector<capture::FrameSource*> tileSources;
+
+        for (const auto& tile : tiles)
+        {
+            capture::DevicePtr dev;
+            HRCHK(OpenFirstDevice(backend, tile.device, dev));
+
+            std::unique_ptr<capture::FrameSource> source;
+            HRCHK(dev->OpenFrameSource(tile.streamId, tile.mediaId, source));
+
+            std::wcout << "Tile " << sources.size() << " " << dev->GetFriendlyName()
+                << " [" << tile.streamId << ", " << tile.mediaId << "]:";
+            capture::PrintMediaTypeInfo(source->GetMediaType(), std::wcout);
+            std::wcout << "\n";
+
+            tileSources.push_back(source.get());
+            sources.push_back(std::move(source));
+            devices.push_back(std::move(dev));
+        }
+
+        mf::MosaicWindow window;
+        HRCHK(window.SetReadDepth(options.readDepth));
+        HRCHK(window.SetTitle(L"msmf mosaic"));
+        HRCHK(window.Show(tileSources, MosaicWidth, MosaicHeight));
+
+        const auto stat = window.GetStatistics();
+
+        std::wcout << std::fixed << std::setprecision(3);
+        std::wcout << "\n Presented   : " << stat.presented << " frames in " << stat.seconds << " s"
+            << ", " << (stat.seconds > 0 ? stat.presented / stat.seconds : 0) << " fps";
+        std::wcout << "\n Compose ms  : avg " << stat.composeMsAvg << " max " << stat.composeMsMax;
+
+        for (size_t i = 0; i < stat.tiles.size(); ++i)
+        {
+            const auto& tile = stat.tiles[i];
+
+            std::wcout << "\n Tile " << i
+                << " : received " << tile.received
+                << ", composed " << tile.composed
+                << ", replaced " << tile.replaced
+                << ", rejected " << tile.rejected
+                << ", " << (stat.seconds > 0 ? tile.received / stat.seconds : 0) << " fps";
+        }
+
+        std::wcout.unsetf(std::ios_base::floatfield);
+        std::wcout << "\n";
+        return S_OK;
+    }
+
+    HRESULT StartSoak(capture::Backend& backend, const std::vector<StreamSpec>& streams, ULONG hours, const CaptureOptions& options)
+    {
+        std::vector<capture::SoakStream> soakStreams;
+
+        for (const auto& spec : streams)
+        {
+            capture::DevicePtr dev;
+            HRCHK(OpenFirstDevice(backend, spec.device, dev));
+
+            std::wcout << "Stream " << soakStreams.size() << " " << dev->GetFriendlyName()
+                << " [" << spec.streamId << ", " << spec.mediaId << "]\n";
+
+            capture::SoakStream stream;
+            stream.device = dev;
+            stream.streamIndex = spec.streamId;
+            stream.mediaTypeIndex = spec.mediaId;
+            soakStreams.push_back(stream);
+        }
+
+        capture::SoakSettings settings;
+        settings.seconds = static_cast<uint64_t>(hours) * 3600;
+        settings.intervalSeconds = options.interval;
+        settings.readDepth = options.readDepth;
+
+        capture::TimeSeriesWriter writer;
+        HRESULT hr = writer.Open(options.outputPath);
+
+        if (FAILED(hr))
+        {
+            std::wcout << "Cannot open '" << options.outputPath << "'\n";
+            return hr;
+        }
+
+        std::wcout << "Soak for " << hours << " h, a sample every " << options.interval << " s"
+            << ", " << backend.GetName() << " backend, time series in " << options.outputPath << "\n";
+
+        //
+        // The time series is the record, the console shows it is alive
+        //
+        capture::SoakAggregate aggregate;
+        HRCHK(capture::RunSoak(soakStreams, settings, writer, aggregate, [](const capture::SoakSample& sample)
+        {
+            std::wcout << std::fixed << std::setprecision(1)
+                << sample.elapsed << " s #" << sample.stream
+                << " " << sample.fps << " fps"
+                << ", jitter p99 " << sample.jitterP99 << " us"
+                << ", dropped " << sample.dropped
+                << ", restarts " << sample.restarts
+                << ", error 0x" << std::hex << static_cast<uint32_t>(sample.error) << std::dec
+                << ", working set " << sample.workingSet / (1024 * 1024) << " MB"
+                << ", handles " << sample.handles << "\n";
+            std::wcout.unsetf(std::ios_base::floatfield);
+        }));
+
+        const auto summary = aggregate.GetSummary();
+
+        std::wcout << std::fixed << std::setprecision(3);
+
+        for (size_t i = 0; i < summary.streams.size(); ++i)
+        {
+            const auto& stream = summary.streams[i];
+
+            std::wcout << "\n Stream #" << i
+                << " : " << stream.frames << " frames"
+                << ", fps avg " << stream.fpsAvg << " min " << stream.fpsMin << " max " << stream.fpsMax
+                << ", dropped " << stream.dropped
+                << ", restarts " << stream.restarts
+                << ", jitter p99 max " << stream.jitterP99Max << " us"
+                << ", last error 0x" << std::hex << static_cast<uint32_t>(stream.lastError) << std::dec;
+        }
+
+        std::wcout << "\n Working set : " << summary.workingSetFirst / (1024 * 1024)
+            << " MB at the start, " << summary.workingSetLast / (1024 * 1024)
+            << " MB at the end, " << summary.workingSetMax / (1024 * 1024) << " MB max";
+        std::wcout << "\n Handles     : " << summary.handlesFirst << " at the start, "
+            << summary.handlesLast << " at the end, " << summary.handlesMax << " max";
+
+        std::wcout.unsetf(std::ios_base::floatfield);
+        std::wcout << "\n";
+        return S_OK;
+    }
+
+    HRESULT StartReplay(const std::wstring& path, bool headless, const CaptureOptions& options)
+    {
+        capture::ReplaySource source;
+        HRESULT hr = source.Open(path, !options.fullSpeed);
+
+        if (FAILED(hr))
+        {
+            std::wcout << "Cannot open recording '" << path << "'\n";
+            return hr;
+        }
+
+        std::wcout << path << ":";
+        capture::PrintMediaTypeInfo(source.GetMediaType(), std::wcout);
+        std::wcout << "\nReplay " << source.GetFrameCount() << " frames"
+            << (options.fullSpeed ? " at full speed" : " at the recorded timing") << "\n";
+
+        if (headless)
+        {
+            video::NullSink nullSink;
+            video::ChecksumSink checksumSink;
+            video::VerifySink verifySink(options.pattern, source.GetMediaType().colorSpace);
+            video::FrameSink& sink = options.verify
+                ? static_cast<video::FrameSink&>(verifySink)
+                : options.checksum
+                ? static_cast<video::FrameSink&>(checksumSink)
+                : static_cast<video::FrameSink&>(nullSink);
+
+            capture::BenchResult result;
+            HRCHK(capture::RunBench(source, sink, options.readDepth, 0, result));
+
+            PrintBenchResult(result, std::wcout);
+
+            if (options.checksum)
+            {
+                std::wcout << "\n Checksum    : " << std::hex << checksumSink.GetChecksum() << std::dec;
+            }
+
+            if (options.verify)
+            {
+                PrintVerifyReport(verifySink, std::wcout);
+            }
+
+            std::wcout << "\n";
+            return S_OK;
+        }
+
+        //
+        // The recorded frames take the same path as the samples of a device
+        //
+        mf::CaptureWindow window;
+        HRCHK(window.SetQueuePolicy(options.queuePolicy, options.queueDepth));
+        HRCHK(window.SetReadDepth(options.readDepth));
+        HRCHK(window.SetRecordPath(options.recordPath));
+        HRCHK(window.SetTimecode(options.timecode));
+        HRCHK(window.SetTitle(path));
+        HRCHK(window.Show(source, false));
+
+        const auto replay = source.GetStatistics();
+        const auto stat = window.GetStatistics();
+        const double seconds = replay.seconds > 0 ? replay.seconds : 0;
+
+        std::wcout << std::fixed << std::setprecision(3);
+        std::wcout << "\n Replayed    : " << replay.frames << " frames in " << seconds << " s";
+        std::wcout << "\n FPS         : " << (seconds > 0 ? replay.frames / seconds : 0);
+        std::wcout << "\n Throughput  : " << (seconds > 0 ? replay.bytes / seconds / 1e9 : 0) << " GB/s";
+        std::wcout << "\n Rendered    : " << stat.rendered << ", skipped for display " << stat.displaySkips
+            << ", dropped: queue " << stat.queueDrops
+            << ", out of order " << stat.outOfOrder;
+
+        PrintTimingReport(stat.timing, std::wcout);
+        PrintLatencyReport(stat.latency, std::wcout);
+        PrintFrameDiffReport(stat.frameDiff, stat.seconds, std::wcout);
+
+        if (!options.recordPath.empty())
+        {
+            PrintRecordStatistics(stat.record, stat.recordError, std::wcout);
+        }
+
+        std::wcout.unsetf(std::ios_base::floatfield);
+        std::wcout << "\n";
+        return S_OK;
+    }
+
+    HRESULT SweepBench(capture::Backend& backend, ULONG seconds, const CaptureOptions& options)
+    {
+        std::vector<capture::BaselineRecord> records;
+        return SweepBench(backend, seconds, options, records);
+    }
+
+    HRESULT SweepBench(
+        capture::Backend& backend,
+        ULONG seconds,
+        const CaptureOptions& options,
+        std::vector<capture::BaselineRecord>& records)
+    {
+        //
+        // Headless counterpart of DeviceCaptureOneByOne
+        //
+        video::NullSink nullSink;
+        video::ChecksumSink checksumSink;
+        video::FrameSink& sink = options.checksum
+            ? static_cast<video::FrameSink&>(checksumSink)
+            : static_cast<video::FrameSink&>(nullSink);
+
+        records.clear();
+
+        HRCHK(capture::Sweep(backend, sink, options.readDepth, seconds, options.adaptiveDwell,
+            [&records](capture::Device& device,
+                const capture::StreamInfo& stream,
+                const capture::MediaTypeInfo& mediaType,
+                HRESULT hr,
+                const capture::BenchResult& result)
+        {
+            records.push_back(capture::MakeBaselineRecord(
+                device.GetSymbolicLink(), device.GetFriendlyName(), stream.index, mediaType, hr, result));
+
+            std::wcout << device.GetFriendlyName()
+                << " [" << std::dec << stream.index << ", " << mediaType.index << "]:";
+            capture::PrintMediaTypeInfo(mediaType, std::wcout);
+
+            if (FAILED(hr))
+            {
+                std::wcout << "\n Error 0x" << std::hex << hr << std::dec << "\n\n";
+                return;
+            }
+
+            PrintBenchResult(result, std::wcout);
+            std::wcout << "\n\n";
+        }));
+
+        if (!options.savePath.empty())
+        {
+            const HRESULT hr = capture::WriteBaseline(options.savePath, records);
+
+            if (FAILED(hr))
+            {
+                std::wcout << "Cannot write the results to '" << options.savePath << "'\n";
+                return hr;
+            }
+
+            std::wcout << "Results of " << records.size() << " modes written to " << options.savePath << "\n";
+        }
+
+        return S_OK;
+    }
+
+    HRESULT CompareSweep(
+        capture::Backend& backend,
+        const std::wstring& baselinePath,
+        ULONG seconds,
+        const CaptureOptions& options,
+        size_t& regressions)
+    {
+        regressions = 0;
+
+        std::vector<capture::BaselineRecord> baseline;
+        std::string error;
+        HRESULT hr = capture::LoadBaseline(baselinePath, baseline, error);
+
+        if (FAILED(hr))
+        {
+            std::wcout << "Cannot load the baseline '" << baselinePath << "', " << error.c_str() << "\n";
+            return hr;
+        }
+
+        std::vector<capture::BaselineRecord> records;
+        HRCHK(SweepBench(backend, seconds, options, records));
+
+        const auto comparisons = capture::CompareBaseline(baseline, records);
+        regressions = capture::CountRegressions(comparisons);
+
+        std::wcout << "Compared with " << baselinePath << ": " << baseline.size() << " modes in the baseline, "
+            << records.size() << " in the run\n";
+        capture::PrintComparison(comparisons, std::wcout);
+        std::wcout << regressions << " regressions\n";
+        return S_OK;
+    }
+
+    HRESULT RunCapturePlan(capture::Backend& backend, const std::wstring& path)
+    {
+        capture::CapturePlan plan;
+        std::string error;
+        HRESULT hr = capture::LoadPlan(path, plan, error);
+
+        if (FAILED(hr))
+        {
+            std::wcout << "Cannot load the plan '" << path << "', " << error.c_str() << "\n";
+            return hr;
+        }
+
+        std::vector<capture::PlanJob> jobs;
+        HRCHK(capture::ExpandPlan(backend, plan, jobs));
+
+        std::wcout << "Plan " << path << ": " << jobs.size() << " jobs of " << plan.entries.size() << " entries"
+            << ", " << (plan.concurrency ? std::to_wstring(plan.concurrency) : std::wstring(L"all")) << " devices at once"
+            << ", " << backend.GetName() << " backend\n";
+
+        //
+        // Progress as the jobs complete, the table follows in the plan order
+        //
+        std::vector<capture::PlanResult> results;
+        HRCHK(capture::RunPlan(backend, plan, jobs, results, [](const capture::PlanResult& result)
+        {
+            std::wcout << result.device;
+
+            if (result.job.status != S_OK)
+            {
+                const char* reason = !result.job.device
+                    ? "not found"
+                    : result.job.status == S_FALSE ? "no media type matches" : "cannot read the media types";
+
+                std::wcout << ": " << reason
+                    << " 0x" << std::hex << static_cast<uint32_t>(result.hr) << std::dec << "\n";
+                return;
+            }
+
+            std::wcout << " [" << result.job.streamIndex << ", " << result.job.mediaType.index << "]:";
+            capture::PrintMediaTypeInfo(result.job.mediaType, std::wcout);
+            std::wcout << std::fixed << std::setprecision(1)
+                << " " << result.bench.bench.fps << " fps in " << result.seconds << " s"
+                << ", 0x" << std::hex << static_cast<uint32_t>(result.hr) << std::dec << "\n";
+            std::wcout.unsetf(std::ios_base::floatfield);
+        }));
+
+        std::wcout << "\n";
+        capture::PrintPlanResults(results, std::wcout);
+        return S_OK;
+    }
+
+    HRESULT DeviceCaptureOneByOne(ULONG timeoutSeconds)
+    {
+        //
+        // Enums all device, stream and media type,
+        // starts video capture for each avaliable config,
+        // waits until its fps and jitter converge or for timeout
+        // and continue enumeration
+        //
+
+        mf::MediaVideoSource sources;
+        mf::MFActivateList devs;
+        HRCHK(sources.EnumDevice(devs));
+
+        size_t deviceNumber = 0;
+
+        for (auto& dev : devs)
+        {
+            ComPtr<IMFAttributes> pAttributes = dev;
+            mf::MFAttributes attr(pAttributes);
+
+            std::wcout << "Device #" << deviceNumber++ << " " << attr.GetString(MF_DEVSOURCE_ATTRIBUTE_FRIENDLY_NAME) << "\n";
+
+            ComPtr<IMFMediaSource> pSource;
+            HRCHK(dev->ActivateObject(__uuidof(IMFMediaSource), reinterpret_cast<void**>(pSource.GetAddressOf())));
+
+            mf::CaptureWindow window;
+            ComPtr<IMFAttributes> pVideoAttributes;
+            HRCHK(MFCreateAttributes(&pVideoAttributes, 10));
+            HRCHK(pVideoAttributes->SetUINT32(MF_READWRITE_ENABLE_HARDWARE_TRANSFORMS, TRUE));
+            HRCHK(pVideoAttributes->SetUINT32(MF_SOURCE_READER_DISABLE_DXVA, FALSE));
+            HRCHK(pVideoAttributes->SetUINT32(MF_SOURCE_READER_ENABLE_VIDEO_PROCESSING, FALSE));
+            HRCHK(pVideoAttributes->SetUINT32(MF_SOURCE_READER_ENABLE_ADVANCED_VIDEO_PROCESSING, TRUE));
+            HRCHK(pVideoAttributes->SetUnknown(MF_SOURCE_READER_ASYNC_CALLBACK, &window));
+
+            ComPtr<IMFMediaType> pType;
+            ComPtr<IMFSourceReader> pVideoFileSource;
+            HRCHK(MFCreateSourceReaderFromMediaSource(pSource.Get(), pVideoAttributes.Get(), pVideoFileSource.ReleaseAndGetAddressOf()));
+
+            DWORD dwMediaTypeTest = 0;
+            DWORD dwStreamTest = 0;
+            HRESULT hr = S_OK;
+
+            while (SUCCEEDED(hr))
+            {
+                HRCHK(pVideoFileSource->SetStreamSelection(static_cast<DWORD>(MF_SOURCE_READER_ALL_STREAMS), TRUE));
+                hr = pVideoFileSource->GetNativeMediaType(dwStreamTest, dwMediaTypeTest, pType.ReleaseAndGetAddressOf());
+
+                if (hr == MF_E_NO_MORE_TYPES)
+                {
+                    hr = S_OK;
+                    dwMediaTypeTest = 0;
+                    ++dwStreamTest;
+                    continue;
+                }
+
+                if (hr == MF_E_INVALIDSTREAMNUMBER)
+                {
+                    break;
+                }
+
+                if (SUCCEEDED(hr))
+                {
+                    if (SUCCEEDED(pType->LockStore()))
+                    {
+                        //
+                        // Print basic media type info
+                        //
+                        PrintBaseVideoMediaType(pType.Get(), std::wcout);
+                        pType->UnlockStore();
+                    }
+
+                    //
+                    // Keep the native format when CaptureWindow can convert it,
+                    // otherwise let Media Foundation decode it to YUY2
+                    //
+                    GUID subtype = GUID_NULL;
+                    HRCHK(pType->GetGUID(MF_MT_SUBTYPE, &subtype));
+
+                    if (!mf::CaptureWindow::IsSubtypeSupported(subtype))
+                    {
+                        HRCHK(pType->SetGUID(MF_MT_SUBTYPE, MFVideoFormat_YUY2));
+                    }
+
+                    //
+                    // Start the video capture
+                    //
+                    HRCHK(pVideoFileSource->SetStreamSelection(static_cast<DWORD>(MF_SOURCE_READER_ALL_STREAMS), FALSE));
+                    HRCHK(pVideoFileSource->SetStreamSelection(dwStreamTest, TRUE));
+                    HRCHK(pVideoFileSource->SetCurrentMediaType(dwStreamTest, NULL, pType.Get()));
+
+                    hr = window.Show(pVideoFileSource, std::move(pType), dwStreamTest, true);
+
+                    if (FAILED(hr))
+                    {
+                        std::wcout << "   <== error 0x" << hr;
+                        hr = S_OK;
+                    }
+                    else
+                    {
+                        if (!window.WaitForDwell(timeoutSeconds * 1000))
+                        {
+                            window.Close();
+                        }
+
+                        std::wcout << std::fixed << std::setprecision(3);
+                        PrintDwellReport(window.GetStatistics().dwell, std::wcout);
+                        std::wcout.unsetf(std::ios_base::floatfield);
+                    }
+
+                    std::wcout << "\n";
+                }
+
+                ++dwMediaTypeTest;
+            }
+        }
+
+        return S_OK;
+    }
+}
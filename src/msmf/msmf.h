@@ -1,15 +1,126 @@
-#pragma once
-#include "ComUtils.h"
-#include "CaptureWindow.h"
-
-namespace console
-{
-    HRESULT DeviceList(bool verbose);
-    HRESULT DeviceMediaTypeList(ComPtr<IMFActivate>& pActivate, bool verbose);
-
-    HRESULT PrintBaseVideoMediaType(IMFMediaType * pMediaType, std::wostream& st);
-    HRESULT PrintMediaType(IMFMediaType * pMediaType);
-
-    HRESULT StartCapture(mf::CaptureWindow& window, ComPtr<IMFActivate>& pActivate, ULONG streamId, ULONG mediaId, bool inThread);
-    HRESULT DeviceCaptureOneByOne(ULONG timeoutSeconds);
-}
+#pragma once
+#include "ComUtils.h"
+#include "CaptureWindow.h"
+#include "MosaicWindow.h"
+#include "BenchRunner.h"
+#include "PlanScheduler.h"
+#include "SweepBaseline.h"
+#include "FrameVerifier.h"
+#include "MediaTypeCatalog.h"
+#include "MediaTypeFormatter.h"
+
+namespace console
+{
+    //
+    // Optional arguments of --capture
+    //
+    struct CaptureOptions
+    {
+        video::QueuePolicy queuePolicy = video::QueuePolicy::DropOldest;
+        size_t queueDepth = 4;
+        ULONG readDepth = 1;
+        bool checksum = false;  // --bench reads every byte of the frame
+        bool verify = false;    // --bench hashes every frame and checks the pattern
+        bool adaptiveDwell = true;  // --sweep stops each mode once its fps and jitter converge
+        video::TestPattern pattern = video::TestPattern::None; // expected by verify, drawn by the fake backend
+        std::wstring backend = L"mf";
+        std::wstring recordPath;
+        bool fullSpeed = false; // --replay ignores the recorded timing
+        bool timecode = false;  // the window burns the host clock into the frames
+        ULONG interval = 10;    // --soak samples every interval seconds
+        std::wstring outputPath = L"msmf-soak.csv"; // --soak time series, appended
+        std::wstring savePath;  // --sweep results of every mode, a baseline for --compare
+    };
+
+    //
+    // <device>:<StreamID>:<ModeID> of --mosaic and --soak
+    //
+    struct StreamSpec
+    {
+        std::wstring device;
+        ULONG streamId = 0;
+        ULONG mediaId = 0;
+    };
+
+    //
+    // Text lists the devices, json and csv list the media types of every device
+    //
+    HRESULT DeviceList(bool verbose, capture::OutputFormat format = capture::OutputFormat::Text);
+    HRESULT DeviceMediaTypeList(ComPtr<IMFActivate>& pActivate, capture::MediaTypeFormatter& formatter);
+
+    //
+    // Media types are listed from the catalog at CatalogPath,
+    // devices missing from it or with a changed driver are read again
+    //
+    std::wstring CatalogPath();
+    HRESULT PrintCachedMediaTypes(capture::StreamCache& cache, capture::Device& device, capture::MediaTypeFormatter& formatter);
+
+    //
+    // Media type attributes are formatted by the table in msmf.cpp
+    //
+    HRESULT FormatMediaType(IMFMediaType * pMediaType, capture::MediaTypeFormatter& formatter);
+    HRESULT PrintBaseVideoMediaType(IMFMediaType * pMediaType, std::wostream& st);
+    HRESULT PrintMediaType(IMFMediaType * pMediaType);
+    void PrintTimingReport(const video::TimingAnalyzer::Report& report, std::wostream& st);
+    void PrintLatencyReport(const video::LatencyTracker::Report& report, std::wostream& st);
+    void PrintFrameDiffReport(const video::FrameDiffDetector::Report& report, double seconds, std::wostream& st);
+    void PrintDwellReport(const video::DwellMonitor::Report& report, std::wostream& st);
+    void PrintBenchResult(const capture::BenchResult& result, std::wostream& st);
+    void PrintVerifyReport(const video::VerifySink& sink, std::wostream& st);
+    void PrintRecordStatistics(const video::RecordWriter::Statistics& stat, HRESULT hr, std::wostream& st);
+
+    HRESULT OpenSourceReader(
+        ComPtr<IMFActivate>& pActivate,
+        IMFSourceReaderCallback* pCallback,
+        ULONG streamId,
+        ULONG mediaId,
+        ComPtr<IMFSourceReader>& pReader,
+        ComPtr<IMFMediaType>& pType,
+        std::wstring& title);
+
+    HRESULT StartCapture(mf::CaptureWindow& window, ComPtr<IMFActivate>& pActivate, ULONG streamId, ULONG mediaId, bool inThread);
+
+    //
+    // The first device found by link, number or name, a warning if there are more
+    //
+    HRESULT OpenFirstDevice(capture::Backend& backend, const std::wstring& device, capture::DevicePtr& dev);
+    HRESULT StartBench(
+        capture::Backend& backend,
+        const std::wstring& device,
+        ULONG streamId,
+        ULONG mediaId,
+        ULONG seconds,
+        const CaptureOptions& options);
+    HRESULT StartMultiStreamBench(
+        capture::Backend& backend,
+        const std::wstring& device,
+        const std::vector<capture::StreamSelection>& selections,
+        ULONG seconds,
+        const CaptureOptions& options);
+    void PrintMultiStreamReport(const capture::StreamDispatcher::Report& report, std::wostream& st);
+    HRESULT StartMosaic(capture::Backend& backend, const std::vector<StreamSpec>& tiles, const CaptureOptions& options);
+    HRESULT StartSoak(capture::Backend& backend, const std::vector<StreamSpec>& streams, ULONG hours, const CaptureOptions& options);
+    HRESULT SweepBench(capture::Backend& backend, ULONG seconds, const CaptureOptions& options);
+
+    //
+    // The results of every mode are written to options.savePath when it is set
+    //
+    HRESULT SweepBench(
+        capture::Backend& backend,
+        ULONG seconds,
+        const CaptureOptions& options,
+        std::vector<capture::BaselineRecord>& records);
+
+    //
+    // Sweeps and compares every mode with the baseline written by --save
+    //
+    HRESULT CompareSweep(
+        capture::Backend& backend,
+        const std::wstring& baselinePath,
+        ULONG seconds,
+        const CaptureOptions& options,
+        size_t& regressions);
+    HRESULT RunCapturePlan(capture::Backend& backend, const std::wstring& path);
+    HRESULT StartReplay(const std::wstring& path, bool headless, const CaptureOptions& options);
+    HRESULT DeviceCaptureOneByOne(ULONG timeoutSeconds);
+}
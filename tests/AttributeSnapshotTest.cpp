@@ -0,0 +1,276 @@
+#include "TestHarness.h"
+#include "AttributeSnapshot.h"
+
+#include <cstddef>
+#include <cstring>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+using utils::AttributeSnapshot;
+using utils::AttributeType;
+
+namespace
+{
+    //
+    // Keys differing in Data1 only, and in the last byte only, as the
+    // Media Foundation attribute guids do. None is all zeros or all ones
+    //
+    GUID MakeKey(size_t i)
+    {
+        GUID key = { 0x10000000u + static_cast<uint32_t>(i) * 0x00010001u, 0x4e45, 0x11d0,
+            { 0x80, 0x00, 0x00, 0xaa, 0x00, 0x38, 0x9b, static_cast<uint8_t>(i) } };
+
+        if (i % 3 == 0)
+        {
+            key.Data1 = 0x7f000000u;
+        }
+
+        return key;
+    }
+
+    constexpr GUID Lowest = { 0, 0, 0, { 0, 0, 0, 0, 0, 0, 0, 0 } };
+    constexpr GUID Highest = { 0xffffffffu, 0xffff, 0xffff, { 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff } };
+
+    //
+    // The same ordering as the snapshot, bytes in memory order
+    //
+    struct KeyLess
+    {
+        bool operator()(const GUID& left, const GUID& right) const noexcept
+        {
+            return memcmp(&left, &right, sizeof(GUID)) < 0;
+        }
+    };
+
+    struct Value
+    {
+        AttributeType type;
+        uint64_t number;
+        std::wstring text;
+        std::vector<uint8_t> blob;
+    };
+}
+
+TEST_CASE(FirstValueOfAKeyWins)
+{
+    const GUID key = MakeKey(1);
+    AttributeSnapshot snapshot;
+    snapshot.AddUint32(key, 7);
+    snapshot.AddUint32(MakeKey(2), 1);
+    snapshot.AddString(key, L"second");
+    snapshot.AddUint32(key, 9);
+    snapshot.Seal();
+
+    CHECK(2 == snapshot.GetCount());
+
+    AttributeType type;
+    REQUIRE(snapshot.GetType(key, type));
+    CHECK(AttributeType::Uint32 == type);
+    CHECK(7 == snapshot.GetUint32Or(key, 0));
+    CHECK(snapshot.GetString(key).empty());
+}
+
+TEST_CASE(LookupsOfAnotherTypeFail)
+{
+    const GUID number = MakeKey(1);
+    const GUID text = MakeKey(2);
+    const GUID guid = MakeKey(4);
+    const GUID blob = MakeKey(5);
+    const uint8_t bytes[] = { 1, 2, 3 };
+
+    AttributeSnapshot snapshot;
+    snapshot.AddUint64(number, 1ull << 40);
+    snapshot.AddString(text, L"name");
+    snapshot.AddGuid(guid, MakeKey(100));
+    snapshot.AddBlob(blob, bytes, sizeof(bytes));
+    snapshot.Seal();
+
+    //
+    // A 64-bit value is not read as a 32-bit one
+    //
+    uint32_t u32 = 5;
+    CHECK(!snapshot.GetUint32(number, u32));
+    CHECK(5 == u32);
+    CHECK(11 == snapshot.GetUint32Or(number, 11));
+    CHECK(11 == snapshot.GetUint32Or(text, 11));
+
+    GUID value = Lowest;
+    CHECK(!snapshot.GetGuid(text, value));
+    CHECK(!snapshot.GetGuid(blob, value));
+    CHECK(Lowest == value);
+    CHECK(snapshot.GetGuid(guid, value));
+    CHECK(MakeKey(100) == value);
+
+    std::wstring_view view;
+    CHECK(!snapshot.GetString(guid, view));
+    CHECK(!snapshot.GetString(number, view));
+    CHECK(snapshot.GetString(blob).empty());
+    CHECK(L"name" == snapshot.GetString(text));
+
+    const uint8_t* data = nullptr;
+    size_t size = 0;
+    CHECK(!snapshot.GetBlob(text, data, size));
+    CHECK(!snapshot.GetBlob(number, data, size));
+    CHECK(nullptr == data && 0 == size);
+
+    double dbl = 0;
+    CHECK(!snapshot.GetDouble(number, dbl));
+}
+
+TEST_CASE(StringsAndBlobsOutliveLaterAdds)
+{
+    AttributeSnapshot snapshot;
+    snapshot.AddString(MakeKey(1), L"\\\\?\\usb#vid_046d&pid_0825#global");
+    snapshot.AddString(MakeKey(2), L"Webcam");
+
+    std::vector<uint8_t> blob(37);
+
+    for (size_t i = 0; i < blob.size(); ++i)
+    {
+        blob[i] = static_cast<uint8_t>(i * 7);
+    }
+
+    snapshot.AddBlob(MakeKey(3), blob.data(), 1);
+    snapshot.AddBlob(MakeKey(4), blob.data(), blob.size());
+    snapshot.AddBlob(MakeKey(5), nullptr, 0);
+
+    //
+    // Enough more strings and blobs to move both arenas
+    //
+    for (size_t i = 10; i < 200; ++i)
+    {
+        snapshot.AddString(MakeKey(i), std::wstring(i, L'x') + L"Webcam");
+        snapshot.AddBlob(MakeKey(i + 1000), blob.data(), i % blob.size());
+    }
+
+    snapshot.AddString(MakeKey(6), L"Webcam");
+    snapshot.Seal();
+
+    CHECK(L"\\\\?\\usb#vid_046d&pid_0825#global" == snapshot.GetString(MakeKey(1)));
+    CHECK(L"Webcam" == snapshot.GetString(MakeKey(2)));
+    CHECK(snapshot.GetString(MakeKey(2)).data() == snapshot.GetString(MakeKey(6)).data());
+    CHECK(std::wstring(199, L'x') + L"Webcam" == snapshot.GetString(MakeKey(199)));
+
+    const uint8_t* data = nullptr;
+    size_t size = 0;
+    REQUIRE(snapshot.GetBlob(MakeKey(4), data, size));
+    CHECK(blob.size() == size && 0 == memcmp(data, blob.data(), size));
+    CHECK(0 == reinterpret_cast<uintptr_t>(data) % alignof(std::max_align_t));
+
+    REQUIRE(snapshot.GetBlob(MakeKey(3), data, size));
+    CHECK(1 == size && 0 == data[0]);
+    CHECK(snapshot.GetBlob(MakeKey(5), data, size));
+    CHECK(0 == size);
+}
+
+TEST_CASE(MissingKeysAtTheEndsAreNotFound)
+{
+    AttributeSnapshot snapshot;
+    CHECK(!snapshot.Contains(Lowest));
+    CHECK(0 == snapshot.GetUint32Or(Highest, 0));
+
+    for (size_t i = 1; i < 30; ++i)
+    {
+        snapshot.AddUint32(MakeKey(i), static_cast<uint32_t>(i));
+    }
+
+    snapshot.Seal();
+    CHECK(!snapshot.Contains(Lowest));
+    CHECK(!snapshot.Contains(Highest));
+    CHECK(!snapshot.Contains(MakeKey(0)));
+    CHECK(!snapshot.Contains(MakeKey(30)));
+
+    AttributeType type;
+    CHECK(!snapshot.GetType(Highest, type));
+
+    //
+    // One item, a key on either side of it
+    //
+    snapshot.Clear();
+    CHECK(0 == snapshot.GetCount());
+    snapshot.AddUint32(MakeKey(2), 2);
+    snapshot.Seal();
+    CHECK(!snapshot.Contains(MakeKey(1)));
+    CHECK(!snapshot.Contains(MakeKey(4)));
+    CHECK(!snapshot.Contains(Lowest));
+    CHECK(!snapshot.Contains(Highest));
+    CHECK(2 == snapshot.GetUint32Or(MakeKey(2), 0));
+}
+
+TEST_CASE(LookupsMatchAMapReference)
+{
+    std::mt19937 random(15);
+
+    for (int round = 0; round < 200; ++round)
+    {
+        std::map<GUID, Value, KeyLess> reference;
+        AttributeSnapshot snapshot;
+        const size_t items = random() % 40;
+
+        for (size_t i = 0; i < items; ++i)
+        {
+            const GUID key = MakeKey(random() % 64);
+            Value value = { static_cast<AttributeType>(random() % 6), random(), {}, {} };
+
+            switch (value.type)
+            {
+            case AttributeType::Uint32: snapshot.AddUint32(key, static_cast<uint32_t>(value.number)); break;
+            case AttributeType::Uint64: snapshot.AddUint64(key, value.number << 20); break;
+            case AttributeType::Double: snapshot.AddDouble(key, value.number / 4.0); break;
+            case AttributeType::Guid: snapshot.AddGuid(key, MakeKey(value.number)); break;
+            case AttributeType::String:
+                value.text = std::to_wstring(value.number % 5);
+                snapshot.AddString(key, value.text);
+                break;
+            case AttributeType::Blob:
+                value.blob.assign(value.number % 20, static_cast<uint8_t>(value.number));
+                snapshot.AddBlob(key, value.blob.data(), value.blob.size());
+                break;
+            }
+
+            reference.emplace(key, value);
+        }
+
+        snapshot.Seal();
+        CHECK(reference.size() == snapshot.GetCount());
+
+        for (size_t i = 0; i < 64; ++i)
+        {
+            const GUID key = MakeKey(i);
+            const auto it = reference.find(key);
+            AttributeType type;
+
+            if (it == reference.end())
+            {
+                CHECK(!snapshot.Contains(key));
+                CHECK(!snapshot.GetType(key, type));
+                continue;
+            }
+
+            const Value& value = it->second;
+            REQUIRE(snapshot.GetType(key, type));
+            CHECK(value.type == type);
+
+            uint64_t u64 = 0;
+            double dbl = 0;
+            GUID guid = Lowest;
+            const uint8_t* data = nullptr;
+            size_t size = 0;
+
+            switch (value.type)
+            {
+            case AttributeType::Uint32: CHECK(static_cast<uint32_t>(value.number) == snapshot.GetUint32Or(key, 0)); break;
+            case AttributeType::Uint64: CHECK(snapshot.GetUint64(key, u64) && value.number << 20 == u64); break;
+            case AttributeType::Double: CHECK(snapshot.GetDouble(key, dbl) && value.number / 4.0 == dbl); break;
+            case AttributeType::Guid: CHECK(snapshot.GetGuid(key, guid) && MakeKey(value.number) == guid); break;
+            case AttributeType::String: CHECK(value.text == snapshot.GetString(key)); break;
+            case AttributeType::Blob:
+                CHECK(snapshot.GetBlob(key, data, size) && value.blob.size() == size);
+                CHECK(value.blob.empty() || 0 == memcmp(data, value.blob.data(), size));
+                break;
+            }
+        }
+    }
+}
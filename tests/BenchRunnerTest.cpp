@@ -0,0 +1,195 @@
+#include "TestHarness.h"
+#include "BenchRunner.h"
+#include "FakeBackend.h"
+
+#include <vector>
+
+using namespace capture;
+using video::PixelFormat;
+
+namespace
+{
+    constexpr uint64_t FrameLimit = 20;
+
+    std::vector<FakeBackend::DeviceConfig> SmallDevices()
+    {
+        FakeBackend::DeviceConfig device;
+        device.friendlyName = L"Small Camera";
+        device.symbolicLink = L"fake#small#0";
+        device.streams.resize(1);
+        device.streams[0].mediaTypes = {
+            FakeBackend::MakeMediaType(0, PixelFormat::NV12, 64, 48, 30),
+            FakeBackend::MakeMediaType(1, PixelFormat::YUY2, 33, 17, 60),
+        };
+
+        return { device };
+    }
+
+    //
+    // Frames as fast as the sink takes them, FrameLimit per stream
+    //
+    FakeBackend MakeBackend()
+    {
+        FakeBackend backend(SmallDevices());
+        backend.SetRealtime(false);
+        backend.SetFrameLimit(FrameLimit);
+        return backend;
+    }
+
+    class FailingSource : public FrameSource
+    {
+    public:
+        const MediaTypeInfo& GetMediaType() const noexcept override { return m_mediaType; }
+        HRESULT Start(video::FrameSink&, uint32_t) override { return E_FAIL; }
+        HRESULT Wait(uint32_t) override { return S_OK; }
+        HRESULT Stop() override { return S_OK; }
+
+    private:
+        MediaTypeInfo m_mediaType = FakeBackend::MakeMediaType(0, PixelFormat::NV12, 64, 48, 30);
+    };
+}
+
+TEST_CASE(NullSinkCountsFramesAndVisibleBytes)
+{
+    std::vector<uint8_t> buffer(64 * 48 * 2);
+    const video::FrameView frame = video::MakeFrameView(PixelFormat::NV12, 33, 17, buffer.data(), 64);
+
+    video::NullSink sink;
+    sink.OnFrame(frame, 0);
+    sink.OnFrame(frame, 1);
+
+    CHECK(2 == sink.GetFrames());
+    CHECK(sink.GetBytes() == 2 * (33 * 17 + 34 * 9));
+}
+
+TEST_CASE(ChecksumIgnoresRowPadding)
+{
+    std::vector<uint8_t> narrow(16 * 4);
+    std::vector<uint8_t> wide(32 * 4, 0xEE);
+
+    for (size_t row = 0; row < 4; ++row)
+    {
+        for (size_t x = 0; x < 16; ++x)
+        {
+            narrow[row * 16 + x] = static_cast<uint8_t>(row * 16 + x);
+            wide[row * 32 + x] = static_cast<uint8_t>(row * 16 + x);
+        }
+    }
+
+    const video::FrameView a = video::MakeFrameView(PixelFormat::YUY2, 8, 4, narrow.data(), 16);
+    const video::FrameView b = video::MakeFrameView(PixelFormat::YUY2, 8, 4, wide.data(), 32);
+    CHECK(video::ChecksumSink::FrameChecksum(a) == video::ChecksumSink::FrameChecksum(b));
+
+    wide[3 * 32 + 15] ^= 1;
+    CHECK(video::ChecksumSink::FrameChecksum(a) != video::ChecksumSink::FrameChecksum(b));
+}
+
+TEST_CASE(ChecksumSinkDependsOnTheFrameOrder)
+{
+    std::vector<uint8_t> first(16, 1);
+    std::vector<uint8_t> second(16, 2);
+    const video::FrameView a = video::MakeFrameView(PixelFormat::RGB32, 4, 1, first.data(), 16);
+    const video::FrameView b = video::MakeFrameView(PixelFormat::RGB32, 4, 1, second.data(), 16);
+
+    video::ChecksumSink ab;
+    ab.OnFrame(a, 0);
+    ab.OnFrame(b, 1);
+
+    video::ChecksumSink ba;
+    ba.OnFrame(b, 0);
+    ba.OnFrame(a, 1);
+
+    CHECK(2 == ab.GetFrames() && 32 == ab.GetBytes());
+    CHECK(ab.GetChecksum() != ba.GetChecksum());
+}
+
+TEST_CASE(BenchStatisticsReportsIntervalsAndCpu)
+{
+    using Clock = video::BenchStatistics::Clock;
+
+    video::BenchStatistics statistics(16);
+    const Clock::time_point start = Clock::now();
+    statistics.Start(start, 1.0);
+
+    //
+    // Ten frames 10 ms apart, the fifth one 30 ms late
+    //
+    Clock::time_point arrival = start;
+
+    for (int i = 0; i < 10; ++i)
+    {
+        arrival += std::chrono::milliseconds(i == 5 ? 40 : 10);
+        statistics.OnFrame(arrival);
+    }
+
+    statistics.Stop(start + std::chrono::seconds(1), 1.5);
+
+    const video::BenchStatistics::Report report = statistics.GetReport();
+    CHECK(10 == report.frames);
+    CHECK(report.seconds > 0.999 && report.seconds < 1.001);
+    CHECK(report.fps > 9.99 && report.fps < 10.01);
+    CHECK(report.intervalMin > 9.99 && report.intervalMin < 10.01);
+    CHECK(report.intervalP50 > 9.99 && report.intervalP50 < 10.01);
+    CHECK(report.intervalMax > 39.99 && report.intervalMax < 40.01);
+    CHECK(report.cpuSeconds > 0.499 && report.cpuSeconds < 0.501);
+    CHECK(report.cpuPerFrameMs > 49.9 && report.cpuPerFrameMs < 50.1);
+}
+
+TEST_CASE(RunBenchDeliversEveryFrameToTheSink)
+{
+    FakeBackend backend = MakeBackend();
+    DeviceList devices;
+    REQUIRE(SUCCEEDED(backend.EnumDevices(devices)) && 1 == devices.size());
+
+    std::unique_ptr<FrameSource> source;
+    REQUIRE(SUCCEEDED(devices[0]->OpenFrameSource(0, 0, source)));
+
+    video::ChecksumSink sink;
+    BenchResult result;
+    CHECK(S_OK == RunBench(*source, sink, 2, 0, result));
+
+    const uint64_t frameBytes = 64 * 48 + 64 * 24;
+    CHECK(FrameLimit == sink.GetFrames());
+    CHECK(FrameLimit == result.bench.frames);
+    CHECK(FrameLimit * frameBytes == sink.GetBytes());
+    CHECK(FrameLimit * frameBytes == result.bytes);
+    CHECK(FrameLimit == result.latency.frames);
+}
+
+TEST_CASE(RunBenchReturnsTheStartError)
+{
+    FailingSource source;
+    video::NullSink sink;
+    BenchResult result;
+
+    CHECK(E_FAIL == RunBench(source, sink, 2, 1, result));
+    CHECK(0 == sink.GetFrames());
+}
+
+TEST_CASE(SweepRunsEveryMediaTypeOnce)
+{
+    FakeBackend backend = MakeBackend();
+    video::NullSink sink;
+
+    std::vector<uint32_t> mediaTypes;
+    std::vector<uint64_t> frames;
+    bool failed = false;
+
+    const HRESULT hr = Sweep(backend, sink, 2, 0, false, [&](
+        Device& device,
+        const StreamInfo& stream,
+        const MediaTypeInfo& mediaType,
+        HRESULT result,
+        const BenchResult& bench)
+    {
+        failed |= FAILED(result) || device.GetSymbolicLink() != L"fake#small#0" || 0 != stream.index;
+        mediaTypes.push_back(mediaType.index);
+        frames.push_back(bench.bench.frames);
+    });
+
+    CHECK(S_OK == hr);
+    CHECK(!failed);
+    CHECK((mediaTypes == std::vector<uint32_t>{ 0, 1 }));
+    CHECK((frames == std::vector<uint64_t>{ FrameLimit, FrameLimit }));
+    CHECK(2 * FrameLimit == sink.GetFrames());
+}
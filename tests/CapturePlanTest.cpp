@@ -0,0 +1,204 @@
+#include "TestHarness.h"
+#include "TempRecording.h"
+#include "FakeBackend.h"
+#include "PlanScheduler.h"
+
+#include <fstream>
+#include <string>
+
+using namespace capture;
+using video::PixelFormat;
+
+namespace
+{
+    struct BadPlan
+    {
+        const char* text;
+        const char* error;
+    };
+
+    //
+    // Every malformed plan names the line and the reason
+    //
+    constexpr BadPlan BadPlans[] =
+    {
+        { "[device a]\nseconds = 0\n", "line 2: bad seconds '0'" },
+        { "seconds = 5s\n[device a]\n", "line 1: bad seconds '5s'" },
+        { "[device a]\nwidth = 1920-640\n", "line 2: bad width '1920-640'" },
+        { "[device a]\nfps = 30-\n", "line 2: bad fps '30-'" },
+        { "[device a]\nheight = 99999999999\n", "line 2: bad height '99999999999'" },
+        { "[device a]\nread-depth = 0\n", "line 2: bad read-depth '0'" },
+        { "[device a]\ndwell = sometimes\n", "line 2: bad dwell 'sometimes'" },
+        { "[device a]\nsink = fast\n", "line 2: bad sink 'fast'" },
+        { "[device a]\npattern = plaid\n", "line 2: bad pattern 'plaid'" },
+        { "[device a]\nstreams = 0, one\n", "line 2: bad stream 'one'" },
+        { "[device a]\nresolution = 640x480\n", "line 2: unknown key 'resolution'" },
+        { "# plan\n\n[device a]\nwidth 640\n", "line 4: expected <key> = <value>" },
+        { "[camera a]\n", "line 1: expected [device <name>]" },
+        { "[device a\n", "line 1: expected [device <name>]" },
+        { "[device  ]\n", "line 1: bad device name" },
+        { "concurrency = all\n[device a]\n", "line 1: bad concurrency 'all'" },
+        { "[device a]\nconcurrency = 2\n", "line 2: concurrency belongs before the first section" },
+        { "concurrency = 2\nseconds = 1\n", "no [device <name>] section" },
+        { "", "no [device <name>] section" },
+    };
+
+    FakeBackend MakeBackend()
+    {
+        std::vector<FakeBackend::DeviceConfig> devices(2);
+
+        for (size_t i = 0; i < devices.size(); ++i)
+        {
+            devices[i].friendlyName = L"Cam " + std::to_wstring(i);
+            devices[i].symbolicLink = L"fake#" + std::to_wstring(i);
+            devices[i].streams.resize(1);
+            devices[i].streams[0].mediaTypes = {
+                FakeBackend::MakeMediaType(0, PixelFormat::NV12, 640, 480, 30),
+                FakeBackend::MakeMediaType(1, PixelFormat::YUY2, 1280, 720, 60),
+                FakeBackend::MakeMediaType(2, PixelFormat::RGB32, 1920, 1080, 30),
+            };
+        }
+
+        FakeBackend backend(devices);
+        backend.SetRealtime(false);
+        backend.SetFrameLimit(20);
+        return backend;
+    }
+}
+
+TEST_CASE(PlanSectionsTakeTheDefaults)
+{
+    const char* text =
+        "\xEF\xBB\xBF# plan\n"
+        "concurrency = 2\n"
+        "seconds = 3\n"
+        "  sink = verify  \n"
+        "\n"
+        "[device Cam 0]\n"
+        "[device fake#1]\n"
+        "formats = nv12, MFVideoFormat_YUY2\n"
+        "streams = 0, 2\n"
+        "width = 640 - 1280\n"
+        "height = 720\n"
+        "fps = 29.97-60\n"
+        "dwell = fixed\n"
+        "read-depth = 4\n"
+        "sink = checksum\n"
+        "pattern = counter\n";
+
+    CapturePlan plan;
+    std::string error;
+    REQUIRE(S_OK == ParsePlan(text, plan, error));
+    CHECK(2 == plan.concurrency);
+    REQUIRE(2 == plan.entries.size());
+
+    const PlanEntry& first = plan.entries[0];
+    CHECK(L"Cam 0" == first.device);
+    CHECK(6 == first.line);
+    CHECK(3 == first.seconds);
+    CHECK(PlanSink::Verify == first.sink);
+    CHECK(first.adaptive && 1 == first.readDepth);
+    CHECK(first.streams.empty() && first.formats.empty());
+
+    //
+    // '#' inside a line is a part of the value, symbolic links contain it
+    //
+    const PlanEntry& second = plan.entries[1];
+    CHECK(L"fake#1" == second.device);
+    CHECK(7 == second.line);
+    CHECK(2 == second.formats.size() && L"nv12" == second.formats[0] && L"MFVideoFormat_YUY2" == second.formats[1]);
+    CHECK(2 == second.streams.size() && 2 == second.streams[1]);
+    CHECK(640 == second.width.min && 1280 == second.width.max);
+    CHECK(720 == second.height.min && 720 == second.height.max);
+    CHECK(29.97 == second.fps.min && 60 == second.fps.max);
+    CHECK(!second.adaptive && 4 == second.readDepth);
+    CHECK(PlanSink::Checksum == second.sink);
+    CHECK(video::TestPattern::Counter == second.pattern);
+    CHECK(3 == second.seconds);
+}
+
+TEST_CASE(ParseErrorsNameTheLine)
+{
+    for (const auto& bad : BadPlans)
+    {
+        CapturePlan plan;
+        plan.concurrency = 7;
+        std::string error;
+
+        CHECK(E_INVALIDARG == ParsePlan(bad.text, plan, error));
+        CHECK(bad.error == error);
+
+        //
+        // Nothing of a rejected plan is kept
+        //
+        CHECK(0 == plan.concurrency && plan.entries.empty());
+    }
+}
+
+TEST_CASE(LoadPlanReadsTheFile)
+{
+    test::TempRecording file(L"msmf_capture_plan_test.plan");
+    CapturePlan plan;
+    std::string error;
+
+    CHECK(E_FAIL == LoadPlan(file.Path(), plan, error));
+    CHECK("cannot open the plan file" == error);
+
+    {
+        std::ofstream out{ std::filesystem::path(file.Path()), std::ios::binary };
+        out << "seconds = 2\r\n[device Cam 1]\r\nformats = YUY2\r\n";
+    }
+
+    REQUIRE(S_OK == LoadPlan(file.Path(), plan, error));
+    REQUIRE(1 == plan.entries.size());
+    CHECK(L"Cam 1" == plan.entries[0].device);
+    CHECK(2 == plan.entries[0].seconds);
+    CHECK(1 == plan.entries[0].formats.size() && L"YUY2" == plan.entries[0].formats[0]);
+}
+
+TEST_CASE(ExpandPlanReportsWhatCannotRun)
+{
+    CapturePlan plan;
+    std::string error;
+    REQUIRE(S_OK == ParsePlan(
+        "[device Cam 0]\nwidth = 640-1280\n"
+        "[device missing]\n"
+        "[device Cam 1]\nwidth = 4000-5000\n"
+        "[device fake#1]\nformats = rgb32\n",
+        plan, error));
+
+    FakeBackend backend = MakeBackend();
+    std::vector<PlanJob> jobs;
+    REQUIRE(SUCCEEDED(ExpandPlan(backend, plan, jobs)));
+    REQUIRE(5 == jobs.size());
+
+    CHECK(0 == jobs[0].entry && S_OK == jobs[0].status && 0 == jobs[0].mediaType.index);
+    CHECK(0 == jobs[1].entry && S_OK == jobs[1].status && 1 == jobs[1].mediaType.index);
+    CHECK(1 == jobs[2].entry && FAILED(jobs[2].status) && !jobs[2].device);
+    CHECK(2 == jobs[3].entry && S_FALSE == jobs[3].status && jobs[3].device);
+    CHECK(3 == jobs[4].entry && S_OK == jobs[4].status && PixelFormat::RGB32 == jobs[4].mediaType.format);
+
+    //
+    // Only the runnable jobs capture, the others keep their status
+    //
+    std::vector<PlanResult> results;
+    size_t callbacks = 0;
+    REQUIRE(SUCCEEDED(RunPlan(backend, plan, jobs, results, [&](const PlanResult&) { callbacks += 1; })));
+    REQUIRE(jobs.size() == results.size());
+    CHECK(jobs.size() == callbacks);
+
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        if (S_OK == jobs[i].status)
+        {
+            CHECK(S_OK == results[i].hr);
+            CHECK(20 == results[i].bench.bench.frames);
+        }
+        else
+        {
+            CHECK(0 == results[i].bench.bench.frames);
+        }
+    }
+
+    CHECK(L"missing" == results[2].device);
+}
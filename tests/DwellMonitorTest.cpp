@@ -0,0 +1,245 @@
+#include "TestHarness.h"
+#include "DwellMonitor.h"
+
+#include <cmath>
+#include <vector>
+
+using namespace video;
+
+namespace
+{
+    //
+    // 30 fps in 100 ns timestamp units and in nanoseconds
+    //
+    constexpr int64_t FrameDuration = 333333;
+    constexpr int64_t FrameNs = FrameDuration * 100;
+    constexpr int64_t Start = 1000000000;
+
+    //
+    // The first five frames arrive in a burst and late, then every frame
+    // comes on time. Timestamps are regular throughout
+    //
+    int64_t Arrival(uint64_t frame)
+    {
+        constexpr int64_t warmup[] = { 40000000, 41000000, 42000000, 150000000, 160000000 };
+        return Start + (frame < 5 ? warmup[frame] : warmup[4] + static_cast<int64_t>(frame - 4) * FrameNs);
+    }
+
+    //
+    // Feeds frames until the monitor converges, returns the frames fed
+    //
+    uint64_t RunUntilConverged(DwellMonitor& monitor, uint64_t maxFrames)
+    {
+        monitor.Start(Start);
+
+        for (uint64_t frame = 0; frame < maxFrames; ++frame)
+        {
+            if (monitor.OnFrame(static_cast<int64_t>(frame) * FrameDuration, Arrival(frame)))
+            {
+                return frame + 1;
+            }
+        }
+
+        return maxFrames;
+    }
+
+    //
+    // 95% half-width of the mean by Student's t with the given quantile
+    //
+    double HalfWidth(const std::vector<double>& samples, double t)
+    {
+        double mean = 0;
+
+        for (double value : samples)
+        {
+            mean += value / samples.size();
+        }
+
+        double squares = 0;
+
+        for (double value : samples)
+        {
+            squares += (value - mean) * (value - mean);
+        }
+
+        return t * std::sqrt(squares / (samples.size() - 1) / samples.size());
+    }
+
+    //
+    // One interval per batch, alternating 25 and 40 fps, no jitter
+    //
+    class AlternatingStream
+    {
+    public:
+        explicit AlternatingStream(DwellMonitor& monitor)
+            : m_monitor(monitor)
+            , m_timestamp(0)
+            , m_arrival(Start)
+        {
+            m_monitor.Start(Start);
+            m_monitor.OnFrame(m_timestamp, m_arrival);
+        }
+
+        bool NextBatch()
+        {
+            const int64_t interval = m_fps.size() % 2 ? 25000000 : 40000000;
+            m_fps.push_back(1e9 / interval);
+            m_timestamp += interval / 100;
+            m_arrival += interval;
+            return m_monitor.OnFrame(m_timestamp, m_arrival);
+        }
+
+        const std::vector<double>& Fps() const noexcept { return m_fps; }
+
+    private:
+        DwellMonitor& m_monitor;
+        int64_t m_timestamp;
+        int64_t m_arrival;
+        std::vector<double> m_fps;
+    };
+
+    DwellMonitor::Settings OneIntervalBatches(double fpsTolerance, uint32_t minBatches)
+    {
+        DwellMonitor::Settings settings;
+        settings.fpsTolerance = fpsTolerance;
+        settings.warmupFrames = 1;
+        settings.batchFrames = 1;
+        settings.minBatches = minBatches;
+        return settings;
+    }
+}
+
+TEST_CASE(SteadyStreamConvergesAfterTheWarmup)
+{
+    //
+    // The 5 warm-up frames are not sampled, the first interval ends at
+    // frame 6 and 5 batches of 10 intervals close at frame 55
+    //
+    DwellMonitor monitor;
+    CHECK(55 == RunUntilConverged(monitor, 1000));
+
+    const DwellMonitor::Report report = monitor.GetReport();
+    CHECK(report.converged);
+    CHECK(55 == report.frames);
+    CHECK(5 == report.batches);
+    CHECK(std::abs(report.fps - 1e9 / FrameNs) < 1e-9);
+    CHECK(0 == report.fpsHalfWidth);
+    CHECK(0 == report.jitterUs && 0 == report.jitterHalfWidthUs);
+    CHECK(40 == report.firstFrameMs);
+    CHECK(std::abs(report.seconds - (Arrival(54) - Start) / 1e9) < 1e-12);
+}
+
+TEST_CASE(WarmupFramesAreCutOff)
+{
+    //
+    // Without a warm-up the burst is sampled: its batch is off and the
+    // interval holds the convergence back
+    //
+    DwellMonitor::Settings settings;
+    settings.warmupFrames = 0;
+    DwellMonitor unwarmed(settings);
+    CHECK(RunUntilConverged(unwarmed, 55) == 55);
+    CHECK(!unwarmed.IsConverged());
+
+    const DwellMonitor::Report report = unwarmed.GetReport();
+    CHECK(5 == report.batches);
+    CHECK(report.fpsHalfWidth > 0);
+    CHECK(report.jitterUs > 0);
+
+    //
+    // A warm-up longer than the burst gives the same batches, later
+    //
+    settings.warmupFrames = 8;
+    DwellMonitor longer(settings);
+    CHECK(58 == RunUntilConverged(longer, 1000));
+}
+
+TEST_CASE(HalfWidthsFollowStudentsT)
+{
+    DwellMonitor monitor(OneIntervalBatches(0.01, 1000));
+    AlternatingStream stream(monitor);
+
+    //
+    // The quantile for n - 1 degrees of freedom, the normal one past 30
+    //
+    const struct { size_t batches; double t; } quantiles[] =
+    {
+        { 2, 12.706 }, { 3, 4.303 }, { 5, 2.776 }, { 11, 2.228 }, { 31, 2.042 }, { 32, 1.96 }, { 60, 1.96 },
+    };
+
+    CHECK(0 == monitor.GetReport().fpsHalfWidth);
+
+    for (const auto& quantile : quantiles)
+    {
+        while (stream.Fps().size() < quantile.batches)
+        {
+            stream.NextBatch();
+        }
+
+        const DwellMonitor::Report report = monitor.GetReport();
+        CHECK(quantile.batches == report.batches);
+        CHECK(std::abs(report.fpsHalfWidth - HalfWidth(stream.Fps(), quantile.t)) < 1e-9);
+        CHECK(0 == report.jitterHalfWidthUs);
+    }
+
+    CHECK(!monitor.IsConverged());
+}
+
+TEST_CASE(ConvergenceWaitsForTheTInterval)
+{
+    //
+    // The 25/40 fps batches are within 25% after 7 batches with Student's t,
+    // the normal quantile would stop at 5
+    //
+    DwellMonitor monitor(OneIntervalBatches(0.25, 2));
+    AlternatingStream stream(monitor);
+    size_t batches = 0;
+
+    while (!stream.NextBatch() && batches < 100)
+    {
+        batches += 1;
+
+        const DwellMonitor::Report report = monitor.GetReport();
+
+        if (report.batches >= 2)
+        {
+            CHECK(report.fpsHalfWidth > 0.25 * report.fps);
+        }
+    }
+
+    CHECK(7 == stream.Fps().size());
+
+    const DwellMonitor::Report report = monitor.GetReport();
+    CHECK(report.converged);
+    CHECK(report.fpsHalfWidth <= 0.25 * report.fps);
+
+    //
+    // The first five batches average 31 fps
+    //
+    const std::vector<double> five(stream.Fps().begin(), stream.Fps().begin() + 5);
+    CHECK(HalfWidth(five, 1.96) <= 0.25 * 31);
+    CHECK(HalfWidth(five, 2.776) > 0.25 * 31);
+}
+
+TEST_CASE(IdleAndBurstStreamsAreNotSampled)
+{
+    DwellMonitor idle;
+    idle.Start(5);
+    CHECK(!idle.GetReport().converged);
+    CHECK(idle.GetReport().firstFrameMs < 0);
+    CHECK(0 == idle.GetReport().frames);
+
+    //
+    // Frames delivered all at once have no rate
+    //
+    DwellMonitor burst;
+    burst.Start(0);
+
+    for (int64_t i = 0; i < 1000; ++i)
+    {
+        burst.OnFrame(i * FrameDuration, 100);
+    }
+
+    CHECK(0 == burst.GetReport().batches);
+    CHECK(!burst.IsConverged());
+}
@@ -0,0 +1,255 @@
+#include "TestHarness.h"
+#include "FrameDiff.h"
+
+#include <cstring>
+#include <random>
+#include <vector>
+
+using namespace video;
+using Result = FrameDiffDetector::Result;
+
+namespace
+{
+    constexpr uint32_t Width = 1920;
+    constexpr uint32_t Height = 1080;
+
+    //
+    // A YUY2 frame whose rows are padded by an odd number of bytes and start
+    // one byte into the buffer, so no tile row is aligned
+    //
+    struct Frame
+    {
+        static constexpr ptrdiff_t Stride = Width * 2 + 7;
+
+        std::vector<uint8_t> buffer = std::vector<uint8_t>(1 + Stride * Height);
+        FrameView view = MakeFrameView(PixelFormat::YUY2, Width, Height, buffer.data() + 1, Stride);
+
+        uint8_t* Row(uint32_t y) noexcept
+        {
+            return buffer.data() + 1 + Stride * y;
+        }
+
+        void Fill(std::mt19937& random)
+        {
+            for (auto& value : buffer)
+            {
+                value = static_cast<uint8_t>(random());
+            }
+        }
+
+        //
+        // Rows [first, last) take the content of another frame
+        //
+        void CopyRows(const Frame& other, uint32_t first, uint32_t last)
+        {
+            memcpy(Row(first), other.buffer.data() + 1 + Stride * first, Stride * (last - first));
+        }
+    };
+}
+
+TEST_CASE(SimdSumsEqualTheScalarOnes)
+{
+    FrameDiffDetector scalar(ConvertKernel::Scalar);
+    FrameDiffDetector simd(ConvertKernel::Auto);
+    CHECK(ConvertKernel::Scalar == scalar.GetKernel());
+    CHECK(PixelConverter::IsSimdAvailable() == (ConvertKernel::Sse2 == simd.GetKernel()));
+
+    std::mt19937 random(21);
+    Frame frame;
+
+    for (int i = 0; i < 20; ++i)
+    {
+        frame.Fill(random);
+        CHECK(scalar.OnFrame(frame.view) == simd.OnFrame(frame.view));
+        CHECK(scalar.GetLastSad() == simd.GetLastSad());
+    }
+
+    //
+    // The largest sums, every byte from 0 to 255 and back
+    //
+    const uint64_t MaxSad = uint64_t(FrameDiffDetector::GridRows) * FrameDiffDetector::GridColumns
+        * FrameDiffDetector::TileRows * FrameDiffDetector::TileBytes * 255;
+
+    memset(frame.buffer.data(), 0, frame.buffer.size());
+    scalar.OnFrame(frame.view);
+    simd.OnFrame(frame.view);
+
+    for (uint8_t value : { 255, 0 })
+    {
+        memset(frame.buffer.data(), value, frame.buffer.size());
+        scalar.OnFrame(frame.view);
+        simd.OnFrame(frame.view);
+        CHECK(MaxSad == scalar.GetLastSad());
+        CHECK(MaxSad == simd.GetLastSad());
+    }
+}
+
+TEST_CASE(RepeatedFramesAreFrozen)
+{
+    for (ConvertKernel kernel : { ConvertKernel::Scalar, ConvertKernel::Auto })
+    {
+        FrameDiffDetector detector(kernel);
+        std::mt19937 random(1);
+        Frame frame;
+
+        frame.Fill(random);
+        CHECK(Result::First == detector.OnFrame(frame.view));
+        frame.Fill(random);
+        CHECK(Result::Unique == detector.OnFrame(frame.view));
+        CHECK(Result::Frozen == detector.OnFrame(frame.view));
+        CHECK(Result::Frozen == detector.OnFrame(frame.view));
+        CHECK(0 == detector.GetLastSad());
+        frame.Fill(random);
+        CHECK(Result::Unique == detector.OnFrame(frame.view));
+        CHECK(Result::Frozen == detector.OnFrame(frame.view));
+
+        const FrameDiffDetector::Report report = detector.GetReport();
+        CHECK(6 == report.frames);
+        CHECK(3 == report.unique);
+        CHECK(3 == report.frozen);
+        CHECK(2 == report.frozenRuns);
+        CHECK(2 == report.longestRun);
+        CHECK(1 == report.currentRun);
+    }
+}
+
+TEST_CASE(OneStaleBandIsPartial)
+{
+    FrameDiffDetector detector;
+    std::mt19937 random(2);
+    Frame previous;
+    Frame frame;
+
+    previous.Fill(random);
+    CHECK(Result::First == detector.OnFrame(previous.view));
+
+    //
+    // Right after the first frame no row is known to change, a stale band
+    // may be a part of the scene
+    //
+    frame.Fill(random);
+    frame.CopyRows(previous, Height / 2, Height);
+    CHECK(Result::Unique == detector.OnFrame(frame.view));
+
+    //
+    // The bottom half changed, then was not written, as a torn buffer looks
+    //
+    previous.Fill(random);
+    CHECK(Result::Unique == detector.OnFrame(previous.view));
+    frame.Fill(random);
+    frame.CopyRows(previous, Height / 2, Height);
+    CHECK(Result::Partial == detector.OnFrame(frame.view));
+    CHECK(0 != detector.GetLastSad());
+
+    //
+    // So is a stale band in the middle after a fresh frame
+    //
+    previous.Fill(random);
+    CHECK(Result::Unique == detector.OnFrame(previous.view));
+    frame.Fill(random);
+    frame.CopyRows(previous, Height / 3, Height * 2 / 3);
+    CHECK(Result::Partial == detector.OnFrame(frame.view));
+
+    //
+    // A band growing from the rows stale last time is torn too
+    //
+    previous.Fill(random);
+    previous.CopyRows(frame, Height / 2, Height);
+    CHECK(Result::Partial == detector.OnFrame(previous.view));
+
+    const FrameDiffDetector::Report report = detector.GetReport();
+    CHECK(3 == report.partial);
+    CHECK(7 == report.unique);
+    CHECK(0 == report.frozen);
+}
+
+TEST_CASE(ConstantBandIsUnique)
+{
+    //
+    // A static banner at the bottom, or padding rows within the height,
+    // stays the same in every frame
+    //
+    FrameDiffDetector detector;
+    std::mt19937 random(5);
+    Frame banner;
+    Frame frame;
+    banner.Fill(random);
+
+    for (int i = 0; i < 20; ++i)
+    {
+        frame.Fill(random);
+        frame.CopyRows(banner, Height - Height / 8, Height);
+        const Result result = detector.OnFrame(frame.view);
+        CHECK((0 == i ? Result::First : Result::Unique) == result);
+    }
+
+    CHECK(0 == detector.GetReport().partial);
+
+    //
+    // A torn write above the banner joins it, the band has rows that
+    // changed last time
+    //
+    Frame torn;
+    torn.Fill(random);
+    torn.CopyRows(frame, Height / 2, Height);
+    CHECK(Result::Partial == detector.OnFrame(torn.view));
+}
+
+TEST_CASE(StaticPartsOfTheSceneAreUnique)
+{
+    FrameDiffDetector detector;
+    std::mt19937 random(3);
+    Frame previous;
+    Frame frame;
+
+    previous.Fill(random);
+    detector.OnFrame(previous.view);
+
+    //
+    // Two stale bands are not one torn write
+    //
+    frame.Fill(random);
+    frame.CopyRows(previous, 0, Height / 4);
+    frame.CopyRows(previous, Height * 3 / 4, Height);
+    CHECK(Result::Unique == detector.OnFrame(frame.view));
+
+    //
+    // A static strip on the left, in every tile row, is a letterbox
+    //
+    previous.Fill(random);
+
+    for (uint32_t y = 0; y < Height; ++y)
+    {
+        memcpy(previous.Row(y), frame.Row(y), FrameDiffDetector::TileBytes);
+    }
+
+    CHECK(Result::Unique == detector.OnFrame(previous.view));
+    CHECK(0 == detector.GetReport().partial);
+}
+
+TEST_CASE(NewFormatsStartOver)
+{
+    FrameDiffDetector detector;
+    std::mt19937 random(4);
+    Frame frame;
+    frame.Fill(random);
+
+    CHECK(Result::First == detector.OnFrame(frame.view));
+    CHECK(Result::Frozen == detector.OnFrame(frame.view));
+
+    //
+    // The same bytes seen as another size, then a frame too small to sample
+    //
+    FrameView smaller = frame.view;
+    smaller.height = Height / 2;
+    CHECK(Result::First == detector.OnFrame(smaller));
+
+    std::vector<uint8_t> tiny(16 * 2);
+    CHECK(Result::First == detector.OnFrame(MakeFrameView(PixelFormat::YUY2, 8, 2, tiny.data(), 16)));
+    CHECK(Result::First == detector.OnFrame(frame.view));
+    CHECK(Result::Frozen == detector.OnFrame(frame.view));
+
+    detector.Reset();
+    CHECK(0 == detector.GetReport().frames);
+    CHECK(Result::First == detector.OnFrame(frame.view));
+}
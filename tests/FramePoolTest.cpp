@@ -0,0 +1,191 @@
+#include "TestHarness.h"
+#include "FramePool.h"
+
+#include <cstring>
+#include <thread>
+#include <vector>
+
+using namespace video;
+
+namespace
+{
+    const FrameFormat Nv12 = FramePool::AlignedFormat(PixelFormat::NV12, 640, 480);
+    const FrameFormat Yuy2 = FramePool::AlignedFormat(PixelFormat::YUY2, 1280, 720);
+}
+
+TEST_CASE(ReleasedBufferIsReusedWithoutAllocating)
+{
+    FramePool pool(Nv12.BufferSize() * 4);
+
+    uint8_t* data = nullptr;
+    {
+        FrameRef frame = pool.Acquire(Nv12);
+        REQUIRE(frame);
+        CHECK(0 == reinterpret_cast<uintptr_t>(frame->Data()) % FrameAlignment);
+        CHECK(frame->Size() == Nv12.BufferSize());
+
+        frame->timestamp = 42;
+        frame->flags = 1;
+        data = frame->Data();
+
+        FrameRef copy = frame;
+        CHECK(1 == pool.GetStatistics().outstanding);
+    }
+
+    FrameRef again = pool.Acquire(Nv12);
+    REQUIRE(again);
+    CHECK(again->Data() == data);
+    CHECK(0 == again->timestamp && 0 == again->flags);
+
+    const FramePool::Statistics stat = pool.GetStatistics();
+    CHECK(1 == stat.misses);
+    CHECK(1 == stat.hits);
+    CHECK(1 == stat.buffers);
+    CHECK(1 == stat.outstanding);
+}
+
+TEST_CASE(MemoryLimitRejectsOneBufferTooMany)
+{
+    FramePool pool(Nv12.BufferSize() * 3 + Nv12.BufferSize() / 2);
+    std::vector<FrameRef> held;
+
+    for (int i = 0; i < 3; ++i)
+    {
+        held.push_back(pool.Acquire(Nv12));
+        REQUIRE(held.back());
+    }
+
+    CHECK(!pool.Acquire(Nv12));
+
+    FramePool::Statistics stat = pool.GetStatistics();
+    CHECK(1 == stat.rejected);
+    CHECK(3 == stat.buffers);
+    CHECK(stat.bytes <= pool.GetMemoryLimit());
+    CHECK(stat.highWaterBytes == Nv12.BufferSize() * 3);
+
+    //
+    // A released buffer is served again although the pool is at its limit
+    //
+    held.pop_back();
+    CHECK(pool.Acquire(Nv12));
+
+    stat = pool.GetStatistics();
+    CHECK(1 == stat.hits);
+    CHECK(1 == stat.rejected);
+    CHECK(3 == stat.highWaterBuffers);
+}
+
+TEST_CASE(FormatChangeEvictsFreeBuffersOfTheOldFormat)
+{
+    REQUIRE(Yuy2.BufferSize() > Nv12.BufferSize());
+
+    FramePool pool(Yuy2.BufferSize() + Nv12.BufferSize());
+    {
+        FrameRef first = pool.Acquire(Nv12);
+        FrameRef second = pool.Acquire(Nv12);
+        REQUIRE(first && second);
+    }
+
+    FrameRef frame = pool.Acquire(Yuy2);
+    REQUIRE(frame);
+
+    const FramePool::Statistics stat = pool.GetStatistics();
+    CHECK(1 == stat.evicted);
+    CHECK(2 == stat.buffers);
+    CHECK(0 == stat.rejected);
+    CHECK(stat.bytes == Yuy2.BufferSize() + Nv12.BufferSize());
+}
+
+TEST_CASE(FormatChangeDoesNotEvictBuffersInUse)
+{
+    FramePool pool(Yuy2.BufferSize() + Nv12.BufferSize() / 2);
+
+    FrameRef held = pool.Acquire(Nv12);
+    REQUIRE(held);
+
+    CHECK(!pool.Acquire(Yuy2));
+
+    const FramePool::Statistics stat = pool.GetStatistics();
+    CHECK(0 == stat.evicted);
+    CHECK(1 == stat.rejected);
+    CHECK(1 == stat.buffers);
+    CHECK(1 == stat.outstanding);
+}
+
+TEST_CASE(TrimReleasesOnlyFreeBuffers)
+{
+    FramePool pool(Nv12.BufferSize() * 4);
+
+    FrameRef held = pool.Acquire(Nv12);
+    pool.Acquire(Nv12);
+    REQUIRE(2 == pool.GetStatistics().buffers);
+
+    pool.Trim();
+
+    const FramePool::Statistics stat = pool.GetStatistics();
+    CHECK(1 == stat.buffers);
+    CHECK(stat.bytes == Nv12.BufferSize());
+}
+
+TEST_CASE(CopyAlignsRowsAndKeepsThePixels)
+{
+    const uint32_t width = 33;
+    const uint32_t height = 5;
+    const ptrdiff_t stride = width + 3;
+
+    std::vector<uint8_t> src(stride * (height + (height + 1) / 2));
+
+    for (size_t i = 0; i < src.size(); ++i)
+    {
+        src[i] = static_cast<uint8_t>(i);
+    }
+
+    const FrameView frame = MakeFrameView(PixelFormat::NV12, width, height, src.data(), stride);
+
+    FramePool pool(1 << 20);
+    FrameRef copy = pool.Copy(frame);
+    REQUIRE(copy);
+
+    const FrameView view = copy->View();
+    CHECK(0 == view.planes[0].stride % FrameAlignment);
+
+    for (size_t plane = 0; plane < frame.planeCount; ++plane)
+    {
+        for (size_t row = 0; row < frame.Rows(plane); ++row)
+        {
+            CHECK(0 == memcmp(
+                view.planes[plane].data + view.planes[plane].stride * row,
+                frame.planes[plane].data + frame.planes[plane].stride * row,
+                frame.RowBytes(plane)));
+        }
+    }
+}
+
+TEST_CASE(ConcurrentAcquireAndReleaseBalance)
+{
+    FramePool pool(Nv12.BufferSize() * 8);
+    std::thread threads[4];
+
+    for (auto& thread : threads)
+    {
+        thread = std::thread([&pool]()
+        {
+            for (int i = 0; i < 2000; ++i)
+            {
+                FrameRef frame = pool.Acquire(Nv12);
+                FrameRef copy = frame;
+            }
+        });
+    }
+
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    const FramePool::Statistics stat = pool.GetStatistics();
+    CHECK(0 == stat.outstanding);
+    CHECK(0 == stat.rejected);
+    CHECK(stat.buffers <= 4);
+    CHECK(stat.hits + stat.misses == 8000);
+}
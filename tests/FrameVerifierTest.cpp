@@ -0,0 +1,337 @@
+#include "TestHarness.h"
+#include "FrameVerifier.h"
+
+#include <algorithm>
+#include <cstring>
+#include <random>
+#include <vector>
+
+using namespace video;
+using Result = PatternChecker::Result;
+using Issue = VerifySink::Issue;
+
+namespace
+{
+    //
+    // A frame in one buffer whose rows are padded by the given bytes,
+    // the padding filled with bytes no pattern draws
+    //
+    struct Frame
+    {
+        std::vector<uint8_t> buffer;
+        FrameView view;
+
+        Frame(PixelFormat format, uint32_t width, uint32_t height, size_t padding = 0)
+        {
+            const FrameView packed = MakeFrameView(format, width, height, nullptr, 0);
+            const ptrdiff_t stride = static_cast<ptrdiff_t>(packed.RowBytes(0) + padding);
+            buffer.assign(static_cast<size_t>(stride) * height * 2, 0xA5);
+            view = MakeFrameView(format, width, height, buffer.data(), stride);
+        }
+
+        uint8_t* Row(size_t plane, size_t y) noexcept
+        {
+            return const_cast<uint8_t*>(view.planes[plane].data) + view.planes[plane].stride * static_cast<ptrdiff_t>(y);
+        }
+
+        void Render(TestPattern pattern, uint64_t frameIndex)
+        {
+            RenderPattern(pattern, view, frameIndex);
+        }
+    };
+
+    uint64_t Hash(const uint8_t* data, size_t size, ConvertKernel kernel)
+    {
+        FrameHasher hasher(kernel);
+        hasher.Update(data, size);
+        return hasher.Final();
+    }
+
+    //
+    // The visible bytes of every plane packed into one buffer
+    //
+    std::vector<uint8_t> Pack(const FrameView& frame)
+    {
+        std::vector<uint8_t> bytes;
+
+        for (size_t plane = 0; plane < frame.planeCount; ++plane)
+        {
+            for (size_t y = 0; y < frame.Rows(plane); ++y)
+            {
+                const uint8_t* row = frame.planes[plane].data + frame.planes[plane].stride * static_cast<ptrdiff_t>(y);
+                bytes.insert(bytes.end(), row, row + frame.RowBytes(plane));
+            }
+        }
+
+        return bytes;
+    }
+}
+
+TEST_CASE(SimdHashEqualsTheScalarOne)
+{
+    FrameHasher simd;
+    CHECK(PixelConverter::IsSimdAvailable() == (ConvertKernel::Sse2 == simd.GetKernel()));
+    CHECK(ConvertKernel::Scalar == FrameHasher(ConvertKernel::Scalar).GetKernel());
+
+    std::mt19937 random(20);
+    std::vector<uint8_t> data(5000);
+
+    for (auto& value : data)
+    {
+        value = static_cast<uint8_t>(random());
+    }
+
+    //
+    // Tails shorter than a stripe, stripes across the 1 KB scramble
+    //
+    for (size_t size : { 0, 1, 7, 63, 64, 65, 127, 1023, 1024, 1025, 1089, 4999 })
+    {
+        const uint64_t scalar = Hash(data.data(), size, ConvertKernel::Scalar);
+        CHECK(scalar == Hash(data.data(), size, ConvertKernel::Auto));
+
+        //
+        // In pieces of any size, from any alignment
+        //
+        FrameHasher pieces;
+        size_t offset = 0;
+
+        while (offset < size)
+        {
+            const size_t piece = std::min<size_t>(random() % 150, size - offset);
+            pieces.Update(data.data() + offset, piece);
+            offset += piece;
+        }
+
+        CHECK(scalar == pieces.Final());
+
+        std::vector<uint8_t> unaligned(size + 1);
+        std::copy(data.begin(), data.begin() + size, unaligned.begin() + 1);
+        CHECK(scalar == Hash(unaligned.data() + 1, size, ConvertKernel::Auto));
+    }
+
+    //
+    // Every byte counts, trailing zeros too
+    //
+    std::vector<uint8_t> zeros(100);
+    CHECK(Hash(zeros.data(), 99, ConvertKernel::Auto) != Hash(zeros.data(), 100, ConvertKernel::Auto));
+    CHECK(Hash(zeros.data(), 0, ConvertKernel::Auto) != Hash(zeros.data(), 1, ConvertKernel::Auto));
+
+    const uint64_t before = Hash(data.data(), 4999, ConvertKernel::Auto);
+    data[4000] ^= 1;
+    CHECK(before != Hash(data.data(), 4999, ConvertKernel::Auto));
+}
+
+TEST_CASE(FrameHashIgnoresTheStride)
+{
+    std::mt19937 random(21);
+
+    //
+    // Odd widths, rows that are not whole stripes, padding of odd sizes
+    //
+    const struct { PixelFormat format; uint32_t width; uint32_t height; } frames[] =
+    {
+        { PixelFormat::RGB24, 333, 17 },
+        { PixelFormat::YUY2, 250, 9 },
+        { PixelFormat::NV12, 90, 30 },
+        { PixelFormat::I420, 64, 16 },
+        { PixelFormat::RGB32, 7, 5 },
+    };
+
+    for (const auto& size : frames)
+    {
+        Frame packed(size.format, size.width, size.height);
+
+        for (auto& value : packed.buffer)
+        {
+            value = static_cast<uint8_t>(random());
+        }
+
+        const uint64_t hash = FrameHasher::HashFrame(packed.view, ConvertKernel::Scalar);
+        const std::vector<uint8_t> bytes = Pack(packed.view);
+        CHECK(hash == Hash(bytes.data(), bytes.size(), ConvertKernel::Scalar));
+        CHECK(hash == FrameHasher::HashFrame(packed.view, ConvertKernel::Auto));
+
+        for (size_t padding : { 1, 13, 64 })
+        {
+            Frame padded(size.format, size.width, size.height, padding);
+
+            for (size_t plane = 0; plane < padded.view.planeCount; ++plane)
+            {
+                for (size_t y = 0; y < padded.view.Rows(plane); ++y)
+                {
+                    memcpy(padded.Row(plane, y), packed.Row(plane, y), padded.view.RowBytes(plane));
+                }
+            }
+
+            CHECK(hash == FrameHasher::HashFrame(padded.view, ConvertKernel::Scalar));
+            CHECK(hash == FrameHasher::HashFrame(padded.view, ConvertKernel::Auto));
+
+            //
+            // Padding is not hashed
+            //
+            padded.Row(0, 0)[padded.view.RowBytes(0)] ^= 0xFF;
+            CHECK(hash == FrameHasher::HashFrame(padded.view, ConvertKernel::Auto));
+        }
+
+        //
+        // The same rows bottom-up
+        //
+        if (1 == packed.view.planeCount)
+        {
+            FrameView bottomUp = packed.view;
+            bottomUp.planes[0].data = packed.Row(0, size.height - 1);
+            bottomUp.planes[0].stride = -packed.view.planes[0].stride;
+            const std::vector<uint8_t> flipped = Pack(bottomUp);
+            CHECK(Hash(flipped.data(), flipped.size(), ConvertKernel::Scalar) == FrameHasher::HashFrame(bottomUp, ConvertKernel::Auto));
+            CHECK(hash != FrameHasher::HashFrame(bottomUp, ConvertKernel::Auto));
+        }
+    }
+}
+
+TEST_CASE(RenderedPatternsMatch)
+{
+    for (PixelFormat format : { PixelFormat::NV12, PixelFormat::I420, PixelFormat::YUY2, PixelFormat::UYVY, PixelFormat::RGB32 })
+    {
+        for (TestPattern pattern : { TestPattern::Gradient, TestPattern::ColorBars, TestPattern::Counter })
+        {
+            Frame frame(format, 640, 360, 32);
+            PatternChecker checker(pattern);
+
+            for (uint64_t i = 0; i < 70; ++i)
+            {
+                frame.Render(pattern, i);
+
+                uint32_t row = 7;
+                uint64_t skipped = 7;
+                const Result result = checker.Check(frame.view, row, skipped);
+
+                //
+                // The gradient wraps after 64 frames and still advances by one
+                //
+                CHECK(Result::Match == result);
+                CHECK(0 == row && 0 == skipped);
+            }
+        }
+    }
+}
+
+TEST_CASE(CorruptRowsAreFound)
+{
+    Frame frame(PixelFormat::YUY2, 640, 360, 16);
+    frame.Render(TestPattern::Gradient, 3);
+
+    PatternChecker checker(TestPattern::Gradient);
+    uint32_t row = 0;
+    uint64_t skipped = 0;
+    CHECK(Result::Match == checker.Check(frame.view, row, skipped));
+
+    frame.Render(TestPattern::Gradient, 4);
+    frame.Row(0, 123)[639 * 2] ^= 0x10;
+    frame.Row(0, 200)[0] ^= 0x10;
+    CHECK(Result::Mismatch == checker.Check(frame.view, row, skipped));
+    CHECK(123 == row);
+
+    //
+    // A chroma row is reported as the luma row it belongs to
+    //
+    Frame nv12(PixelFormat::NV12, 640, 360, 16);
+    nv12.Render(TestPattern::Gradient, 0);
+    nv12.Row(1, 50)[101] = 0;
+    CHECK(Result::Mismatch == PatternChecker(TestPattern::Gradient).Check(nv12.view, row, skipped));
+    CHECK(100 == row);
+
+    Frame bars(PixelFormat::RGB32, 640, 360);
+    bars.Render(TestPattern::ColorBars, 0);
+    bars.Row(0, 77)[340 * 4] ^= 0x80;
+    CHECK(Result::Mismatch == PatternChecker(TestPattern::ColorBars).Check(bars.view, row, skipped));
+    CHECK(77 == row);
+
+    //
+    // A blurred counter cell is not read as a number
+    //
+    Frame counter(PixelFormat::NV12, 640, 360);
+    counter.Render(TestPattern::Counter, 5);
+    counter.Row(0, 0)[CounterCellBytes * 31 + 3] = 128;
+    CHECK(Result::Mismatch == PatternChecker(TestPattern::Counter).Check(counter.view, row, skipped));
+}
+
+TEST_CASE(CounterJumpsAreSkips)
+{
+    Frame frame(PixelFormat::NV12, 640, 360, 8);
+    PatternChecker checker(TestPattern::Counter);
+    uint32_t row = 0;
+    uint64_t skipped = 0;
+
+    const struct { uint64_t frame; Result result; uint64_t skipped; } steps[] =
+    {
+        { 1000, Result::Match, 0 },
+        { 1001, Result::Match, 0 },
+        { 1004, Result::Skipped, 2 },
+        { 1004, Result::Repeated, 0 },
+        { 1005, Result::Match, 0 },
+        { 1003, Result::Mismatch, 0 },
+        { 1100, Result::Skipped, 96 },
+    };
+
+    for (const auto& step : steps)
+    {
+        frame.Render(TestPattern::Counter, step.frame);
+        CHECK(step.result == checker.Check(frame.view, row, skipped));
+        CHECK(step.skipped == skipped);
+    }
+}
+
+TEST_CASE(SinkReportsRepeatsAndSkips)
+{
+    Frame frame(PixelFormat::YUY2, 320, 240, 4);
+    VerifySink sink(TestPattern::Counter);
+    int64_t timestamp = 0;
+
+    //
+    // Frame 2 twice, then 3 and 4 missing
+    //
+    for (uint64_t i : { 0, 1, 2, 2, 5, 6 })
+    {
+        frame.Render(TestPattern::Counter, i);
+        sink.OnFrame(frame.view, timestamp);
+        timestamp += 333333;
+    }
+
+    const VerifySink::Report report = sink.GetReport();
+    CHECK(6 == report.frames);
+    CHECK(6 * frame.view.Bytes() == report.bytes);
+    CHECK(1 == report.identical);
+    CHECK(2 == report.skipped);
+    CHECK(0 == report.mismatched && 0 == report.repeated);
+
+    const std::vector<VerifySink::Event>& events = sink.GetEvents();
+    REQUIRE(2 == events.size());
+    CHECK(Issue::Identical == events[0].issue && 3 == events[0].frame && 3 * 333333 == events[0].timestamp);
+    CHECK(Issue::Skipped == events[1].issue && 4 == events[1].frame && 2 == events[1].skipped);
+
+    //
+    // The same frames with the scalar hash give the same stream hash
+    //
+    VerifySink scalar(TestPattern::Counter, ColorSpace(), ConvertKernel::Scalar);
+
+    for (uint64_t i : { 0, 1, 2, 2, 5, 6 })
+    {
+        frame.Render(TestPattern::Counter, i);
+        scalar.OnFrame(frame.view, 0);
+    }
+
+    CHECK(report.hash == scalar.GetReport().hash);
+
+    //
+    // Events beyond the limit are counted only
+    //
+    VerifySink frozen;
+
+    for (size_t i = 0; i < VerifySink::MaxEvents + 11; ++i)
+    {
+        frozen.OnFrame(frame.view, 0);
+    }
+
+    CHECK(VerifySink::MaxEvents == frozen.GetEvents().size());
+    CHECK(10 == frozen.GetReport().lostEvents);
+}
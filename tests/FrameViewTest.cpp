@@ -0,0 +1,73 @@
+#include "TestHarness.h"
+#include "FrameView.h"
+
+#include <vector>
+
+using namespace video;
+
+TEST_CASE(SpanBytesCountsTheStrideOfEveryPlane)
+{
+    std::vector<uint8_t> buffer(4096);
+
+    CHECK(MakeFrameView(PixelFormat::YUY2, 10, 3, buffer.data(), 32).SpanBytes() == 32 * 3);
+    CHECK(MakeFrameView(PixelFormat::YUY2, 10, 3, buffer.data() + 64, -32).SpanBytes() == 32 * 3);
+    CHECK(MakeFrameView(PixelFormat::NV12, 10, 5, buffer.data(), 16).SpanBytes() == 16 * 5 + 16 * 3);
+    CHECK(MakeFrameView(PixelFormat::I420, 10, 5, buffer.data(), 16).SpanBytes() == 16 * 5 + 8 * 3 * 2);
+}
+
+TEST_CASE(TopDownFrameFitsAnExactBuffer)
+{
+    std::vector<uint8_t> buffer(16 * 5 + 16 * 3);
+    const FrameView view = MakeFrameView(PixelFormat::NV12, 10, 5, buffer.data(), 16);
+
+    CHECK(FitsBuffer(view, buffer.data(), buffer.size()));
+    CHECK(!FitsBuffer(view, buffer.data(), buffer.size() - 1));
+}
+
+TEST_CASE(PlanarFrameFitsAnExactBuffer)
+{
+    std::vector<uint8_t> buffer(16 * 5 + 8 * 3 * 2);
+    const FrameView view = MakeFrameView(PixelFormat::I420, 10, 5, buffer.data(), 16);
+
+    CHECK(FitsBuffer(view, buffer.data(), buffer.size()));
+    CHECK(!FitsBuffer(view, buffer.data(), buffer.size() - 1));
+}
+
+TEST_CASE(FrameOffsetInTheBufferNeedsTheRowsAfterIt)
+{
+    std::vector<uint8_t> buffer(32 * 4);
+    const FrameView view = MakeFrameView(PixelFormat::RGB32, 8, 3, buffer.data() + 32, 32);
+
+    CHECK(FitsBuffer(view, buffer.data(), buffer.size()));
+    CHECK(!FitsBuffer(view, buffer.data() + 64, 64));
+    CHECK(!FitsBuffer(view, buffer.data(), buffer.size() - 1));
+}
+
+TEST_CASE(BottomUpFrameStartsAtTheLastRow)
+{
+    std::vector<uint8_t> buffer(32 * 3);
+
+    //
+    // The first row is the last one in memory, as the Lock path sets it up
+    //
+    const FrameView view = MakeFrameView(PixelFormat::RGB32, 8, 3, buffer.data() + 32 * 2, -32);
+    CHECK(FitsBuffer(view, buffer.data(), buffer.size()));
+    CHECK(!FitsBuffer(view, buffer.data(), buffer.size() - 1));
+
+    //
+    // A first row at the start of the buffer would read below it
+    //
+    const FrameView below = MakeFrameView(PixelFormat::RGB32, 8, 3, buffer.data(), -32);
+    CHECK(!FitsBuffer(below, buffer.data(), buffer.size()));
+
+    const FrameView past = MakeFrameView(PixelFormat::RGB32, 8, 3, buffer.data() + 32 * 3, -32);
+    CHECK(!FitsBuffer(past, buffer.data(), buffer.size()));
+}
+
+TEST_CASE(EmptyViewDoesNotFit)
+{
+    std::vector<uint8_t> buffer(64);
+
+    CHECK(!FitsBuffer(FrameView(), buffer.data(), buffer.size()));
+    CHECK(!FitsBuffer(MakeFrameView(PixelFormat::RGB32, 4, 0, buffer.data(), 16), buffer.data(), buffer.size()));
+}
@@ -0,0 +1,108 @@
+#include "TestHarness.h"
+#include "GuidRegistry.h"
+
+#include <algorithm>
+#include <random>
+#include <string>
+
+using utils::GuidName;
+using utils::GuidRegistry;
+
+namespace
+{
+    //
+    // About as many guids as the Media Foundation table, shaped like it:
+    // families sharing Data2..Data4 that differ in Data1 only (the
+    // FOURCC subtypes), and guids differing in the last byte only
+    //
+    constexpr size_t GuidCount = 180;
+
+    GUID MakeGuid(size_t i)
+    {
+        GUID guid = { 0x32595559u + static_cast<uint32_t>(i / 2) * 0x01000193u, 0x0000, 0x0010,
+            { 0x80, 0x00, 0x00, 0xaa, 0x00, 0x38, 0x9b, 0x71 } };
+
+        if (i % 2)
+        {
+            guid.Data2 = 0xc4a7;
+            guid.Data4[7] = static_cast<uint8_t>(i);
+        }
+
+        return guid;
+    }
+
+    struct Table
+    {
+        std::vector<std::wstring> names;
+        std::vector<GuidName> entries;
+
+        Table()
+        {
+            names.reserve(GuidCount);
+
+            for (size_t i = 0; i < GuidCount; ++i)
+            {
+                names.push_back(L"GUID_" + std::to_wstring(i));
+            }
+
+            for (size_t i = 0; i < GuidCount; ++i)
+            {
+                entries.push_back({ MakeGuid(i), names[i] });
+            }
+        }
+    };
+}
+
+TEST_CASE(EveryRegisteredGuidMapsBackToItsName)
+{
+    Table table;
+    GuidRegistry registry(table.entries);
+
+    CHECK(registry.GetCount() == GuidCount);
+
+    for (size_t i = 0; i < GuidCount; ++i)
+    {
+        CHECK(registry.Find(MakeGuid(i)) == table.names[i]);
+    }
+}
+
+TEST_CASE(LookupDoesNotDependOnTheListedOrder)
+{
+    Table table;
+    std::shuffle(table.entries.begin(), table.entries.end(), std::mt19937(7));
+    GuidRegistry registry(table.entries);
+
+    for (size_t i = 0; i < GuidCount; ++i)
+    {
+        CHECK(registry.Find(MakeGuid(i)) == table.names[i]);
+    }
+}
+
+TEST_CASE(UnknownGuidsAreEmpty)
+{
+    Table table;
+    GuidRegistry registry(table.entries);
+
+    GUID unknown = MakeGuid(4);
+    unknown.Data4[0] ^= 1;
+    CHECK(registry.Find(unknown).empty());
+
+    const GUID zero = {};
+    CHECK(registry.Find(zero).empty());
+
+    GuidRegistry empty({});
+    CHECK(empty.GetCount() == 0);
+    CHECK(empty.Find(MakeGuid(0)).empty());
+}
+
+TEST_CASE(DuplicatedGuidKeepsTheFirstName)
+{
+    const GUID guid = MakeGuid(10);
+    const GUID other = MakeGuid(11);
+
+    GuidRegistry registry({ { other, L"OTHER" }, { guid, L"FIRST" }, { guid, L"SECOND" }, { guid, L"THIRD" } });
+
+    CHECK(registry.GetCount() == 2);
+    CHECK(registry.Find(guid) == L"FIRST");
+    CHECK(registry.Find(other) == L"OTHER");
+}
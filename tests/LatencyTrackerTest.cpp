@@ -0,0 +1,185 @@
+#include "TestHarness.h"
+#include "BenchRunner.h"
+#include "FakeBackend.h"
+#include "LatencyTracker.h"
+
+#include <thread>
+#include <vector>
+
+using namespace video;
+using Span = LatencyTracker::Span;
+
+namespace
+{
+    constexpr int64_t Ms = 1000000;
+
+    //
+    // 2 ms from the device, 1 ms queued, 0.5 ms copying and 4.5 ms to present
+    //
+    FrameTimes MakeTimes(int64_t device)
+    {
+        FrameTimes times;
+        times.device = device;
+        times.arrival = 3 * Ms;
+        times.copyStart = 4 * Ms;
+        times.copyEnd = 4 * Ms + Ms / 2;
+        times.present = 9 * Ms;
+        return times;
+    }
+}
+
+TEST_CASE(EveryStageSpanIsMeasured)
+{
+    LatencyTracker tracker;
+    tracker.Record(MakeTimes(1 * Ms));
+
+    const LatencyTracker::Report report = tracker.GetReport();
+    CHECK(1 == report.frames);
+    CHECK(0 == report.unmapped);
+
+    for (size_t i = 0; i < static_cast<size_t>(Span::Count); ++i)
+    {
+        CHECK(1 == report.spans[i].count);
+    }
+
+    CHECK(2000 == report[Span::Device].max && 2000 == report[Span::Device].mean);
+    CHECK(1000 == report[Span::Queue].max);
+    CHECK(500 == report[Span::Copy].max);
+    CHECK(4500 == report[Span::Present].max);
+    CHECK(8000 == report[Span::Total].max);
+}
+
+TEST_CASE(StagesNotPassedAreLeftOut)
+{
+    LatencyTracker tracker;
+
+    //
+    // Not presented and no device time, the total runs from
+    // the arrival to the end of the copy
+    //
+    FrameTimes times = MakeTimes(0);
+    times.present = 0;
+    tracker.Record(times);
+
+    //
+    // A copy ending before it starts is not a span, the total
+    // ends at the copy end still
+    //
+    times.copyEnd = times.copyStart - 1;
+    tracker.Record(times);
+
+    const LatencyTracker::Report report = tracker.GetReport();
+    CHECK(2 == report.frames);
+    CHECK(0 == report.unmapped);
+    CHECK(0 == report[Span::Device].count);
+    CHECK(2 == report[Span::Queue].count);
+    CHECK(1 == report[Span::Copy].count);
+    CHECK(0 == report[Span::Present].count);
+    CHECK(2 == report[Span::Total].count);
+    CHECK(1500 == report[Span::Total].max);
+    CHECK(1249.5 == report[Span::Total].mean);
+}
+
+TEST_CASE(DeviceTimesOfAnotherClockAreUnmapped)
+{
+    LatencyTracker tracker;
+
+    //
+    // After the arrival, and older than the largest device latency
+    //
+    tracker.Record(MakeTimes(5 * Ms));
+    FrameTimes old = MakeTimes(1 * Ms);
+    old.arrival += LatencyTracker::MaxDeviceLatency;
+    old.copyStart = old.arrival;
+    old.copyEnd = old.arrival;
+    old.present = old.arrival;
+    tracker.Record(old);
+
+    const LatencyTracker::Report report = tracker.GetReport();
+    CHECK(2 == report.frames);
+    CHECK(2 == report.unmapped);
+    CHECK(0 == report[Span::Device].count);
+
+    //
+    // Their totals start at the arrival
+    //
+    CHECK(2 == report[Span::Total].count);
+    CHECK(6000 == report[Span::Total].max);
+}
+
+TEST_CASE(ResetStartsOver)
+{
+    LatencyTracker tracker;
+    tracker.Record(MakeTimes(5 * Ms));
+    tracker.Reset();
+    tracker.Record(MakeTimes(1 * Ms));
+
+    const LatencyTracker::Report report = tracker.GetReport();
+    CHECK(1 == report.frames);
+    CHECK(0 == report.unmapped);
+    CHECK(1 == report[Span::Device].count && 1 == report[Span::Total].count);
+    CHECK(8000 == report[Span::Total].max);
+}
+
+TEST_CASE(ThreadsRecordTogether)
+{
+    constexpr int Threads = 4;
+    constexpr int64_t Frames = 20000;
+    LatencyTracker tracker;
+    std::vector<std::thread> threads;
+
+    for (int t = 0; t < Threads; ++t)
+    {
+        threads.emplace_back([&tracker, t]
+        {
+            for (int64_t i = 0; i < Frames; ++i)
+            {
+                tracker.Record(MakeTimes((1 + t) * Ms / 2));
+            }
+        });
+    }
+
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    const LatencyTracker::Report report = tracker.GetReport();
+    CHECK(Threads * Frames == report.frames);
+    CHECK(Threads * Frames == report[Span::Device].count);
+    CHECK(Threads * Frames == report[Span::Total].count);
+    CHECK(2500 == report[Span::Device].max);
+    CHECK(8500 == report[Span::Total].max);
+}
+
+TEST_CASE(BenchReportsTheLatencyOfEveryFrame)
+{
+    capture::FakeBackend::DeviceConfig device;
+    device.friendlyName = L"Latency Camera";
+    device.symbolicLink = L"fake#latency#0";
+    device.streams.resize(1);
+    device.streams[0].mediaTypes = { capture::FakeBackend::MakeMediaType(0, PixelFormat::NV12, 64, 48, 60) };
+
+    capture::FakeBackend backend({ device });
+    backend.SetFrameLimit(10);
+
+    capture::DeviceList devices;
+    std::unique_ptr<capture::FrameSource> source;
+    REQUIRE(SUCCEEDED(backend.EnumDevices(devices)));
+    REQUIRE(S_OK == devices[0]->OpenFrameSource(0, 0, source));
+
+    NullSink sink;
+    capture::BenchResult result;
+    REQUIRE(S_OK == capture::RunBench(*source, sink, 1, 0, result));
+
+    //
+    // The sink is the copy, nothing is presented
+    //
+    const LatencyTracker::Report& latency = result.latency;
+    CHECK(10 == latency.frames);
+    CHECK(latency.frames == latency[Span::Device].count + latency.unmapped);
+    CHECK(latency.frames == latency[Span::Queue].count);
+    CHECK(latency.frames == latency[Span::Copy].count);
+    CHECK(0 == latency[Span::Present].count);
+    CHECK(latency.frames == latency[Span::Total].count);
+}
@@ -0,0 +1,356 @@
+#include "TestHarness.h"
+#include "PixelConvert.h"
+
+#include <algorithm>
+#include <cstring>
+#include <random>
+#include <vector>
+
+using namespace video;
+
+namespace
+{
+    constexpr PixelFormat SourceFormats[] =
+    {
+        PixelFormat::NV12,
+        PixelFormat::YUY2,
+        PixelFormat::UYVY,
+        PixelFormat::I420,
+        PixelFormat::YV12,
+        PixelFormat::RGB24,
+    };
+
+    //
+    // Widths around the 16 pixel SIMD block and odd sizes,
+    // where the scalar tail and the rounded up chroma take over
+    //
+    constexpr uint32_t Widths[] = { 1, 2, 3, 15, 16, 17, 31, 33, 47, 64, 101 };
+    constexpr uint32_t Heights[] = { 1, 2, 3, 5 };
+
+    //
+    // Strides are padded by an odd number of bytes so no row is aligned
+    //
+    constexpr ptrdiff_t Padding = 7;
+    constexpr uint8_t Guard = 0xA5;
+
+    struct Source
+    {
+        std::vector<uint8_t> buffer;
+        Plane planes[MaxPlanes];
+
+        Source(PixelFormat format, uint32_t width, uint32_t height, std::mt19937& random)
+        {
+            const uint32_t chromaWidth = (width + 1) / 2;
+            const uint32_t chromaHeight = (height + 1) / 2;
+
+            ptrdiff_t strides[MaxPlanes] = {};
+            uint32_t rows[MaxPlanes] = {};
+
+            switch (format)
+            {
+            case PixelFormat::NV12:
+                strides[0] = width + Padding;
+                strides[1] = chromaWidth * 2 + Padding;
+                rows[0] = height;
+                rows[1] = chromaHeight;
+                break;
+            case PixelFormat::I420:
+            case PixelFormat::YV12:
+                strides[0] = width + Padding;
+                strides[1] = strides[2] = chromaWidth + Padding;
+                rows[0] = height;
+                rows[1] = rows[2] = chromaHeight;
+                break;
+            case PixelFormat::RGB24:
+                strides[0] = width * 3 + Padding;
+                rows[0] = height;
+                break;
+            default:
+                strides[0] = chromaWidth * 4 + Padding;
+                rows[0] = height;
+                break;
+            }
+
+            size_t offsets[MaxPlanes] = {};
+            size_t size = 0;
+
+            for (size_t i = 0; i < MaxPlanes; ++i)
+            {
+                offsets[i] = size;
+                size += static_cast<size_t>(strides[i]) * rows[i];
+            }
+
+            buffer.resize(size);
+
+            for (auto& value : buffer)
+            {
+                value = static_cast<uint8_t>(random());
+            }
+
+            for (size_t i = 0; i < MaxPlanes; ++i)
+            {
+                planes[i] = { buffer.data() + offsets[i], strides[i] };
+            }
+        }
+    };
+
+    //
+    // The destination row is followed by guard bytes,
+    // a kernel writing past the row changes them
+    //
+    struct Destination
+    {
+        ptrdiff_t rowBytes;
+        ptrdiff_t stride;
+        std::vector<uint8_t> buffer;
+
+        Destination(PixelFormat format, uint32_t width, uint32_t height)
+            : rowBytes(format == PixelFormat::YUY2 ? ((width + 1) / 2) * 4 : width * 4)
+            , stride(rowBytes + Padding)
+            , buffer(static_cast<size_t>(stride) * height, Guard)
+        {
+        }
+
+        bool GuardsIntact() const
+        {
+            for (size_t row = 0; row < buffer.size() / stride; ++row)
+            {
+                for (ptrdiff_t x = rowBytes; x < stride; ++x)
+                {
+                    if (buffer[row * stride + x] != Guard)
+                    {
+                        return false;
+                    }
+                }
+            }
+
+            return true;
+        }
+    };
+
+    ColorSpace MakeColorSpace(int index)
+    {
+        ColorSpace colorSpace;
+        colorSpace.matrix = (index & 1) ? YuvMatrix::BT709 : YuvMatrix::BT601;
+        colorSpace.range = (index & 2) ? YuvRange::Full : YuvRange::Studio;
+        return colorSpace;
+    }
+
+    //
+    // Converts random frames of every size with both kernels,
+    // the SSE2 output must match the scalar reference byte for byte
+    //
+    void CheckSimdMatchesScalar(PixelFormat dstFormat)
+    {
+        std::mt19937 random(42);
+
+        for (PixelFormat srcFormat : SourceFormats)
+        {
+            //
+            // YUY2 to YUY2 is a copy and has no SIMD kernel
+            //
+            if (!PixelConverter::IsSupported(srcFormat, dstFormat) || srcFormat == dstFormat)
+            {
+                continue;
+            }
+
+            for (uint32_t width : Widths)
+            {
+                for (uint32_t height : Heights)
+                {
+                    for (int colorSpace = 0; colorSpace < 4; ++colorSpace)
+                    {
+                        const Source src(srcFormat, width, height, random);
+                        Destination scalar(dstFormat, width, height);
+                        Destination simd(dstFormat, width, height);
+
+                        const PixelConverter reference(srcFormat, dstFormat, width, height, MakeColorSpace(colorSpace), ConvertKernel::Scalar);
+                        const PixelConverter converter(srcFormat, dstFormat, width, height, MakeColorSpace(colorSpace), ConvertKernel::Sse2);
+
+                        REQUIRE(converter.GetKernel() == ConvertKernel::Sse2);
+                        REQUIRE(reference.Convert(src.planes, scalar.buffer.data(), scalar.stride));
+                        REQUIRE(converter.Convert(src.planes, simd.buffer.data(), simd.stride));
+
+                        if (!CHECK(scalar.buffer == simd.buffer) || !CHECK(simd.GuardsIntact()))
+                        {
+                            std::printf("  %ls -> %ls %ux%u color space %d\n",
+                                PixelFormatName(srcFormat), PixelFormatName(dstFormat), width, height, colorSpace);
+                            return;
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    //
+    // RGB to YUV in the fixed point the kernels use, written out from the
+    // coefficients: the chroma of a pair is that of its rounded mean color
+    //
+    uint8_t ToYuv(const int16_t* weights, int offset, int r, int g, int b)
+    {
+        return static_cast<uint8_t>(std::min(std::max(((weights[0] * r + weights[1] * g + weights[2] * b + 128) >> 8) + offset, 0), 255));
+    }
+
+    void Rgb24ToYuy2Reference(const YuvCoefficients& c, const uint8_t* rgb, uint32_t width, uint8_t* yuy2)
+    {
+        for (uint32_t x = 0; x < width; x += 2)
+        {
+            const uint8_t* p0 = rgb + x * 3;
+            const uint8_t* p1 = x + 1 < width ? p0 + 3 : p0;
+            const int r = (p0[2] + p1[2] + 1) / 2;
+            const int g = (p0[1] + p1[1] + 1) / 2;
+            const int b = (p0[0] + p1[0] + 1) / 2;
+
+            yuy2[x * 2 + 0] = ToYuv(c.toY, c.yOffset, p0[2], p0[1], p0[0]);
+            yuy2[x * 2 + 1] = ToYuv(c.toU, 128, r, g, b);
+            yuy2[x * 2 + 2] = ToYuv(c.toY, c.yOffset, p1[2], p1[1], p1[0]);
+            yuy2[x * 2 + 3] = ToYuv(c.toV, 128, r, g, b);
+        }
+    }
+}
+
+TEST_CASE(ToRgb32Sse2MatchesScalar)
+{
+    if (!PixelConverter::IsSimdAvailable())
+    {
+        return;
+    }
+
+    CheckSimdMatchesScalar(PixelFormat::RGB32);
+}
+
+TEST_CASE(ToYuy2Sse2MatchesScalar)
+{
+    if (!PixelConverter::IsSimdAvailable())
+    {
+        return;
+    }
+
+    CheckSimdMatchesScalar(PixelFormat::YUY2);
+}
+
+TEST_CASE(ScalarReferenceConvertsWhiteAndBlack)
+{
+    const uint8_t y[2] = { 235, 16 };
+    const uint8_t uv[2] = { 128, 128 };
+    const Plane planes[2] = { { y, 2 }, { uv, 2 } };
+    uint8_t bgra[8] = {};
+
+    REQUIRE(PixelConverter(PixelFormat::NV12, PixelFormat::RGB32, 2, 1, ColorSpace(), ConvertKernel::Scalar).Convert(planes, bgra, 8));
+
+    CHECK(bgra[0] >= 254 && bgra[1] >= 254 && bgra[2] >= 254 && bgra[3] == 0xFF);
+    CHECK(bgra[4] <= 1 && bgra[5] <= 1 && bgra[6] <= 1 && bgra[7] == 0xFF);
+}
+
+TEST_CASE(Yv12SwapsTheChromaPlanesOfI420)
+{
+    std::mt19937 random(3);
+    const uint32_t width = 33;
+    const uint32_t height = 5;
+
+    const Source i420(PixelFormat::I420, width, height, random);
+    Plane yv12[MaxPlanes] = { i420.planes[0], i420.planes[2], i420.planes[1] };
+
+    Destination fromI420(PixelFormat::RGB32, width, height);
+    Destination fromYv12(PixelFormat::RGB32, width, height);
+
+    REQUIRE(PixelConverter(PixelFormat::I420, PixelFormat::RGB32, width, height, ColorSpace()).Convert(i420.planes, fromI420.buffer.data(), fromI420.stride));
+    REQUIRE(PixelConverter(PixelFormat::YV12, PixelFormat::RGB32, width, height, ColorSpace()).Convert(yv12, fromYv12.buffer.data(), fromYv12.stride));
+
+    CHECK(fromI420.buffer == fromYv12.buffer);
+}
+
+TEST_CASE(Rgb24IsStoredBgr)
+{
+    //
+    // Two rows of two pixels, { B, G, R } in memory
+    //
+    const uint8_t rgb[2][6] = { { 1, 2, 3, 10, 20, 30 }, { 40, 50, 60, 70, 80, 90 } };
+    const uint8_t top[8] = { 1, 2, 3, 0xFF, 10, 20, 30, 0xFF };
+    const uint8_t bottom[8] = { 40, 50, 60, 0xFF, 70, 80, 90, 0xFF };
+
+    for (ConvertKernel kernel : { ConvertKernel::Scalar, ConvertKernel::Auto })
+    {
+        const PixelConverter converter(PixelFormat::RGB24, PixelFormat::RGB32, 2, 2, ColorSpace(), kernel);
+        uint8_t bgra[2][8] = {};
+
+        const Plane topDown[1] = { { rgb[0], 6 } };
+        REQUIRE(converter.Convert(topDown, bgra[0], 8));
+        CHECK(0 == memcmp(bgra[0], top, 8) && 0 == memcmp(bgra[1], bottom, 8));
+
+        //
+        // A bottom-up DIB: the first row in memory is the last one shown
+        //
+        const Plane bottomUp[1] = { { rgb[1], -6 } };
+        REQUIRE(converter.Convert(bottomUp, bgra[0], 8));
+        CHECK(0 == memcmp(bgra[0], bottom, 8) && 0 == memcmp(bgra[1], top, 8));
+    }
+}
+
+TEST_CASE(Rgb24ToYuy2FollowsTheMatrixAndRange)
+{
+    //
+    // Pure red and white in each color space, 16 pixels so SSE2 takes the row
+    //
+    const struct { uint8_t b, g, r; int colorSpace; uint8_t yuy2[4]; } cases[] =
+    {
+        { 0, 0, 255, 0, { 82, 90, 82, 240 } },      // BT.601 studio
+        { 0, 0, 255, 1, { 63, 102, 63, 240 } },     // BT.709 studio
+        { 255, 255, 255, 0, { 235, 128, 235, 128 } },
+        { 255, 255, 255, 2, { 255, 128, 255, 128 } }, // full range
+        { 0, 0, 0, 1, { 16, 128, 16, 128 } },
+        { 0, 0, 0, 3, { 0, 128, 0, 128 } },
+    };
+
+    for (const auto& test : cases)
+    {
+        std::vector<uint8_t> rgb;
+
+        for (int i = 0; i < 16; ++i)
+        {
+            rgb.insert(rgb.end(), { test.b, test.g, test.r });
+        }
+
+        for (ConvertKernel kernel : { ConvertKernel::Scalar, ConvertKernel::Auto })
+        {
+            const Plane planes[1] = { { rgb.data(), static_cast<ptrdiff_t>(rgb.size()) } };
+            uint8_t yuy2[32] = {};
+            REQUIRE(PixelConverter(PixelFormat::RGB24, PixelFormat::YUY2, 16, 1, MakeColorSpace(test.colorSpace), kernel).Convert(planes, yuy2, 32));
+
+            for (size_t i = 0; i < sizeof(yuy2); i += 4)
+            {
+                CHECK(0 == memcmp(yuy2 + i, test.yuy2, 4));
+            }
+        }
+    }
+
+    //
+    // Random rows of every width against the reference, both kernels
+    //
+    std::mt19937 random(24);
+
+    for (uint32_t width : Widths)
+    {
+        for (int colorSpace = 0; colorSpace < 4; ++colorSpace)
+        {
+            const Source src(PixelFormat::RGB24, width, 1, random);
+            const YuvCoefficients coeffs = GetYuvCoefficients(MakeColorSpace(colorSpace));
+
+            Destination expected(PixelFormat::YUY2, width, 1);
+            Rgb24ToYuy2Reference(coeffs, src.planes[0].data, width, expected.buffer.data());
+
+            for (ConvertKernel kernel : { ConvertKernel::Scalar, ConvertKernel::Auto })
+            {
+                Destination actual(PixelFormat::YUY2, width, 1);
+                REQUIRE(PixelConverter(PixelFormat::RGB24, PixelFormat::YUY2, width, 1, MakeColorSpace(colorSpace), kernel).Convert(src.planes, actual.buffer.data(), actual.stride));
+
+                if (!CHECK(expected.buffer == actual.buffer))
+                {
+                    std::printf("  width %u color space %d kernel %d\n", width, colorSpace, static_cast<int>(kernel));
+                    return;
+                }
+            }
+        }
+    }
+}
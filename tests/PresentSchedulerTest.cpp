@@ -0,0 +1,137 @@
+#include "TestHarness.h"
+#include "PresentScheduler.h"
+
+using namespace video;
+
+namespace
+{
+    constexpr int64_t Second = 1000000000;
+}
+
+TEST_CASE(NewestFrameWins)
+{
+    //
+    // 10 s of a 240 fps capture on a 60 Hz display, on a virtual clock.
+    // The caller keeps the newest frame and presents it when a tick is due
+    //
+    PresentScheduler scheduler;
+    scheduler.SetRefreshRate(60);
+    CHECK(Second / 60 == scheduler.GetPeriod());
+
+    constexpr int Frames = 2400;
+    int pending = -1;
+    int lastPresented = -1;
+    uint64_t presents = 0;
+
+    for (int i = 0; i < Frames; ++i)
+    {
+        scheduler.OnFrame();
+        pending = i;
+
+        if (scheduler.OnTick(i * Second / 240))
+        {
+            CHECK(pending > lastPresented);
+            CHECK(!scheduler.HasPending());
+            lastPresented = pending;
+            presents += 1;
+        }
+    }
+
+    const PresentScheduler::Statistics stat = scheduler.GetStatistics();
+    CHECK(Frames == stat.frames);
+    CHECK(presents == stat.presented);
+    CHECK(Frames == stat.presented + stat.skipped + (scheduler.HasPending() ? 1 : 0));
+    CHECK(stat.presented >= 595 && stat.presented <= 601);
+
+    //
+    // The frame left pending is the newest one, a later tick presents it
+    //
+    if (scheduler.HasPending())
+    {
+        CHECK(scheduler.OnTick(Frames * Second / 240 + Second));
+        CHECK(stat.skipped == scheduler.GetStatistics().skipped);
+    }
+}
+
+TEST_CASE(SlowCaptureIsPresentedWhole)
+{
+    PresentScheduler scheduler;
+    scheduler.SetRefreshRate(60);
+
+    for (int i = 0; i < 300; ++i)
+    {
+        scheduler.OnFrame();
+        CHECK(scheduler.OnTick(i * Second / 30));
+    }
+
+    CHECK(300 == scheduler.GetStatistics().presented);
+    CHECK(0 == scheduler.GetStatistics().skipped);
+    CHECK(PresentScheduler::WaitInfinite == scheduler.GetWaitTime(0));
+    CHECK(!scheduler.OnTick(300 * Second / 30));
+}
+
+TEST_CASE(PresentsFollowTheDisplayPeriod)
+{
+    constexpr int64_t Period = 16000000;
+    PresentScheduler scheduler(Period);
+
+    scheduler.OnFrame();
+    CHECK(0 == scheduler.GetWaitTime(100));
+    CHECK(scheduler.OnTick(100));
+
+    //
+    // The next frame waits for the next period of the schedule
+    //
+    scheduler.OnFrame();
+    CHECK(!scheduler.OnTick(200));
+    CHECK(Period + 100 - 200 == scheduler.GetWaitTime(200));
+    CHECK(scheduler.OnTick(Period + 100));
+
+    scheduler.OnFrame();
+    CHECK(2 * Period + 100 - (Period + 200) == scheduler.GetWaitTime(Period + 200));
+
+    //
+    // A frame after an idle time is presented at once and starts a new
+    // schedule, the display is not caught up by presenting twice
+    //
+    CHECK(scheduler.OnTick(100000000));
+    scheduler.OnFrame();
+    CHECK(!scheduler.OnTick(100000001));
+    CHECK(Period - 1 == scheduler.GetWaitTime(100000001));
+}
+
+TEST_CASE(ZeroPeriodPresentsEveryFrame)
+{
+    PresentScheduler scheduler;
+    CHECK(0 == scheduler.GetPeriod());
+
+    for (int i = 0; i < 10; ++i)
+    {
+        scheduler.OnFrame();
+        CHECK(0 == scheduler.GetWaitTime(5));
+        CHECK(scheduler.OnTick(5));
+    }
+
+    CHECK(10 == scheduler.GetStatistics().presented);
+
+    scheduler.SetPeriod(-5);
+    CHECK(0 == scheduler.GetPeriod());
+    scheduler.SetRefreshRate(0);
+    CHECK(0 == scheduler.GetPeriod());
+}
+
+TEST_CASE(ResetDropsThePendingFrame)
+{
+    PresentScheduler scheduler(1000);
+    scheduler.OnFrame();
+    scheduler.OnFrame();
+    CHECK(1 == scheduler.GetStatistics().skipped);
+
+    scheduler.Reset();
+    CHECK(!scheduler.HasPending());
+    CHECK(0 == scheduler.GetStatistics().frames);
+    CHECK(!scheduler.OnTick(0));
+
+    scheduler.OnFrame();
+    CHECK(scheduler.OnTick(0));
+}
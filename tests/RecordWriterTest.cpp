@@ -0,0 +1,187 @@
+#include "TestHarness.h"
+#include "TempRecording.h"
+#include "RecordWriter.h"
+
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+using namespace video;
+
+namespace
+{
+    constexpr uint32_t Width = 33;
+    constexpr uint32_t Height = 17;
+    constexpr int FrameCount = 16;
+
+    std::vector<uint8_t> ReadFile(const std::wstring& path)
+    {
+        std::ifstream file(std::filesystem::path(path), std::ios::binary);
+        return std::vector<uint8_t>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+
+    //
+    // A pooled NV12 frame filled with one byte value per frame
+    //
+    FrameRef MakeFrame(FramePool& pool, int index)
+    {
+        FrameRef frame = pool.Acquire(FramePool::AlignedFormat(PixelFormat::NV12, Width, Height));
+
+        if (frame)
+        {
+            memset(frame->Data(), index + 1, frame->Size());
+            frame->timestamp = index * 333333;
+            frame->flags = static_cast<uint32_t>(index % 2);
+        }
+
+        return frame;
+    }
+}
+
+TEST_CASE(RecordingHasTheHeaderIndexAndFrames)
+{
+    test::TempRecording recording(L"msmf_record_writer_test.raw");
+    FramePool pool(1 << 22);
+    RecordWriter writer;
+
+    REQUIRE(S_OK == writer.Open(recording.Path(), PixelFormat::NV12, Width, Height, 30, 1));
+    CHECK(writer.IsOpen());
+
+    size_t frameSize = 0;
+
+    for (int i = 0; i < FrameCount; ++i)
+    {
+        FrameRef frame = MakeFrame(pool, i);
+        REQUIRE(frame);
+        frameSize = frame->Size();
+        CHECK(writer.Write(std::move(frame)));
+    }
+
+    CHECK(S_OK == writer.Close());
+    CHECK(!writer.IsOpen());
+
+    const RecordWriter::Statistics stat = writer.GetStatistics();
+    CHECK(FrameCount == stat.queued);
+    CHECK(FrameCount == stat.written);
+    CHECK(FrameCount * frameSize == stat.bytes);
+    CHECK(0 == stat.dropped && 0 == stat.rejected);
+
+    const std::vector<uint8_t> data = ReadFile(recording.Path());
+    REQUIRE(data.size() >= RecordDataOffset + FrameCount * frameSize);
+
+    RecordHeader header;
+    memcpy(&header, data.data(), sizeof(header));
+    CHECK(RecordMagic == header.magic);
+    CHECK(RecordVersion == header.version);
+    CHECK(static_cast<uint32_t>(PixelFormat::NV12) == header.format);
+    CHECK(Width == header.width && Height == header.height);
+    CHECK(0 == header.stride % FrameAlignment);
+    CHECK(30 == header.fpsNumerator && 1 == header.fpsDenominator);
+    CHECK(FrameCount == header.frameCount);
+    CHECK(FrameCount * frameSize == header.dataSize);
+
+    const std::vector<uint8_t> index = ReadFile(RecordIndexPath(recording.Path()));
+    REQUIRE(index.size() == FrameCount * sizeof(RecordIndexEntry));
+
+    for (int i = 0; i < FrameCount; ++i)
+    {
+        RecordIndexEntry entry;
+        memcpy(&entry, index.data() + i * sizeof(entry), sizeof(entry));
+
+        CHECK(i * 333333 == entry.timestamp);
+        CHECK(static_cast<uint32_t>(i % 2) == entry.flags);
+        CHECK(frameSize == entry.size);
+        REQUIRE(entry.offset >= RecordDataOffset && entry.offset + entry.size <= data.size());
+
+        const uint8_t* frame = data.data() + entry.offset;
+        CHECK(frame[0] == i + 1 && frame[frameSize - 1] == i + 1);
+    }
+}
+
+TEST_CASE(FramesOfAnotherFormatAreRejected)
+{
+    test::TempRecording recording(L"msmf_record_writer_reject.raw");
+    FramePool pool(1 << 22);
+    RecordWriter writer;
+
+    REQUIRE(S_OK == writer.Open(recording.Path(), PixelFormat::NV12, Width, Height, 30, 1));
+
+    CHECK(writer.Write(MakeFrame(pool, 0)));
+    CHECK(writer.Write(pool.Acquire(FramePool::AlignedFormat(PixelFormat::YUY2, Width, Height))));
+    CHECK(S_OK == writer.Close());
+
+    const RecordWriter::Statistics stat = writer.GetStatistics();
+    CHECK(2 == stat.queued);
+    CHECK(1 == stat.written);
+    CHECK(1 == stat.rejected);
+}
+
+TEST_CASE(FullQueueDropsInsteadOfBlocking)
+{
+    test::TempRecording recording(L"msmf_record_writer_drop.raw");
+    FramePool pool(1 << 24);
+    RecordWriter writer(2);
+
+    REQUIRE(S_OK == writer.Open(recording.Path(), PixelFormat::NV12, Width, Height, 30, 1));
+
+    //
+    // Whatever the disk keeps up with, every frame is either queued or dropped
+    //
+    int accepted = 0;
+
+    for (int i = 0; i < 200; ++i)
+    {
+        accepted += writer.Write(MakeFrame(pool, i)) ? 1 : 0;
+    }
+
+    CHECK(S_OK == writer.Close());
+
+    const RecordWriter::Statistics stat = writer.GetStatistics();
+    CHECK(static_cast<uint64_t>(accepted) == stat.queued);
+    CHECK(200 == stat.queued + stat.dropped);
+    CHECK(stat.queued == stat.written);
+    CHECK(stat.maxBacklog <= 2);
+}
+
+TEST_CASE(WriterRefusesBadUse)
+{
+    test::TempRecording recording(L"msmf_record_writer_misuse.raw");
+    FramePool pool(1 << 22);
+    RecordWriter writer;
+
+    CHECK(!writer.Write(MakeFrame(pool, 0)));
+    CHECK(E_INVALIDARG == writer.Open(recording.Path(), PixelFormat::Unknown, Width, Height, 30, 1));
+
+    REQUIRE(S_OK == writer.Open(recording.Path(), PixelFormat::NV12, Width, Height, 30, 1));
+    CHECK(E_UNEXPECTED == writer.Open(recording.Path(), PixelFormat::NV12, Width, Height, 30, 1));
+    CHECK(!writer.Write(FrameRef()));
+    CHECK(S_OK == writer.Close());
+
+    CHECK(!writer.Write(MakeFrame(pool, 1)));
+    CHECK(S_OK == writer.Close());
+}
+
+TEST_CASE(RecordSinkCopiesFramesIntoThePool)
+{
+    test::TempRecording recording(L"msmf_record_sink.raw");
+    FramePool pool(1 << 22);
+    RecordWriter writer;
+
+    REQUIRE(S_OK == writer.Open(recording.Path(), PixelFormat::YUY2, 8, 2, 30, 1));
+
+    std::vector<uint8_t> pixels(16 * 2, 0x42);
+    RecordSink sink(writer, pool);
+    sink.OnFrame(MakeFrameView(PixelFormat::YUY2, 8, 2, pixels.data(), 16), 1234);
+
+    CHECK(S_OK == writer.Close());
+    CHECK(0 == sink.GetPoolDrops());
+    CHECK(1 == writer.GetStatistics().written);
+
+    const std::vector<uint8_t> index = ReadFile(RecordIndexPath(recording.Path()));
+    REQUIRE(index.size() == sizeof(RecordIndexEntry));
+
+    RecordIndexEntry entry;
+    memcpy(&entry, index.data(), sizeof(entry));
+    CHECK(1234 == entry.timestamp);
+}
@@ -0,0 +1,196 @@
+#include "TestHarness.h"
+#include "TempRecording.h"
+#include "BenchRunner.h"
+#include "FakeBackend.h"
+#include "RecordWriter.h"
+#include "ReplaySource.h"
+
+#include <fstream>
+#include <vector>
+
+using namespace capture;
+using video::PixelFormat;
+
+namespace
+{
+    constexpr uint64_t FrameLimit = 24;
+
+    //
+    // Passes every frame to two sinks
+    //
+    class TeeSink : public video::FrameSink
+    {
+    public:
+        TeeSink(video::FrameSink& first, video::FrameSink& second) noexcept
+            : m_first(first)
+            , m_second(second)
+        {
+        }
+
+        void OnFrame(const video::FrameView& frame, int64_t timestamp) override
+        {
+            m_first.OnFrame(frame, timestamp);
+            m_second.OnFrame(frame, timestamp);
+        }
+
+    private:
+        video::FrameSink& m_first;
+        video::FrameSink& m_second;
+    };
+
+    class TimestampSink : public video::FrameSink
+    {
+    public:
+        void OnFrame(const video::FrameView&, int64_t timestamp) override
+        {
+            timestamps.push_back(timestamp);
+        }
+
+        std::vector<int64_t> timestamps;
+    };
+
+    //
+    // Records FrameLimit frames of an odd sized I420 fake stream,
+    // the checksum and timestamps of the captured frames are kept
+    //
+    void Record(const std::wstring& path, video::ChecksumSink& captured, TimestampSink& timestamps)
+    {
+        FakeBackend::DeviceConfig device;
+        device.friendlyName = L"Replay Camera";
+        device.symbolicLink = L"fake#replay#0";
+        device.streams.resize(1);
+        device.streams[0].mediaTypes = { FakeBackend::MakeMediaType(0, PixelFormat::I420, 99, 37, 60) };
+
+        FakeBackend backend({ device });
+        backend.SetRealtime(false);
+        backend.SetFrameLimit(FrameLimit);
+
+        DeviceList devices;
+        std::unique_ptr<FrameSource> source;
+        backend.EnumDevices(devices);
+        devices[0]->OpenFrameSource(0, 0, source);
+
+        const MediaTypeInfo& mediaType = source->GetMediaType();
+        video::FramePool pool(1 << 24);
+        video::RecordWriter writer(FrameLimit * 2);
+        writer.Open(path, mediaType.format, mediaType.width, mediaType.height, mediaType.fpsNumerator, mediaType.fpsDenominator);
+
+        video::RecordSink record(writer, pool);
+        TeeSink checked(captured, timestamps);
+        TeeSink tee(record, checked);
+
+        BenchResult result;
+        RunBench(*source, tee, 1, 0, result);
+        writer.Close();
+    }
+
+    void PatchFile(const std::wstring& path, size_t offset, const void* data, size_t size)
+    {
+        std::fstream file(std::filesystem::path(path), std::ios::binary | std::ios::in | std::ios::out);
+        file.seekp(static_cast<std::streamoff>(offset));
+        file.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+    }
+}
+
+TEST_CASE(ReplayDeliversTheRecordedFrames)
+{
+    test::TempRecording recording(L"msmf_replay_round_trip.raw");
+    video::ChecksumSink captured;
+    TimestampSink capturedTimestamps;
+    Record(recording.Path(), captured, capturedTimestamps);
+    REQUIRE(FrameLimit == captured.GetFrames());
+
+    ReplaySource replay;
+    REQUIRE(S_OK == replay.Open(recording.Path(), false));
+    CHECK(FrameLimit == replay.GetFrameCount());
+
+    const MediaTypeInfo& mediaType = replay.GetMediaType();
+    CHECK(PixelFormat::I420 == mediaType.format);
+    CHECK(99 == mediaType.width && 37 == mediaType.height);
+    CHECK(60 == mediaType.fpsNumerator && 1 == mediaType.fpsDenominator);
+
+    video::ChecksumSink replayed;
+    TimestampSink replayedTimestamps;
+    TeeSink tee(replayed, replayedTimestamps);
+
+    BenchResult result;
+    CHECK(S_OK == RunBench(replay, tee, 1, 0, result));
+
+    CHECK(FrameLimit == replayed.GetFrames());
+    CHECK(captured.GetBytes() == replayed.GetBytes());
+    CHECK(captured.GetChecksum() == replayed.GetChecksum());
+    CHECK(capturedTimestamps.timestamps == replayedTimestamps.timestamps);
+    CHECK(0 == result.timing.droppedFrames);
+
+    const ReplaySource::Statistics stat = replay.GetStatistics();
+    CHECK(FrameLimit == stat.frames);
+    CHECK(FrameLimit * video::FramePool::AlignedFormat(PixelFormat::I420, 99, 37).BufferSize() == stat.bytes);
+}
+
+TEST_CASE(RealtimeReplayStopsOnRequest)
+{
+    test::TempRecording recording(L"msmf_replay_stop.raw");
+    video::ChecksumSink captured;
+    TimestampSink timestamps;
+    Record(recording.Path(), captured, timestamps);
+
+    //
+    // 24 frames at 60 fps take 400 ms, the replay is stopped after 50 ms
+    //
+    ReplaySource replay;
+    REQUIRE(S_OK == replay.Open(recording.Path(), true));
+
+    video::NullSink sink;
+    REQUIRE(S_OK == replay.Start(sink, 1));
+    CHECK(S_FALSE == replay.Wait(50));
+    CHECK(S_OK == replay.Stop());
+
+    CHECK(sink.GetFrames() < FrameLimit);
+    CHECK(sink.GetFrames() == replay.GetStatistics().frames);
+}
+
+TEST_CASE(InterruptedRecordingReplaysTheFramesOnDisk)
+{
+    test::TempRecording recording(L"msmf_replay_interrupted.raw");
+    video::ChecksumSink captured;
+    TimestampSink timestamps;
+    Record(recording.Path(), captured, timestamps);
+
+    //
+    // No frame count in the header and the last frame cut short,
+    // as a recording looks when the process dies
+    //
+    const uint64_t zero = 0;
+    PatchFile(recording.Path(), offsetof(video::RecordHeader, frameCount), &zero, sizeof(zero));
+    std::filesystem::resize_file(recording.Path(), std::filesystem::file_size(recording.Path()) - 1);
+
+    ReplaySource replay;
+    REQUIRE(S_OK == replay.Open(recording.Path(), false));
+    CHECK(FrameLimit - 1 == replay.GetFrameCount());
+
+    video::NullSink sink;
+    BenchResult result;
+    CHECK(S_OK == RunBench(replay, sink, 1, 0, result));
+    CHECK(FrameLimit - 1 == sink.GetFrames());
+}
+
+TEST_CASE(OpenRejectsMissingAndCorruptRecordings)
+{
+    test::TempRecording recording(L"msmf_replay_corrupt.raw");
+
+    ReplaySource missing;
+    CHECK(FAILED(missing.Open(recording.Path(), false)));
+
+    video::ChecksumSink captured;
+    TimestampSink timestamps;
+    Record(recording.Path(), captured, timestamps);
+
+    const uint32_t version = video::RecordVersion + 1;
+    PatchFile(recording.Path(), offsetof(video::RecordHeader, version), &version, sizeof(version));
+
+    ReplaySource corrupt;
+    CHECK(E_INVALIDARG == corrupt.Open(recording.Path(), false));
+
+    video::NullSink sink;
+    CHECK(E_UNEXPECTED == corrupt.Start(sink, 1));
+}
@@ -0,0 +1,187 @@
+#include "TestHarness.h"
+#include "TempRecording.h"
+#include "FakeBackend.h"
+#include "SoakMonitor.h"
+
+#include <algorithm>
+#include <fstream>
+#include <string>
+#include <vector>
+
+using namespace capture;
+
+namespace
+{
+    SoakSample MakeSample(uint32_t stream, double elapsed, uint64_t frames, uint64_t workingSet, uint32_t handles)
+    {
+        SoakSample sample = {};
+        sample.elapsed = elapsed;
+        sample.stream = stream;
+        sample.frames = frames;
+        sample.fps = static_cast<double>(frames);
+        sample.workingSet = workingSet;
+        sample.handles = handles;
+        return sample;
+    }
+
+    std::vector<std::string> ReadLines(const std::wstring& path)
+    {
+        std::ifstream file{ std::filesystem::path(path) };
+        std::vector<std::string> lines;
+
+        for (std::string line; std::getline(file, line);)
+        {
+            lines.push_back(line);
+        }
+
+        return lines;
+    }
+
+    //
+    // A 60 fps stream that ends after 6 frames, 100 ms, every time it is opened
+    //
+    FakeBackend MakeBackend()
+    {
+        FakeBackend::DeviceConfig device;
+        device.friendlyName = L"Flaky Camera";
+        device.symbolicLink = L"fake#flaky#0";
+        device.streams.resize(1);
+        device.streams[0].mediaTypes = { FakeBackend::MakeMediaType(0, video::PixelFormat::NV12, 64, 48, 60) };
+
+        FakeBackend backend({ device });
+        backend.SetFrameLimit(6);
+        return backend;
+    }
+}
+
+TEST_CASE(SampleIsOneLineOfTheHeaderColumns)
+{
+    SoakSample sample = MakeSample(1, 10.5, 300, 1 << 20, 42);
+    sample.restarts = 2;
+    sample.error = E_FAIL;
+
+    std::string line;
+    TimeSeriesWriter::FormatSample(sample, line);
+
+    const std::string header = TimeSeriesWriter::Header();
+    REQUIRE(!line.empty() && '\n' == line.back());
+    CHECK(1 == std::count(line.begin(), line.end(), '\n'));
+    CHECK(std::count(header.begin(), header.end(), ',') == std::count(line.begin(), line.end(), ','));
+    CHECK(0 == line.find("10.500,1,300,300.000,"));
+    CHECK(std::string::npos != line.find(",2,0x80004005,1048576,42\n"));
+}
+
+TEST_CASE(RunsShareOneHeader)
+{
+    test::TempRecording file(L"msmf_soak_test.csv");
+
+    TimeSeriesWriter closed;
+    CHECK(E_UNEXPECTED == closed.Append(MakeSample(0, 1, 30, 0, 0)));
+
+    for (int run = 0; run < 2; ++run)
+    {
+        TimeSeriesWriter writer;
+        REQUIRE(S_OK == writer.Open(file.Path()));
+        CHECK(S_OK == writer.Append(MakeSample(0, 1, 30, 0, 0)));
+        CHECK(S_OK == writer.Append(MakeSample(1, 1, 15, 0, 0)));
+        writer.Close();
+    }
+
+    const std::vector<std::string> lines = ReadLines(file.Path());
+    REQUIRE(5 == lines.size());
+    CHECK(TimeSeriesWriter::Header() == lines[0]);
+    CHECK(1 == std::count(lines.begin(), lines.end(), lines[0]));
+}
+
+TEST_CASE(AggregateKeepsTotalsAndExtremes)
+{
+    SoakAggregate aggregate;
+
+    //
+    // Stream 1 is seen first, stream 0 misses the first interval
+    //
+    aggregate.Add(MakeSample(1, 10, 300, 1000, 10));
+    aggregate.Add(MakeSample(1, 20, 100, 3000, 12));
+    aggregate.Add(MakeSample(0, 20, 200, 3000, 12));
+    aggregate.Add(MakeSample(1, 30, 200, 2000, 11));
+    aggregate.Add(MakeSample(0, 30, 250, 2000, 11));
+
+    const SoakAggregate::Summary summary = aggregate.GetSummary();
+    CHECK(30 == summary.seconds);
+    CHECK(1000 == summary.workingSetFirst && 2000 == summary.workingSetLast && 3000 == summary.workingSetMax);
+    CHECK(10 == summary.handlesFirst && 11 == summary.handlesLast && 12 == summary.handlesMax);
+
+    REQUIRE(2 == summary.streams.size());
+    const SoakAggregate::StreamSummary& late = summary.streams[0];
+    const SoakAggregate::StreamSummary& early = summary.streams[1];
+
+    CHECK(3 == early.samples && 600 == early.frames);
+    CHECK(100 == early.fpsMin && 300 == early.fpsMax);
+    CHECK(20 == early.fpsAvg);
+
+    //
+    // The average runs over the time the stream was sampled
+    //
+    CHECK(2 == late.samples && 450 == late.frames);
+    CHECK(200 == late.fpsMin && 250 == late.fpsMax);
+    CHECK(15 == late.fpsAvg);
+}
+
+TEST_CASE(StoppedSourcesAreRestarted)
+{
+    FakeBackend backend = MakeBackend();
+    DeviceList devices;
+    REQUIRE(SUCCEEDED(backend.EnumDevices(devices)));
+
+    test::TempRecording file(L"msmf_soak_run.csv");
+    TimeSeriesWriter writer;
+    REQUIRE(S_OK == writer.Open(file.Path()));
+
+    std::vector<SoakStream> streams(1);
+    streams[0].device = devices[0];
+
+    SoakSettings settings;
+    settings.seconds = 1;
+    settings.intervalSeconds = 1;
+    settings.restartDelayMs = 50;
+
+    SoakAggregate aggregate;
+    uint64_t callbacks = 0;
+    CHECK(S_OK == RunSoak(streams, settings, writer, aggregate, [&](const SoakSample&) { callbacks += 1; }));
+    writer.Close();
+
+    const SoakAggregate::Summary summary = aggregate.GetSummary();
+    REQUIRE(1 == summary.streams.size());
+
+    const SoakAggregate::StreamSummary& stream = summary.streams[0];
+    CHECK(stream.samples >= 1 && callbacks == stream.samples);
+    CHECK(stream.restarts >= 2);
+    CHECK(stream.frames >= 6 * stream.restarts);
+    CHECK(0 == stream.dropped);
+    CHECK(S_OK == stream.lastError);
+    CHECK(1 + callbacks == ReadLines(file.Path()).size());
+}
+
+TEST_CASE(SoakNeedsStreamsThatOpen)
+{
+    FakeBackend backend = MakeBackend();
+    DeviceList devices;
+    REQUIRE(SUCCEEDED(backend.EnumDevices(devices)));
+
+    TimeSeriesWriter writer;
+    SoakAggregate aggregate;
+    SoakSettings settings;
+    settings.seconds = 1;
+
+    CHECK(E_INVALIDARG == RunSoak({}, settings, writer, aggregate, nullptr));
+
+    std::vector<SoakStream> streams(1);
+    streams[0].device = devices[0];
+    settings.intervalSeconds = 0;
+    CHECK(E_INVALIDARG == RunSoak(streams, settings, writer, aggregate, nullptr));
+
+    settings.intervalSeconds = 1;
+    streams[0].mediaTypeIndex = 5;
+    CHECK(FAILED(RunSoak(streams, settings, writer, aggregate, nullptr)));
+    CHECK(0 == aggregate.GetSummary().streams.size());
+}
@@ -0,0 +1,208 @@
+#include "TestHarness.h"
+#include "SpscQueue.h"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+using video::QueuePolicy;
+using video::SpscQueue;
+
+namespace
+{
+    constexpr uint64_t StressItems = 100000;
+
+    struct StressResult
+    {
+        uint64_t accepted = 0;      // Push returned true
+        uint64_t received = 0;
+        bool ordered = true;
+        SpscQueue<uint64_t>::Statistics statistics = {};
+    };
+
+    //
+    // One producer pushes 1..StressItems, one consumer pops until the producer
+    // is done and the queue is empty. A slow consumer sleeps now and then,
+    // so the queue fills up and the policy has to act
+    //
+    StressResult RunStress(QueuePolicy policy, bool slowConsumer)
+    {
+        SpscQueue<uint64_t> queue(8, policy);
+        std::atomic<bool> done(false);
+        StressResult result;
+
+        std::thread consumer([&]()
+        {
+            uint64_t last = 0;
+            uint64_t value = 0;
+
+            for (;;)
+            {
+                if (queue.Pop(value))
+                {
+                    result.ordered = result.ordered && value > last;
+                    last = value;
+                    result.received += 1;
+
+                    if (slowConsumer && 0 == result.received % 1024)
+                    {
+                        std::this_thread::sleep_for(std::chrono::microseconds(200));
+                    }
+                }
+                else if (done.load(std::memory_order_acquire))
+                {
+                    if (0 == queue.Size())
+                    {
+                        break;
+                    }
+                }
+                else
+                {
+                    std::this_thread::yield();
+                }
+            }
+        });
+
+        for (uint64_t i = 1; i <= StressItems; ++i)
+        {
+            uint64_t value = i;
+
+            if (queue.Push(std::move(value)))
+            {
+                result.accepted += 1;
+            }
+        }
+
+        done.store(true, std::memory_order_release);
+        consumer.join();
+
+        result.statistics = queue.GetStatistics();
+        return result;
+    }
+}
+
+TEST_CASE(DropOldestKeepsTheNewestItems)
+{
+    SpscQueue<int> queue(4, QueuePolicy::DropOldest);
+
+    for (int i = 1; i <= 10; ++i)
+    {
+        int value = i;
+        CHECK(queue.Push(std::move(value)));
+    }
+
+    const auto stat = queue.GetStatistics();
+    CHECK(stat.droppedOldest == 6);
+    CHECK(stat.droppedNewest == 0);
+    CHECK(stat.blocked == 0);
+
+    int value = 0;
+
+    for (int expected = 7; expected <= 10; ++expected)
+    {
+        CHECK(queue.Pop(value));
+        CHECK(value == expected);
+    }
+
+    CHECK(!queue.Pop(value));
+}
+
+TEST_CASE(DropNewestKeepsTheOldestItems)
+{
+    SpscQueue<int> queue(4, QueuePolicy::DropNewest);
+
+    for (int i = 1; i <= 10; ++i)
+    {
+        int value = i;
+        CHECK(queue.Push(std::move(value)) == (i <= 4));
+    }
+
+    const auto stat = queue.GetStatistics();
+    CHECK(stat.droppedNewest == 6);
+    CHECK(stat.droppedOldest == 0);
+    CHECK(stat.blocked == 0);
+
+    int value = 0;
+
+    for (int expected = 1; expected <= 4; ++expected)
+    {
+        CHECK(queue.Pop(value));
+        CHECK(value == expected);
+    }
+
+    CHECK(!queue.Pop(value));
+}
+
+TEST_CASE(CloseReleasesABlockedProducer)
+{
+    SpscQueue<int> queue(2, QueuePolicy::Block);
+
+    for (int i = 0; i < 2; ++i)
+    {
+        int value = i;
+        CHECK(queue.Push(std::move(value)));
+    }
+
+    std::atomic<bool> pushed(true);
+
+    std::thread producer([&]()
+    {
+        int value = 2;
+        pushed = queue.Push(std::move(value));
+    });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    queue.Close();
+    producer.join();
+
+    const auto stat = queue.GetStatistics();
+    CHECK(!pushed);
+    CHECK(stat.blocked == 1);
+    CHECK(stat.droppedNewest == 1);
+    CHECK(queue.Size() == 2);
+}
+
+TEST_CASE(StressDropOldest)
+{
+    const auto result = RunStress(QueuePolicy::DropOldest, true);
+    const auto& stat = result.statistics;
+
+    CHECK(result.ordered);
+    CHECK(result.accepted == StressItems);
+    CHECK(stat.pushed == StressItems);
+    CHECK(stat.popped == result.received);
+    CHECK(stat.pushed == stat.popped + stat.droppedOldest);
+    CHECK(stat.droppedOldest > 0);
+    CHECK(stat.droppedNewest == 0);
+    CHECK(stat.blocked == 0);
+}
+
+TEST_CASE(StressDropNewest)
+{
+    const auto result = RunStress(QueuePolicy::DropNewest, true);
+    const auto& stat = result.statistics;
+
+    CHECK(result.ordered);
+    CHECK(stat.pushed == result.accepted);
+    CHECK(stat.popped == result.received);
+    CHECK(stat.pushed == stat.popped);
+    CHECK(stat.pushed + stat.droppedNewest == StressItems);
+    CHECK(stat.droppedNewest > 0);
+    CHECK(stat.droppedOldest == 0);
+    CHECK(stat.blocked == 0);
+}
+
+TEST_CASE(StressBlock)
+{
+    const auto result = RunStress(QueuePolicy::Block, true);
+    const auto& stat = result.statistics;
+
+    CHECK(result.ordered);
+    CHECK(result.accepted == StressItems);
+    CHECK(result.received == StressItems);
+    CHECK(stat.pushed == StressItems);
+    CHECK(stat.popped == StressItems);
+    CHECK(stat.blocked > 0);
+    CHECK(stat.droppedOldest == 0);
+    CHECK(stat.droppedNewest == 0);
+}
@@ -0,0 +1,180 @@
+#include "TestHarness.h"
+#include "BenchRunner.h"
+#include "FakeBackend.h"
+
+#include <vector>
+
+using namespace capture;
+using video::PixelFormat;
+
+namespace
+{
+    constexpr uint64_t FrameLimit = 40;
+
+    struct Delivery
+    {
+        uint32_t stream;
+        int64_t timestamp;
+        uint32_t width;
+    };
+
+    //
+    // The sinks of all the streams log to one list, the source delivers
+    // from one thread so the list is the delivery order
+    //
+    class LogSink : public video::FrameSink
+    {
+    public:
+        LogSink(uint32_t stream, std::vector<Delivery>& log) noexcept
+            : m_stream(stream)
+            , m_log(log)
+        {
+        }
+
+        void OnFrame(const video::FrameView& frame, int64_t timestamp) override
+        {
+            m_log.push_back({ m_stream, timestamp, frame.width });
+        }
+
+    private:
+        const uint32_t m_stream;
+        std::vector<Delivery>& m_log;
+    };
+
+    //
+    // A 120 fps preview stream and a 30 fps record stream
+    //
+    FakeBackend MakeBackend()
+    {
+        FakeBackend::DeviceConfig device;
+        device.friendlyName = L"Two Pin Camera";
+        device.symbolicLink = L"fake#twopin#0";
+        device.streams.resize(2);
+        device.streams[0].index = 0;
+        device.streams[0].mediaTypes = { FakeBackend::MakeMediaType(0, PixelFormat::NV12, 64, 48, 120) };
+        device.streams[1].index = 1;
+        device.streams[1].mediaTypes = {
+            FakeBackend::MakeMediaType(0, PixelFormat::YUY2, 96, 64, 30),
+            FakeBackend::MakeMediaType(1, PixelFormat::RGB32, 32, 24, 30),
+        };
+
+        FakeBackend backend({ device });
+        backend.SetRealtime(false);
+        backend.SetFrameLimit(FrameLimit);
+        return backend;
+    }
+}
+
+TEST_CASE(FramesAreRoutedByStreamIndex)
+{
+    std::vector<Delivery> log;
+    LogSink first(0, log);
+    LogSink second(3, log);
+
+    StreamDispatcher dispatcher;
+    CHECK(S_OK == dispatcher.AddStream(0, first));
+    CHECK(S_OK == dispatcher.AddStream(3, second));
+    CHECK(E_INVALIDARG == dispatcher.AddStream(3, first));
+    CHECK(FAILED(dispatcher.AddStream(StreamDispatcher::MaxStreamIndex + 1, first)));
+    CHECK(2 == dispatcher.GetStreamCount());
+
+    std::vector<uint8_t> pixels(16 * 4);
+    const video::FrameView frame = video::MakeFrameView(PixelFormat::RGB32, 4, 4, pixels.data(), 16);
+
+    dispatcher.Start();
+    dispatcher.OnFrame(3, frame, 0);
+    dispatcher.OnFrame(3, frame, 1);
+    dispatcher.OnFrame(0, frame, 0);
+    dispatcher.OnFrame(1, frame, 0);
+    dispatcher.OnFrame(99, frame, 0);
+    dispatcher.Stop();
+
+    REQUIRE(3 == log.size());
+    CHECK(3 == log[0].stream && 3 == log[1].stream && 0 == log[2].stream);
+
+    const StreamDispatcher::Report report = dispatcher.GetReport();
+    CHECK(3 == report.frames);
+    CHECK(2 == report.unrouted);
+    CHECK(3 * 64 == report.bytes);
+    REQUIRE(2 == report.streams.size());
+    CHECK(0 == report.streams[0].streamIndex && 1 == report.streams[0].bench.frames);
+    CHECK(3 == report.streams[1].streamIndex && 2 == report.streams[1].bench.frames);
+}
+
+TEST_CASE(StreamsInterleaveInTimestampOrder)
+{
+    FakeBackend backend = MakeBackend();
+    DeviceList devices;
+    REQUIRE(SUCCEEDED(backend.EnumDevices(devices)));
+
+    std::unique_ptr<MultiStreamSource> source;
+    REQUIRE(S_OK == devices[0]->OpenMultiStreamSource({ { 1, 0 }, { 0, 0 } }, source));
+    REQUIRE(2 == source->GetStreamCount());
+    CHECK(1 == source->GetStreamIndex(0) && 0 == source->GetStreamIndex(1));
+
+    std::vector<Delivery> log;
+    LogSink record(1, log);
+    LogSink preview(0, log);
+
+    StreamDispatcher::Report report;
+    REQUIRE(S_OK == RunMultiStreamBench(*source, { &record, &preview }, 1, 0, report));
+    REQUIRE(2 * FrameLimit == log.size());
+
+    //
+    // Timestamps never go back across the streams, and while both streams run
+    // four preview frames come between two record frames. The first preview
+    // frame ties with the first record frame and follows it
+    //
+    uint64_t previewSinceRecord = 0;
+    uint64_t recordFrames = 0;
+
+    for (size_t i = 0; i < log.size(); ++i)
+    {
+        CHECK(log[i].width == (log[i].stream == 1 ? 96u : 64u));
+
+        if (i > 0 && !CHECK(log[i].timestamp >= log[i - 1].timestamp))
+        {
+            return;
+        }
+
+        if (log[i].stream == 0)
+        {
+            previewSinceRecord += 1;
+            continue;
+        }
+
+        if (recordFrames > 1 && recordFrames < FrameLimit / 4)
+        {
+            CHECK(4 == previewSinceRecord);
+        }
+
+        recordFrames += 1;
+        previewSinceRecord = 0;
+    }
+
+    CHECK(2 * FrameLimit == report.frames);
+    CHECK(0 == report.unrouted);
+    REQUIRE(2 == report.streams.size());
+    CHECK(1 == report.streams[0].streamIndex && FrameLimit == report.streams[0].bench.frames);
+    CHECK(0 == report.streams[1].streamIndex && FrameLimit == report.streams[1].bench.frames);
+    CHECK(FrameLimit * 96 * 64 * 2 == report.streams[0].bytes);
+}
+
+TEST_CASE(MultiStreamSelectionsAreChecked)
+{
+    FakeBackend backend = MakeBackend();
+    DeviceList devices;
+    REQUIRE(SUCCEEDED(backend.EnumDevices(devices)));
+
+    std::unique_ptr<MultiStreamSource> source;
+    CHECK(E_INVALIDARG == devices[0]->OpenMultiStreamSource({}, source));
+    CHECK(E_INVALIDARG == devices[0]->OpenMultiStreamSource({ { 1, 0 }, { 1, 1 } }, source));
+    CHECK(E_INVALIDARG == devices[0]->OpenMultiStreamSource({ { 0, 0 }, { 2, 0 } }, source));
+    CHECK(E_INVALIDARG == devices[0]->OpenMultiStreamSource({ { 0, 1 } }, source));
+
+    REQUIRE(S_OK == devices[0]->OpenMultiStreamSource({ { 0, 0 }, { 1, 1 } }, source));
+
+    video::NullSink sink;
+    StreamDispatcher::Report report;
+    CHECK(E_INVALIDARG == RunMultiStreamBench(*source, { &sink }, 1, 0, report));
+}
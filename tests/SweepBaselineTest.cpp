@@ -0,0 +1,292 @@
+#include "TestHarness.h"
+#include "TempRecording.h"
+#include "SweepBaseline.h"
+
+#include <string>
+#include <vector>
+
+using namespace capture;
+
+namespace
+{
+    //
+    // A converged 30 fps mode of 300 frames, the names need quoting
+    //
+    BaselineRecord MakeRecord(double fps, double fpsHalfWidth, double jitterUs = 200, double jitterHalfWidthUs = 20)
+    {
+        BaselineRecord record;
+        record.symbolicLink = L"\\\\?\\usb#vid,1";
+        record.device = L"Cam \"A\", big";
+        record.subtype = L"NV12";
+        record.width = 1280;
+        record.height = 720;
+        record.fpsNumerator = 30;
+        record.fpsDenominator = 1;
+        record.frames = 300;
+        record.seconds = 10;
+        record.converged = true;
+        record.batches = 20;
+        record.fps = fps;
+        record.fpsHalfWidth = fpsHalfWidth;
+        record.jitterUs = jitterUs;
+        record.jitterHalfWidthUs = jitterHalfWidthUs;
+        record.jitterP50 = 100;
+        record.jitterP99 = 900;
+        record.jitterP999 = 1500;
+        record.firstFrameMs = 120;
+        record.cpuPerFrameMs = 0.2;
+        return record;
+    }
+
+    BaselineComparison CompareOne(const BaselineRecord& baseline, const BaselineRecord& current)
+    {
+        const std::vector<BaselineComparison> comparisons = CompareBaseline({ baseline }, { current });
+        return comparisons.empty() ? BaselineComparison() : comparisons[0];
+    }
+
+    struct BadBaseline
+    {
+        const char* text;
+        const char* error;
+    };
+
+    constexpr const char* KeyHeader = "symbolic_link,subtype,width,height,fps_numerator,fps_denominator\n";
+
+    //
+    // Every malformed baseline names the line and the reason
+    //
+    const BadBaseline BadBaselines[] =
+    {
+        { "", "no header" },
+        { "\r\n\r\n", "no header" },
+        { "width,height\n1,2\n", "line 1: no symbolic_link column" },
+        { "symbolic_link,subtype,width,height,fps_numerator\n", "line 1: no fps_denominator column" },
+        { "symbolic_link,subtype,width,height,fps_numerator,fps_denominator\n\"a,NV12,1,2,3,4\n", "line 2: unterminated quote" },
+        { "symbolic_link,subtype,width,height,fps_numerator,fps_denominator\na,NV12,1,2,3\n", "line 2: 5 fields of 6" },
+        { "symbolic_link,subtype,width,height,fps_numerator,fps_denominator\na,NV12,1,-2,3,4\n", "line 2: bad height '-2'" },
+        { "symbolic_link,subtype,width,height,fps_numerator,fps_denominator\na,NV12,1,99999999999,3,4\n", "line 2: bad height '99999999999'" },
+        { "symbolic_link,subtype,width,height,fps_numerator,fps_denominator,hr\na,NV12,1,2,3,4,80004005\n", "line 2: bad hr '80004005'" },
+        { "symbolic_link,subtype,width,height,fps_numerator,fps_denominator,fps\n\na,NV12,1,2,3,4,nan\n", "line 3: bad fps 'nan'" },
+        { "symbolic_link,subtype,width,height,fps_numerator,fps_denominator,converged\na,NV12,1,2,3,4,yes\n", "line 2: bad converged 'yes'" },
+    };
+}
+
+TEST_CASE(RecordsRoundTrip)
+{
+    std::vector<BaselineRecord> records = { MakeRecord(30, 0.1), MakeRecord(29.97, 0.01) };
+    records[1].fpsNumerator = 30000;
+    records[1].fpsDenominator = 1001;
+    records[1].hr = static_cast<HRESULT>(0x80070005);
+    records[1].converged = false;
+    records[1].batches = 1;
+    records[1].firstFrameMs = -1;
+
+    //
+    // Commas and quotes are quoted, quotes doubled
+    //
+    std::string line;
+    FormatBaselineRecord(records[0], line);
+    CHECK(0 == line.find("\"\\\\?\\usb#vid,1\",\"Cam \"\"A\"\", big\",0,0,NV12,1280,720,30,1,0x00000000,300,"));
+    CHECK('\n' == line.back());
+
+    test::TempRecording file(L"msmf_sweep_baseline_test.csv");
+    std::vector<BaselineRecord> loaded;
+    std::string error;
+    CHECK(E_FAIL == LoadBaseline(file.Path(), loaded, error));
+    CHECK("cannot open the baseline file" == error);
+
+    REQUIRE(S_OK == WriteBaseline(file.Path(), records));
+    REQUIRE(S_OK == LoadBaseline(file.Path(), loaded, error));
+    CHECK(error.empty());
+    REQUIRE(2 == loaded.size());
+
+    for (size_t i = 0; i < loaded.size(); ++i)
+    {
+        CHECK(records[i].Key() == loaded[i].Key());
+        CHECK(records[i].device == loaded[i].device);
+        CHECK(records[i].hr == loaded[i].hr);
+        CHECK(records[i].frames == loaded[i].frames);
+        CHECK(records[i].converged == loaded[i].converged);
+        CHECK(records[i].batches == loaded[i].batches);
+        CHECK(records[i].fps == loaded[i].fps);
+        CHECK(records[i].jitterP999 == loaded[i].jitterP999);
+        CHECK(records[i].firstFrameMs == loaded[i].firstFrameMs);
+        CHECK(records[i].cpuPerFrameMs == loaded[i].cpuPerFrameMs);
+    }
+
+    CHECK(loaded[0].Key() != loaded[1].Key());
+}
+
+TEST_CASE(ColumnsAreMatchedByName)
+{
+    //
+    // A BOM, CRLF lines, columns in another order, an unknown column and
+    // blank lines. Columns left out keep their defaults
+    //
+    std::vector<BaselineRecord> records;
+    std::string error;
+    REQUIRE(S_OK == ParseBaseline(
+        "\xEF\xBB\xBFwidth,extra,height,symbolic_link,subtype,fps_numerator,fps_denominator,fps\r\n"
+        "1,x,2,a,NV12,30,1,29.5\r\n"
+        "\r\n"
+        "3,\"y,z\",4,\"b\"\"c\",YUY2,60,1,59\r\n",
+        records, error));
+    REQUIRE(2 == records.size());
+    CHECK(1 == records[0].width && 2 == records[0].height);
+    CHECK(L"a" == records[0].symbolicLink && L"NV12" == records[0].subtype);
+    CHECK(29.5 == records[0].fps);
+    CHECK(records[0].firstFrameMs < 0);
+    CHECK(S_OK == records[0].hr && 0 == records[0].batches);
+    CHECK(L"b\"c" == records[1].symbolicLink && 59 == records[1].fps);
+
+    //
+    // A header alone is an empty baseline
+    //
+    CHECK(S_OK == ParseBaseline(BaselineHeader() + "\n", records, error));
+    CHECK(records.empty());
+}
+
+TEST_CASE(ParseErrorsNameTheLine)
+{
+    for (const auto& bad : BadBaselines)
+    {
+        std::vector<BaselineRecord> records(1);
+        std::string error;
+
+        CHECK(E_INVALIDARG == ParseBaseline(bad.text, records, error));
+        CHECK(bad.error == error);
+    }
+
+    std::vector<BaselineRecord> records;
+    std::string error;
+    CHECK(E_INVALIDARG == ParseBaseline(BaselineHeader() + "\n1,2\n", records, error));
+    CHECK("line 2: 2 fields of 24" == error);
+
+    CHECK(S_OK == ParseBaseline(std::string(KeyHeader) + "a,NV12,1,2,3,4\n", records, error));
+    CHECK(1 == records.size());
+}
+
+TEST_CASE(FpsAndJitterRegressBeyondTheIntervals)
+{
+    CHECK(!CompareOne(MakeRecord(30, 0.1), MakeRecord(29.9, 0.1)).Regressed());
+    CHECK(!CompareOne(MakeRecord(30, 0.1), MakeRecord(33, 0.1)).Regressed());
+    CHECK(CompareOne(MakeRecord(30, 0.1), MakeRecord(27, 0.1)).fps);
+
+    //
+    // 3 fps lost within the combined +-4.2 fps is noise
+    //
+    CHECK(!CompareOne(MakeRecord(30, 3), MakeRecord(27, 3)).fps);
+
+    CHECK(CompareOne(MakeRecord(30, 0.1, 200, 20), MakeRecord(30, 0.1, 400, 20)).jitter);
+
+    //
+    // 80 us of growth is under the floor, 250 us is beyond the combined
+    // +-212 us but not beyond +-283 us
+    //
+    CHECK(!CompareOne(MakeRecord(30, 0.1, 200, 20), MakeRecord(30, 0.1, 280, 20)).jitter);
+    CHECK(CompareOne(MakeRecord(30, 0.1, 200, 150), MakeRecord(30, 0.1, 450, 150)).jitter);
+    CHECK(!CompareOne(MakeRecord(30, 0.1, 200, 200), MakeRecord(30, 0.1, 450, 200)).jitter);
+}
+
+TEST_CASE(FewerThanTwoBatchesAreNeverSignificant)
+{
+    //
+    // A mean of a single batch has no interval, whichever side it is on
+    //
+    for (int side = 0; side < 2; ++side)
+    {
+        BaselineRecord baseline = MakeRecord(30, 0, 200, 0);
+        BaselineRecord current = MakeRecord(20, 0, 900, 0);
+        (side ? baseline : current).batches = 1;
+
+        const BaselineComparison comparison = CompareOne(baseline, current);
+        CHECK(!comparison.fps);
+        CHECK(!comparison.jitter);
+        CHECK(!comparison.Regressed());
+    }
+
+    BaselineRecord baseline = MakeRecord(30, 0, 200, 0);
+    baseline.batches = 2;
+    CHECK(CompareOne(baseline, MakeRecord(20, 0, 900, 0)).fps);
+}
+
+TEST_CASE(DropsRegressBySignificantGrowth)
+{
+    BaselineRecord baseline = MakeRecord(30, 0.1);
+    BaselineRecord current = MakeRecord(30, 0.1);
+
+    //
+    // 10 of 310 frames missing against none of 300 is z = 3.1
+    //
+    current.dropped = 10;
+    CHECK(CompareOne(baseline, current).drops);
+
+    //
+    // 1 of 301 is over the tolerance but z = 1.0
+    //
+    current.dropped = 1;
+    CHECK(!CompareOne(baseline, current).drops);
+
+    //
+    // 500 of a million is significant but within the 0.1% tolerance
+    //
+    baseline.frames = 1000000;
+    current.frames = 1000000;
+    current.dropped = 500;
+    CHECK(!CompareOne(baseline, current).drops);
+    current.dropped = 2000;
+    CHECK(CompareOne(baseline, current).drops);
+
+    //
+    // A share that does not grow is not a regression, however many
+    //
+    baseline.dropped = 2000;
+    CHECK(!CompareOne(baseline, current).drops);
+    CHECK(!CompareOne(current, MakeRecord(30, 0.1)).drops);
+}
+
+TEST_CASE(StartupAndCpuRegressOverTheFloor)
+{
+    const BaselineRecord baseline = MakeRecord(30, 0.1);
+    BaselineRecord current = MakeRecord(30, 0.1);
+
+    current.firstFrameMs = 300;
+    CHECK(CompareOne(baseline, current).firstFrame);
+    current.firstFrameMs = 160;
+    CHECK(!CompareOne(baseline, current).Regressed());
+
+    current.cpuPerFrameMs = 0.4;
+    CHECK(CompareOne(baseline, current).cpu);
+    current.cpuPerFrameMs = 0.24;
+    CHECK(!CompareOne(baseline, current).cpu);
+
+    //
+    // No first frame time in the baseline, nothing to compare with
+    //
+    BaselineRecord unknown = baseline;
+    unknown.firstFrameMs = -1;
+    current.firstFrameMs = 5000;
+    CHECK(!CompareOne(unknown, current).firstFrame);
+}
+
+TEST_CASE(MissingFailedAndNewModes)
+{
+    const BaselineRecord baseline = MakeRecord(30, 0.1);
+    BaselineRecord failed = MakeRecord(30, 0.1);
+    failed.hr = E_FAIL;
+    failed.frames = 0;
+
+    CHECK(CompareOne(baseline, failed).failed);
+    CHECK(!CompareOne(failed, baseline).Regressed());
+
+    //
+    // The baseline order first, then the new modes
+    //
+    BaselineRecord other = baseline;
+    other.width = 640;
+    const std::vector<BaselineComparison> comparisons = CompareBaseline({ baseline, baseline }, { other, other });
+    REQUIRE(2 == comparisons.size());
+    CHECK(comparisons[0].hasBaseline && !comparisons[0].hasCurrent && comparisons[0].missing);
+    CHECK(!comparisons[1].hasBaseline && comparisons[1].hasCurrent && !comparisons[1].Regressed());
+    CHECK(1 == CountRegressions(comparisons));
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <filesystem>
+#include <string>
+#include "RecordFile.h"
+
+namespace test
+{
+    //
+    // A recording path in the temp directory, the data file
+    // and the index are removed when it goes out of scope
+    //
+    class TempRecording
+    {
+    public:
+        explicit TempRecording(const wchar_t* name)
+            : m_path((std::filesystem::temp_directory_path() / name).wstring())
+        {
+            Remove();
+        }
+
+        ~TempRecording()
+        {
+            Remove();
+        }
+
+        TempRecording(const TempRecording&) = delete;
+        TempRecording& operator=(const TempRecording&) = delete;
+
+        const std::wstring& Path() const noexcept { return m_path; }
+
+    private:
+        void Remove() noexcept
+        {
+            std::error_code error;
+            std::filesystem::remove(m_path, error);
+            std::filesystem::remove(video::RecordIndexPath(m_path), error);
+        }
+
+    private:
+        std::wstring m_path;
+    };
+}
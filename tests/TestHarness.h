@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstdio>
+#include <vector>
+
+//
+// A test file registers its cases with TEST_CASE, TestMain.cpp runs them.
+// CHECK reports a failure and continues, REQUIRE also leaves the case
+//
+namespace test
+{
+    struct TestCase
+    {
+        const char* name;
+        void (*function)();
+    };
+
+    std::vector<TestCase>& Registry();
+
+    //
+    // Counts the failure of the running case and prints it
+    //
+    bool Fail(const char* file, int line, const char* expression);
+
+    struct Registrar
+    {
+        Registrar(const char* name, void (*function)())
+        {
+            Registry().push_back({ name, function });
+        }
+    };
+}
+
+#define TEST_CASE(name) \
+    static void name(); \
+    static const test::Registrar name##Registrar(#name, name); \
+    static void name()
+
+#define CHECK(expression) \
+    ((expression) ? true : test::Fail(__FILE__, __LINE__, #expression))
+
+#define REQUIRE(expression) \
+    do { if (!(expression)) { test::Fail(__FILE__, __LINE__, #expression); return; } } while (false)
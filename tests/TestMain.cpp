@@ -0,0 +1,63 @@
+#include "TestHarness.h"
+
+#include <cstring>
+
+namespace
+{
+    size_t g_failures = 0;
+}
+
+namespace test
+{
+    std::vector<TestCase>& Registry()
+    {
+        static std::vector<TestCase> registry;
+        return registry;
+    }
+
+    bool Fail(const char* file, int line, const char* expression)
+    {
+        g_failures += 1;
+        std::printf("%s:%d: CHECK(%s) failed\n", file, line, expression);
+        std::fflush(stdout);
+        return false;
+    }
+}
+
+//
+// Runs every case, or the cases whose name contains argv[1]
+//
+int main(int argc, char** argv)
+{
+    const char* filter = argc > 1 ? argv[1] : nullptr;
+    size_t failedCases = 0;
+    size_t ran = 0;
+
+    for (const auto& testCase : test::Registry())
+    {
+        if (filter && !std::strstr(testCase.name, filter))
+        {
+            continue;
+        }
+
+        std::printf("[ RUN  ] %s\n", testCase.name);
+        std::fflush(stdout);
+
+        const size_t failures = g_failures;
+        testCase.function();
+        ran += 1;
+
+        if (failures != g_failures)
+        {
+            failedCases += 1;
+            std::printf("[ FAIL ] %s\n", testCase.name);
+        }
+        else
+        {
+            std::printf("[   OK ] %s\n", testCase.name);
+        }
+    }
+
+    std::printf("%zu cases, %zu failed\n", ran, failedCases);
+    return failedCases ? 1 : 0;
+}
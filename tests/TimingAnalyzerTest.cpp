@@ -0,0 +1,198 @@
+#include "TestHarness.h"
+#include "TimingAnalyzer.h"
+
+using video::LogHistogram;
+using video::TimingAnalyzer;
+
+namespace
+{
+    //
+    // 30 fps in 100 ns units
+    //
+    constexpr int64_t Interval = 333333;
+
+    //
+    // Sample timestamps in 100 ns, arrivals on time in ns
+    //
+    void Feed(TimingAnalyzer& timing, int64_t timestamp)
+    {
+        timing.OnSample(timestamp, timestamp * 100);
+    }
+}
+
+TEST_CASE(EveryValueFallsInsideItsBucket)
+{
+    for (uint64_t value = 0; value < 100000; ++value)
+    {
+        const size_t index = LogHistogram::BucketIndex(value);
+
+        if (!CHECK(value >= LogHistogram::BucketLowerBound(index) && value <= LogHistogram::BucketUpperBound(index)))
+        {
+            return;
+        }
+    }
+
+    CHECK(LogHistogram::BucketIndex(UINT64_MAX) < LogHistogram::BucketCount);
+}
+
+TEST_CASE(PercentilesAreWithinTheBucketError)
+{
+    LogHistogram histogram;
+
+    for (uint64_t value = 1; value <= 10000; ++value)
+    {
+        histogram.Add(value);
+    }
+
+    CHECK(10000 == histogram.Count());
+    CHECK(1 == histogram.Min());
+    CHECK(10000 == histogram.Max());
+    CHECK(histogram.Mean() > 5000.4 && histogram.Mean() < 5000.6);
+
+    const uint64_t p50 = histogram.Percentile(0.5);
+    const uint64_t p99 = histogram.Percentile(0.99);
+    CHECK(p50 > 5000 * 0.9375 && p50 < 5000 * 1.0625);
+    CHECK(p99 > 9900 * 0.9375 && p99 < 9900 * 1.0625);
+    CHECK(histogram.Percentile(1.0) > 10000 * 0.9375 && histogram.Percentile(1.0) <= 10000);
+}
+
+TEST_CASE(MergeAndSnapshotAddUp)
+{
+    LogHistogram low;
+    LogHistogram high;
+    video::AtomicLogHistogram atomic;
+
+    for (uint64_t value = 0; value < 100; ++value)
+    {
+        low.Add(value);
+        high.Add(value + 1000);
+        atomic.Add(value + 1000);
+    }
+
+    LogHistogram snapshot;
+    atomic.Snapshot(snapshot);
+    CHECK(100 == snapshot.Count());
+    CHECK(snapshot.Percentile(0.5) == high.Percentile(0.5));
+
+    low.Merge(high);
+    CHECK(200 == low.Count());
+    CHECK(0 == low.Min());
+    CHECK(1099 == low.Max());
+
+    low.Reset();
+    CHECK(0 == low.Count() && 0 == low.Max() && 0 == low.Min());
+}
+
+TEST_CASE(SteadyStreamHasNoGaps)
+{
+    TimingAnalyzer timing;
+    timing.SetFrameRate(30, 1);
+
+    for (int64_t i = 0; i < 300; ++i)
+    {
+        Feed(timing, i * Interval);
+    }
+
+    const TimingAnalyzer::Report report = timing.GetReport();
+    CHECK(300 == report.frames);
+    CHECK(0 == report.droppedFrames);
+    CHECK(0 == report.gaps);
+    CHECK(0 == report.nonMonotonic);
+    CHECK(report.measuredFps > 29.99 && report.measuredFps < 30.01);
+    CHECK(report.intervalMax == 33333);
+    CHECK(0 == report.jitterMax);
+}
+
+TEST_CASE(GapsCountTheMissingFrames)
+{
+    TimingAnalyzer timing;
+    timing.SetFrameRate(30, 1);
+
+    //
+    // Frames 10 and 11 are missing, one gap of two frames, then frame 20 is
+    // missing, then a 1.4 interval late frame that is not a gap
+    //
+    int64_t timestamp = 0;
+
+    for (int64_t i = 0; i < 30; ++i)
+    {
+        if (i == 10 || i == 11 || i == 20)
+        {
+            continue;
+        }
+
+        timestamp = i * Interval;
+        Feed(timing, timestamp);
+    }
+
+    Feed(timing, timestamp + Interval * 14 / 10);
+
+    const TimingAnalyzer::Report report = timing.GetReport();
+    CHECK(28 == report.frames);
+    CHECK(2 == report.gaps);
+    CHECK(3 == report.droppedFrames);
+    CHECK(0 == report.nonMonotonic);
+}
+
+TEST_CASE(OutOfOrderTimestampsAreNotIntervals)
+{
+    TimingAnalyzer timing;
+    timing.SetFrameRate(30, 1);
+
+    Feed(timing, 0);
+    Feed(timing, Interval);
+    Feed(timing, Interval);         // repeated
+    Feed(timing, 3 * Interval);     // one frame missing
+    Feed(timing, 2 * Interval);     // late, reordered
+    Feed(timing, 4 * Interval);
+
+    const TimingAnalyzer::Report report = timing.GetReport();
+    CHECK(6 == report.frames);
+    CHECK(2 == report.nonMonotonic);
+    CHECK(1 == report.gaps);
+    CHECK(1 == report.droppedFrames);
+    CHECK(3 == timing.GetIntervals().Count());
+
+    //
+    // The delivered rate: 3 advancing frames over 4 frame intervals
+    //
+    CHECK(report.measuredFps > 22.49 && report.measuredFps < 22.51);
+}
+
+TEST_CASE(JitterIsTheArrivalIntervalError)
+{
+    TimingAnalyzer timing;
+    timing.SetFrameRate(30, 1);
+
+    //
+    // Every other frame arrives 2 ms late
+    //
+    for (int64_t i = 0; i < 100; ++i)
+    {
+        timing.OnSample(i * Interval, i * Interval * 100 + ((i % 2) ? 2000000 : 0));
+    }
+
+    const TimingAnalyzer::Report report = timing.GetReport();
+    CHECK(0 == report.gaps);
+    CHECK(report.jitterP50 > 1875 && report.jitterP50 < 2125);
+    CHECK(report.jitterMax == 2000);
+}
+
+TEST_CASE(NoFrameRateDisablesDropDetection)
+{
+    TimingAnalyzer timing;
+
+    Feed(timing, 0);
+    Feed(timing, Interval);
+    Feed(timing, 10 * Interval);
+
+    TimingAnalyzer::Report report = timing.GetReport();
+    CHECK(0 == report.gaps);
+    CHECK(0 == report.droppedFrames);
+    CHECK(0 == report.nominalFps);
+
+    timing.Reset();
+    report = timing.GetReport();
+    CHECK(0 == report.frames);
+    CHECK(0 == timing.GetIntervals().Count());
+}